@@ -22,7 +22,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QMap>
 #include <QVector>
 
+#include <cerrno>
+
 static QMap<int, QVector<_drmModeProperty>> s_drmProperties{};
+static QMap<int, QMap<uint32_t, QByteArray>> s_drmPropertyBlobs{};
+static uint32_t s_nextPropertyBlobId = 1;
 
 namespace MockDrm
 {
@@ -32,6 +36,16 @@ void addDrmModeProperties(int fd, const QVector<_drmModeProperty> &properties)
     s_drmProperties.insert(fd, properties);
 }
 
+QByteArray propertyBlob(int fd, uint32_t blobId)
+{
+    return s_drmPropertyBlobs.value(fd).value(blobId);
+}
+
+int propertyBlobCount(int fd)
+{
+    return s_drmPropertyBlobs.value(fd).count();
+}
+
 }
 
 int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id, uint64_t value)
@@ -76,3 +90,18 @@ void drmModeFreeProperty(drmModePropertyPtr ptr)
 {
     delete ptr;
 }
+
+int drmModeCreatePropertyBlob(int fd, const void *data, size_t size, uint32_t *id)
+{
+    *id = s_nextPropertyBlobId++;
+    s_drmPropertyBlobs[fd].insert(*id, QByteArray(static_cast<const char *>(data), size));
+    return 0;
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id)
+{
+    if (!s_drmPropertyBlobs[fd].remove(id)) {
+        return -EINVAL;
+    }
+    return 0;
+}
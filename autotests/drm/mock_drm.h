@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <cstdint>
 #include <xf86drmMode.h>
 
+#include <QByteArray>
 #include <QVector>
 
 namespace MockDrm
@@ -29,4 +30,10 @@ namespace MockDrm
 
 void addDrmModeProperties(int fd, const QVector<_drmModeProperty> &properties);
 
+/**
+ * @return the data of the property blob @p blobId, empty if there is no such blob
+ */
+QByteArray propertyBlob(int fd, uint32_t blobId);
+int propertyBlobCount(int fd);
+
 }
@@ -54,6 +54,14 @@ public:
         return property->propId();
     }
 
+    uint64_t value(int prop) const {
+        auto property = DrmObject::m_props.at(prop);
+        if (!property) {
+            return 0;
+        }
+        return property->value();
+    }
+
 private:
     uint32_t m_count = 0;
     uint32_t *m_props = nullptr;
@@ -85,6 +93,7 @@ private Q_SLOTS:
     void testFd();
     void testOutput();
     void testInitProperties();
+    void testSetBlob();
 };
 
 void ObjectTest::testId_data()
@@ -214,5 +223,61 @@ void ObjectTest::testInitProperties()
     QCOMPARE(object.propHasEnum(2, 0), false);
 }
 
+void ObjectTest::testSetBlob()
+{
+    uint32_t propertiesIds[] = { 0 };
+    uint64_t values[] = { 0 };
+    MockDrm::addDrmModeProperties(21, QVector<_drmModeProperty>{
+        _drmModeProperty{
+            0,
+            DRM_MODE_PROP_BLOB,
+            "foo\0",
+            0,
+            nullptr,
+            0,
+            nullptr,
+            0,
+            nullptr
+        }
+    });
+
+    {
+        MockDrmObject object{0, 21};
+        object.setProperties(1, propertiesIds, values);
+        object.atomicInit();
+
+        QVERIFY(object.setBlob(0, QByteArrayLiteral("lut1")));
+        const uint64_t blobId = object.value(0);
+        QVERIFY(blobId != 0);
+        QCOMPARE(MockDrm::propertyBlobCount(21), 1);
+        QCOMPARE(MockDrm::propertyBlob(21, blobId), QByteArrayLiteral("lut1"));
+
+        // the same data doesn't create a new blob
+        QVERIFY(object.setBlob(0, QByteArrayLiteral("lut1")));
+        QCOMPARE(object.value(0), blobId);
+        QCOMPARE(MockDrm::propertyBlobCount(21), 1);
+
+        // other data replaces the blob
+        QVERIFY(object.setBlob(0, QByteArrayLiteral("lut2")));
+        QVERIFY(object.value(0) != blobId);
+        QCOMPARE(MockDrm::propertyBlobCount(21), 1);
+        QCOMPARE(MockDrm::propertyBlob(21, object.value(0)), QByteArrayLiteral("lut2"));
+
+        // no data unsets the blob
+        QVERIFY(object.setBlob(0, QByteArray()));
+        QCOMPARE(object.value(0), uint64_t(0));
+        QCOMPARE(MockDrm::propertyBlobCount(21), 0);
+
+        QVERIFY(object.setBlob(0, QByteArrayLiteral("lut3")));
+        QCOMPARE(MockDrm::propertyBlobCount(21), 1);
+
+        // the property is not known
+        QVERIFY(!object.setBlob(1, QByteArrayLiteral("lut")));
+    }
+
+    // the blob is released together with the object
+    QCOMPARE(MockDrm::propertyBlobCount(21), 0);
+}
+
 QTEST_GUILESS_MAIN(ObjectTest)
 #include "objecttest.moc"
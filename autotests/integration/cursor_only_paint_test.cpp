@@ -0,0 +1,174 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "composite.h"
+#include "cursor.h"
+#include "effectloader.h"
+#include "effect_builtins.h"
+#include "platform.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "xdgshellclient.h"
+
+#include <kwinglutils.h>
+
+#include <KConfigGroup>
+
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_cursor_only_paint-0");
+
+class CursorOnlyPaintTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testCursorMotion();
+    void testWindowDamage();
+
+private:
+    quint64 cursorOnlyFrames() const;
+    bool paintFrame();
+};
+
+void CursorOnlyPaintTest::initTestCase()
+{
+    qRegisterMetaType<KWin::XdgShellClient *>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+
+    // disable all effects - we don't want to have it interact with the rendering
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    ScriptedEffectLoader loader;
+    const auto builtinNames = BuiltInEffects::availableEffectNames() << loader.listOfKnownEffects();
+    for (QString name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("XCURSOR_THEME", QByteArrayLiteral("DMZ-White"));
+    qputenv("XCURSOR_SIZE", QByteArrayLiteral("24"));
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    // only the per screen rendering draws the software cursor
+    qputenv("KWIN_WAYLAND_VIRTUAL_PER_SCREEN_RENDERING", QByteArrayLiteral("1"));
+    qputenv("KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH", QByteArrayLiteral("2"));
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    QVERIFY(Compositor::self());
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QCOMPARE(scene->compositingType(), KWin::OpenGL2Compositing);
+    QVERIFY(kwinApp()->platform()->usesSoftwareCursor());
+    if (!GLRenderTarget::blitSupported()) {
+        QSKIP("The cursor backing store needs framebuffer blits");
+    }
+}
+
+void CursorOnlyPaintTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+    // away from the windows, so that no decoration reacts to the pointer
+    Cursor::setPos(QPoint(900, 800));
+}
+
+void CursorOnlyPaintTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+quint64 CursorOnlyPaintTest::cursorOnlyFrames() const
+{
+    return Compositor::self()->scene()->property("cursorOnlyFrames").value<quint64>();
+}
+
+bool CursorOnlyPaintTest::paintFrame()
+{
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    Compositor::self()->addRepaintFull();
+    return swapSpy.wait();
+}
+
+void CursorOnlyPaintTest::testCursorMotion()
+{
+    // this test verifies that a frame in which only the software cursor moved is presented
+    // without painting the windows
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    XdgShellClient *client = Test::renderAndWaitForShown(surface.data(), QSize(200, 150), Qt::blue);
+    QVERIFY(client);
+
+    // the full repaint saves the screen without the cursor
+    QVERIFY(paintFrame());
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene->canPaintCursorOnly());
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    const quint64 frames = cursorOnlyFrames();
+    for (int i = 1; i <= 3; ++i) {
+        // each motion is presented from the backing store of the previous frames
+        Cursor::setPos(QPoint(900 + 20 * i, 800));
+        QVERIFY(swapSpy.wait());
+        QTRY_COMPARE(cursorOnlyFrames(), frames + i);
+        QVERIFY(scene->canPaintCursorOnly());
+    }
+}
+
+void CursorOnlyPaintTest::testWindowDamage()
+{
+    // this test verifies that damage of a window is painted normally and keeps the
+    // backing store usable for the next cursor motion
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    XdgShellClient *client = Test::renderAndWaitForShown(surface.data(), QSize(200, 150), Qt::blue);
+    QVERIFY(client);
+    QVERIFY(paintFrame());
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene->canPaintCursorOnly());
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    const quint64 frames = cursorOnlyFrames();
+    QSignalSpy damagedSpy(client, &Toplevel::damaged);
+    QVERIFY(damagedSpy.isValid());
+    Test::render(surface.data(), QSize(200, 150), Qt::red);
+    QVERIFY(damagedSpy.wait());
+    QVERIFY(swapSpy.wait());
+    QCOMPARE(cursorOnlyFrames(), frames);
+    QVERIFY(scene->canPaintCursorOnly());
+
+    // the next motion is presented without painting the windows again
+    Cursor::setPos(QPoint(920, 800));
+    QVERIFY(swapSpy.wait());
+    QTRY_COMPARE(cursorOnlyFrames(), frames + 1);
+}
+
+WAYLANDTEST_MAIN(CursorOnlyPaintTest)
+#include "cursor_only_paint_test.moc"
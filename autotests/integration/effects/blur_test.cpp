@@ -0,0 +1,237 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "composite.h"
+#include "effectloader.h"
+#include "effects.h"
+#include "platform.h"
+#include "scene.h"
+#include "xdgshellclient.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include "effect_builtins.h"
+
+#include <KWayland/Client/blur.h>
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_effects_blur-0");
+
+class BlurTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testCacheIsBounded();
+    void testCacheReusedAfterClose();
+    void testPopupNotCached();
+
+private:
+    struct BlurredWindow {
+        QSharedPointer<Surface> surface;
+        QSharedPointer<XdgShellSurface> shellSurface;
+        QSharedPointer<Blur> blur;
+        XdgShellClient *client = nullptr;
+    };
+    BlurredWindow createBlurredWindow(const QPoint &pos);
+    bool paintFrame();
+
+    Effect *m_blur = nullptr;
+};
+
+void BlurTest::initTestCase()
+{
+    qputenv("XDG_DATA_DIRS", QCoreApplication::applicationDirPath().toUtf8());
+
+    qRegisterMetaType<KWin::AbstractClient *>();
+    qRegisterMetaType<KWin::XdgShellClient *>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    ScriptedEffectLoader loader;
+    const auto builtinNames = BuiltInEffects::availableEffectNames() << loader.listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+
+    auto scene = KWin::Compositor::self()->scene();
+    QVERIFY(scene);
+    QCOMPARE(scene->compositingType(), KWin::OpenGL2Compositing);
+}
+
+void BlurTest::init()
+{
+    auto effectsImpl = qobject_cast<EffectsHandlerImpl *>(effects);
+    QVERIFY(effectsImpl);
+    if (!effectsImpl->loadEffect(BuiltInEffects::nameForEffect(BuiltInEffect::Blur))) {
+        QSKIP("The blur effect is not supported by the GL implementation");
+    }
+    m_blur = effectsImpl->findEffect(BuiltInEffects::nameForEffect(BuiltInEffect::Blur));
+    QVERIFY(m_blur);
+
+    // the blur manager is announced once the effect is loaded
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::BlurManager));
+}
+
+void BlurTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+
+    auto effectsImpl = qobject_cast<EffectsHandlerImpl *>(effects);
+    QVERIFY(effectsImpl);
+    effectsImpl->unloadAllEffects();
+    QVERIFY(effectsImpl->loadedEffects().isEmpty());
+    m_blur = nullptr;
+}
+
+BlurTest::BlurredWindow BlurTest::createBlurredWindow(const QPoint &pos)
+{
+    BlurredWindow window;
+    window.surface.reset(Test::createSurface());
+    window.shellSurface.reset(Test::createXdgShellStableSurface(window.surface.data()));
+
+    // without a region the whole window gets blurred
+    window.blur.reset(Test::waylandBlurManager()->createBlur(window.surface.data()));
+    window.blur->commit();
+
+    window.client = Test::renderAndWaitForShown(window.surface.data(), QSize(100, 50), QColor(0, 0, 255, 128));
+    if (window.client) {
+        window.client->move(pos);
+    }
+    return window;
+}
+
+bool BlurTest::paintFrame()
+{
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    Compositor::self()->addRepaintFull();
+    return swapSpy.wait();
+}
+
+void BlurTest::testCacheIsBounded()
+{
+    // this test verifies that blurring more windows than the cache limit doesn't make the
+    // windows take the caches over from each other in every frame
+    QVector<BlurredWindow> windows;
+    for (int i = 0; i < 6; ++i) {
+        // far enough apart that repainting one window doesn't touch the background of another
+        windows << createBlurredWindow(QPoint((i % 3) * 500, 100 + (i / 3) * 500));
+        QVERIFY(windows.last().client);
+    }
+
+    QVERIFY(paintFrame());
+    QVERIFY(m_blur->property("fullBlurPasses").toInt() >= 6);
+    QCOMPARE(m_blur->property("cachedBlurWindows").toInt(), 6);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 6);
+
+    // only the windows themselves change, so every window is restored from its cache
+    const int fullBlurPasses = m_blur->property("fullBlurPasses").toInt();
+    const int skippedBlurPasses = m_blur->property("skippedBlurPasses").toInt();
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    for (const BlurredWindow &window : windows) {
+        window.client->addRepaintFull();
+    }
+    QVERIFY(swapSpy.wait());
+    QCOMPARE(m_blur->property("fullBlurPasses").toInt(), fullBlurPasses);
+    QCOMPARE(m_blur->property("skippedBlurPasses").toInt(), skippedBlurPasses + 6);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 6);
+
+    // the textures above the limit are released once the windows are gone
+    for (int i = 0; i < 3; ++i) {
+        BlurredWindow &window = windows[i];
+        window.shellSurface.clear();
+        window.surface.clear();
+        QVERIFY(Test::waitForWindowDestroyed(window.client));
+    }
+    QTRY_COMPARE(m_blur->property("cachedBlurWindows").toInt(), 3);
+    QVERIFY(paintFrame());
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 4);
+}
+
+void BlurTest::testCacheReusedAfterClose()
+{
+    // this test verifies that the cache of a closed window is kept for the next blurred window
+    BlurredWindow first = createBlurredWindow(QPoint(100, 100));
+    QVERIFY(first.client);
+    QVERIFY(paintFrame());
+    QCOMPARE(m_blur->property("cachedBlurWindows").toInt(), 1);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 1);
+
+    first.shellSurface.clear();
+    first.surface.clear();
+    QVERIFY(Test::waitForWindowDestroyed(first.client));
+    QTRY_COMPARE(m_blur->property("cachedBlurWindows").toInt(), 0);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 1);
+
+    BlurredWindow second = createBlurredWindow(QPoint(300, 100));
+    QVERIFY(second.client);
+    QVERIFY(paintFrame());
+    QCOMPARE(m_blur->property("cachedBlurWindows").toInt(), 1);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 1);
+}
+
+void BlurTest::testPopupNotCached()
+{
+    // this test verifies that short-lived popups are blurred without a cache
+    QScopedPointer<Surface> mainSurface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> mainShellSurface(Test::createXdgShellStableSurface(mainSurface.data()));
+    XdgShellClient *mainWindow = Test::renderAndWaitForShown(mainSurface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(mainWindow);
+
+    QScopedPointer<Surface> popupSurface(Test::createSurface());
+    XdgPositioner positioner(QSize(50, 50), QRect(0, 0, 10, 10));
+    positioner.setGravity(Qt::BottomEdge | Qt::RightEdge);
+    positioner.setAnchorEdge(Qt::BottomEdge | Qt::LeftEdge);
+    QScopedPointer<XdgShellPopup> popupShellSurface(Test::createXdgShellStablePopup(popupSurface.data(), mainShellSurface.data(), positioner));
+    QScopedPointer<Blur> blur(Test::waylandBlurManager()->createBlur(popupSurface.data()));
+    blur->commit();
+    XdgShellClient *popup = Test::renderAndWaitForShown(popupSurface.data(), positioner.initialSize(), QColor(255, 0, 0, 128));
+    QVERIFY(popup);
+    QVERIFY(popup->isPopupWindow());
+
+    QVERIFY(paintFrame());
+    QCOMPARE(m_blur->property("cachedBlurWindows").toInt(), 0);
+    QCOMPARE(m_blur->property("blurCacheTextures").toInt(), 0);
+}
+
+WAYLANDTEST_MAIN(BlurTest)
+#include "blur_test.moc"
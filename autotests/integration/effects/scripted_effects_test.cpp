@@ -66,6 +66,8 @@ private Q_SLOTS:
     void testShortcuts();
     void testAnimations_data();
     void testAnimations();
+    void testAnimationsOfSeveralWindows_data();
+    void testAnimationsOfSeveralWindows();
     void testScreenEdge();
     void testScreenEdgeTouch();
     void testFullScreenEffect_data();
@@ -349,6 +351,63 @@ void ScriptedEffectsTest::testAnimations()
     }
 }
 
+void ScriptedEffectsTest::testAnimationsOfSeveralWindows_data()
+{
+    QTest::addColumn<int>("minimized");
+    QTest::addColumn<QVector<int>>("remaining");
+
+    // the short animation of the minimized window cancels the one of the window added after it
+    QTest::newRow("first") << 0 << QVector<int>{2, 3};
+    QTest::newRow("last") << 3 << QVector<int>{1, 2};
+}
+
+void ScriptedEffectsTest::testAnimationsOfSeveralWindows()
+{
+    // this test verifies that the animations stay with their windows when
+    // the windows in between are released, also while the rows are walked
+    QFETCH(int, minimized);
+    QFETCH(QVector<int>, remaining);
+
+    auto *effect = new ScriptedEffectWithDebugSpy;
+    QSignalSpy effectOutputSpy(effect, &ScriptedEffectWithDebugSpy::testOutput);
+    QVERIFY(effectOutputSpy.isValid());
+    QVERIFY(effect->load(QStringLiteral("animationTestSeveral")));
+
+    using namespace KWayland::Client;
+    QVector<Surface *> surfaces;
+    QVector<XdgShellSurface *> shellSurfaces;
+    QVector<AbstractClient *> clients;
+    for (int i = 0; i < 4; ++i) {
+        auto *surface = Test::createSurface(Test::waylandCompositor());
+        QVERIFY(surface);
+        auto *shellSurface = Test::createXdgShellV6Surface(surface, surface);
+        QVERIFY(shellSurface);
+        auto *c = Test::renderAndWaitForShown(surface, QSize(100, 50), Qt::blue);
+        QVERIFY(c);
+        surfaces << surface;
+        shellSurfaces << shellSurface;
+        clients << c;
+    }
+    QCOMPARE(effect->state().count(), 4);
+
+    clients[minimized]->setMinimized(true);
+    QVERIFY(effectOutputSpy.wait());
+    QCOMPARE(effectOutputSpy.last().first(), QStringLiteral("ended"));
+    QTRY_COMPARE(effect->state().count(), remaining.count());
+
+    const auto state = effect->state();
+    for (int i : remaining) {
+        QVERIFY(state.contains(clients[i]->effectWindow()));
+        const auto &animationsForWindow = state.value(clients[i]->effectWindow()).first;
+        QCOMPARE(animationsForWindow.count(), 1);
+        QCOMPARE(animationsForWindow[0].attribute, AnimationEffect::Scale);
+        QCOMPARE(animationsForWindow[0].timeLine.duration(), 100000ms);
+    }
+
+    qDeleteAll(shellSurfaces);
+    qDeleteAll(surfaces);
+}
+
 void ScriptedEffectsTest::testScreenEdge()
 {
     // this test checks registerScreenEdge functions
@@ -0,0 +1,18 @@
+var windows = [];
+
+effects.windowAdded.connect(function(w) {
+    windows.push(w);
+    w.anim1 = effect.animate(w, Effect.Scale, 100000, 1.4, 0.2, 0, QEasingCurve.OutQuad);
+});
+
+effects.windowMinimized.connect(function(w) {
+    cancel(w.anim1);
+    w.anim1 = effect.animate(w, Effect.Opacity, 1, 0.5, 1.0);
+});
+
+effect.animationEnded.connect(function(w) {
+    // cancel the animation of another window while its row is walked
+    var next = windows[(windows.indexOf(w) + 1) % windows.length];
+    cancel(next.anim1);
+    sendTestResponse("ended");
+});
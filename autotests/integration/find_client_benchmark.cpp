@@ -0,0 +1,134 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "xdgshellclient.h"
+
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+#include <KWayland/Server/seat_interface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_find_client_benchmark-0");
+
+/**
+ * Benchmarks looking up the client of a surface and of a window id, as done with every
+ * focus change. The focus sequence is recorded by moving the pointer over a grid of windows.
+ */
+class FindClientBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void benchmarkFocusChurn_data();
+    void benchmarkFocusChurn();
+};
+
+void FindClientBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::XdgShellClient *>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void FindClientBenchmark::init()
+{
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::Seat));
+}
+
+void FindClientBenchmark::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void FindClientBenchmark::benchmarkFocusChurn_data()
+{
+    QTest::addColumn<int>("windows");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("300") << 300;
+}
+
+void FindClientBenchmark::benchmarkFocusChurn()
+{
+    QFETCH(int, windows);
+
+    // lay the windows out in a grid, so that every pointer motion may change the focus
+    const int columns = 20;
+    const QSize size(64, 64);
+    QVector<Surface *> surfaces;
+    QVector<XdgShellSurface *> shellSurfaces;
+    QVector<XdgShellClient *> clients;
+    for (int i = 0; i < windows; ++i) {
+        Surface *surface = Test::createSurface();
+        QVERIFY(surface);
+        XdgShellSurface *shellSurface = Test::createXdgShellStableSurface(surface);
+        QVERIFY(shellSurface);
+        XdgShellClient *client = Test::renderAndWaitForShown(surface, size, Qt::blue);
+        QVERIFY(client);
+        client->move(QPoint((i % columns) * size.width(), (i / columns) * size.height()));
+        surfaces << surface;
+        shellSurfaces << shellSurface;
+        clients << client;
+    }
+
+    // record the focused surfaces while the pointer zigzags over the windows
+    const int rows = (windows + columns - 1) / columns;
+    QVector<KWayland::Server::SurfaceInterface *> focusSequence;
+    quint32 timestamp = 1;
+    for (int step = 0; step < 1000; ++step) {
+        const QPointF pos((step * 37) % (columns * size.width()) + 0.5,
+                          (step * 23) % (rows * size.height()) + 0.5);
+        kwinApp()->platform()->pointerMotion(pos, timestamp++);
+        if (auto surface = waylandServer()->seat()->focusedPointerSurface()) {
+            focusSequence << surface;
+        }
+    }
+    QVERIFY(!focusSequence.isEmpty());
+
+    QBENCHMARK {
+        for (KWayland::Server::SurfaceInterface *surface : qAsConst(focusSequence)) {
+            XdgShellClient *client = waylandServer()->findClient(surface);
+            QVERIFY(client);
+            QCOMPARE(waylandServer()->findClient(client->windowId()), client);
+        }
+    }
+
+    qDeleteAll(shellSurfaces);
+    qDeleteAll(surfaces);
+    for (XdgShellClient *client : clients) {
+        QVERIFY(Test::waitForWindowDestroyed(client));
+    }
+}
+
+WAYLANDTEST_MAIN(FindClientBenchmark)
+#include "find_client_benchmark.moc"
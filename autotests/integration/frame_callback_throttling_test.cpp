@@ -0,0 +1,175 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "abstract_client.h"
+#include "composite.h"
+#include "options.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "xdgshellclient.h"
+
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_callback_throttling-0");
+
+class FrameCallbackThrottlingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testVisibleWindow();
+    void testMinimizedWindow();
+    void testOccludedFrameRate();
+    void testCoveredWindow();
+};
+
+void FrameCallbackThrottlingTest::initTestCase()
+{
+    qRegisterMetaType<KWin::XdgShellClient *>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("Q"));
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    QVERIFY(Compositor::self());
+    waylandServer()->initWorkspace();
+}
+
+void FrameCallbackThrottlingTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+    options->setOccludedFrameRate(Options::defaultOccludedFrameRate());
+}
+
+void FrameCallbackThrottlingTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+static void commitWithFrameCallback(Surface *surface)
+{
+    Test::render(surface, QSize(100, 50), Qt::red);
+    surface->commit(Surface::CommitFlag::FrameCallback);
+}
+
+void FrameCallbackThrottlingTest::testVisibleWindow()
+{
+    // a window which is painted gets its frame callbacks with the next frame
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    auto client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    commitWithFrameCallback(surface.data());
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+void FrameCallbackThrottlingTest::testMinimizedWindow()
+{
+    // a minimized window doesn't get frame callbacks while it can't be seen
+    options->setOccludedFrameRate(0);
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    auto client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    client->minimize();
+    QVERIFY(client->isMinimized());
+
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    commitWithFrameCallback(surface.data());
+    // keep the compositor busy, so that frames are rendered
+    Compositor::self()->addRepaintFull();
+    QVERIFY(!frameRenderedSpy.wait(500));
+
+    // once it is painted again, the pending frame callback is sent
+    client->unminimize();
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+void FrameCallbackThrottlingTest::testOccludedFrameRate()
+{
+    // a minimized window still gets frame callbacks at the occluded frame rate
+    options->setOccludedFrameRate(10);
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    auto client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    client->minimize();
+    QVERIFY(client->isMinimized());
+
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    commitWithFrameCallback(surface.data());
+    Compositor::self()->addRepaintFull();
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+void FrameCallbackThrottlingTest::testCoveredWindow()
+{
+    // a window completely covered by an opaque window doesn't get frame callbacks
+    options->setOccludedFrameRate(0);
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    auto client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+    client->move(QPoint(100, 100));
+
+    QScopedPointer<Surface> coverSurface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> coverShellSurface(Test::createXdgShellStableSurface(coverSurface.data()));
+    auto cover = Test::renderAndWaitForShown(coverSurface.data(), QSize(400, 300), Qt::green, QImage::Format_RGB32);
+    QVERIFY(cover);
+    QVERIFY(!cover->hasAlpha());
+    cover->move(QPoint(0, 0));
+    QVERIFY(cover->frameGeometry().contains(client->frameGeometry()));
+    QCOMPARE(workspace()->activeClient(), cover);
+
+    QSignalSpy frameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    commitWithFrameCallback(surface.data());
+    // keep the compositor busy, so that frames are rendered
+    Compositor::self()->addRepaintFull();
+    QVERIFY(!frameRenderedSpy.wait(500));
+
+    // once the window is uncovered, the pending frame callback is sent
+    cover->move(QPoint(600, 600));
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+WAYLANDTEST_MAIN(FrameCallbackThrottlingTest)
+#include "frame_callback_throttling_test.moc"
@@ -0,0 +1,182 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "composite.h"
+#include "effectloader.h"
+#include "effect_builtins.h"
+#include "platform.h"
+#include "scene.h"
+#include "screens.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "xdgshellclient.h"
+
+#include <KConfigGroup>
+
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_time_benchmark-0");
+
+/**
+ * Headless frame time benchmark on top of the virtual platform.
+ *
+ * Every workload performs one scripted step per frame and waits for the buffer swap. The
+ * swap chain depth of the virtual backend can be changed with the
+ * KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH environment variable, by default three buffers with
+ * buffer age support are used. Setting it to 0 benchmarks full repaints.
+ */
+class FrameTimeBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void benchmarkFrame_data();
+    void benchmarkFrame();
+};
+
+void FrameTimeBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::XdgShellClient *>();
+    qRegisterMetaType<KWin::AbstractClient*>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+
+    // disable all effects, only the scene itself is benchmarked
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    ScriptedEffectLoader loader;
+    const auto builtinNames = BuiltInEffects::availableEffectNames() << loader.listOfKnownEffects();
+    for (QString name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("XCURSOR_THEME", QByteArrayLiteral("DMZ-White"));
+    qputenv("XCURSOR_SIZE", QByteArrayLiteral("24"));
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    if (!qEnvironmentVariableIsSet("KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH")) {
+        qputenv("KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH", QByteArrayLiteral("3"));
+    }
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    QVERIFY(Compositor::self());
+    QVERIFY(Compositor::self()->scene());
+    QCOMPARE(kwinApp()->platform()->selectedCompositor(), KWin::OpenGLCompositing);
+}
+
+void FrameTimeBenchmark::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void FrameTimeBenchmark::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void FrameTimeBenchmark::benchmarkFrame_data()
+{
+    QTest::addColumn<QString>("workload");
+    QTest::addColumn<int>("windows");
+
+    QTest::newRow("move/1") << QStringLiteral("move") << 1;
+    QTest::newRow("move/10") << QStringLiteral("move") << 10;
+    QTest::newRow("update/1") << QStringLiteral("update") << 1;
+    QTest::newRow("update/10") << QStringLiteral("update") << 10;
+    QTest::newRow("repaintFull/10") << QStringLiteral("repaintFull") << 10;
+}
+
+void FrameTimeBenchmark::benchmarkFrame()
+{
+    QFETCH(QString, workload);
+    QFETCH(int, windows);
+
+    QVector<Surface *> surfaces;
+    QVector<XdgShellSurface *> shellSurfaces;
+    QVector<XdgShellClient *> clients;
+    for (int i = 0; i < windows; ++i) {
+        Surface *surface = Test::createSurface();
+        QVERIFY(surface);
+        XdgShellSurface *shellSurface = Test::createXdgShellStableSurface(surface);
+        QVERIFY(shellSurface);
+        XdgShellClient *client = Test::renderAndWaitForShown(surface, QSize(200, 150), Qt::blue);
+        QVERIFY(client);
+        client->move(QPoint(40 * i, 30 * i));
+        surfaces << surface;
+        shellSurfaces << shellSurface;
+        clients << client;
+    }
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    // settle the initial full repaints
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+
+    Platform *platform = kwinApp()->platform();
+    QMetaObject::invokeMethod(platform, "resetFrameStatistics");
+
+    int step = 0;
+    QBENCHMARK {
+        const int index = step % windows;
+        if (workload == QLatin1String("move")) {
+            XdgShellClient *client = clients.at(index);
+            client->move(client->pos() + QPoint((step / windows) % 2 ? -4 : 4, 0));
+        } else if (workload == QLatin1String("update")) {
+            Test::render(surfaces.at(index), QSize(200, 150), step % 2 ? Qt::blue : Qt::red);
+        } else {
+            Compositor::self()->addRepaintFull();
+        }
+        step++;
+        QVERIFY(swapSpy.wait());
+    }
+
+    const quint64 frames = platform->property("renderedFrames").toULongLong();
+    const quint64 repainted = platform->property("repaintedPixels").toULongLong();
+    const quint64 damaged = platform->property("damagedPixels").toULongLong();
+    QVERIFY(frames > 0);
+    const quint64 screenArea = quint64(screens()->size().width()) * screens()->size().height();
+    qDebug() << "swap chain depth" << platform->property("swapChainDepth").toInt()
+             << "frames" << frames
+             << "repainted per frame" << repainted / frames
+             << "damaged per frame" << damaged / frames
+             << "screen" << screenArea;
+    if (workload != QLatin1String("repaintFull") && platform->property("swapChainDepth").toInt() > 0) {
+        // partial repaints must not degrade into full repaints
+        QVERIFY(repainted < frames * screenArea);
+    }
+
+    qDeleteAll(shellSurfaces);
+    qDeleteAll(surfaces);
+    for (XdgShellClient *client : clients) {
+        QVERIFY(Test::waitForWindowDestroyed(client));
+    }
+}
+
+WAYLANDTEST_MAIN(FrameTimeBenchmark)
+#include "frame_time_benchmark.moc"
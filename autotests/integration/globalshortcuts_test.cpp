@@ -55,6 +55,7 @@ private Q_SLOTS:
     void testRepeatedTrigger();
     void testUserActionsMenu();
     void testMetaShiftW();
+    void testMetaShiftTab();
     void testComponseKey();
     void testX11ClientShortcut();
     void testWaylandClientShortcut();
@@ -205,6 +206,37 @@ void GlobalShortcutsTest::testMetaShiftW()
     kwinApp()->platform()->keyboardKeyReleased(KEY_LEFTMETA, timestamp++);
 }
 
+void GlobalShortcutsTest::testMetaShiftTab()
+{
+    // shift+tab produces Backtab, which must still trigger a shortcut registered as shift+tab
+    QScopedPointer<QAction> action(new QAction(nullptr));
+    action->setProperty("componentName", QStringLiteral(KWIN_NAME));
+    action->setObjectName(QStringLiteral("globalshortcuts-test-meta-shift-tab"));
+    QSignalSpy triggeredSpy(action.data(), &QAction::triggered);
+    QVERIFY(triggeredSpy.isValid());
+    KGlobalAccel::self()->setShortcut(action.data(), QList<QKeySequence>{Qt::META + Qt::SHIFT + Qt::Key_Tab}, KGlobalAccel::NoAutoloading);
+    input()->registerShortcut(Qt::META + Qt::SHIFT + Qt::Key_Tab, action.data());
+
+    // press meta+shift+tab
+    quint32 timestamp = 0;
+    kwinApp()->platform()->keyboardKeyPressed(KEY_LEFTMETA, timestamp++);
+    kwinApp()->platform()->keyboardKeyPressed(KEY_LEFTSHIFT, timestamp++);
+    QCOMPARE(input()->keyboardModifiers(), Qt::ShiftModifier | Qt::MetaModifier);
+    kwinApp()->platform()->keyboardKeyPressed(KEY_TAB, timestamp++);
+    QTRY_COMPARE(triggeredSpy.count(), 1);
+    kwinApp()->platform()->keyboardKeyReleased(KEY_TAB, timestamp++);
+
+    // a key which is not part of any shortcut doesn't trigger
+    kwinApp()->platform()->keyboardKeyPressed(KEY_Q, timestamp++);
+    kwinApp()->platform()->keyboardKeyReleased(KEY_Q, timestamp++);
+    QTest::qWait(50);
+    QCOMPARE(triggeredSpy.count(), 1);
+
+    // release meta+shift
+    kwinApp()->platform()->keyboardKeyReleased(KEY_LEFTSHIFT, timestamp++);
+    kwinApp()->platform()->keyboardKeyReleased(KEY_LEFTMETA, timestamp++);
+}
+
 void GlobalShortcutsTest::testComponseKey()
 {
     // BUG 390110
@@ -154,6 +154,11 @@ void WaylandTestApplication::continueStartupWithScene()
         std::cerr << "Xwayland had a critical error. Going to exit now." << std::endl;
         exit(code);
     });
+    if (m_startXwaylandLazily) {
+        m_xwayland->listen();
+        finalizeStartup();
+        return;
+    }
     connect(m_xwayland, &Xwl::Xwayland::initialized, this, &WaylandTestApplication::finalizeStartup);
     m_xwayland->init();
 }
@@ -33,6 +33,7 @@ namespace KWayland
 namespace Client
 {
 class AppMenuManager;
+class BlurManager;
 class ConnectionThread;
 class Compositor;
 class IdleInhibitManager;
@@ -67,6 +68,14 @@ public:
     WaylandTestApplication(OperationMode mode, int &argc, char **argv);
     ~WaylandTestApplication() override;
 
+    /**
+     * Whether Xwayland is started when the first X11 client connects instead of right away.
+     * Has to be set before the application is started.
+     */
+    void setStartXwaylandLazily(bool lazily) {
+        m_startXwaylandLazily = lazily;
+    }
+
 protected:
     void performStartup() override;
 
@@ -77,6 +86,7 @@ private:
     void finalizeStartup();
 
     Xwl::Xwayland *m_xwayland = nullptr;
+    bool m_startXwaylandLazily = false;
 };
 
 namespace Test
@@ -92,6 +102,7 @@ enum class AdditionalWaylandInterface {
     AppMenu = 1 << 6,
     ShadowManager = 1 << 7,
     XdgDecoration = 1 << 8,
+    BlurManager = 1 << 9,
 };
 Q_DECLARE_FLAGS(AdditionalWaylandInterfaces, AdditionalWaylandInterface)
 /**
@@ -114,6 +125,7 @@ KWayland::Client::ConnectionThread *waylandConnection();
 KWayland::Client::Compositor *waylandCompositor();
 KWayland::Client::SubCompositor *waylandSubCompositor();
 KWayland::Client::ShadowManager *waylandShadowManager();
+KWayland::Client::BlurManager *waylandBlurManager();
 KWayland::Client::ShmPool *waylandShmPool();
 KWayland::Client::Seat *waylandSeat();
 KWayland::Client::ServerSideDecorationManager *waylandServerSideDecoration();
@@ -1029,6 +1029,7 @@ void PointerInputTest::testCursorImage()
     QVERIFY(cursorRenderedSpy.wait());
     QCOMPARE(p->cursorImage(), red);
     QCOMPARE(p->cursorHotSpot(), QPoint(5, 5));
+    const qint64 redCacheKey = p->cursorImage().cacheKey();
     // change hotspot
     pointer->setCursor(cursorSurface, QPoint(6, 6));
     Test::flushWaylandConnection();
@@ -1046,6 +1047,15 @@ void PointerInputTest::testCursorImage()
     QTRY_COMPARE(p->cursorImage(), blue);
     QCOMPARE(p->cursorHotSpot(), QPoint(6, 6));
 
+    // a new buffer with a recently shown image, like the frames of an animated cursor,
+    // gives the same image, so that the cursor renderers can reuse their textures
+    cursorSurface->attachBuffer(Test::waylandShmPool()->createBuffer(red));
+    cursorSurface->damage(QRect(0, 0, 10, 10));
+    cursorSurface->commit();
+    QVERIFY(cursorRenderedSpy.wait());
+    QTRY_COMPARE(p->cursorImage(), red);
+    QCOMPARE(p->cursorImage().cacheKey(), redCacheKey);
+
     // scaled cursor
     QImage blueScaled = QImage(QSize(20, 20), QImage::Format_ARGB32_Premultiplied);
     blueScaled.fill(Qt::blue);
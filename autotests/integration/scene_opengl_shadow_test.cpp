@@ -43,6 +43,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "effectloader.h"
 #include "effects.h"
 #include "platform.h"
+#include "plugins/scenes/opengl/scene_opengl.h"
 #include "shadow.h"
 #include "xdgshellclient.h"
 #include "wayland_server.h"
@@ -70,6 +71,7 @@ private Q_SLOTS:
     void testShadowTileOverlaps();
     void testNoCornerShadowTiles();
     void testDistributeHugeCornerTiles();
+    void testSharedShadowTexture();
 
 };
 
@@ -860,5 +862,69 @@ void SceneOpenGLShadowTest::testDistributeHugeCornerTiles()
     }
 }
 
+void SceneOpenGLShadowTest::testSharedShadowTexture()
+{
+    // this test verifies that windows with shadows of the same contents share the texture
+
+    QVERIFY(Test::setupWaylandConnection(Test::AdditionalWaylandInterface::ShadowManager));
+
+    auto *shmPool = Test::waylandShmPool();
+    QVector<Buffer::Ptr> buffers;
+    QVector<KWayland::Client::Shadow *> clientShadows;
+    auto commitShadow = [&](Surface *surface, XdgShellClient *client, const QColor &color) {
+        QImage tile(128, 128, QImage::Format_ARGB32_Premultiplied);
+        tile.fill(color);
+        Buffer::Ptr buffer = shmPool->createBuffer(tile);
+        buffers << buffer;
+
+        KWayland::Client::Shadow *clientShadow = Test::waylandShadowManager()->createShadow(surface);
+        clientShadows << clientShadow;
+        clientShadow->attachTopLeft(buffer);
+        clientShadow->attachTop(buffer);
+        clientShadow->attachTopRight(buffer);
+        clientShadow->attachRight(buffer);
+        clientShadow->attachBottomRight(buffer);
+        clientShadow->attachBottom(buffer);
+        clientShadow->attachBottomLeft(buffer);
+        clientShadow->attachLeft(buffer);
+        clientShadow->setOffsets(QMarginsF(128, 128, 128, 128));
+
+        QSignalSpy shadowChangedSpy(client->surface(), &KWayland::Server::SurfaceInterface::shadowChanged);
+        clientShadow->commit();
+        surface->commit(Surface::CommitFlag::None);
+        return shadowChangedSpy.wait();
+    };
+    auto shadowTexture = [](XdgShellClient *client) -> GLTexture * {
+        auto *shadow = static_cast<SceneOpenGLShadow *>(client->effectWindow()->sceneWindow()->shadow());
+        return shadow ? shadow->shadowTexture() : nullptr;
+    };
+
+    QScopedPointer<Surface> surface1(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface1(Test::createXdgShellStableSurface(surface1.data()));
+    auto *client1 = Test::renderAndWaitForShown(surface1.data(), QSize(512, 512), Qt::blue);
+    QVERIFY(client1);
+    QVERIFY(commitShadow(surface1.data(), client1, QColor(0, 0, 0, 128)));
+
+    QScopedPointer<Surface> surface2(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface2(Test::createXdgShellStableSurface(surface2.data()));
+    auto *client2 = Test::renderAndWaitForShown(surface2.data(), QSize(256, 256), Qt::blue);
+    QVERIFY(client2);
+    QVERIFY(commitShadow(surface2.data(), client2, QColor(0, 0, 0, 128)));
+
+    QScopedPointer<Surface> surface3(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface3(Test::createXdgShellStableSurface(surface3.data()));
+    auto *client3 = Test::renderAndWaitForShown(surface3.data(), QSize(512, 512), Qt::blue);
+    QVERIFY(client3);
+    QVERIFY(commitShadow(surface3.data(), client3, QColor(0, 0, 0, 64)));
+
+    // the same contents share the texture, no matter the size of the window
+    QVERIFY(shadowTexture(client1));
+    QCOMPARE(shadowTexture(client2), shadowTexture(client1));
+    QVERIFY(shadowTexture(client3));
+    QVERIFY(shadowTexture(client3) != shadowTexture(client1));
+
+    qDeleteAll(clientShadows);
+}
+
 WAYLANDTEST_MAIN(SceneOpenGLShadowTest)
 #include "scene_opengl_shadow_test.moc"
@@ -19,12 +19,244 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "generic_scene_opengl_test.h"
 
+#include "composite.h"
+#include "effect_builtins.h"
+#include "effects.h"
+#include "options.h"
+#include "scene.h"
+#include "virtualdesktops.h"
+#include "xdgshellclient.h"
+
+#include <KWayland/Client/surface.h>
+#include <KWayland/Client/xdgshell.h>
+
+using namespace KWin;
+
 class SceneOpenGLTest : public GenericSceneOpenGLTest
 {
     Q_OBJECT
 public:
     SceneOpenGLTest() : GenericSceneOpenGLTest(QByteArrayLiteral("O2")) {}
+private Q_SLOTS:
+    void testBatchedDrawSubmission();
+    void testBatchedDrawSubmissionWithEffects();
+    void testTextureEviction();
+    void testTextureRewarmUnderPressure();
 };
 
+void SceneOpenGLTest::testBatchedDrawSubmission()
+{
+    // this test verifies that untransformed windows are submitted through the render list
+    // and share the shader state instead of setting it up for each window
+    using namespace KWayland::Client;
+    QVERIFY(Test::setupWaylandConnection());
+
+    QScopedPointer<Surface> surface1(Test::createSurface());
+    QVERIFY(!surface1.isNull());
+    QScopedPointer<XdgShellSurface> shellSurface1(Test::createXdgShellStableSurface(surface1.data()));
+    QVERIFY(!shellSurface1.isNull());
+    XdgShellClient *client1 = Test::renderAndWaitForShown(surface1.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client1);
+
+    QScopedPointer<Surface> surface2(Test::createSurface());
+    QVERIFY(!surface2.isNull());
+    QScopedPointer<XdgShellSurface> shellSurface2(Test::createXdgShellStableSurface(surface2.data()));
+    QVERIFY(!shellSurface2.isNull());
+    XdgShellClient *client2 = Test::renderAndWaitForShown(surface2.data(), QSize(100, 50), Qt::red);
+    QVERIFY(client2);
+    client2->move(QPoint(300, 300));
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    const int renderItems = scene->property("renderItems").toInt();
+    const int drawCalls = scene->property("drawCalls").toInt();
+    QVERIFY(renderItems >= 2);
+    QVERIFY(drawCalls >= 2);
+    QVERIFY(drawCalls <= renderItems);
+    // both windows use the default shader, it only needs to be bound once per frame
+    QCOMPARE(scene->property("shaderChanges").toInt(), 1);
+    QVERIFY(scene->property("textureChanges").toInt() <= drawCalls);
+    // one texture bind per draw, plus the shared shader, projection and blend state
+    QVERIFY(scene->property("stateChanges").toInt() <= drawCalls + 3);
+}
+
+void SceneOpenGLTest::testBatchedDrawSubmissionWithEffects()
+{
+    // this test verifies that windows are still batched with the default effects loaded,
+    // blur and background contrast take part in painting every window
+    using namespace KWayland::Client;
+    QVERIFY(Test::setupWaylandConnection());
+
+    QScopedPointer<Surface> surface1(Test::createSurface());
+    QVERIFY(!surface1.isNull());
+    QScopedPointer<XdgShellSurface> shellSurface1(Test::createXdgShellStableSurface(surface1.data()));
+    QVERIFY(!shellSurface1.isNull());
+    XdgShellClient *client1 = Test::renderAndWaitForShown(surface1.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client1);
+
+    QScopedPointer<Surface> surface2(Test::createSurface());
+    QVERIFY(!surface2.isNull());
+    QScopedPointer<XdgShellSurface> shellSurface2(Test::createXdgShellStableSurface(surface2.data()));
+    QVERIFY(!shellSurface2.isNull());
+    XdgShellClient *client2 = Test::renderAndWaitForShown(surface2.data(), QSize(100, 50), Qt::red);
+    QVERIFY(client2);
+    client2->move(QPoint(300, 300));
+
+    // load the effects once the windows are shown, so that no appear animation is running
+    auto effectsImpl = static_cast<EffectsHandlerImpl *>(effects);
+    for (BuiltInEffect effect : BuiltInEffects::availableEffects()) {
+        if (BuiltInEffects::enabledByDefault(effect)) {
+            effectsImpl->loadEffect(BuiltInEffects::nameForEffect(effect));
+        }
+    }
+    if (!effectsImpl->isEffectLoaded(BuiltInEffects::nameForEffect(BuiltInEffect::Blur)) &&
+            !effectsImpl->isEffectLoaded(BuiltInEffects::nameForEffect(BuiltInEffect::Contrast))) {
+        effectsImpl->unloadAllEffects();
+        QSKIP("Neither blur nor background contrast is supported");
+    }
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QVERIFY(scene->property("renderItems").toInt() >= 2);
+    QVERIFY(scene->property("drawCalls").toInt() >= 2);
+    // no effect drew anything on its own, so the render list was submitted once
+    QCOMPARE(scene->property("shaderChanges").toInt(), 1);
+
+    effectsImpl->unloadAllEffects();
+}
+
+void SceneOpenGLTest::testTextureEviction()
+{
+    // this test verifies that the texture of a window on another desktop is released once the
+    // window textures exceed the budget, and loaded again when the window is shown again
+    using namespace KWayland::Client;
+    QVERIFY(Test::setupWaylandConnection());
+    VirtualDesktopManager::self()->setCount(2);
+    VirtualDesktopManager::self()->setCurrent(1);
+    // one MiB, less than the texture of the window
+    options->setTextureMemoryBudget(1);
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QVERIFY(!surface.isNull());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    QVERIFY(!shellSurface.isNull());
+    XdgShellClient *client = Test::renderAndWaitForShown(surface.data(), QSize(800, 600), Qt::blue);
+    QVERIFY(client);
+    QCOMPARE(client->desktop(), 1);
+
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QVariantMap memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("budget")).toLongLong(), qint64(1024 * 1024));
+    QVERIFY(memory.value(QStringLiteral("windowTextures")).toLongLong() >= qint64(800 * 600 * 4));
+    QCOMPARE(memory.value(QStringLiteral("evictions")).toULongLong(), quint64(0));
+
+    // the window is not painted on the second desktop, so its texture has to go
+    VirtualDesktopManager::self()->setCurrent(2);
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+    memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("evictions")).toULongLong(), quint64(1));
+    QCOMPARE(memory.value(QStringLiteral("evictedWindows")).toInt(), 1);
+    QVERIFY(memory.value(QStringLiteral("windowTextures")).toLongLong() < qint64(800 * 600 * 4));
+    // the texture doesn't fit into the budget, so it is not loaded in advance either
+    QCOMPARE(memory.value(QStringLiteral("rewarms")).toULongLong(), quint64(0));
+
+    // with enough room the window on the previous desktop is loaded before switching back
+    options->setTextureMemoryBudget(8);
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+    memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("rewarms")).toULongLong(), quint64(1));
+    QCOMPARE(memory.value(QStringLiteral("evictedWindows")).toInt(), 0);
+    QVERIFY(memory.value(QStringLiteral("windowTextures")).toLongLong() >= qint64(800 * 600 * 4));
+
+    // and painted without loading it again
+    VirtualDesktopManager::self()->setCurrent(1);
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+    memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("evictedWindows")).toInt(), 0);
+    QCOMPARE(memory.value(QStringLiteral("evictions")).toULongLong(), quint64(1));
+    QCOMPARE(memory.value(QStringLiteral("rewarms")).toULongLong(), quint64(1));
+
+    options->setTextureMemoryBudget(Options::defaultTextureMemoryBudget());
+    VirtualDesktopManager::self()->setCount(1);
+}
+
+void SceneOpenGLTest::testTextureRewarmUnderPressure()
+{
+    // this test verifies that the textures of windows the user is not likely to switch to are
+    // released first and far enough to load a released texture of a predicted window again
+    using namespace KWayland::Client;
+    QVERIFY(Test::setupWaylandConnection());
+    // a two by two grid, the fourth desktop is no neighbour of the first one
+    VirtualDesktopManager::self()->setCount(4);
+    VirtualDesktopManager::self()->setRows(2);
+    VirtualDesktopManager::self()->setCurrent(1);
+
+    QScopedPointer<QObject> surfaces(new QObject);
+    auto createWindow = [&surfaces](const QSize &size) {
+        Surface *surface = Test::createSurface(surfaces.data());
+        Test::createXdgShellStableSurface(surface, surface);
+        return Test::renderAndWaitForShown(surface, size, Qt::blue);
+    };
+    // 160000 bytes
+    XdgShellClient *predicted = createWindow(QSize(200, 200));
+    QVERIFY(predicted);
+    predicted->setDesktop(4);
+    // 360000 bytes each
+    XdgShellClient *other1 = createWindow(QSize(300, 300));
+    QVERIFY(other1);
+    XdgShellClient *other2 = createWindow(QSize(300, 300));
+    QVERIFY(other2);
+    XdgShellClient *current = createWindow(QSize(300, 300));
+    QVERIFY(current);
+
+    // the window on the fourth desktop is the only one which can be released
+    options->setTextureMemoryBudget(1);
+    QSignalSpy swapSpy(Compositor::self(), &Compositor::bufferSwapCompleted);
+    QVERIFY(swapSpy.isValid());
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QVariantMap memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("evictions")).toULongLong(), quint64(1));
+    QCOMPARE(memory.value(QStringLiteral("evictedWindows")).toInt(), 1);
+    QCOMPARE(memory.value(QStringLiteral("rewarms")).toULongLong(), quint64(0));
+
+    // releasing one of the windows would be enough for the budget, but both have to go to
+    // load the window on the neighbouring desktop again
+    predicted->setDesktop(2);
+    other1->setDesktop(4);
+    other2->setDesktop(4);
+    Compositor::self()->addRepaintFull();
+    QVERIFY(swapSpy.wait());
+    memory = scene->textureMemory();
+    QCOMPARE(memory.value(QStringLiteral("evictions")).toULongLong(), quint64(3));
+    QCOMPARE(memory.value(QStringLiteral("rewarms")).toULongLong(), quint64(1));
+    QCOMPARE(memory.value(QStringLiteral("evictedWindows")).toInt(), 2);
+    QCOMPARE(memory.value(QStringLiteral("windowTextures")).toLongLong(), qint64(160000 + 360000));
+
+    options->setTextureMemoryBudget(Options::defaultTextureMemoryBudget());
+    VirtualDesktopManager::self()->setCount(1);
+}
+
 WAYLANDTEST_MAIN(SceneOpenGLTest)
 #include "scene_opengl_test.moc"
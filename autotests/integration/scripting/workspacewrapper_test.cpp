@@ -0,0 +1,106 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "kwin_wayland_test.h"
+
+#include "platform.h"
+#include "scripting/workspace_wrapper.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "xdgshellclient.h"
+
+#include <KWayland/Client/surface.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_workspacewrapper-0");
+
+class WorkspaceWrapperTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testCoalescedGeometryChanges();
+};
+
+void WorkspaceWrapperTest::initTestCase()
+{
+    qRegisterMetaType<AbstractClient *>();
+    qRegisterMetaType<XdgShellClient *>();
+
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void WorkspaceWrapperTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void WorkspaceWrapperTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void WorkspaceWrapperTest::testCoalescedGeometryChanges()
+{
+    // This test verifies that many geometry changes of a client within one frame are
+    // delivered to scripts only once.
+
+    using namespace KWayland::Client;
+
+    QtScriptWorkspaceWrapper wrapper;
+    QSignalSpy geometryChangedSpy(&wrapper, &WorkspaceWrapper::clientGeometryChanged);
+    QVERIFY(geometryChangedSpy.isValid());
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<XdgShellSurface> shellSurface(Test::createXdgShellStableSurface(surface.data()));
+    XdgShellClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+    // placing the client changed its geometry
+    QTRY_COMPARE(geometryChangedSpy.count(), 1);
+    geometryChangedSpy.clear();
+
+    for (int i = 0; i < 100; ++i) {
+        client->move(QPoint(i, i));
+    }
+    QCOMPARE(geometryChangedSpy.count(), 0);
+    QVERIFY(geometryChangedSpy.wait());
+    QCOMPARE(geometryChangedSpy.count(), 1);
+    QCOMPARE(geometryChangedSpy.first().first().value<AbstractClient *>(), client);
+    QCOMPARE(client->pos(), QPoint(99, 99));
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
+}
+
+WAYLANDTEST_MAIN(KWin::WorkspaceWrapperTest)
+#include "workspacewrapper_test.moc"
@@ -33,6 +33,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KWayland/Client/seat.h>
 #include <KWayland/Client/server_decoration.h>
 #include <KWayland/Client/shadow.h>
+#include <KWayland/Client/blur.h>
 #include <KWayland/Client/shm_pool.h>
 #include <KWayland/Client/output.h>
 #include <KWayland/Client/subcompositor.h>
@@ -67,6 +68,7 @@ static struct {
     SubCompositor *subCompositor = nullptr;
     ServerSideDecorationManager *decoration = nullptr;
     ShadowManager *shadowManager = nullptr;
+    BlurManager *blurManager = nullptr;
     XdgShell *xdgShellV6 = nullptr;
     XdgShell *xdgShellStable = nullptr;
     ShmPool *shm = nullptr;
@@ -175,6 +177,13 @@ bool setupWaylandConnection(AdditionalWaylandInterfaces flags)
             return false;
         }
     }
+    if (flags.testFlag(AdditionalWaylandInterface::BlurManager)) {
+        s_waylandConnection.blurManager = registry->createBlurManager(registry->interface(Registry::Interface::Blur).name,
+                                                                      registry->interface(Registry::Interface::Blur).version);
+        if (!s_waylandConnection.blurManager->isValid()) {
+            return false;
+        }
+    }
     if (flags.testFlag(AdditionalWaylandInterface::Decoration)) {
         s_waylandConnection.decoration = registry->createServerSideDecorationManager(registry->interface(Registry::Interface::ServerSideDecorationManager).name,
                                                                                     registry->interface(Registry::Interface::ServerSideDecorationManager).version);
@@ -250,6 +259,8 @@ void destroyWaylandConnection()
     s_waylandConnection.xdgShellStable = nullptr;
     delete s_waylandConnection.shadowManager;
     s_waylandConnection.shadowManager = nullptr;
+    delete s_waylandConnection.blurManager;
+    s_waylandConnection.blurManager = nullptr;
     delete s_waylandConnection.idleInhibit;
     s_waylandConnection.idleInhibit = nullptr;
     delete s_waylandConnection.shm;
@@ -296,6 +307,11 @@ ShadowManager *waylandShadowManager()
     return s_waylandConnection.shadowManager;
 }
 
+BlurManager *waylandBlurManager()
+{
+    return s_waylandConnection.blurManager;
+}
+
 ShmPool *waylandShmPool()
 {
     return s_waylandConnection.shm;
@@ -27,7 +27,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "deleted.h"
 #include "platform.h"
 #include "screens.h"
+#include "shadow.h"
 #include "xdgshellclient.h"
+#include "virtualdesktops.h"
 #include "wayland_server.h"
 #include "workspace.h"
 
@@ -57,6 +59,10 @@ private Q_SLOTS:
     void testCaptionWmName();
     void testCaptionMultipleWindows();
     void testFullscreenWindowGroups();
+    void testHiddenPreviewsBudget();
+    void testHiddenPreviewsBudgetUpdates();
+    void testX11Shadow();
+    void testX11ShadowChangedDuringFetch();
 };
 
 void X11ClientTest::initTestCase()
@@ -626,5 +632,319 @@ void X11ClientTest::testFullscreenWindowGroups()
     QTRY_COMPARE(client->layer(), ActiveLayer);
 }
 
+void X11ClientTest::testHiddenPreviewsBudget()
+{
+    // this test verifies that only the windows on the desktops the user is likely to switch to
+    // are kept mapped for hidden previews, as long as they fit into the budget
+    VirtualDesktopManager *manager = VirtualDesktopManager::self();
+    manager->setCount(4);
+    manager->setRows(1);
+    manager->setNavigationWrappingAround(false);
+    manager->setCurrent(1);
+
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    auto createWindow = [&c]() {
+        const QRect windowGeometry(0, 0, 400, 400);
+        xcb_window_t w = xcb_generate_id(c.data());
+        xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, w, rootWindow(),
+                          windowGeometry.x(),
+                          windowGeometry.y(),
+                          windowGeometry.width(),
+                          windowGeometry.height(),
+                          0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+        xcb_size_hints_t hints;
+        memset(&hints, 0, sizeof(hints));
+        xcb_icccm_size_hints_set_position(&hints, 1, windowGeometry.x(), windowGeometry.y());
+        xcb_icccm_size_hints_set_size(&hints, 1, windowGeometry.width(), windowGeometry.height());
+        xcb_icccm_set_wm_normal_hints(c.data(), w, &hints);
+        xcb_map_window(c.data(), w);
+        xcb_flush(c.data());
+        return w;
+    };
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    const xcb_window_t w1 = createWindow();
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client1 = windowCreatedSpy.last().first().value<X11Client *>();
+    QVERIFY(client1);
+    const xcb_window_t w2 = createWindow();
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client2 = windowCreatedSpy.last().first().value<X11Client *>();
+    QVERIFY(client2);
+
+    // without a budget all windows on other desktops are kept
+    workspace()->sendClientToDesktop(client2, 4, true);
+    QVERIFY(client2->hiddenPreview());
+
+    // there is only room for one of the windows, the one on the desktop left behind wins
+    options->setHiddenPreviewsBudget(1);
+    manager->setCurrent(2);
+    QVERIFY(client1->hiddenPreview());
+    QVERIFY(!client2->hiddenPreview());
+
+    // the window on the current desktop is mapped again, and there is room for the other one
+    // as the budget is only shared by the windows on other desktops
+    manager->setCurrent(4);
+    QVERIFY(client2->isOnCurrentDesktop());
+    QVERIFY(!client2->hiddenPreview());
+    QVERIFY(client1->hiddenPreview());
+
+    options->setHiddenPreviewsBudget(Options::defaultHiddenPreviewsBudget());
+    manager->setCurrent(1);
+    manager->setCount(1);
+
+    // and destroy the windows again
+    QSignalSpy windowClosedSpy1(client1, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy1.isValid());
+    QSignalSpy windowClosedSpy2(client2, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy2.isValid());
+    xcb_unmap_window(c.data(), w1);
+    xcb_unmap_window(c.data(), w2);
+    xcb_flush(c.data());
+    QVERIFY(windowClosedSpy1.wait());
+    if (windowClosedSpy2.isEmpty()) {
+        QVERIFY(windowClosedSpy2.wait());
+    }
+    xcb_destroy_window(c.data(), w1);
+    xcb_destroy_window(c.data(), w2);
+    c.reset();
+}
+
+void X11ClientTest::testHiddenPreviewsBudgetUpdates()
+{
+    // this test verifies that the hidden previews are picked again when windows are sent to
+    // another desktop and when the budget changes, not only on desktop switches
+    VirtualDesktopManager *manager = VirtualDesktopManager::self();
+    manager->setCount(3);
+    manager->setRows(1);
+    manager->setNavigationWrappingAround(false);
+    manager->setCurrent(1);
+    options->setHiddenPreviewsBudget(1);
+
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    auto createWindow = [&c]() {
+        const QRect windowGeometry(0, 0, 400, 400);
+        xcb_window_t w = xcb_generate_id(c.data());
+        xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, w, rootWindow(),
+                          windowGeometry.x(),
+                          windowGeometry.y(),
+                          windowGeometry.width(),
+                          windowGeometry.height(),
+                          0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+        xcb_size_hints_t hints;
+        memset(&hints, 0, sizeof(hints));
+        xcb_icccm_size_hints_set_position(&hints, 1, windowGeometry.x(), windowGeometry.y());
+        xcb_icccm_size_hints_set_size(&hints, 1, windowGeometry.width(), windowGeometry.height());
+        xcb_icccm_set_wm_normal_hints(c.data(), w, &hints);
+        xcb_map_window(c.data(), w);
+        xcb_flush(c.data());
+        return w;
+    };
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    const xcb_window_t w1 = createWindow();
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client1 = windowCreatedSpy.last().first().value<X11Client *>();
+    QVERIFY(client1);
+    const xcb_window_t w2 = createWindow();
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client2 = windowCreatedSpy.last().first().value<X11Client *>();
+    QVERIFY(client2);
+
+    // a window sent to the neighbouring desktop fits into the budget
+    workspace()->sendClientToDesktop(client1, 2, true);
+    QTRY_VERIFY(client1->hiddenPreview());
+
+    // the second one doesn't fit anymore
+    workspace()->sendClientToDesktop(client2, 3, true);
+    QVERIFY(!client2->isShown(true));
+    // let the hidden previews be picked again
+    QCoreApplication::processEvents();
+    QVERIFY(client1->hiddenPreview());
+    QVERIFY(!client2->hiddenPreview());
+
+    // with a larger budget both are kept
+    options->setHiddenPreviewsBudget(2);
+    QTRY_VERIFY(client2->hiddenPreview());
+    QVERIFY(client1->hiddenPreview());
+
+    // without hidden previews none is kept
+    options->setHiddenPreviews(HiddenPreviewsNever);
+    QTRY_VERIFY(!client1->hiddenPreview());
+    QVERIFY(!client2->hiddenPreview());
+
+    options->setHiddenPreviews(Options::defaultHiddenPreviews());
+    options->setHiddenPreviewsBudget(Options::defaultHiddenPreviewsBudget());
+    manager->setCount(1);
+
+    // and destroy the windows again
+    QSignalSpy windowClosedSpy1(client1, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy1.isValid());
+    QSignalSpy windowClosedSpy2(client2, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy2.isValid());
+    xcb_unmap_window(c.data(), w1);
+    xcb_unmap_window(c.data(), w2);
+    xcb_flush(c.data());
+    QVERIFY(windowClosedSpy1.wait());
+    if (windowClosedSpy2.isEmpty()) {
+        QVERIFY(windowClosedSpy2.wait());
+    }
+    xcb_destroy_window(c.data(), w1);
+    xcb_destroy_window(c.data(), w2);
+    c.reset();
+}
+
+static QVector<xcb_pixmap_t> createShadowPixmaps(xcb_connection_t *c, int size)
+{
+    QVector<xcb_pixmap_t> pixmaps;
+    for (int i = 0; i < 8; ++i) {
+        xcb_pixmap_t pixmap = xcb_generate_id(c);
+        xcb_create_pixmap(c, 32, pixmap, rootWindow(), size, size);
+        xcb_gcontext_t gc = xcb_generate_id(c);
+        const uint32_t foreground = 0x80000000;
+        xcb_create_gc(c, gc, pixmap, XCB_GC_FOREGROUND, &foreground);
+        const xcb_rectangle_t rect = {0, 0, uint16_t(size), uint16_t(size)};
+        xcb_poly_fill_rectangle(c, pixmap, gc, 1, &rect);
+        xcb_free_gc(c, gc);
+        pixmaps << pixmap;
+    }
+    return pixmaps;
+}
+
+static void setShadowProperty(xcb_connection_t *c, xcb_window_t w, const QVector<xcb_pixmap_t> &pixmaps, uint32_t offset)
+{
+    // the eight pixmaps followed by the top, right, bottom and left offsets
+    QVector<uint32_t> data;
+    for (xcb_pixmap_t pixmap : pixmaps) {
+        data << pixmap;
+    }
+    data << offset << offset << offset << offset;
+    xcb_change_property(c, XCB_PROP_MODE_REPLACE, w, atoms->kde_net_wm_shadow, XCB_ATOM_CARDINAL, 32,
+                        data.count(), data.constData());
+}
+
+void X11ClientTest::testX11Shadow()
+{
+    // this test verifies that the shadow set through _KDE_NET_WM_SHADOW shows up once its
+    // pixmaps have been fetched
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    const QRect windowGeometry(0, 0, 100, 200);
+    xcb_window_t w = xcb_generate_id(c.data());
+    xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, w, rootWindow(),
+                      windowGeometry.x(),
+                      windowGeometry.y(),
+                      windowGeometry.width(),
+                      windowGeometry.height(),
+                      0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_size_hints_t hints;
+    memset(&hints, 0, sizeof(hints));
+    xcb_icccm_size_hints_set_position(&hints, 1, windowGeometry.x(), windowGeometry.y());
+    xcb_icccm_size_hints_set_size(&hints, 1, windowGeometry.width(), windowGeometry.height());
+    xcb_icccm_set_wm_normal_hints(c.data(), w, &hints);
+    xcb_map_window(c.data(), w);
+    xcb_flush(c.data());
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client = windowCreatedSpy.first().first().value<X11Client *>();
+    QVERIFY(client);
+    // a decoration shadow would take precedence
+    client->setNoBorder(true);
+    QVERIFY(!client->isDecorated());
+    QTRY_VERIFY(client->effectWindow() && client->effectWindow()->sceneWindow());
+    QVERIFY(!client->shadow());
+
+    const QVector<xcb_pixmap_t> pixmaps = createShadowPixmaps(c.data(), 10);
+    setShadowProperty(c.data(), w, pixmaps, 10);
+    xcb_flush(c.data());
+
+    // the shadow covers the offsets around the window once the pixmaps are there
+    const QRect shadowRect = QRect(QPoint(0, 0), client->size()).adjusted(-10, -10, 10, 10);
+    QTRY_VERIFY(client->shadow());
+    QTRY_COMPARE(client->shadow()->shadowRegion().boundingRect(), shadowRect);
+    QCOMPARE(client->shadow()->shadowQuads().count(), 8);
+
+    // withdrawing the property removes the shadow
+    xcb_delete_property(c.data(), w, atoms->kde_net_wm_shadow);
+    xcb_flush(c.data());
+    QTRY_VERIFY(!client->shadow());
+
+    // and destroy the window again
+    xcb_unmap_window(c.data(), w);
+    xcb_flush(c.data());
+    QSignalSpy windowClosedSpy(client, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy.isValid());
+    QVERIFY(windowClosedSpy.wait());
+    for (xcb_pixmap_t pixmap : pixmaps) {
+        xcb_free_pixmap(c.data(), pixmap);
+    }
+    xcb_destroy_window(c.data(), w);
+    c.reset();
+}
+
+void X11ClientTest::testX11ShadowChangedDuringFetch()
+{
+    // this test verifies that a shadow property set while the pixmaps of the previous one
+    // are still fetched wins over the previous one
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    const QRect windowGeometry(0, 0, 100, 200);
+    xcb_window_t w = xcb_generate_id(c.data());
+    xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, w, rootWindow(),
+                      windowGeometry.x(),
+                      windowGeometry.y(),
+                      windowGeometry.width(),
+                      windowGeometry.height(),
+                      0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_size_hints_t hints;
+    memset(&hints, 0, sizeof(hints));
+    xcb_icccm_size_hints_set_position(&hints, 1, windowGeometry.x(), windowGeometry.y());
+    xcb_icccm_size_hints_set_size(&hints, 1, windowGeometry.width(), windowGeometry.height());
+    xcb_icccm_set_wm_normal_hints(c.data(), w, &hints);
+    xcb_map_window(c.data(), w);
+    xcb_flush(c.data());
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client = windowCreatedSpy.first().first().value<X11Client *>();
+    QVERIFY(client);
+    client->setNoBorder(true);
+    QVERIFY(!client->isDecorated());
+    QTRY_VERIFY(client->effectWindow() && client->effectWindow()->sceneWindow());
+
+    // both properties arrive before the pixmaps of the first one can have been fetched
+    const QVector<xcb_pixmap_t> first = createShadowPixmaps(c.data(), 10);
+    const QVector<xcb_pixmap_t> second = createShadowPixmaps(c.data(), 20);
+    setShadowProperty(c.data(), w, first, 10);
+    setShadowProperty(c.data(), w, second, 20);
+    xcb_flush(c.data());
+
+    const QRect shadowRect = QRect(QPoint(0, 0), client->size()).adjusted(-20, -20, 20, 20);
+    QTRY_VERIFY(client->shadow());
+    QTRY_COMPARE(client->shadow()->shadowRegion().boundingRect(), shadowRect);
+    // a late result of the first fetch doesn't replace it
+    QTest::qWait(100);
+    QCOMPARE(client->shadow()->shadowRegion().boundingRect(), shadowRect);
+
+    // and destroy the window again
+    xcb_unmap_window(c.data(), w);
+    xcb_flush(c.data());
+    QSignalSpy windowClosedSpy(client, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy.isValid());
+    QVERIFY(windowClosedSpy.wait());
+    for (xcb_pixmap_t pixmap : first + second) {
+        xcb_free_pixmap(c.data(), pixmap);
+    }
+    xcb_destroy_window(c.data(), w);
+    c.reset();
+}
+
 WAYLANDTEST_MAIN(X11ClientTest)
 #include "x11_client_test.moc"
@@ -0,0 +1,127 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "kwin_wayland_test.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "x11client.h"
+
+#include <QtConcurrentRun>
+
+#include <xcb/xcb_icccm.h>
+
+using namespace KWin;
+
+static const QString s_socketName = QStringLiteral("wayland_test_xwayland_lazy_start-0");
+
+class XwaylandLazyStartTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testNotStartedWithoutClient();
+    void testStartedByClient();
+};
+
+struct XcbConnectionDeleter
+{
+    static inline void cleanup(xcb_connection_t *pointer)
+    {
+        xcb_disconnect(pointer);
+    }
+};
+
+void XwaylandLazyStartTest::initTestCase()
+{
+    qRegisterMetaType<KWin::X11Client *>();
+    QSignalSpy workspaceCreatedSpy(kwinApp(), &Application::workspaceCreated);
+    QVERIFY(workspaceCreatedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName.toLocal8Bit()));
+    static_cast<WaylandTestApplication *>(kwinApp())->setStartXwaylandLazily(true);
+
+    kwinApp()->start();
+    QVERIFY(workspaceCreatedSpy.wait());
+    waylandServer()->initWorkspace();
+}
+
+void XwaylandLazyStartTest::testNotStartedWithoutClient()
+{
+    // this test verifies that the workspace is created without an X server,
+    // while the display is already announced
+    QVERIFY(!kwinApp()->x11Connection());
+    QVERIFY(!qEnvironmentVariableIsEmpty("DISPLAY"));
+
+    QSignalSpy x11ConnectionChangedSpy(kwinApp(), &Application::x11ConnectionChanged);
+    QVERIFY(x11ConnectionChangedSpy.isValid());
+    QVERIFY(!x11ConnectionChangedSpy.wait(500));
+    QVERIFY(!kwinApp()->x11Connection());
+}
+
+void XwaylandLazyStartTest::testStartedByClient()
+{
+    // this test verifies that the first X11 client starts Xwayland and gets its window managed
+    QSignalSpy x11ConnectionChangedSpy(kwinApp(), &Application::x11ConnectionChanged);
+    QVERIFY(x11ConnectionChangedSpy.isValid());
+
+    // connecting blocks until Xwayland accepts the connection, which needs the event loop
+    QFuture<xcb_connection_t *> future = QtConcurrent::run([] {
+        return xcb_connect(nullptr, nullptr);
+    });
+    QVERIFY(x11ConnectionChangedSpy.wait());
+    QVERIFY(kwinApp()->x11Connection());
+    QTRY_VERIFY(future.isFinished());
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(future.result());
+    QVERIFY(!xcb_connection_has_error(c.data()));
+
+    const QRect windowGeometry(0, 0, 100, 200);
+    const xcb_window_t root = xcb_setup_roots_iterator(xcb_get_setup(c.data())).data->root;
+    xcb_window_t w = xcb_generate_id(c.data());
+    xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, w, root,
+                      windowGeometry.x(),
+                      windowGeometry.y(),
+                      windowGeometry.width(),
+                      windowGeometry.height(),
+                      0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_size_hints_t hints;
+    memset(&hints, 0, sizeof(hints));
+    xcb_icccm_size_hints_set_position(&hints, 1, windowGeometry.x(), windowGeometry.y());
+    xcb_icccm_size_hints_set_size(&hints, 1, windowGeometry.width(), windowGeometry.height());
+    xcb_icccm_set_wm_normal_hints(c.data(), w, &hints);
+    xcb_map_window(c.data(), w);
+    xcb_flush(c.data());
+
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client = windowCreatedSpy.first().first().value<X11Client *>();
+    QVERIFY(client);
+    QCOMPARE(client->window(), w);
+
+    // and destroy the window again
+    xcb_unmap_window(c.data(), w);
+    xcb_flush(c.data());
+    QSignalSpy windowClosedSpy(client, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy.isValid());
+    QVERIFY(windowClosedSpy.wait());
+    xcb_destroy_window(c.data(), w);
+    c.reset();
+}
+
+WAYLANDTEST_MAIN(XwaylandLazyStartTest)
+#include "xwayland_lazy_start_test.moc"
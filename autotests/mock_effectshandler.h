@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MOCK_EFFECTS_HANDLER_H
 
 #include <kwineffects.h>
+#include <QAction>
+#include <QMultiHash>
+#include <QPointer>
 #include <QX11Info>
 
 class MockEffectsHandler : public KWin::EffectsHandler
@@ -30,10 +33,10 @@ public:
     explicit MockEffectsHandler(KWin::CompositingType type);
     void activateWindow(KWin::EffectWindow *) override {}
     KWin::Effect *activeFullScreenEffect() const override {
-        return nullptr;
+        return m_fullScreenEffect;
     }
     bool hasActiveFullScreenEffect() const override {
-        return false;
+        return m_fullScreenEffect;
     }
     int activeScreen() const override {
         return 0;
@@ -186,21 +189,31 @@ public:
     void reconfigure() override {}
     void refTabBox() override {}
     void registerAxisShortcut(Qt::KeyboardModifiers, KWin::PointerAxisDirection, QAction *) override {}
-    void registerGlobalShortcut(const QKeySequence &, QAction *) override {}
+    void registerGlobalShortcut(const QKeySequence &, QAction *action) override {
+        m_globalShortcuts << action;
+    }
     void registerPointerShortcut(Qt::KeyboardModifiers, Qt::MouseButton, QAction *) override {}
     void registerTouchpadSwipeShortcut(KWin::SwipeDirection, QAction *) override {}
     void reloadEffect(KWin::Effect *) override {}
     void removeSupportProperty(const QByteArray &, KWin::Effect *) override {}
-    void reserveElectricBorder(KWin::ElectricBorder, KWin::Effect *) override {}
-    void registerTouchBorder(KWin::ElectricBorder, QAction *) override {}
-    void unregisterTouchBorder(KWin::ElectricBorder, QAction *) override {}
+    void reserveElectricBorder(KWin::ElectricBorder border, KWin::Effect *effect) override {
+        m_reservedBorders.insert(border, effect);
+    }
+    void registerTouchBorder(KWin::ElectricBorder border, QAction *action) override {
+        m_touchBorders.insert(border, action);
+    }
+    void unregisterTouchBorder(KWin::ElectricBorder border, QAction *action) override {
+        m_touchBorders.remove(border, action);
+    }
     QPainter *scenePainter() override {
         return nullptr;
     }
     int screenNumber(const QPoint &) const override {
         return 0;
     }
-    void setActiveFullScreenEffect(KWin::Effect *) override {}
+    void setActiveFullScreenEffect(KWin::Effect *effect) override {
+        m_fullScreenEffect = effect;
+    }
     void setCurrentDesktop(int) override {}
     void setElevatedWindow(KWin::EffectWindow *, bool) override {}
     void setNumberOfDesktops(int) override {}
@@ -216,7 +229,9 @@ public:
     void stopMousePolling() override {}
     void ungrabKeyboard() override {}
     void unrefTabBox() override {}
-    void unreserveElectricBorder(KWin::ElectricBorder, KWin::Effect *) override {}
+    void unreserveElectricBorder(KWin::ElectricBorder border, KWin::Effect *effect) override {
+        m_reservedBorders.remove(border, effect);
+    }
     QRect virtualScreenGeometry() const override {
         return QRect();
     }
@@ -250,6 +265,9 @@ public:
     void setAnimationsSupported(bool set) {
         m_animationsSuported = set;
     }
+    void setCompositingType(KWin::CompositingType type) {
+        compositing_type = type;
+    }
 
     KWin::PlatformCursorImage cursorImage() const override {
         return KWin::PlatformCursorImage();
@@ -285,7 +303,30 @@ public:
         return KWin::SessionState::Normal;
     }
 
+    QList<KWin::Effect *> reservedBorders(KWin::ElectricBorder border) const {
+        return m_reservedBorders.values(border);
+    }
+    QList<QAction *> touchBorders(KWin::ElectricBorder border) const {
+        return m_touchBorders.values(border);
+    }
+    /**
+     * The actions registered for global shortcuts which still exist.
+     */
+    QList<QAction *> globalShortcuts() const {
+        QList<QAction *> actions;
+        for (const QPointer<QAction> &action : m_globalShortcuts) {
+            if (action) {
+                actions << action;
+            }
+        }
+        return actions;
+    }
+
 private:
     bool m_animationsSuported = true;
+    KWin::Effect *m_fullScreenEffect = nullptr;
+    QMultiHash<KWin::ElectricBorder, KWin::Effect *> m_reservedBorders;
+    QMultiHash<KWin::ElectricBorder, QAction *> m_touchBorders;
+    QList<QPointer<QAction>> m_globalShortcuts;
 };
 #endif
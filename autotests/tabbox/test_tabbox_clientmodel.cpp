@@ -90,5 +90,46 @@ void TestTabBoxClientModel::testCreateClientListActiveClientNotInFocusChain()
     QCOMPARE(clientModel->rowCount(), 1);
 }
 
+void TestTabBoxClientModel::testCreateClientListIncremental()
+{
+    MockTabBoxHandler tabboxhandler;
+    tabboxhandler.setConfig(TabBox::TabBoxConfig());
+    TabBox::ClientModel *clientModel = new TabBox::ClientModel(&tabboxhandler);
+    tabboxhandler.createMockWindow(QString("test"));
+    QWeakPointer<TabBox::TabBoxClient> client = tabboxhandler.createMockWindow(QString("test2"));
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+
+    QSignalSpy resetSpy(clientModel, &QAbstractItemModel::modelReset);
+    QVERIFY(resetSpy.isValid());
+    QSignalSpy insertedSpy(clientModel, &QAbstractItemModel::rowsInserted);
+    QVERIFY(insertedSpy.isValid());
+    QSignalSpy removedSpy(clientModel, &QAbstractItemModel::rowsRemoved);
+    QVERIFY(removedSpy.isValid());
+
+    // an unchanged list doesn't touch the rows
+    const TabBox::TabBoxClientList clients = clientModel->clientList();
+    clientModel->createClientList();
+    QCOMPARE(clientModel->clientList(), clients);
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // a new window is inserted
+    tabboxhandler.createMockWindow(QString("test3"));
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 3);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // a closed window is removed
+    QSharedPointer<TabBox::TabBoxClient> clientOwner = client.toStrongRef();
+    tabboxhandler.closeWindow(client.data());
+    clientModel->createClientList();
+    QCOMPARE(clientModel->rowCount(), 2);
+    QVERIFY(!clientModel->clientList().contains(client));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+}
+
 Q_CONSTRUCTOR_FUNCTION(forceXcb)
 QTEST_MAIN(TestTabBoxClientModel)
@@ -48,6 +48,11 @@ private slots:
      * See BUG: 306260
      */
     void testCreateClientListActiveClientNotInFocusChain();
+    /**
+     * Tests that creating the Client list again updates the rows
+     * of the model instead of resetting it.
+     */
+    void testCreateClientListIncremental();
 };
 
 #endif
@@ -67,6 +67,10 @@ private Q_SLOTS:
     void testLoadBuiltInEffect_data();
     void testLoadBuiltInEffect();
     void testLoadAllEffects();
+    void testDeferredEffect();
+    void testDeferredEffectShortcut();
+    void testDeferredEffectLoadFailure();
+    void testDeferredEffectScreenEdge();
 };
 
 void TestBuiltInEffectLoader::initTestCase()
@@ -562,6 +566,193 @@ void TestBuiltInEffectLoader::testLoadAllEffects()
     QCOMPARE(loadedEffects.at(1), QStringLiteral("mouseclick"));
 }
 
+void TestBuiltInEffectLoader::testDeferredEffect()
+{
+    // invert is only supported with OpenGL compositing
+    QScopedPointer<MockEffectsHandler, QScopedPointerDeleteLater>mockHandler(new MockEffectsHandler(KWin::OpenGL2Compositing));
+    KWin::BuiltInEffectLoader loader;
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    loader.setConfig(config);
+
+    qRegisterMetaType<KWin::Effect*>();
+    QSignalSpy spy(&loader, &KWin::BuiltInEffectLoader::effectLoaded);
+    // connect to signal to ensure that we delete the Effect again as the Effect doesn't have a parent
+    connect(&loader, &KWin::BuiltInEffectLoader::effectLoaded,
+        [](KWin::Effect *effect) {
+            effect->deleteLater();
+        }
+    );
+
+    // desktopgrid declares its activation triggers, so it doesn't get created yet
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::DesktopGrid, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(spy.isEmpty());
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("desktopgrid")));
+    // deferring it again doesn't do anything
+    QVERIFY(!loader.loadEffect(KWin::BuiltInEffect::DesktopGrid, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+
+    // an effect without activation triggers gets created right away
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::MouseClick, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(1).toString(), QStringLiteral("mouseclick"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("mouseclick")));
+
+    // loading the deferred effect explicitly creates it
+    QVERIFY(loader.loadEffect(QStringLiteral("desktopgrid")));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().at(1).toString(), QStringLiteral("desktopgrid"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("desktopgrid")));
+
+    // a discarded effect can be deferred again
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::Invert, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("invert")));
+    loader.discardDeferredEffect(QStringLiteral("invert"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("invert")));
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::Invert, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("invert")));
+    QVERIFY(spy.isEmpty());
+
+    // the creation of the effects got measured
+    const QHash<QString, qint64> loadTimes = loader.loadTimes();
+    QVERIFY(loadTimes.contains(QStringLiteral("mouseclick")));
+    QVERIFY(loadTimes.contains(QStringLiteral("desktopgrid")));
+    QVERIFY(!loadTimes.contains(QStringLiteral("invert")));
+}
+
+void TestBuiltInEffectLoader::testDeferredEffectShortcut()
+{
+    // this test verifies that a shortcut creates the deferred effect and gets handed over to it
+    QScopedPointer<MockEffectsHandler, QScopedPointerDeleteLater>mockHandler(new MockEffectsHandler(KWin::OpenGL2Compositing));
+    KWin::BuiltInEffectLoader loader;
+    loader.setConfig(KSharedConfig::openConfig(QString(), KConfig::SimpleConfig));
+
+    qRegisterMetaType<KWin::Effect*>();
+    QSignalSpy spy(&loader, &KWin::BuiltInEffectLoader::effectLoaded);
+    QVERIFY(spy.isValid());
+
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::Invert, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("invert")));
+    auto findShortcut = [&mockHandler](const QString &name) -> QAction* {
+        const QList<QAction*> actions = mockHandler->globalShortcuts();
+        auto it = std::find_if(actions.begin(), actions.end(),
+            [&name](QAction *action) { return action->objectName() == name; });
+        return it != actions.end() ? *it : nullptr;
+    };
+    QAction *standIn = findShortcut(QStringLiteral("Invert"));
+    QVERIFY(standIn);
+    QVERIFY(findShortcut(QStringLiteral("InvertWindow")));
+
+    standIn->trigger();
+    // triggering again before the effect got created doesn't create it twice
+    standIn->trigger();
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QScopedPointer<KWin::Effect> effect(spy.first().first().value<KWin::Effect*>());
+    QCOMPARE(spy.first().at(1).toString(), QStringLiteral("invert"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("invert")));
+
+    // the effect got the shortcut which created it
+    QVERIFY(effect->isActive());
+
+    // only the shortcuts of the effect are left
+    QAction *action = findShortcut(QStringLiteral("Invert"));
+    QVERIFY(action);
+    QCOMPARE(action->parent(), effect.data());
+    action = findShortcut(QStringLiteral("InvertWindow"));
+    QVERIFY(action);
+    QCOMPARE(action->parent(), effect.data());
+    QCOMPARE(mockHandler->globalShortcuts().count(), 2);
+}
+
+void TestBuiltInEffectLoader::testDeferredEffectLoadFailure()
+{
+    // this test verifies that the stand-in keeps its shortcuts if the effect can't be loaded
+    QScopedPointer<MockEffectsHandler, QScopedPointerDeleteLater>mockHandler(new MockEffectsHandler(KWin::OpenGL2Compositing));
+    KWin::BuiltInEffectLoader loader;
+    loader.setConfig(KSharedConfig::openConfig(QString(), KConfig::SimpleConfig));
+
+    qRegisterMetaType<KWin::Effect*>();
+    QSignalSpy spy(&loader, &KWin::BuiltInEffectLoader::effectLoaded);
+    QVERIFY(spy.isValid());
+
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::Invert, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("invert")));
+    auto findShortcut = [&mockHandler](const QString &name) -> QAction* {
+        const QList<QAction*> actions = mockHandler->globalShortcuts();
+        auto it = std::find_if(actions.begin(), actions.end(),
+            [&name](QAction *action) { return action->objectName() == name; });
+        return it != actions.end() ? *it : nullptr;
+    };
+    QPointer<QAction> standIn = findShortcut(QStringLiteral("Invert"));
+    QVERIFY(standIn);
+
+    // invert is not supported without OpenGL, so triggering the shortcut doesn't create it
+    mockHandler->setCompositingType(KWin::XRenderCompositing);
+    QVERIFY(!loader.loadEffect(QStringLiteral("invert")));
+    standIn->trigger();
+    QVERIFY(!spy.wait(100));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("invert")));
+    QVERIFY(standIn);
+    QCOMPARE(findShortcut(QStringLiteral("Invert")), standIn.data());
+    QVERIFY(findShortcut(QStringLiteral("InvertWindow")));
+
+    // once it is supported again, the shortcut still creates the effect
+    mockHandler->setCompositingType(KWin::OpenGL2Compositing);
+    standIn->trigger();
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QScopedPointer<KWin::Effect> effect(spy.first().first().value<KWin::Effect*>());
+    QCOMPARE(spy.first().at(1).toString(), QStringLiteral("invert"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("invert")));
+    QVERIFY(effect->isActive());
+    QAction *action = findShortcut(QStringLiteral("Invert"));
+    QVERIFY(action);
+    QCOMPARE(action->parent(), effect.data());
+}
+
+void TestBuiltInEffectLoader::testDeferredEffectScreenEdge()
+{
+    // this test verifies that a screen edge creates the deferred effect and gets handed over to it
+    QScopedPointer<MockEffectsHandler, QScopedPointerDeleteLater>mockHandler(new MockEffectsHandler(KWin::XRenderCompositing));
+    // desktopgrid reads its config from the effects handler, so the loader has to use the same
+    KSharedConfig::Ptr config = mockHandler->config();
+    KConfigGroup group = config->group("Effect-DesktopGrid");
+    group.writeEntry("BorderActivate", QList<int>{int(KWin::ElectricTopLeft)});
+    group.writeEntry("TouchBorderActivate", QList<int>{int(KWin::ElectricLeft)});
+    group.sync();
+    KWin::BuiltInEffectLoader loader;
+    loader.setConfig(config);
+
+    qRegisterMetaType<KWin::Effect*>();
+    QSignalSpy spy(&loader, &KWin::BuiltInEffectLoader::effectLoaded);
+    QVERIFY(spy.isValid());
+
+    QVERIFY(loader.loadEffect(KWin::BuiltInEffect::DesktopGrid, KWin::LoadEffectFlag::Load | KWin::LoadEffectFlag::Defer));
+    QVERIFY(loader.isEffectDeferred(QStringLiteral("desktopgrid")));
+    QCOMPARE(mockHandler->reservedBorders(KWin::ElectricTopLeft).count(), 1);
+    KWin::Effect *standIn = mockHandler->reservedBorders(KWin::ElectricTopLeft).first();
+    QCOMPARE(mockHandler->touchBorders(KWin::ElectricLeft).count(), 1);
+    QCOMPARE(mockHandler->touchBorders(KWin::ElectricLeft).first()->parent(), standIn);
+
+    // another full screen effect keeps desktopgrid from showing up once it got the screen edge
+    KWin::Effect fullScreenEffect;
+    mockHandler->setActiveFullScreenEffect(&fullScreenEffect);
+    QVERIFY(standIn->borderActivated(KWin::ElectricTopLeft));
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QScopedPointer<KWin::Effect> effect(spy.first().first().value<KWin::Effect*>());
+    QCOMPARE(spy.first().at(1).toString(), QStringLiteral("desktopgrid"));
+    QVERIFY(!loader.isEffectDeferred(QStringLiteral("desktopgrid")));
+
+    // the screen edges are reserved by the effect alone
+    QCOMPARE(mockHandler->reservedBorders(KWin::ElectricTopLeft), QList<KWin::Effect*>{effect.data()});
+    QCOMPARE(mockHandler->touchBorders(KWin::ElectricLeft).count(), 1);
+    QCOMPARE(mockHandler->touchBorders(KWin::ElectricLeft).first()->parent(), effect.data());
+    mockHandler->setActiveFullScreenEffect(nullptr);
+
+    group.deleteGroup();
+    group.sync();
+}
+
 Q_CONSTRUCTOR_FUNCTION(forceXcb)
 QTEST_MAIN(TestBuiltInEffectLoader)
 #include "test_builtin_effectloader.moc"
@@ -0,0 +1,321 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../frametimings.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTest>
+
+Q_LOGGING_CATEGORY(KWIN_CORE, "kwin_core")
+
+using namespace KWin;
+
+class FrameTimingsTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSelf();
+    void testDisabled();
+    void testDiscardFrame();
+    void testNestedScopes();
+    void testScopeOutsideFrame();
+    void testEffectCosts();
+    void testEffectGpuTimingWithoutQueries();
+    void testRingBufferWraps();
+    void testLateGpuTime();
+    void testFlipAttribution();
+    void testTrace();
+    void testTraceDoesNotOverwrite();
+};
+
+void FrameTimingsTest::testSelf()
+{
+    QVERIFY(!FrameTimings::self());
+    {
+        FrameTimings timings;
+        QCOMPARE(FrameTimings::self(), &timings);
+    }
+    QVERIFY(!FrameTimings::self());
+}
+
+void FrameTimingsTest::testDisabled()
+{
+    // nothing gets recorded unless enabled
+    FrameTimings timings;
+    QVERIFY(!timings.isEnabled());
+    timings.beginFrame();
+    QVERIFY(!timings.isRecording());
+    {
+        FrameTimingScope scope(FrameTimings::Painting);
+    }
+    timings.endFrame();
+    QVERIFY(timings.frames(10).isEmpty());
+
+    timings.setEnabled(true);
+    timings.beginFrame();
+    QVERIFY(timings.isRecording());
+    timings.endFrame();
+    QCOMPARE(timings.frames(10).count(), 1);
+}
+
+void FrameTimingsTest::testDiscardFrame()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+    timings.beginFrame();
+    QVERIFY(timings.isRecording());
+    QCOMPARE(timings.sequence(), quint64(1));
+    timings.discardFrame();
+    QVERIFY(!timings.isRecording());
+    QVERIFY(timings.frames(10).isEmpty());
+
+    // the sequence number of a discarded frame is reused
+    timings.beginFrame();
+    QCOMPARE(timings.sequence(), quint64(1));
+    timings.endFrame();
+    const auto frames = timings.frames(10);
+    QCOMPARE(frames.count(), 1);
+    QCOMPARE(frames.first().sequence, quint64(1));
+}
+
+void FrameTimingsTest::testNestedScopes()
+{
+    // a nested scope is not accounted to the enclosing phase
+    FrameTimings timings;
+    timings.setEnabled(true);
+    timings.beginFrame();
+    {
+        FrameTimingScope painting(FrameTimings::Painting);
+        {
+            FrameTimingScope culling(FrameTimings::Culling);
+            QTest::qSleep(20);
+        }
+    }
+    timings.endFrame();
+
+    const auto frames = timings.frames(1);
+    QCOMPARE(frames.count(), 1);
+    const FrameTimings::Frame &frame = frames.first();
+    QVERIFY(frame.phases[FrameTimings::Culling] >= 20 * 1000 * 1000);
+    QVERIFY(frame.phases[FrameTimings::Painting] < frame.phases[FrameTimings::Culling]);
+    QVERIFY(frame.duration >= frame.phases[FrameTimings::Culling] + frame.phases[FrameTimings::Painting]);
+}
+
+void FrameTimingsTest::testScopeOutsideFrame()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+    {
+        FrameTimingScope scope(FrameTimings::Painting);
+    }
+    QVERIFY(timings.frames(10).isEmpty());
+}
+
+void FrameTimingsTest::testEffectCosts()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+    const Effect *effect = reinterpret_cast<const Effect *>(0x1);
+    for (int i = 0; i < 3; ++i) {
+        timings.beginFrame();
+        {
+            FrameTimingScope scope(FrameTimings::Effects, effect);
+            QTest::qSleep(1);
+            FrameTimingScope scene(FrameTimings::Painting);
+        }
+        timings.endFrame();
+    }
+    QCOMPARE(timings.effectCosts().count(), 1);
+    const FrameTimings::EffectCost cost = timings.effectCosts().value(effect);
+    QCOMPARE(cost.frames, quint64(3));
+    QVERIFY(cost.cpuTime >= 3 * 1000 * 1000);
+
+    timings.addGpuTime(3, effect, 500);
+    QCOMPARE(timings.effectCosts().value(effect).gpuTime, qint64(500));
+
+    timings.forgetEffect(effect);
+    QVERIFY(timings.effectCosts().isEmpty());
+    // results arriving for an unloaded effect are dropped
+    timings.addGpuTime(3, effect, 500);
+    QVERIFY(timings.effectCosts().isEmpty());
+}
+
+void FrameTimingsTest::testEffectGpuTimingWithoutQueries()
+{
+    // without a GL context there are no timer queries, enabling the timing must be harmless
+    FrameTimings timings;
+    timings.setEnabled(true);
+    QVERIFY(!timings.isEffectGpuTimingEnabled());
+    timings.setEffectGpuTimingEnabled(true);
+    QVERIFY(timings.isEffectGpuTimingEnabled());
+    QVERIFY(!timings.gpuTimerQueries());
+
+    const Effect *effect = reinterpret_cast<const Effect *>(0x1);
+    timings.beginFrame();
+    {
+        FrameTimingScope scope(FrameTimings::Effects, effect);
+        FrameTimingScope scene(FrameTimings::Painting);
+    }
+    timings.endFrame();
+    QCOMPARE(timings.effectCosts().value(effect).frames, quint64(1));
+    QCOMPARE(timings.effectCosts().value(effect).gpuTime, qint64(0));
+}
+
+void FrameTimingsTest::testRingBufferWraps()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+    for (int i = 0; i < 300; ++i) {
+        timings.beginFrame();
+        timings.endFrame();
+    }
+    QCOMPARE(timings.frames(0).count(), 0);
+    auto frames = timings.frames(10);
+    QCOMPARE(frames.count(), 10);
+    QCOMPARE(frames.first().sequence, quint64(291));
+    QCOMPARE(frames.last().sequence, quint64(300));
+
+    // only the capacity of the ring buffer is retained
+    frames = timings.frames(1000);
+    QCOMPARE(frames.count(), 256);
+    QCOMPARE(frames.first().sequence, quint64(45));
+}
+
+void FrameTimingsTest::testLateGpuTime()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+    for (int i = 0; i < 3; ++i) {
+        timings.beginFrame();
+        timings.endFrame();
+    }
+    timings.addGpuTime(2, nullptr, 1000);
+    timings.addGpuTime(2, nullptr, 500);
+    // frames no longer in the ring buffer are ignored
+    timings.addGpuTime(1000, nullptr, 1000);
+
+    const auto frames = timings.frames(3);
+    QCOMPARE(frames.count(), 3);
+    QCOMPARE(frames.at(0).phases[FrameTimings::Gpu], qint64(0));
+    QCOMPARE(frames.at(1).phases[FrameTimings::Gpu], qint64(1500));
+    QCOMPARE(frames.at(2).phases[FrameTimings::Gpu], qint64(0));
+}
+
+void FrameTimingsTest::testFlipAttribution()
+{
+    FrameTimings timings;
+    timings.setEnabled(true);
+
+    // the backend presents the previous frame when starting a new one
+    timings.beginFrame();
+    timings.markRendered();
+    timings.endFrame();
+    timings.beginFrame();
+    timings.swapStarted();
+    QTest::qSleep(1);
+    timings.swapCompleted();
+    timings.markRendered();
+    timings.endFrame();
+
+    auto frames = timings.frames(2);
+    QCOMPARE(frames.count(), 2);
+    QVERIFY(frames.at(0).phases[FrameTimings::Flip] > 0);
+    QCOMPARE(frames.at(1).phases[FrameTimings::Flip], qint64(0));
+
+    // the backend presents the frame right after rendering it, the swap completes later
+    timings.beginFrame();
+    timings.markRendered();
+    timings.swapStarted();
+    timings.endFrame();
+    QTest::qSleep(1);
+    timings.swapCompleted();
+
+    frames = timings.frames(1);
+    QCOMPARE(frames.count(), 1);
+    QCOMPARE(frames.first().sequence, quint64(3));
+    QVERIFY(frames.first().phases[FrameTimings::Flip] >= 1000 * 1000);
+}
+
+void FrameTimingsTest::testTrace()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("trace.json"));
+
+    // tracing records the frames without enabling the recorder
+    FrameTimings timings;
+    QVERIFY(!timings.isTracing());
+    QVERIFY(timings.startTrace(fileName));
+    QVERIFY(timings.isTracing());
+    for (int i = 0; i < 20; ++i) {
+        timings.beginFrame();
+        {
+            FrameTimingScope scope(FrameTimings::Painting);
+            QTest::qSleep(1);
+        }
+        timings.endFrame();
+    }
+    timings.stopTrace();
+    QVERIFY(!timings.isTracing());
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QVERIFY(document.isArray());
+
+    int frames = 0;
+    int painting = 0;
+    const QJsonArray events = document.array();
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("name")).toString() == QLatin1String("frame")) {
+            frames++;
+        } else if (event.value(QStringLiteral("name")).toString() == QLatin1String("painting")) {
+            QCOMPARE(event.value(QStringLiteral("ph")).toString(), QStringLiteral("X"));
+            QVERIFY(event.value(QStringLiteral("dur")).toDouble() >= 1000.0);
+            painting++;
+        }
+    }
+    QCOMPARE(frames, 20);
+    QCOMPARE(painting, 20);
+}
+
+void FrameTimingsTest::testTraceDoesNotOverwrite()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("existing"));
+    QFile existing(fileName);
+    QVERIFY(existing.open(QIODevice::WriteOnly));
+    existing.write(QByteArrayLiteral("keep"));
+    existing.close();
+
+    FrameTimings timings;
+    QVERIFY(!timings.startTrace(fileName));
+    QVERIFY(!timings.isTracing());
+
+    QVERIFY(existing.open(QIODevice::ReadOnly));
+    QCOMPARE(existing.readAll(), QByteArrayLiteral("keep"));
+}
+
+QTEST_GUILESS_MAIN(FrameTimingsTest)
+#include "test_frame_timings.moc"
@@ -0,0 +1,245 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../effects/presentwindows/naturallayout.h"
+
+#include <QRegion>
+#include <QtTest>
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(QVector<QRect>)
+
+/**
+ * The natural layout as calculated before the grid, comparing every window with every other.
+ */
+static QVector<QRect> referenceLayout(const QVector<QRect> &geometries, const QRect &area, int accuracy, bool fillGaps)
+{
+    auto heightForWidth = [&geometries](int w, int width) {
+        return int((width / double(geometries[w].width())) * geometries[w].height());
+    };
+
+    QRect bounds = area;
+    QVector<QRect> targets = geometries;
+    for (const QRect &target : qAsConst(targets))
+        bounds = bounds.united(target);
+
+    bool overlap;
+    do {
+        overlap = false;
+        for (int w = 0; w < targets.count(); ++w) {
+            QRect *target_w = &targets[w];
+            for (int e = 0; e < targets.count(); ++e) {
+                if (w == e)
+                    continue;
+                QRect *target_e = &targets[e];
+                if (target_w->adjusted(-5, -5, 5, 5).intersects(target_e->adjusted(-5, -5, 5, 5))) {
+                    overlap = true;
+                    QPoint diff(target_e->center() - target_w->center());
+                    if (diff.x() == 0 && diff.y() == 0)
+                        diff.setX(1);
+                    diff *= accuracy / double(diff.manhattanLength());
+                    target_w->translate(-diff);
+                    target_e->translate(diff);
+
+                    const int direction = w % 4;
+                    int xSection = (target_w->x() - bounds.x()) / (bounds.width() / 3);
+                    int ySection = (target_w->y() - bounds.y()) / (bounds.height() / 3);
+                    diff = QPoint(0, 0);
+                    if (xSection != 1 || ySection != 1) {
+                        if (xSection == 1)
+                            xSection = (direction / 2 ? 2 : 0);
+                        if (ySection == 1)
+                            ySection = (direction % 2 ? 2 : 0);
+                    }
+                    if (xSection == 0 && ySection == 0)
+                        diff = QPoint(bounds.topLeft() - target_w->center());
+                    if (xSection == 2 && ySection == 0)
+                        diff = QPoint(bounds.topRight() - target_w->center());
+                    if (xSection == 2 && ySection == 2)
+                        diff = QPoint(bounds.bottomRight() - target_w->center());
+                    if (xSection == 0 && ySection == 2)
+                        diff = QPoint(bounds.bottomLeft() - target_w->center());
+                    if (diff.x() != 0 || diff.y() != 0) {
+                        diff *= accuracy / double(diff.manhattanLength());
+                        target_w->translate(diff);
+                    }
+
+                    bounds = bounds.united(*target_w);
+                    bounds = bounds.united(*target_e);
+                }
+            }
+        }
+    } while (overlap);
+
+    double scale;
+    if (bounds == area)
+        scale = 1.0;
+    else if (area.width() / double(bounds.width()) < area.height() / double(bounds.height()))
+        scale = (area.width() - 20) / double(bounds.width());
+    else
+        scale = (area.height() - 20) / double(bounds.height());
+    bounds = QRect(
+                 bounds.x() - (area.width() - 20 - bounds.width() * scale) / 2 - 10 / scale,
+                 bounds.y() - (area.height() - 20 - bounds.height() * scale) / 2 - 10 / scale,
+                 area.width() / scale,
+                 area.height() / scale
+             );
+    for (QRect &target : targets) {
+        target.setRect((target.x() - bounds.x()) * scale + area.x(),
+                       (target.y() - bounds.y()) * scale + area.y(),
+                       target.width() * scale,
+                       target.height() * scale);
+    }
+
+    if (fillGaps) {
+        QRegion borderRegion(area.adjusted(-200, -200, 200, 200));
+        borderRegion ^= area.adjusted(10 / scale, 10 / scale, -10 / scale, -10 / scale);
+        auto isOverlappingAny = [&targets, &borderRegion](int w) {
+            if (borderRegion.intersects(targets[w]))
+                return true;
+            for (int e = 0; e < targets.count(); ++e) {
+                if (e != w && targets[w].adjusted(-5, -5, 5, 5).intersects(targets[e].adjusted(-5, -5, 5, 5)))
+                    return true;
+            }
+            return false;
+        };
+
+        bool moved;
+        do {
+            moved = false;
+            for (int w = 0; w < targets.count(); ++w) {
+                QRect *target = &targets[w];
+                int widthDiff = accuracy;
+                int heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                int xDiff = widthDiff / 2;
+                int yDiff = heightDiff / 2;
+                // enlarge to the top-right, bottom-right, bottom-left and top-left
+                for (int i = 0; i < 4; ++i) {
+                    QPoint offset;
+                    switch (i) {
+                    case 0: offset = QPoint(xDiff, -yDiff - heightDiff); break;
+                    case 1: offset = QPoint(xDiff, yDiff); break;
+                    case 2: offset = QPoint(-xDiff - widthDiff, yDiff); break;
+                    default: offset = QPoint(-xDiff - widthDiff, -yDiff - heightDiff); break;
+                    }
+                    const QRect oldRect = *target;
+                    target->setRect(target->x() + offset.x(), target->y() + offset.y(),
+                                    target->width() + widthDiff, target->height() + heightDiff);
+                    if (isOverlappingAny(w)) {
+                        *target = oldRect;
+                    } else {
+                        moved = true;
+                        if (i < 3) {
+                            heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                            yDiff = heightDiff / 2;
+                        }
+                    }
+                }
+            }
+        } while (moved);
+
+        for (int w = 0; w < targets.count(); ++w) {
+            QRect *target = &targets[w];
+            const QRect &geometry = geometries.at(w);
+            double scale = target->width() / double(geometry.width());
+            if (scale > 2.0 || (scale > 1.0 && (geometry.width() > 300 || geometry.height() > 300))) {
+                scale = (geometry.width() > 300 || geometry.height() > 300) ? 1.0 : 2.0;
+                target->setRect(target->center().x() - int(geometry.width() * scale) / 2,
+                                target->center().y() - int(geometry.height() * scale) / 2,
+                                geometry.width() * scale,
+                                geometry.height() * scale);
+            }
+        }
+    }
+
+    return targets;
+}
+
+class NaturalLayoutTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLayout_data();
+    void testLayout();
+    void testEstimate();
+};
+
+void NaturalLayoutTest::testLayout_data()
+{
+    QTest::addColumn<QVector<QRect>>("geometries");
+    QTest::addColumn<bool>("fillGaps");
+
+    QVector<QRect> cascaded;
+    for (int i = 0; i < 12; ++i)
+        cascaded << QRect(50 + i * 30, 40 + i * 30, 640, 480);
+
+    QVector<QRect> stacked;
+    for (int i = 0; i < 8; ++i)
+        stacked << QRect(200, 150, 800, 600);
+
+    // deterministic pseudo random geometries
+    QVector<QRect> scattered;
+    quint32 seed = 42;
+    auto next = [&seed](int max) {
+        seed = seed * 1103515245 + 12345;
+        return int((seed >> 16) % quint32(max));
+    };
+    for (int i = 0; i < 40; ++i)
+        scattered << QRect(next(1600), next(1000), 100 + next(900), 80 + next(700));
+
+    QTest::newRow("single") << QVector<QRect>{QRect(100, 100, 400, 300)} << true;
+    QTest::newRow("cascaded") << cascaded << false;
+    QTest::newRow("cascaded/fillGaps") << cascaded << true;
+    QTest::newRow("stacked") << stacked << false;
+    QTest::newRow("stacked/fillGaps") << stacked << true;
+    QTest::newRow("scattered") << scattered << false;
+    QTest::newRow("scattered/fillGaps") << scattered << true;
+}
+
+void NaturalLayoutTest::testLayout()
+{
+    // the grid must not change the layout, and the worker thread gets the same result
+    QFETCH(QVector<QRect>, geometries);
+    QFETCH(bool, fillGaps);
+    const QRect area(0, 0, 1920, 1080);
+    const int accuracy = 20;
+
+    const NaturalLayout layout(geometries, area, accuracy, fillGaps);
+    const QVector<QRect> targets = layout.calculate();
+    QCOMPARE(targets.count(), geometries.count());
+    QCOMPARE(targets, referenceLayout(geometries, area, accuracy, fillGaps));
+
+    QFuture<QVector<QRect>> future = layout.calculateAsync();
+    future.waitForFinished();
+    QCOMPARE(future.result(), targets);
+}
+
+void NaturalLayoutTest::testEstimate()
+{
+    // the estimate keeps all windows inside the area
+    const QRect area(0, 0, 1920, 1080);
+    const QVector<QRect> geometries{QRect(-500, 0, 800, 600), QRect(1500, 700, 800, 600)};
+    const NaturalLayout layout(geometries, area, 20, false);
+    const QVector<QRect> estimate = layout.estimate();
+    QCOMPARE(estimate.count(), 2);
+    for (const QRect &rect : estimate)
+        QVERIFY(area.contains(rect));
+}
+
+QTEST_GUILESS_MAIN(NaturalLayoutTest)
+#include "test_natural_layout.moc"
@@ -0,0 +1,129 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "../placementmap.h"
+
+#include <QRandomGenerator>
+#include <QTest>
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(KWin::PlacementMap::Method)
+
+class PlacementMapTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testWeights();
+    void testRandomLayouts();
+    void benchmarkSmartPosition_data();
+    void benchmarkSmartPosition();
+};
+
+static const QRect s_area(0, 0, 1920, 1080);
+
+static QVector<PlacementMap::Window> randomLayout(QRandomGenerator *generator, int count)
+{
+    QVector<PlacementMap::Window> windows;
+    for (int i = 0; i < count; ++i) {
+        const QRect geometry(generator->bounded(-100, 1800), generator->bounded(-100, 1000),
+                             generator->bounded(1, 800), generator->bounded(1, 600));
+        int weight = 1;
+        const int kind = generator->bounded(10);
+        if (kind == 0) {
+            weight = 16;
+        } else if (kind == 1) {
+            weight = 0;
+        }
+        windows.append({geometry, weight});
+    }
+    return windows;
+}
+
+void PlacementMapTest::testEmpty()
+{
+    PlacementMap map({});
+    QCOMPARE(map.overlap(s_area), qint64(0));
+    QCOMPARE(map.smartPosition(QSize(100, 100), s_area), s_area.topLeft());
+}
+
+void PlacementMapTest::testWeights()
+{
+    PlacementMap map({
+        {QRect(0, 0, 100, 100), 1},
+        {QRect(50, 50, 100, 100), 16},
+        {QRect(0, 0, 1000, 1000), 0}
+    });
+    QCOMPARE(map.overlap(QRect(0, 0, 10, 10)), qint64(100));
+    QCOMPARE(map.overlap(QRect(60, 60, 10, 10)), qint64(17 * 100));
+    QCOMPARE(map.overlap(QRect(200, 200, 10, 10)), qint64(0));
+    QCOMPARE(map.overlap(QRect(-50, -50, 300, 300)), qint64(100 * 100 + 16 * 100 * 100));
+    // the window covered by a window with weight 0 is not avoided
+    QCOMPARE(map.smartPosition(QSize(100, 100), s_area), QPoint(150, 0));
+}
+
+void PlacementMapTest::testRandomLayouts()
+{
+    // the summed-area table must place exactly like the brute force algorithm
+    QRandomGenerator generator(42);
+    for (int i = 0; i < 500; ++i) {
+        const PlacementMap map(randomLayout(&generator, generator.bounded(40)));
+        for (int j = 0; j < 10; ++j) {
+            const QRect rect(generator.bounded(-50, 1950), generator.bounded(-50, 1150),
+                             generator.bounded(900), generator.bounded(700));
+            QCOMPARE(map.overlap(rect), map.overlap(rect, PlacementMap::BruteForce));
+        }
+        const QSize size(generator.bounded(1, 900), generator.bounded(1, 700));
+        QCOMPARE(map.smartPosition(size, s_area), map.smartPosition(size, s_area, PlacementMap::BruteForce));
+    }
+}
+
+void PlacementMapTest::benchmarkSmartPosition_data()
+{
+    QTest::addColumn<PlacementMap::Method>("method");
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("bruteForce/10") << PlacementMap::BruteForce << 10;
+    QTest::newRow("summedAreaTable/10") << PlacementMap::SummedAreaTable << 10;
+    QTest::newRow("bruteForce/50") << PlacementMap::BruteForce << 50;
+    QTest::newRow("summedAreaTable/50") << PlacementMap::SummedAreaTable << 50;
+    QTest::newRow("bruteForce/200") << PlacementMap::BruteForce << 200;
+    QTest::newRow("summedAreaTable/200") << PlacementMap::SummedAreaTable << 200;
+}
+
+void PlacementMapTest::benchmarkSmartPosition()
+{
+    QFETCH(PlacementMap::Method, method);
+    QFETCH(int, count);
+
+    QRandomGenerator generator(count);
+    QVector<QVector<PlacementMap::Window>> layouts;
+    for (int i = 0; i < 16; ++i) {
+        layouts.append(randomLayout(&generator, count));
+    }
+
+    int layout = 0;
+    QBENCHMARK {
+        // building the table is part of every placement
+        const PlacementMap map(layouts.at(layout++ % layouts.count()));
+        map.smartPosition(QSize(640, 480), s_area, method);
+    }
+}
+
+QTEST_GUILESS_MAIN(PlacementMapTest)
+#include "test_placement_map.moc"
@@ -132,6 +132,9 @@ private Q_SLOTS:
     void testTouchEdge();
     void testTouchCallback_data();
     void testTouchCallback();
+    void testApproachingOutsideEdges();
+    void benchmarkPointerMotion_data();
+    void benchmarkPointerMotion();
 };
 
 void TestScreenEdges::initTestCase()
@@ -468,7 +471,7 @@ void TestScreenEdges::testCallback()
     event.time = QDateTime::currentMSecsSinceEpoch();
     setPos(QPoint(0, 50));
     auto isEntered = [s] (xcb_enter_notify_event_t *event) {
-        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), QDateTime::fromMSecsSinceEpoch(event->time));
+        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), event->time);
     };
     QVERIFY(isEntered(&event));
     // doesn't trigger as the edge was not triggered yet
@@ -574,12 +577,12 @@ void TestScreenEdges::testCallbackWithCheck()
     s->reserve(ElectricLeft, &callback, "callback");
 
     // check activating a different edge doesn't do anything
-    s->check(QPoint(50, 0), QDateTime::currentDateTime(), true);
+    s->check(QPoint(50, 0), QDateTime::currentMSecsSinceEpoch(), true);
     QVERIFY(spy.isEmpty());
 
     // try a direct activate without pushback
     Cursor::setPos(0, 50);
-    s->check(QPoint(0, 50), QDateTime::currentDateTime(), true);
+    s->check(QPoint(0, 50), QDateTime::currentMSecsSinceEpoch(), true);
     QCOMPARE(spy.count(), 1);
     QEXPECT_FAIL("", "Argument says force no pushback, but it gets pushed back. Needs investigation", Continue);
     QCOMPARE(Cursor::pos(), QPoint(0, 50));
@@ -587,14 +590,14 @@ void TestScreenEdges::testCallbackWithCheck()
     // use a different edge, this time with pushback
     s->reserve(KWin::ElectricRight, &callback, "callback");
     Cursor::setPos(99, 50);
-    s->check(QPoint(99, 50), QDateTime::currentDateTime());
+    s->check(QPoint(99, 50), QDateTime::currentMSecsSinceEpoch());
     QCOMPARE(spy.count(), 1);
     QCOMPARE(spy.last().first().value<ElectricBorder>(), ElectricLeft);
     QCOMPARE(Cursor::pos(), QPoint(98, 50));
     // and trigger it again
     QTest::qWait(160);
     Cursor::setPos(99, 50);
-    s->check(QPoint(99, 50), QDateTime::currentDateTime());
+    s->check(QPoint(99, 50), QDateTime::currentMSecsSinceEpoch());
     QCOMPARE(spy.count(), 2);
     QCOMPARE(spy.last().first().value<ElectricBorder>(), ElectricRight);
     QCOMPARE(Cursor::pos(), QPoint(98, 50));
@@ -650,7 +653,7 @@ void TestScreenEdges::testPushBack()
     event.same_screen_focus = 1;
     event.time = QDateTime::currentMSecsSinceEpoch();
     auto isEntered = [s] (xcb_enter_notify_event_t *event) {
-        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), QDateTime::fromMSecsSinceEpoch(event->time));
+        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), event->time);
     };
     QVERIFY(isEntered(&event));
     QVERIFY(spy.isEmpty());
@@ -658,7 +661,7 @@ void TestScreenEdges::testPushBack()
 
     // do the same without the event, but the check method
     Cursor::setPos(trigger);
-    s->check(trigger, QDateTime::currentDateTime());
+    s->check(trigger, QDateTime::currentMSecsSinceEpoch());
     QVERIFY(spy.isEmpty());
     QTEST(Cursor::pos(), "expected");
 }
@@ -700,7 +703,7 @@ void TestScreenEdges::testFullScreenBlocking()
     event.same_screen_focus = 1;
     event.time = QDateTime::currentMSecsSinceEpoch();
     auto isEntered = [s] (xcb_enter_notify_event_t *event) {
-        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), QDateTime::fromMSecsSinceEpoch(event->time));
+        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), event->time);
     };
     QVERIFY(isEntered(&event));
     QVERIFY(spy.isEmpty());
@@ -823,7 +826,7 @@ void TestScreenEdges::testClientEdge()
     event.same_screen_focus = 1;
     event.time = QDateTime::currentMSecsSinceEpoch();
     auto isEntered = [s] (xcb_enter_notify_event_t *event) {
-        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), QDateTime::fromMSecsSinceEpoch(event->time));
+        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), event->time);
     };
     QVERIFY(isEntered(&event));
     // autohiding panels shall activate instantly
@@ -863,7 +866,7 @@ void TestScreenEdges::testClientEdge()
     s->reserve(&client, KWin::ElectricTop);
     QCOMPARE(client.isHiddenInternal(), true);
     Cursor::setPos(50, 0);
-    s->check(QPoint(50, 0), QDateTime::currentDateTime());
+    s->check(QPoint(50, 0), QDateTime::currentMSecsSinceEpoch());
     QCOMPARE(client.isHiddenInternal(), false);
     QCOMPARE(Cursor::pos(), QPoint(50, 1));
 
@@ -872,7 +875,7 @@ void TestScreenEdges::testClientEdge()
     // check on previous edge again, should fail
     client.setHiddenInternal(true);
     Cursor::setPos(50, 0);
-    s->check(QPoint(50, 0), QDateTime::currentDateTime());
+    s->check(QPoint(50, 0), QDateTime::currentMSecsSinceEpoch());
     QCOMPARE(client.isHiddenInternal(), true);
     QCOMPARE(Cursor::pos(), QPoint(50, 0));
 
@@ -960,12 +963,12 @@ void TestScreenEdges::testTouchEdge()
     event.time = QDateTime::currentMSecsSinceEpoch();
     setPos(QPoint(0, 50));
     auto isEntered = [s] (xcb_enter_notify_event_t *event) {
-        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), QDateTime::fromMSecsSinceEpoch(event->time));
+        return s->handleEnterNotifiy(event->event, QPoint(event->root_x, event->root_y), event->time);
     };
     QCOMPARE(isEntered(&event), false);
     QVERIFY(approachingSpy.isEmpty());
     // let's also verify the check
-    s->check(QPoint(0, 50), QDateTime::currentDateTime(), false);
+    s->check(QPoint(0, 50), QDateTime::currentMSecsSinceEpoch(), false);
     QVERIFY(approachingSpy.isEmpty());
 
     s->gestureRecognizer()->startSwipeGesture(QPoint(0, 50));
@@ -1083,6 +1086,90 @@ void TestScreenEdges::testTouchCallback()
     }
 }
 
+void TestScreenEdges::testApproachingOutsideEdges()
+{
+    // this test verifies that approaching stops when the pointer leaves the edges, even though
+    // motion outside of all edges isn't looked at any further
+    using namespace KWin;
+    auto s = ScreenEdges::self();
+    s->init();
+    TestObject callback;
+    s->reserve(ElectricLeft, &callback, "callback");
+    QSignalSpy approachingSpy(s, &ScreenEdges::approaching);
+    QVERIFY(approachingSpy.isValid());
+
+    const QList<Edge*> edges = s->findChildren<Edge*>(QString(), Qt::FindDirectChildrenOnly);
+    auto it = std::find_if(edges.constBegin(), edges.constEnd(), [](Edge *e) {
+        return e->isScreenEdge() && e->isLeft();
+    });
+    QVERIFY(it != edges.constEnd());
+    const QPoint approachPos = (*it)->approachGeometry().center();
+    const QPoint centerPos = screens()->geometry().center();
+    QVERIFY(!(*it)->approachGeometry().contains(centerPos));
+
+    auto move = [s](const QPoint &pos) {
+        QMouseEvent event(QEvent::MouseMove, pos, pos, Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+        s->isEntered(&event);
+    };
+    move(approachPos);
+    QVERIFY((*it)->isApproaching());
+    const int count = approachingSpy.count();
+    QVERIFY(count > 0);
+    move(centerPos);
+    QVERIFY(!(*it)->isApproaching());
+    QCOMPARE(approachingSpy.count(), count + 1);
+    move(centerPos + QPoint(1, 1));
+    QCOMPARE(approachingSpy.count(), count + 1);
+}
+
+void TestScreenEdges::benchmarkPointerMotion_data()
+{
+    QTest::addColumn<bool>("nearEdge");
+
+    QTest::newRow("interior") << false;
+    QTest::newRow("nearEdge") << true;
+}
+
+void TestScreenEdges::benchmarkPointerMotion()
+{
+    // one second of 1 kHz pointer motion, either in the middle of the screen or along the
+    // left edge, with callbacks reserved on all edges
+    using namespace KWin;
+    QFETCH(bool, nearEdge);
+    auto s = ScreenEdges::self();
+    s->init();
+    TestObject callback;
+    const ElectricBorder borders[] = {
+        ElectricTop, ElectricTopRight, ElectricRight, ElectricBottomRight,
+        ElectricBottom, ElectricBottomLeft, ElectricLeft, ElectricTopLeft
+    };
+    for (ElectricBorder border : borders) {
+        s->reserve(border, &callback, "callback");
+    }
+
+    const QRect geometry = screens()->geometry();
+    QVector<QPoint> positions;
+    positions.reserve(1000);
+    for (int i = 0; i < 1000; ++i) {
+        const int y = geometry.y() + i % geometry.height();
+        if (nearEdge) {
+            positions << QPoint(geometry.x() + 1 + i % 3, y);
+        } else {
+            positions << QPoint(geometry.center().x() + i % 5, y);
+        }
+    }
+
+    quint32 timestamp = 0;
+    QBENCHMARK {
+        for (const QPoint &pos : qAsConst(positions)) {
+            QMouseEvent event(QEvent::MouseMove, pos, pos, Qt::NoButton, Qt::NoButton, Qt::NoModifier);
+            event.setTimestamp(++timestamp);
+            s->isEntered(&event);
+            s->check(pos, timestamp);
+        }
+    }
+}
+
 Q_CONSTRUCTOR_FUNCTION(forceXcb)
 QTEST_MAIN(TestScreenEdges)
 #include "test_screen_edges.moc"
@@ -0,0 +1,167 @@
+/********************************************************************
+KWin - the KDE window manager
+This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "testutils.h"
+// KWin
+#include "../xcbutils.h"
+// Qt
+#include <QApplication>
+#include <QtTest>
+#include <QX11Info>
+// xcb
+#include <xcb/xcb.h>
+#include <xcb/xfixes.h>
+
+using namespace KWin;
+
+class TestXcbRegionReplies : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testWait_data();
+    void testWait();
+    void testPoll();
+    void testDiscard();
+
+private:
+    xcb_xfixes_region_t createRegion(const QVector<QRect> &rects);
+};
+
+void TestXcbRegionReplies::initTestCase()
+{
+    qApp->setProperty("x11RootWindow", QVariant::fromValue<quint32>(QX11Info::appRootWindow()));
+    qApp->setProperty("x11Connection", QVariant::fromValue<void*>(QX11Info::connection()));
+
+    // the version has to be negotiated before any other XFixes request
+    xcb_connection_t *c = connection();
+    ScopedCPointer<xcb_xfixes_query_version_reply_t> version(xcb_xfixes_query_version_reply(c,
+        xcb_xfixes_query_version_unchecked(c, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION), nullptr));
+    if (version.isNull() || version->major_version < 2) {
+        QSKIP("XFixes regions are not supported by the X server");
+    }
+}
+
+xcb_xfixes_region_t TestXcbRegionReplies::createRegion(const QVector<QRect> &rects)
+{
+    QVector<xcb_rectangle_t> xrects;
+    for (const QRect &rect : rects) {
+        xrects << xcb_rectangle_t{int16_t(rect.x()), int16_t(rect.y()), uint16_t(rect.width()), uint16_t(rect.height())};
+    }
+    const xcb_xfixes_region_t region = xcb_generate_id(connection());
+    xcb_xfixes_create_region(connection(), region, xrects.count(), xrects.constData());
+    return region;
+}
+
+// rectangles which don't touch each other, so the server doesn't merge them
+static QVector<QRect> separateRects(int count)
+{
+    QVector<QRect> rects;
+    for (int i = 0; i < count; ++i) {
+        rects << QRect((i % 8) * 48, (i / 8) * 48, 16, 16);
+    }
+    return rects;
+}
+
+void TestXcbRegionReplies::testWait_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("maxRects");
+    QTest::addColumn<bool>("precise");
+
+    QTest::newRow("empty") << 0 << 15 << true;
+    QTest::newRow("single") << 1 << 15 << true;
+    QTest::newRow("4") << 4 << 15 << true;
+    QTest::newRow("15") << 15 << 15 << true;
+    QTest::newRow("16") << 16 << 15 << false;
+    QTest::newRow("64") << 64 << 15 << false;
+    QTest::newRow("64/unlimited") << 64 << INT_MAX << true;
+}
+
+void TestXcbRegionReplies::testWait()
+{
+    QFETCH(int, count);
+    QFETCH(int, maxRects);
+    QFETCH(bool, precise);
+
+    const QVector<QRect> rects = separateRects(count);
+    QRegion expected;
+    expected.setRects(rects.constData(), rects.count());
+    if (!precise) {
+        expected = expected.boundingRect();
+    }
+
+    Xcb::RegionReplies replies;
+    QVERIFY(replies.isEmpty());
+    const xcb_xfixes_region_t region = createRegion(rects);
+    replies.fetch(region);
+    xcb_xfixes_destroy_region(connection(), region);
+    QVERIFY(!replies.isEmpty());
+
+    QRegion result;
+    replies.wait(&result, maxRects);
+    QVERIFY(replies.isEmpty());
+    QCOMPARE(result, expected);
+}
+
+void TestXcbRegionReplies::testPoll()
+{
+    // the replies of several requests are collected as they arrive
+    Xcb::RegionReplies replies;
+    const QVector<QRect> rects{QRect(0, 0, 10, 10), QRect(100, 0, 10, 10), QRect(0, 100, 20, 20)};
+    for (const QRect &rect : rects) {
+        const xcb_xfixes_region_t id = createRegion({rect});
+        replies.fetch(id);
+        xcb_xfixes_destroy_region(connection(), id);
+    }
+    xcb_flush(connection());
+
+    QRegion result;
+    QTRY_VERIFY(replies.poll(&result, 15));
+    QVERIFY(replies.isEmpty());
+    QCOMPARE(result, QRegion(rects[0]) + rects[1] + rects[2]);
+
+    // nothing is outstanding anymore
+    QVERIFY(replies.poll(&result, 15));
+    QCOMPARE(result, QRegion(rects[0]) + rects[1] + rects[2]);
+}
+
+void TestXcbRegionReplies::testDiscard()
+{
+    // discarded replies don't show up in later replies
+    Xcb::RegionReplies replies;
+    xcb_xfixes_region_t region = createRegion({QRect(0, 0, 10, 10)});
+    replies.fetch(region);
+    xcb_xfixes_destroy_region(connection(), region);
+    replies.discard();
+    QVERIFY(replies.isEmpty());
+
+    region = createRegion({QRect(50, 50, 10, 10)});
+    replies.fetch(region);
+    xcb_xfixes_destroy_region(connection(), region);
+    QRegion result;
+    replies.wait(&result, 15);
+    QCOMPARE(result, QRegion(50, 50, 10, 10));
+
+    // the connection is still usable after the discarded reply
+    Xcb::sync();
+    QVERIFY(!xcb_connection_has_error(connection()));
+}
+
+Q_CONSTRUCTOR_FUNCTION(forceXcb)
+QTEST_MAIN(TestXcbRegionReplies)
+#include "test_xcb_region_replies.moc"
@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "decorations/decoratedclient.h"
 #include "deleted.h"
 #include "effects.h"
+#include "frametimings.h"
 #include "internal_client.h"
 #include "overlaywindow.h"
 #include "platform.h"
@@ -49,6 +50,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KNotification>
 #include <KSelectionOwner>
 
+#include <QAbstractEventDispatcher>
 #include <QDateTime>
 #include <QFutureWatcher>
 #include <QMenu>
@@ -129,6 +131,7 @@ Compositor::Compositor(QObject* workspace)
     , m_scene(nullptr)
     , m_bufferSwapPending(false)
     , m_composeAtSwapCompletion(false)
+    , m_frameTimings(new FrameTimings)
 {
     connect(options, &Options::configChanged, this, &Compositor::configChanged);
     connect(options, &Options::animationSpeedChanged, this, &Compositor::configChanged);
@@ -148,6 +151,14 @@ Compositor::Compositor(QObject* workspace)
     connect(&m_unusedSupportPropertyTimer, &QTimer::timeout,
             this, &Compositor::deleteUnusedSupportProperties);
 
+    m_occludedFrameCallbackTimer.setSingleShot(true);
+    connect(&m_occludedFrameCallbackTimer, &QTimer::timeout,
+            this, &Compositor::sendOccludedFrameCallbacks);
+
+    // the damage region replies are collected before the event loop goes to sleep
+    connect(QAbstractEventDispatcher::instance(), &QAbstractEventDispatcher::aboutToBlock,
+            this, &Compositor::collectDamageReplies);
+
     // Delay the call to start by one event cycle.
     // The ctor of this class is invoked from the Workspace ctor, that means before
     // Workspace is completely constructed, so calling Workspace::self() would result
@@ -473,6 +484,7 @@ void Compositor::stop()
     m_scene = nullptr;
     compositeTimer.stop();
     repaints_region = QRegion();
+    m_cursorRepaints = QRegion();
 
     m_state = State::Off;
     emit compositingToggled(false);
@@ -590,6 +602,15 @@ void Compositor::addRepaintFull()
     scheduleRepaint();
 }
 
+void Compositor::addCursorRepaint(const QRegion &r)
+{
+    if (m_state != State::On) {
+        return;
+    }
+    m_cursorRepaints += r;
+    scheduleRepaint();
+}
+
 void Compositor::timerEvent(QTimerEvent *te)
 {
     if (te->timerId() == compositeTimer.timerId()) {
@@ -603,12 +624,14 @@ void Compositor::aboutToSwapBuffers()
     Q_ASSERT(!m_bufferSwapPending);
 
     m_bufferSwapPending = true;
+    m_frameTimings->swapStarted();
 }
 
 void Compositor::bufferSwapComplete()
 {
     Q_ASSERT(m_bufferSwapPending);
     m_bufferSwapPending = false;
+    m_frameTimings->swapCompleted();
 
     emit bufferSwapCompleted();
 
@@ -635,12 +658,16 @@ void Compositor::performCompositing()
         return;
     }
 
+    m_frameTimings->beginFrame();
+
     // Create a list of all windows in the stacking order
     QList<Toplevel *> windows = Workspace::self()->xStackingOrder();
     QList<Toplevel *> damaged;
 
     // Reset the damage state of each window and fetch the damage region
-    // without waiting for a reply
+    // without waiting for a reply, most regions have already been requested
+    // when the damage was reported
+    m_frameTimings->enter(FrameTimings::DamageFetch);
     for (Toplevel *win : windows) {
         if (win->resetAndFetchDamage()) {
             damaged << win;
@@ -653,15 +680,19 @@ void Compositor::performCompositing()
             xcb_flush(c);
         }
     }
+    m_frameTimings->leave();
 
     // Move elevated windows to the top of the stacking order
+    m_frameTimings->enter(FrameTimings::Stacking);
     for (EffectWindow *c : static_cast<EffectsHandlerImpl *>(effects)->elevatedWindows()) {
         Toplevel *t = static_cast<EffectWindowImpl *>(c)->window();
         windows.removeAll(t);
         windows.append(t);
     }
+    m_frameTimings->leave();
 
-    // Get the replies
+    // Get the replies which haven't been collected from the event loop yet
+    m_frameTimings->enter(FrameTimings::DamageFetch);
     for (Toplevel *win : damaged) {
         // Discard the cached lanczos texture
         if (win->effectWindow()) {
@@ -674,8 +705,10 @@ void Compositor::performCompositing()
 
         win->getDamageRegionReply();
     }
+    m_frameTimings->leave();
 
-    if (repaints_region.isEmpty() && !windowRepaintsPending()) {
+    if (repaints_region.isEmpty() && m_cursorRepaints.isEmpty() && !windowRepaintsPending()) {
+        m_frameTimings->discardFrame();
         m_scene->idle();
         m_timeSinceLastVBlank = fpsInterval - (options->vBlankTime() + 1); // means "start now"
         // Note: It would seem here we should undo suspended unredirect, but when scenes need
@@ -692,6 +725,7 @@ void Compositor::performCompositing()
     // TODO? This cannot be used so carelessly - needs protections against broken clients, the
     // window should not get focus before it's displayed, handle unredirected windows properly and
     // so on.
+    m_frameTimings->enter(FrameTimings::Stacking);
     for (Toplevel *win : windows) {
         if (!win->readyForPainting()) {
             windows.removeAll(win);
@@ -702,15 +736,24 @@ void Compositor::performCompositing()
             }
         }
     }
+    m_frameTimings->leave();
 
     QRegion repaints = repaints_region;
+    const QRegion cursorRepaints = m_cursorRepaints;
     // clear all repaints, so that post-pass can add repaints for the next repaint
     repaints_region = QRegion();
+    m_cursorRepaints = QRegion();
 
     if (m_framesToTestForSafety > 0 && (m_scene->compositingType() & OpenGLCompositing)) {
         kwinApp()->platform()->createOpenGLSafePoint(Platform::OpenGLSafePoint::PreFrame);
     }
-    m_timeSinceLastVBlank = m_scene->paint(repaints, windows);
+    if (repaints.isEmpty() && !windowRepaintsPending() && m_scene->canPaintCursorOnly()) {
+        // only the software cursor moved or changed its shape, the windows are still the same
+        m_timeSinceLastVBlank = m_scene->paintCursorOnly(cursorRepaints);
+    } else {
+        m_timeSinceLastVBlank = m_scene->paint(repaints | cursorRepaints, windows);
+    }
+    m_frameTimings->endFrame();
     if (m_framesToTestForSafety > 0) {
         if (m_scene->compositingType() & OpenGLCompositing) {
             kwinApp()->platform()->createOpenGLSafePoint(Platform::OpenGLSafePoint::PostFrame);
@@ -724,11 +767,21 @@ void Compositor::performCompositing()
 
     if (waylandServer()) {
         const auto currentTime = static_cast<quint32>(m_monotonicClock.elapsed());
+        bool throttled = false;
         for (Toplevel *win : qAsConst(windows)) {
             if (auto surface = win->surface()) {
+                if (isFrameCallbackThrottled(win)) {
+                    throttled = true;
+                    continue;
+                }
                 surface->frameRendered(currentTime);
             }
         }
+        // Clients which can't be seen still get frame callbacks at a low rate, so that they
+        // don't stall completely if they rely on them, e.g. for playing audio and video.
+        if (throttled && options->occludedFrameRate() > 0 && !m_occludedFrameCallbackTimer.isActive()) {
+            m_occludedFrameCallbackTimer.start(qMax(1u, 1000 / options->occludedFrameRate()));
+        }
     }
 
     // Stop here to ensure *we* cause the next repaint schedule - not some effect
@@ -746,6 +799,59 @@ void Compositor::performCompositing()
     }
 }
 
+bool Compositor::isFrameCallbackThrottled(Toplevel *window) const
+{
+    EffectWindowImpl *effectWindow = window->effectWindow();
+    if (!effectWindow || !effectWindow->sceneWindow()) {
+        return false;
+    }
+    if (!effectWindow->sceneWindow()->isOccluded()) {
+        return false;
+    }
+    return !effectWindow->data(WindowForceFrameCallbacksRole).toBool();
+}
+
+void Compositor::sendOccludedFrameCallbacks()
+{
+    if (!m_scene || !Workspace::self()) {
+        return;
+    }
+    const auto currentTime = static_cast<quint32>(m_monotonicClock.elapsed());
+    for (Toplevel *win : Workspace::self()->xStackingOrder()) {
+        if (auto surface = win->surface()) {
+            if (isFrameCallbackThrottled(win)) {
+                surface->frameRendered(currentTime);
+            }
+        }
+    }
+}
+
+void Compositor::addPendingDamageReply(Toplevel *window)
+{
+    m_pendingDamageReplies.insert(window);
+}
+
+void Compositor::removePendingDamageReply(Toplevel *window)
+{
+    m_pendingDamageReplies.remove(window);
+}
+
+void Compositor::collectDamageReplies()
+{
+    if (m_pendingDamageReplies.isEmpty()) {
+        return;
+    }
+    // the requests must have been sent before their replies can arrive
+    xcb_flush(kwinApp()->x11Connection());
+    for (auto it = m_pendingDamageReplies.begin(); it != m_pendingDamageReplies.end();) {
+        if ((*it)->pollDamageRegionReply()) {
+            it = m_pendingDamageReplies.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 template <class T>
 static bool repaintsPending(const QList<T*> &windows)
 {
@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 class CompositorSelectionOwner;
+class FrameTimings;
 class Scene;
 class X11Client;
 
@@ -54,6 +55,13 @@ public:
     void addRepaint(const QRegion& r);
     void addRepaint(int x, int y, int w, int h);
     void addRepaintFull();
+    /**
+     * Adds a repaint for the software cursor. A frame in which only the cursor changed is
+     * presented without painting the windows, if the scene supports it.
+     *
+     * @see Scene::paintCursorOnly
+     */
+    void addCursorRepaint(const QRegion &r);
 
     /**
      * Schedules a new repaint if no repaint is currently scheduled.
@@ -96,6 +104,13 @@ public:
         return m_scene;
     }
 
+    /**
+     * The per-phase timings of the recently composited frames.
+     */
+    FrameTimings *frameTimings() const {
+        return m_frameTimings.data();
+    }
+
     /**
      * @brief Static check to test whether the Compositor is available and active.
      *
@@ -105,6 +120,14 @@ public:
         return s_compositor != nullptr && s_compositor->isActive();
     }
 
+    /**
+     * Collects the damage region replies of @p window from the event loop as they arrive,
+     * so that they don't have to be waited for while painting the next frame.
+     * @see Toplevel::pollDamageRegionReply
+     */
+    void addPendingDamageReply(Toplevel *window);
+    void removePendingDamageReply(Toplevel *window);
+
     // for delayed supportproperty management of effects
     void keepSupportProperty(xcb_atom_t atom);
     void removeSupportProperty(xcb_atom_t atom);
@@ -151,6 +174,10 @@ private:
     void releaseCompositorSelection();
     void deleteUnusedSupportProperties();
 
+    bool isFrameCallbackThrottled(Toplevel *window) const;
+    void sendOccludedFrameCallbacks();
+    void collectDamageReplies();
+
     State m_state;
 
     QBasicTimer compositeTimer;
@@ -158,8 +185,11 @@ private:
     QTimer m_releaseSelectionTimer;
     QList<xcb_atom_t> m_unusedSupportProperties;
     QTimer m_unusedSupportPropertyTimer;
+    QTimer m_occludedFrameCallbackTimer;
+    QSet<Toplevel *> m_pendingDamageReplies;
     qint64 vBlankInterval, fpsInterval;
     QRegion repaints_region;
+    QRegion m_cursorRepaints;
 
     qint64 m_timeSinceLastVBlank;
 
@@ -170,6 +200,7 @@ private:
 
     int m_framesToTestForSafety = 3;
     QElapsedTimer m_monotonicClock;
+    QScopedPointer<FrameTimings> m_frameTimings;
 };
 
 class KWIN_EXPORT WaylandCompositor : public Compositor
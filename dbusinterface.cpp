@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "atoms.h"
 #include "composite.h"
 #include "debug_console.h"
+#include "frametimings.h"
 #include "main.h"
 #include "placement.h"
 #include "platform.h"
@@ -40,6 +41,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 // Qt
+#include <QDir>
 #include <QOpenGLContext>
 #include <QDBusServiceWatcher>
 
@@ -326,6 +328,54 @@ void CompositorDBusInterface::reinitialize()
     m_compositor->reinitialize();
 }
 
+QVariantList CompositorDBusInterface::frameTimings(int count) const
+{
+    QVariantList result;
+    const auto frames = m_compositor->frameTimings()->frames(count);
+    for (const FrameTimings::Frame &frame : frames) {
+        QVariantMap map;
+        map.insert(QStringLiteral("sequence"), frame.sequence);
+        map.insert(QStringLiteral("timestamp"), frame.timestamp);
+        map.insert(QStringLiteral("duration"), frame.duration);
+        for (int phase = 0; phase < FrameTimings::PhaseCount; ++phase) {
+            map.insert(FrameTimings::phaseName(FrameTimings::Phase(phase)), frame.phases[phase]);
+        }
+        result << map;
+    }
+    return result;
+}
+
+bool CompositorDBusInterface::isFrameTimingsEnabled() const
+{
+    return m_compositor->frameTimings()->isEnabled();
+}
+
+void CompositorDBusInterface::setFrameTimingsEnabled(bool enabled)
+{
+    m_compositor->frameTimings()->setEnabled(enabled);
+}
+
+bool CompositorDBusInterface::startFrameTimingTrace(const QString &fileName)
+{
+    if (QDir::isRelativePath(fileName)) {
+        return false;
+    }
+    return m_compositor->frameTimings()->startTrace(fileName);
+}
+
+void CompositorDBusInterface::stopFrameTimingTrace()
+{
+    m_compositor->frameTimings()->stopTrace();
+}
+
+QVariantMap CompositorDBusInterface::textureMemory() const
+{
+    if (Scene *scene = m_compositor->scene()) {
+        return scene->textureMemory();
+    }
+    return QVariantMap();
+}
+
 QStringList CompositorDBusInterface::supportedOpenGLPlatformInterfaces() const
 {
     QStringList interfaces;
@@ -123,6 +123,13 @@ class CompositorDBusInterface : public QObject
      */
     Q_PROPERTY(QStringList supportedOpenGLPlatformInterfaces READ supportedOpenGLPlatformInterfaces)
     Q_PROPERTY(bool platformRequiresCompositing READ platformRequiresCompositing)
+    /**
+     * @brief Whether the timings of the composited frames are recorded.
+     *
+     * Disabled by default. Tracing with startFrameTimingTrace records them as well.
+     * @see frameTimings
+     */
+    Q_PROPERTY(bool frameTimingsEnabled READ isFrameTimingsEnabled WRITE setFrameTimingsEnabled)
 public:
     explicit CompositorDBusInterface(Compositor *parent);
     ~CompositorDBusInterface() override = default;
@@ -134,6 +141,8 @@ public:
     QString compositingType() const;
     QStringList supportedOpenGLPlatformInterfaces() const;
     bool platformRequiresCompositing() const;
+    bool isFrameTimingsEnabled() const;
+    void setFrameTimingsEnabled(bool enabled);
 
 public Q_SLOTS:
     /**
@@ -171,6 +180,39 @@ public Q_SLOTS:
      * On signal Compositor reloads settings and restarts.
      */
     void reinitialize();
+    /**
+     * @brief The timings of up to @p count of the most recently composited frames, oldest first.
+     *
+     * Each entry is a map with the keys @c sequence, @c timestamp and @c duration and one key per
+     * phase: @c damageFetch, @c stacking, @c prePaint, @c culling, @c painting, @c effects,
+     * @c swap, @c gpu and @c flip. All times are in nanoseconds. The phases hold exclusive times,
+     * e.g. painting does not include the time spent in effects. The gpu time is resolved a few
+     * frames later and stays @c 0 if the driver doesn't support timer queries.
+     */
+    QVariantList frameTimings(int count) const;
+    /**
+     * @brief Starts writing the frame timings to @p fileName in the Chrome trace event format.
+     *
+     * @p fileName has to be an absolute path to a file which does not exist yet.
+     *
+     * @return bool @c true if the file could be created
+     * @see stopFrameTimingTrace
+     */
+    bool startFrameTimingTrace(const QString &fileName);
+    /**
+     * @brief Stops writing the frame timings and closes the trace file.
+     */
+    void stopFrameTimingTrace();
+    /**
+     * @brief The memory occupied by the textures of the Compositor.
+     *
+     * All sizes are in bytes. The window textures are kept within @c budget, @c 0 meaning no
+     * limit, by releasing the textures of windows on other desktops: @c windowTextures,
+     * @c residentWindows, @c evictedWindows, @c evictions and @c rewarms. The textures of
+     * @c decorationTextures, @c shadowTextures and @c lanczosTextures are only counted.
+     * The map is empty if the Compositor is not active or doesn't use OpenGL.
+     */
+    QVariantMap textureMemory() const;
 
 Q_SIGNALS:
     void compositingToggled(bool active);
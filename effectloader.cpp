@@ -27,12 +27,15 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "utils.h"
 // KDE
 #include <KConfigGroup>
+#include <KGlobalAccel>
 #include <KPluginLoader>
 #include <KPackage/Package>
 #include <KPackage/PackageLoader>
 // Qt
 #include <QtConcurrentRun>
+#include <QAction>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QMap>
 #include <QStringList>
@@ -54,6 +57,32 @@ void AbstractEffectLoader::setConfig(KSharedConfig::Ptr config)
     m_config = config;
 }
 
+bool AbstractEffectLoader::isEffectDeferred(const QString &name) const
+{
+    Q_UNUSED(name)
+    return false;
+}
+
+void AbstractEffectLoader::discardDeferredEffect(const QString &name)
+{
+    Q_UNUSED(name)
+}
+
+void AbstractEffectLoader::reconfigureDeferredEffect(const QString &name)
+{
+    Q_UNUSED(name)
+}
+
+QHash<QString, qint64> AbstractEffectLoader::loadTimes() const
+{
+    return m_loadTimes;
+}
+
+void AbstractEffectLoader::addLoadTime(const QString &name, qint64 nsecs)
+{
+    m_loadTimes.insert(name, nsecs);
+}
+
 LoadEffectFlags AbstractEffectLoader::readConfig(const QString &effectName, bool defaultValue) const
 {
     Q_ASSERT(m_config);
@@ -74,6 +103,123 @@ LoadEffectFlags AbstractEffectLoader::readConfig(const QString &effectName, bool
     return LoadEffectFlags();
 }
 
+/**
+ * Stands in for a built-in effect until one of its activation triggers fires. It registers
+ * the global shortcuts and screen edges of the effect, and hands the trigger over to the
+ * effect once that got created.
+ */
+class DeferredEffect : public Effect
+{
+    Q_OBJECT
+public:
+    DeferredEffect(const BuiltInEffects::EffectTriggers &triggers, KSharedConfig::Ptr config,
+                   std::function<Effect*()> create);
+    ~DeferredEffect() override;
+
+    /**
+     * Gives up the shortcuts and screen edges, so that the effect can register them.
+     */
+    void release();
+
+public Q_SLOTS:
+    bool borderActivated(ElectricBorder border) override;
+
+private:
+    void activate(std::function<void(Effect*)> trigger);
+
+    std::function<Effect*()> m_create;
+    QVector<ElectricBorder> m_borders;
+    QVector<QPair<ElectricBorder, QAction*>> m_touchBorders;
+    bool m_activating = false;
+};
+
+DeferredEffect::DeferredEffect(const BuiltInEffects::EffectTriggers &triggers, KSharedConfig::Ptr config,
+                               std::function<Effect*()> create)
+    : m_create(create)
+{
+    const KConfigGroup group = config->group(triggers.configGroup);
+    for (const QString &entry : triggers.borderEntries) {
+        const QList<int> borders = group.readEntry(entry, QList<int>());
+        for (int border : borders) {
+            m_borders << ElectricBorder(border);
+            effects->reserveElectricBorder(ElectricBorder(border), this);
+        }
+    }
+
+    for (const BuiltInEffects::EffectShortcut &shortcut : triggers.shortcuts) {
+        QAction *action = new QAction(this);
+        action->setObjectName(shortcut.action);
+        // picks up the shortcut configured by the user, like the effect does
+        KGlobalAccel::self()->setShortcut(action, QList<QKeySequence>() << shortcut.defaultShortcut);
+        effects->registerGlobalShortcut(shortcut.defaultShortcut, action);
+        if (shortcut.swipe != SwipeDirection::Invalid) {
+            effects->registerTouchpadSwipeShortcut(shortcut.swipe, action);
+        }
+        if (!shortcut.touchBorderEntry.isEmpty()) {
+            const QList<int> borders = group.readEntry(shortcut.touchBorderEntry, QList<int>());
+            for (int border : borders) {
+                m_touchBorders << qMakePair(ElectricBorder(border), action);
+                effects->registerTouchBorder(ElectricBorder(border), action);
+            }
+        }
+        const QString actionName = shortcut.action;
+        connect(action, &QAction::triggered, this,
+            [this, actionName] {
+                activate([actionName](Effect *effect) {
+                    if (QAction *action = effect->findChild<QAction*>(actionName)) {
+                        action->trigger();
+                    }
+                });
+            }
+        );
+    }
+}
+
+DeferredEffect::~DeferredEffect()
+{
+    release();
+}
+
+void DeferredEffect::release()
+{
+    for (ElectricBorder border : qAsConst(m_borders)) {
+        effects->unreserveElectricBorder(border, this);
+    }
+    m_borders.clear();
+    for (const auto &touchBorder : qAsConst(m_touchBorders)) {
+        effects->unregisterTouchBorder(touchBorder.first, touchBorder.second);
+    }
+    m_touchBorders.clear();
+    qDeleteAll(findChildren<QAction*>(QString(), Qt::FindDirectChildrenOnly));
+}
+
+bool DeferredEffect::borderActivated(ElectricBorder border)
+{
+    activate([border](Effect *effect) {
+        effect->borderActivated(border);
+    });
+    return true;
+}
+
+void DeferredEffect::activate(std::function<void(Effect*)> trigger)
+{
+    if (m_activating) {
+        return;
+    }
+    m_activating = true;
+    // the effect registers the same shortcuts, so they have to be released first, which can't
+    // be done while one of the actions is being triggered
+    QMetaObject::invokeMethod(this,
+        [this, trigger] {
+            if (Effect *effect = m_create()) {
+                trigger(effect);
+            } else {
+                // the stand-in stays, so that the user can try again
+                m_activating = false;
+            }
+        }, Qt::QueuedConnection);
+}
+
 BuiltInEffectLoader::BuiltInEffectLoader(QObject *parent)
     : AbstractEffectLoader(parent)
     , m_queue(new EffectLoadQueue<BuiltInEffectLoader, BuiltInEffect>(this))
@@ -109,13 +255,13 @@ void BuiltInEffectLoader::queryAndLoadAll()
     const QList<BuiltInEffect> effects = BuiltInEffects::availableEffects();
     for (BuiltInEffect effect : effects) {
         // check whether it is already loaded
-        if (m_loadedEffects.contains(effect)) {
+        if (m_loadedEffects.contains(effect) || m_deferredEffects.contains(effect)) {
             continue;
         }
         const QString key = BuiltInEffects::nameForEffect(effect);
         const LoadEffectFlags flags = readConfig(key, BuiltInEffects::enabledByDefault(effect));
         if (flags.testFlag(LoadEffectFlag::Load)) {
-            m_queue->enqueue(qMakePair(effect, flags));
+            m_queue->enqueue(qMakePair(effect, flags | LoadEffectFlag::Defer));
         }
     }
 }
@@ -138,6 +284,9 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
     if (m_loadedEffects.contains(effect)) {
         return false;
     }
+    if (m_deferredEffects.contains(effect) && flags.testFlag(LoadEffectFlag::Defer)) {
+        return false;
+    }
 
     // supported might need a context
 #ifndef KWIN_UNIT_TEST
@@ -155,12 +304,32 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
         }
     }
 
+    if (flags.testFlag(LoadEffectFlag::Defer) && deferEffect(name, effect)) {
+        return true;
+    }
+
+    // the effect takes over the shortcuts and screen edges of its stand-in, it registers them
+    // while being created, so they have to be given up right before
+    const bool deferred = m_deferredEffects.contains(effect);
+    if (deferred) {
+        DeferredEffect *standIn = m_deferredEffects.take(effect);
+        standIn->release();
+        standIn->deleteLater();
+    }
+
     // ok, now we can try to create the Effect
+    QElapsedTimer timer;
+    timer.start();
     Effect *e = BuiltInEffects::create(effect);
     if (!e) {
         qCDebug(KWIN_CORE) << "Failed to create effect: " << name;
+        if (deferred) {
+            // a new stand-in keeps the triggers working
+            deferEffect(name, effect);
+        }
         return false;
     }
+    addLoadTime(name, timer.nsecsElapsed());
     // insert in our loaded effects
     m_loadedEffects.insert(effect, e);
     connect(e, &Effect::destroyed, this,
@@ -168,11 +337,54 @@ bool BuiltInEffectLoader::loadEffect(const QString &name, BuiltInEffect effect,
             m_loadedEffects.remove(effect);
         }
     );
-    qCDebug(KWIN_CORE) << "Successfully loaded built-in effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded built-in effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     return true;
 }
 
+bool BuiltInEffectLoader::deferEffect(const QString &name, BuiltInEffect effect)
+{
+    const BuiltInEffects::EffectTriggers &triggers = BuiltInEffects::effectData(effect).triggers;
+    if (triggers.isEmpty()) {
+        return false;
+    }
+    DeferredEffect *deferred = new DeferredEffect(triggers, config(),
+        [this, name, effect]() -> Effect* {
+            if (!loadEffect(name, effect, LoadEffectFlag::Load)) {
+                return nullptr;
+            }
+            return m_loadedEffects.value(effect);
+        }
+    );
+    m_deferredEffects.insert(effect, deferred);
+    qCDebug(KWIN_CORE) << "Deferred loading built-in effect until it gets activated: " << name;
+    return true;
+}
+
+bool BuiltInEffectLoader::isEffectDeferred(const QString &name) const
+{
+    return m_deferredEffects.contains(BuiltInEffects::builtInForName(internalName(name)));
+}
+
+void BuiltInEffectLoader::discardDeferredEffect(const QString &name)
+{
+    if (DeferredEffect *deferred = m_deferredEffects.take(BuiltInEffects::builtInForName(internalName(name)))) {
+        deferred->release();
+        deferred->deleteLater();
+    }
+}
+
+void BuiltInEffectLoader::reconfigureDeferredEffect(const QString &name)
+{
+    const BuiltInEffect effect = BuiltInEffects::builtInForName(internalName(name));
+    if (!m_deferredEffects.contains(effect)) {
+        return;
+    }
+    // a new stand-in registers the screen edges from the new config
+    discardDeferredEffect(name);
+    deferEffect(BuiltInEffects::nameForEffect(effect), effect);
+}
+
 QString BuiltInEffectLoader::internalName(const QString& name) const
 {
     return name.toLower();
@@ -181,6 +393,8 @@ QString BuiltInEffectLoader::internalName(const QString& name) const
 void BuiltInEffectLoader::clear()
 {
     m_queue->clear();
+    qDeleteAll(m_deferredEffects);
+    m_deferredEffects.clear();
 }
 
 static const QString s_nameProperty = QStringLiteral("X-KDE-PluginInfo-Name");
@@ -247,18 +461,21 @@ bool ScriptedEffectLoader::loadEffect(const KPluginMetaData &effect, LoadEffectF
         return false;
     }
 
+    QElapsedTimer timer;
+    timer.start();
     ScriptedEffect *e = ScriptedEffect::create(effect);
     if (!e) {
         qCDebug(KWIN_CORE) << "Could not initialize scripted effect: " << name;
         return false;
     }
+    addLoadTime(name, timer.nsecsElapsed());
     connect(e, &ScriptedEffect::destroyed, this,
         [this, name]() {
             m_loadedEffects.removeAll(name);
         }
     );
 
-    qCDebug(KWIN_CORE) << "Successfully loaded scripted effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded scripted effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     m_loadedEffects << name;
     return true;
@@ -426,11 +643,14 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
     }
 
     // ok, now we can try to create the Effect
+    QElapsedTimer timer;
+    timer.start();
     Effect *e = effectFactory->createEffect();
     if (!e) {
         qCDebug(KWIN_CORE) << "Failed to create effect: " << name;
         return false;
     }
+    addLoadTime(name, timer.nsecsElapsed());
     // insert in our loaded effects
     m_loadedEffects << name;
     connect(e, &Effect::destroyed, this,
@@ -438,7 +658,7 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
             m_loadedEffects.removeAll(name);
         }
     );
-    qCDebug(KWIN_CORE) << "Successfully loaded plugin effect: " << name;
+    qCDebug(KWIN_CORE) << "Successfully loaded plugin effect: " << name << "in" << timer.elapsed() << "ms";
     emit effectLoaded(e, name);
     return true;
 }
@@ -511,6 +731,7 @@ EffectLoader::~EffectLoader()
 
 BOOL_MERGE(hasEffect)
 BOOL_MERGE(isEffectSupported)
+BOOL_MERGE(isEffectDeferred)
 
 #undef BOOL_MERGE
 
@@ -555,4 +776,29 @@ void EffectLoader::clear()
     }
 }
 
+void EffectLoader::discardDeferredEffect(const QString &name)
+{
+    for (auto it = m_loaders.constBegin(); it != m_loaders.constEnd(); ++it) {
+        (*it)->discardDeferredEffect(name);
+    }
+}
+
+void EffectLoader::reconfigureDeferredEffect(const QString &name)
+{
+    for (auto it = m_loaders.constBegin(); it != m_loaders.constEnd(); ++it) {
+        (*it)->reconfigureDeferredEffect(name);
+    }
+}
+
+QHash<QString, qint64> EffectLoader::loadTimes() const
+{
+    QHash<QString, qint64> result;
+    for (auto it = m_loaders.constBegin(); it != m_loaders.constEnd(); ++it) {
+        result.unite((*it)->loadTimes());
+    }
+    return result;
+}
+
 } // namespace KWin
+
+#include "effectloader.moc"
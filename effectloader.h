@@ -26,12 +26,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QObject>
 #include <QFlags>
+#include <QHash>
 #include <QMap>
 #include <QPair>
 #include <QQueue>
 
 namespace KWin
 {
+class DeferredEffect;
 class Effect;
 class EffectPluginFactory;
 enum class BuiltInEffect;
@@ -46,7 +48,8 @@ enum class BuiltInEffect;
  */
 enum class LoadEffectFlag {
     Load = 1 << 0, ///< Effect should be loaded
-    CheckDefaultFunction = 1 << 2 ///< The Check Default Function needs to be invoked if the Effect provides it
+    CheckDefaultFunction = 1 << 2, ///< The Check Default Function needs to be invoked if the Effect provides it
+    Defer = 1 << 3 ///< The Effect may be created on first use, if it declares its activation triggers
 };
 Q_DECLARE_FLAGS(LoadEffectFlags, LoadEffectFlag)
 
@@ -168,6 +171,39 @@ public:
      */
     virtual void clear() = 0;
 
+    /**
+     * @brief Whether the Effect with the given @p name is enabled, but not created before one
+     * of its activation triggers fires.
+     *
+     * The default implementation returns @c false.
+     *
+     * @param name The name of the Effect to check.
+     * @see LoadEffectFlag::Defer
+     */
+    virtual bool isEffectDeferred(const QString &name) const;
+
+    /**
+     * @brief Drops the deferred Effect with the given @p name without creating it.
+     *
+     * @param name The name of the Effect to drop.
+     */
+    virtual void discardDeferredEffect(const QString &name);
+
+    /**
+     * @brief Replaces the deferred Effect with the given @p name by one which registers the
+     * activation triggers from the current config, without creating the Effect.
+     *
+     * @param name The name of the Effect to reconfigure.
+     */
+    virtual void reconfigureDeferredEffect(const QString &name);
+
+    /**
+     * @brief The time in nanoseconds it took to create each of the Effects loaded so far.
+     *
+     * @return QHash<QString, qint64> The creation times by the internal names of the Effects
+     */
+    virtual QHash<QString, qint64> loadTimes() const;
+
 Q_SIGNALS:
     /**
      * @brief The loader emits this signal when it successfully loaded an effect.
@@ -193,9 +229,14 @@ protected:
      * @returns Flags indicating whether the Effect should be loaded and how it should be loaded
      */
     LoadEffectFlags readConfig(const QString &effectName, bool defaultValue) const;
+    KSharedConfig::Ptr config() const {
+        return m_config;
+    }
+    void addLoadTime(const QString &name, qint64 nsecs);
 
 private:
     KSharedConfig::Ptr m_config;
+    QHash<QString, qint64> m_loadTimes;
 };
 
 /**
@@ -274,6 +315,9 @@ private:
 
 /**
  * @brief Can load the Built-In-Effects
+ *
+ * The Effects loaded through queryAndLoadAll() which declare their activation triggers, see
+ * BuiltInEffects::EffectTriggers, are only created once one of the triggers fires.
  */
 class BuiltInEffectLoader : public AbstractEffectLoader
 {
@@ -291,11 +335,17 @@ public:
     bool loadEffect(const QString& name) override;
     bool loadEffect(BuiltInEffect effect, LoadEffectFlags flags);
 
+    bool isEffectDeferred(const QString &name) const override;
+    void discardDeferredEffect(const QString &name) override;
+    void reconfigureDeferredEffect(const QString &name) override;
+
 private:
     bool loadEffect(const QString &name, BuiltInEffect effect, LoadEffectFlags flags);
+    bool deferEffect(const QString &name, BuiltInEffect effect);
     QString internalName(const QString &name) const;
     EffectLoadQueue<BuiltInEffectLoader, BuiltInEffect> *m_queue;
     QMap<BuiltInEffect, Effect*> m_loadedEffects;
+    QMap<BuiltInEffect, DeferredEffect*> m_deferredEffects;
 };
 
 /**
@@ -366,6 +416,10 @@ public:
     void queryAndLoadAll() override;
     void setConfig(KSharedConfig::Ptr config) override;
     void clear() override;
+    bool isEffectDeferred(const QString &name) const override;
+    void discardDeferredEffect(const QString &name) override;
+    void reconfigureDeferredEffect(const QString &name) override;
+    QHash<QString, qint64> loadTimes() const override;
 
 private:
     QList<AbstractEffectLoader*> m_loaders;
@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "effectsadaptor.h"
 #include "effectloader.h"
+#include "frametimings.h"
 #ifdef KWIN_BUILD_ACTIVITIES
 #include "activities.h"
 #endif
@@ -393,6 +394,7 @@ void EffectsHandlerImpl::reconfigure()
 void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData& data, int time)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        FrameTimingScope scope(FrameTimings::PrePaint, *m_currentPaintScreenIterator);
         (*m_currentPaintScreenIterator++)->prePaintScreen(data, time);
         --m_currentPaintScreenIterator;
     }
@@ -402,10 +404,13 @@ void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData& data, int time)
 void EffectsHandlerImpl::paintScreen(int mask, const QRegion &region, ScreenPaintData& data)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        FrameTimingScope scope(FrameTimings::Effects, *m_currentPaintScreenIterator);
         (*m_currentPaintScreenIterator++)->paintScreen(mask, region, data);
         --m_currentPaintScreenIterator;
-    } else
+    } else {
+        FrameTimingScope scope(FrameTimings::Painting);
         m_scene->finalPaintScreen(mask, region, data);
+    }
 }
 
 void EffectsHandlerImpl::paintDesktop(int desktop, int mask, QRegion region, ScreenPaintData &data)
@@ -436,6 +441,7 @@ void EffectsHandlerImpl::postPaintScreen()
 void EffectsHandlerImpl::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time)
 {
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
+        FrameTimingScope scope(FrameTimings::PrePaint, *m_currentPaintWindowIterator);
         (*m_currentPaintWindowIterator++)->prePaintWindow(w, data, time);
         --m_currentPaintWindowIterator;
     }
@@ -445,10 +451,13 @@ void EffectsHandlerImpl::prePaintWindow(EffectWindow* w, WindowPrePaintData& dat
 void EffectsHandlerImpl::paintWindow(EffectWindow* w, int mask, const QRegion &region, WindowPaintData& data)
 {
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
+        FrameTimingScope scope(FrameTimings::Effects, *m_currentPaintWindowIterator);
         (*m_currentPaintWindowIterator++)->paintWindow(w, mask, region, data);
         --m_currentPaintWindowIterator;
-    } else
+    } else {
+        FrameTimingScope scope(FrameTimings::Painting);
         m_scene->finalPaintWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+    }
 }
 
 void EffectsHandlerImpl::paintEffectFrame(EffectFrame* frame, const QRegion &region, double opacity, double frameOpacity)
@@ -482,10 +491,19 @@ Effect *EffectsHandlerImpl::provides(Effect::Feature ef)
 void EffectsHandlerImpl::drawWindow(EffectWindow* w, int mask, const QRegion &region, WindowPaintData& data)
 {
     if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
+        FrameTimingScope scope(FrameTimings::Effects, *m_currentDrawWindowIterator);
         (*m_currentDrawWindowIterator++)->drawWindow(w, mask, region, data);
         --m_currentDrawWindowIterator;
-    } else
+    } else {
+        FrameTimingScope scope(FrameTimings::Painting);
+        // the scene's own pass of the window already decided whether it is occluded, anything
+        // else drawing it, e.g. a thumbnail, needs its contents to be up to date
+        Scene::Window *sceneWindow = static_cast<EffectWindowImpl*>(w)->sceneWindow();
+        if (sceneWindow != m_scene->m_paintedWindow) {
+            sceneWindow->setOccluded(false);
+        }
         m_scene->finalDrawWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+    }
 }
 
 void EffectsHandlerImpl::buildQuads(EffectWindow* w, WindowQuadList& quadList)
@@ -1383,7 +1401,7 @@ QPainter *EffectsHandlerImpl::scenePainter()
 
 void EffectsHandlerImpl::toggleEffect(const QString& name)
 {
-    if (isEffectLoaded(name))
+    if (isEffectLoaded(name) || isEffectDeferred(name))
         unloadEffect(name);
     else
         loadEffect(name);
@@ -1414,6 +1432,12 @@ bool EffectsHandlerImpl::loadEffect(const QString& name)
 
 void EffectsHandlerImpl::unloadEffect(const QString& name)
 {
+    if (isEffectDeferred(name)) {
+        qCDebug(KWIN_CORE) << "EffectsHandler::unloadEffect : Discarding deferred Effect :" << name;
+        m_effectLoader->discardDeferredEffect(name);
+        return;
+    }
+
     auto it = std::find_if(effect_order.begin(), effect_order.end(),
         [name](EffectPair &pair) {
             return pair.first == name;
@@ -1451,6 +1475,10 @@ void EffectsHandlerImpl::destroyEffect(Effect *effect)
         removeSupportProperty(property, effect);
     }
 
+    if (FrameTimings *timings = m_compositor->frameTimings()) {
+        timings->forgetEffect(effect);
+    }
+
     delete effect;
 }
 
@@ -1463,6 +1491,10 @@ void EffectsHandlerImpl::reconfigureEffect(const QString& name)
             (*it).second->reconfigure(Effect::ReconfigureAll);
             return;
         }
+    if (isEffectDeferred(name)) {
+        kwinApp()->config()->reparseConfiguration();
+        m_effectLoader->reconfigureDeferredEffect(name);
+    }
 }
 
 bool EffectsHandlerImpl::isEffectLoaded(const QString& name) const
@@ -1472,10 +1504,15 @@ bool EffectsHandlerImpl::isEffectLoaded(const QString& name) const
     return it != loaded_effects.constEnd();
 }
 
+bool EffectsHandlerImpl::isEffectDeferred(const QString &name) const
+{
+    return m_effectLoader->isEffectDeferred(name);
+}
+
 bool EffectsHandlerImpl::isEffectSupported(const QString &name)
 {
     // If the effect is loaded, it is obviously supported.
-    if (isEffectLoaded(name)) {
+    if (isEffectLoaded(name) || isEffectDeferred(name)) {
         return true;
     }
 
@@ -1538,6 +1575,41 @@ QStringList EffectsHandlerImpl::activeEffects() const
     return ret;
 }
 
+bool EffectsHandlerImpl::isEffectGpuTimingEnabled() const
+{
+    return m_compositor->frameTimings()->isEffectGpuTimingEnabled();
+}
+
+void EffectsHandlerImpl::setEffectGpuTimingEnabled(bool enabled)
+{
+    m_compositor->frameTimings()->setEffectGpuTimingEnabled(enabled);
+}
+
+QVariantMap EffectsHandlerImpl::effectPaintCosts() const
+{
+    const auto &costs = m_compositor->frameTimings()->effectCosts();
+    QVariantMap ret;
+    for (const EffectPair &pair : loaded_effects) {
+        const FrameTimings::EffectCost cost = costs.value(pair.second);
+        ret.insert(pair.first, QVariantMap{
+            {QStringLiteral("cpuTime"), cost.cpuTime},
+            {QStringLiteral("gpuTime"), cost.gpuTime},
+            {QStringLiteral("frames"), cost.frames}
+        });
+    }
+    return ret;
+}
+
+QVariantMap EffectsHandlerImpl::effectLoadTimes() const
+{
+    const QHash<QString, qint64> times = m_effectLoader->loadTimes();
+    QVariantMap ret;
+    for (auto it = times.constBegin(); it != times.constEnd(); ++it) {
+        ret.insert(it.key(), it.value());
+    }
+    return ret;
+}
+
 KWayland::Server::Display *EffectsHandlerImpl::waylandDisplay() const
 {
     if (waylandServer()) {
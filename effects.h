@@ -71,6 +71,11 @@ class KWIN_EXPORT EffectsHandlerImpl : public EffectsHandler
     Q_PROPERTY(QStringList activeEffects READ activeEffects)
     Q_PROPERTY(QStringList loadedEffects READ loadedEffects)
     Q_PROPERTY(QStringList listOfEffects READ listOfEffects)
+    /**
+     * Whether the GPU time of the effects' paint hooks is measured for effectPaintCosts.
+     * Disabled by default, not supported with OpenGL ES.
+     */
+    Q_PROPERTY(bool effectGpuTiming READ isEffectGpuTimingEnabled WRITE setEffectGpuTimingEnabled)
 public:
     EffectsHandlerImpl(Compositor *compositor, Scene *scene);
     ~EffectsHandlerImpl() override;
@@ -87,7 +92,6 @@ public:
     void paintEffectFrame(EffectFrame* frame, const QRegion &region, double opacity, double frameOpacity) override;
 
     Effect *provides(Effect::Feature ef);
-
     void drawWindow(EffectWindow* w, int mask, const QRegion &region, WindowPaintData& data) override;
 
     void buildQuads(EffectWindow* w, WindowQuadList& quadList) override;
@@ -218,6 +222,9 @@ public:
     QList<EffectWindow*> elevatedWindows() const;
     QStringList activeEffects() const;
 
+    bool isEffectGpuTimingEnabled() const;
+    void setEffectGpuTimingEnabled(bool enabled);
+
     /**
      * @returns Whether we are currently in a desktop rendering process triggered by paintDesktop hook
      */
@@ -289,10 +296,26 @@ public Q_SLOTS:
     Q_SCRIPTABLE void toggleEffect(const QString& name);
     Q_SCRIPTABLE void unloadEffect(const QString& name);
     Q_SCRIPTABLE bool isEffectLoaded(const QString& name) const;
+    /**
+     * Whether the effect is enabled, but waits for one of its activation triggers
+     * before it gets created.
+     */
+    Q_SCRIPTABLE bool isEffectDeferred(const QString& name) const;
     Q_SCRIPTABLE bool isEffectSupported(const QString& name);
     Q_SCRIPTABLE QList<bool> areEffectsSupported(const QStringList &names);
     Q_SCRIPTABLE QString supportInformation(const QString& name) const;
     Q_SCRIPTABLE QString debug(const QString& name, const QString& parameter = QString()) const;
+    /**
+     * The accumulated paint costs of the loaded effects, keyed by the effect name. Each entry
+     * holds the CPU and GPU time in nanoseconds and the number of frames the effect painted in.
+     */
+    Q_SCRIPTABLE QVariantMap effectPaintCosts() const;
+    /**
+     * The time in nanoseconds it took to create each of the effects loaded so far, keyed by the
+     * effect name. Effects which wait for their activation triggers are missing until they got
+     * created.
+     */
+    Q_SCRIPTABLE QVariantMap effectLoadTimes() const;
 
 protected Q_SLOTS:
     void slotClientShown(KWin::Toplevel*);
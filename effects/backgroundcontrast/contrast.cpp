@@ -493,6 +493,7 @@ void ContrastEffect::doContrast(EffectWindow *w, const QRegion& shape, const QRe
     scratch.bind();
 
     const QRect sg = GLRenderTarget::virtualScreenGeometry();
+    ShaderManager::instance()->flushDeferredDraws();
     glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (r.x() - sg.x()) * scale, (sg.height() - (r.y() - sg.y() + r.height())) * scale,
                         scratch.width(), scratch.height());
 
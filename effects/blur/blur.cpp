@@ -83,6 +83,7 @@ BlurEffect::BlurEffect()
 
 BlurEffect::~BlurEffect()
 {
+    discardBlurCaches();
     deleteFBOs();
 }
 
@@ -115,6 +116,7 @@ void BlurEffect::deleteFBOs()
 
 void BlurEffect::updateTexture()
 {
+    discardBlurCaches();
     deleteFBOs();
 
     /* Reserve memory for:
@@ -335,6 +337,8 @@ void BlurEffect::slotWindowAdded(EffectWindow *w)
 
 void BlurEffect::slotWindowDeleted(EffectWindow *w)
 {
+    discardBlurCache(w);
+
     auto it = windowBlurChangedConnections.find(w);
     if (it == windowBlurChangedConnections.end()) {
         return;
@@ -437,9 +441,94 @@ QRegion BlurEffect::blurRegion(const EffectWindow *w) const
     return region;
 }
 
-void BlurEffect::uploadRegion(QVector2D *&map, const QRegion &region, const int downSampleIterations)
+bool BlurEffect::isBlurCacheInUse(const BlurCache *cache) const
+{
+    // with per screen rendering each screen is a paint pass of its own
+    return m_paintPass - cache->lastUsedPass < quint64(effects->numScreens());
+}
+
+BlurEffect::BlurCache *BlurEffect::blurCache(EffectWindow *w, const QRect &screen)
+{
+    // popups and the like are gone before a cache would pay off
+    if (w->isPopupWindow()) {
+        return nullptr;
+    }
+
+    BlurCache *cache = nullptr;
+    for (auto it = m_blurCaches.constFind(w); it != m_blurCaches.constEnd() && it.key() == w; ++it) {
+        if ((*it)->screen == screen) {
+            cache = *it;
+            break;
+        }
+    }
+    if (cache) {
+        cache->lastUsedPass = m_paintPass;
+        m_blurCacheOrder.removeOne(cache);
+        m_blurCacheOrder.append(cache);
+        return cache;
+    }
+
+    if (!m_unusedBlurCaches.isEmpty()) {
+        cache = m_unusedBlurCaches.takeLast();
+    } else if (m_blurCaches.count() >= s_maxBlurCaches && !isBlurCacheInUse(m_blurCacheOrder.first())) {
+        // take over the cache of the window that was blurred the longest time ago
+        cache = m_blurCacheOrder.takeFirst();
+        m_blurCaches.remove(cache->window, cache);
+    } else {
+        cache = new BlurCache;
+        cache->texture = GLTexture(m_renderTextures[1].internalFormat(), m_renderTextures[1].size());
+        cache->texture.setFilter(GL_LINEAR);
+        cache->texture.setWrapMode(GL_CLAMP_TO_EDGE);
+        cache->renderTarget.reset(new GLRenderTarget(cache->texture));
+    }
+    cache->window = w;
+    cache->lastUsedPass = m_paintPass;
+    cache->screen = screen;
+    cache->validRegion = QRegion();
+    cache->storedRegion = QRegion();
+
+    m_blurCaches.insert(w, cache);
+    m_blurCacheOrder.append(cache);
+    return cache;
+}
+
+void BlurEffect::discardBlurCache(EffectWindow *w)
+{
+    // keep the textures around for the next window that gets blurred
+    const QList<BlurCache *> caches = m_blurCaches.values(w);
+    for (BlurCache *cache : caches) {
+        m_blurCacheOrder.removeOne(cache);
+        cache->window = nullptr;
+        m_unusedBlurCaches.append(cache);
+    }
+    m_blurCaches.remove(w);
+}
+
+void BlurEffect::discardBlurCaches()
+{
+    if (m_blurCaches.isEmpty() && m_unusedBlurCaches.isEmpty()) {
+        return;
+    }
+    effects->makeOpenGLContextCurrent();
+    qDeleteAll(m_blurCaches);
+    qDeleteAll(m_unusedBlurCaches);
+    m_blurCaches.clear();
+    m_blurCacheOrder.clear();
+    m_unusedBlurCaches.clear();
+}
+
+static int regionArea(const QRegion &region)
+{
+    int area = 0;
+    for (const QRect &rect : region) {
+        area += rect.width() * rect.height();
+    }
+    return area;
+}
+
+void BlurEffect::uploadRegion(QVector2D *&map, const QRegion &region, const int firstIteration, const int lastIteration)
 {
-    for (int i = 0; i <= downSampleIterations; i++) {
+    for (int i = firstIteration; i <= lastIteration; i++) {
         const int divisionRatio = (1 << i);
 
         for (const QRect &r : region) {
@@ -461,17 +550,22 @@ void BlurEffect::uploadRegion(QVector2D *&map, const QRegion &region, const int
     }
 }
 
-void BlurEffect::uploadGeometry(GLVertexBuffer *vbo, const QRegion &blurRegion, const QRegion &windowRegion)
+void BlurEffect::uploadGeometry(GLVertexBuffer *vbo, const QRegion &blurRegion, const QRegion &windowRegion,
+                                const QRegion &restoreRegion, const QRegion &storeRegion)
 {
-    const int vertexCount = ((blurRegion.rectCount() * (m_downSampleIterations + 1)) + windowRegion.rectCount()) * 6;
+    const int vertexCount = ((blurRegion.rectCount() * (m_downSampleIterations + 1)) + windowRegion.rectCount() +
+                             restoreRegion.rectCount() + storeRegion.rectCount()) * 6;
 
     if (!vertexCount)
         return;
 
     QVector2D *map = (QVector2D *) vbo->map(vertexCount * sizeof(QVector2D));
 
-    uploadRegion(map, blurRegion, m_downSampleIterations);
-    uploadRegion(map, windowRegion, 0);
+    uploadRegion(map, blurRegion, 0, m_downSampleIterations);
+    uploadRegion(map, windowRegion, 0, 0);
+    // the cache has the layout of the first downsampled texture
+    uploadRegion(map, restoreRegion, 1, 1);
+    uploadRegion(map, storeRegion, 1, 1);
 
     vbo->unmap();
 
@@ -488,8 +582,16 @@ void BlurEffect::prePaintScreen(ScreenPrePaintData &data, int time)
     m_damagedArea = QRegion();
     m_paintedArea = QRegion();
     m_currentBlur = QRegion();
+    m_paintPass++;
 
     effects->prePaintScreen(data, time);
+
+    // Everything behind a blurred window changes when the screen is transformed
+    if (data.mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS)) {
+        m_screenDamage = effects->virtualScreenGeometry();
+    } else {
+        m_screenDamage = data.paint;
+    }
 }
 
 void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time)
@@ -499,6 +601,8 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
     effects->prePaintWindow(w, data, time);
 
     if (!w->isPaintingEnabled()) {
+        // nothing keeps track of what happens behind the window while it's not painted
+        discardBlurCache(w);
         return;
     }
     if (!m_shader || !m_shader->isValid()) {
@@ -528,6 +632,15 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
     const QRegion blurArea = blurRegion(w).translated(w->pos()) & screen;
     const QRegion expandedBlur = (w->isDock() ? blurArea : expand(blurArea)) & screen;
 
+    // Anything repainted below the window changes the blurred background. The window's own
+    // repaints are only part of m_paintedArea once the windows above are processed.
+    const QRegion damageBehind = (m_paintedArea | m_screenDamage) & expandedBlur;
+    if (!damageBehind.isEmpty()) {
+        for (auto it = m_blurCaches.find(w); it != m_blurCaches.end() && it.key() == w; ++it) {
+            (*it)->validRegion -= expand(damageBehind);
+        }
+    }
+
     // if this window or a window underneath the blurred area is painted again we have to
     // blur everything
     if (m_paintedArea.intersects(expandedBlur) || data.paint.intersects(blurArea)) {
@@ -553,6 +666,19 @@ void BlurEffect::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int t
     m_paintedArea |= data.paint;
 }
 
+void BlurEffect::postPaintScreen()
+{
+    // release the spare textures a busy frame needed on top of the limit
+    if (!m_unusedBlurCaches.isEmpty() && m_blurCaches.count() + m_unusedBlurCaches.count() > s_maxBlurCaches) {
+        effects->makeOpenGLContextCurrent();
+        while (!m_unusedBlurCaches.isEmpty() && m_blurCaches.count() + m_unusedBlurCaches.count() > s_maxBlurCaches) {
+            delete m_unusedBlurCaches.takeLast();
+        }
+    }
+
+    effects->postPaintScreen();
+}
+
 bool BlurEffect::shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const
 {
     if (!m_renderTargetsValid || !m_shader || !m_shader->isValid())
@@ -607,7 +733,7 @@ void BlurEffect::drawWindow(EffectWindow *w, int mask, const QRegion &region, Wi
         }
 
         if (!shape.isEmpty()) {
-            doBlur(shape, screen, data.opacity(), data.screenProjectionMatrix(), w->isDock(), w->geometry());
+            doBlur(shape, screen, data.opacity(), data.screenProjectionMatrix(), w->isDock(), w->geometry(), blurCache(w, screen));
         }
     }
 
@@ -655,14 +781,41 @@ void BlurEffect::generateNoiseTexture()
     m_noiseTexture.setWrapMode(GL_REPEAT);
 }
 
-void BlurEffect::doBlur(const QRegion& shape, const QRect& screen, const float opacity, const QMatrix4x4 &screenProjection, bool isDock, QRect windowRect)
+void BlurEffect::doBlur(const QRegion& shape, const QRect& screen, const float opacity, const QMatrix4x4 &screenProjection, bool isDock, QRect windowRect, BlurCache *cache)
 {
     // Blur would not render correctly on a secondary monitor because of wrong coordinates
     // BUG: 393723
     const int xTranslate = -screen.x();
     const int yTranslate = effects->virtualScreenSize().height() - screen.height() - screen.y();
 
-    const QRegion expandedBlurRegion = expand(shape) & expand(screen);
+    // The part of the shape which has to go through the down and upsample chain. With a
+    // cache only the part whose background changed has to, the rest gets copied over.
+    QRegion blurShape = shape;
+    QRegion restoreRegion;
+    QRegion storeRegion;
+    if (cache) {
+        const QRegion missing = shape - cache->validRegion;
+        storeRegion = expand(shape) & expand(screen);
+        if (missing.isEmpty()) {
+            blurShape = QRegion();
+            restoreRegion = storeRegion & cache->storedRegion;
+            storeRegion = QRegion();
+            m_skippedBlurPasses++;
+        } else if (!isDock && regionArea(missing) * 2 < regionArea(shape)) {
+            // the dock blur is clamped to the shape, so it can't be computed partially
+            blurShape = missing;
+            restoreRegion = (storeRegion - missing) & cache->storedRegion;
+            cache->validRegion |= missing;
+            m_partialBlurPasses++;
+        } else {
+            // the border around the shape only serves as input for the blur
+            cache->validRegion = (cache->validRegion - storeRegion) | shape;
+            m_fullBlurPasses++;
+        }
+        cache->storedRegion |= storeRegion;
+    }
+
+    const QRegion expandedBlurRegion = expand(blurShape) & expand(screen);
 
     const bool useSRGB = m_renderTextures.first().internalFormat() == GL_SRGB8_ALPHA8;
 
@@ -670,43 +823,61 @@ void BlurEffect::doBlur(const QRegion& shape, const QRect& screen, const float o
     GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
     vbo->reset();
 
-    uploadGeometry(vbo, expandedBlurRegion.translated(xTranslate, yTranslate), shape);
+    uploadGeometry(vbo, expandedBlurRegion.translated(xTranslate, yTranslate), shape,
+                   restoreRegion.translated(xTranslate, yTranslate), storeRegion.translated(xTranslate, yTranslate));
     vbo->bindArrays();
 
-    const QRect sourceRect = expandedBlurRegion.boundingRect() & screen;
-    const QRect destRect = sourceRect.translated(xTranslate, yTranslate);
-
-    GLRenderTarget::pushRenderTargets(m_renderTargetStack);
     int blurRectCount = expandedBlurRegion.rectCount() * 6;
+    const int windowStart = blurRectCount * (m_downSampleIterations + 1);
+    const int restoreStart = windowStart + shape.rectCount() * 6;
+    const int storeStart = restoreStart + restoreRegion.rectCount() * 6;
+
+    if (!blurShape.isEmpty()) {
+        const QRect sourceRect = expandedBlurRegion.boundingRect() & screen;
+        const QRect destRect = sourceRect.translated(xTranslate, yTranslate);
+
+        GLRenderTarget::pushRenderTargets(m_renderTargetStack);
+
+        /*
+         * If the window is a dock or panel we avoid the "extended blur" effect.
+         * Extended blur is when windows that are not under the blurred area affect
+         * the final blur result.
+         * We want to avoid this on panels, because it looks really weird and ugly
+         * when maximized windows or windows near the panel affect the dock blur.
+         */
+        if (isDock) {
+            m_renderTargets.last()->blitFromFramebuffer(sourceRect, destRect);
+
+            if (useSRGB) {
+                glEnable(GL_FRAMEBUFFER_SRGB);
+            }
 
-    /*
-     * If the window is a dock or panel we avoid the "extended blur" effect.
-     * Extended blur is when windows that are not under the blurred area affect
-     * the final blur result.
-     * We want to avoid this on panels, because it looks really weird and ugly
-     * when maximized windows or windows near the panel affect the dock blur.
-     */
-    if (isDock) {
-        m_renderTargets.last()->blitFromFramebuffer(sourceRect, destRect);
-
-        if (useSRGB) {
-            glEnable(GL_FRAMEBUFFER_SRGB);
-        }
+            copyScreenSampleTexture(vbo, blurRectCount, shape.translated(xTranslate, yTranslate), screenProjection);
+        } else {
+            m_renderTargets.first()->blitFromFramebuffer(sourceRect, destRect);
 
-        copyScreenSampleTexture(vbo, blurRectCount, shape.translated(xTranslate, yTranslate), screenProjection);
-    } else {
-        m_renderTargets.first()->blitFromFramebuffer(sourceRect, destRect);
+            if (useSRGB) {
+                glEnable(GL_FRAMEBUFFER_SRGB);
+            }
 
-        if (useSRGB) {
-            glEnable(GL_FRAMEBUFFER_SRGB);
+            // Remove the m_renderTargets[0] from the top of the stack that we will not use
+            GLRenderTarget::popRenderTarget();
         }
 
-        // Remove the m_renderTargets[0] from the top of the stack that we will not use
-        GLRenderTarget::popRenderTarget();
+        downSampleTexture(vbo, blurRectCount);
+        upSampleTexture(vbo, blurRectCount);
+    } else if (useSRGB) {
+        glEnable(GL_FRAMEBUFFER_SRGB);
     }
 
-    downSampleTexture(vbo, blurRectCount);
-    upSampleTexture(vbo, blurRectCount);
+    if (cache) {
+        if (!restoreRegion.isEmpty()) {
+            copySampleTexture(vbo, restoreStart, restoreRegion.rectCount() * 6, cache->texture, m_renderTargets[1]);
+        }
+        if (!storeRegion.isEmpty()) {
+            copySampleTexture(vbo, storeStart, storeRegion.rectCount() * 6, m_renderTextures[1], cache->renderTarget.data());
+        }
+    }
 
     // Modulate the blurred texture with the window opacity if the window isn't opaque
     if (opacity < 1.0) {
@@ -722,7 +893,7 @@ void BlurEffect::doBlur(const QRegion& shape, const QRect& screen, const float o
         glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
     }
 
-    upscaleRenderToScreen(vbo, blurRectCount * (m_downSampleIterations + 1), shape.rectCount() * 6, screenProjection, windowRect.topLeft());
+    upscaleRenderToScreen(vbo, windowStart, shape.rectCount() * 6, screenProjection, windowRect.topLeft());
 
     if (useSRGB) {
         glDisable(GL_FRAMEBUFFER_SRGB);
@@ -811,6 +982,28 @@ void BlurEffect::upSampleTexture(GLVertexBuffer *vbo, int blurRectCount)
     m_shader->unbind();
 }
 
+void BlurEffect::copySampleTexture(GLVertexBuffer *vbo, int vboStart, int rectCount, GLTexture &source, GLRenderTarget *target)
+{
+    // source and target have the same size, so this is a plain copy of the given rects
+    const QSize size = m_renderTextures[1].size();
+
+    QMatrix4x4 modelViewProjectionMatrix;
+    modelViewProjectionMatrix.ortho(0, size.width(), size.height(), 0, 0, 65535);
+
+    GLRenderTarget::pushRenderTarget(target);
+    m_shader->bind(BlurShader::CopySampleType);
+
+    m_shader->setModelViewProjectionMatrix(modelViewProjectionMatrix);
+    m_shader->setTargetTextureSize(size);
+    m_shader->setBlurRect(QRect(0, 0, size.width() + 1, size.height() + 1), size);
+    source.bind();
+
+    vbo->draw(GL_TRIANGLES, vboStart, rectCount);
+    GLRenderTarget::popRenderTarget();
+
+    m_shader->unbind();
+}
+
 void BlurEffect::copyScreenSampleTexture(GLVertexBuffer *vbo, int blurRectCount, QRegion blurShape, QMatrix4x4 screenProjection)
 {
     m_shader->bind(BlurShader::CopySampleType);
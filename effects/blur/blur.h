@@ -25,6 +25,9 @@
 #include <kwinglplatform.h>
 #include <kwinglutils.h>
 
+#include <QHash>
+#include <QList>
+#include <QScopedPointer>
 #include <QVector>
 #include <QVector2D>
 #include <QStack>
@@ -47,6 +50,11 @@ class BlurShader;
 class BlurEffect : public KWin::Effect
 {
     Q_OBJECT
+    Q_PROPERTY(int fullBlurPasses READ fullBlurPasses)
+    Q_PROPERTY(int partialBlurPasses READ partialBlurPasses)
+    Q_PROPERTY(int skippedBlurPasses READ skippedBlurPasses)
+    Q_PROPERTY(int cachedBlurWindows READ cachedBlurWindows)
+    Q_PROPERTY(int blurCacheTextures READ blurCacheTextures)
 
 public:
     BlurEffect();
@@ -57,6 +65,7 @@ public:
 
     void reconfigure(ReconfigureFlags flags) override;
     void prePaintScreen(ScreenPrePaintData &data, int time) override;
+    void postPaintScreen() override;
     void prePaintWindow(EffectWindow* w, WindowPrePaintData& data, int time) override;
     void drawWindow(EffectWindow *w, int mask, const QRegion &region, WindowPaintData &data) override;
     void paintEffectFrame(EffectFrame *frame, const QRegion &region, double opacity, double frameOpacity) override;
@@ -69,6 +78,37 @@ public:
 
     bool eventFilter(QObject *watched, QEvent *event) override;
 
+    /**
+     * Number of times the down- and upsample chain ran for the whole blurred area.
+     */
+    int fullBlurPasses() const {
+        return m_fullBlurPasses;
+    }
+    /**
+     * Number of times only the part of a cached blur affected by damage got blurred again.
+     */
+    int partialBlurPasses() const {
+        return m_partialBlurPasses;
+    }
+    /**
+     * Number of times the cached blur of a window got reused without any blur pass.
+     */
+    int skippedBlurPasses() const {
+        return m_skippedBlurPasses;
+    }
+    /**
+     * Number of windows which currently hold a cached blur.
+     */
+    int cachedBlurWindows() const {
+        return m_blurCaches.uniqueKeys().count();
+    }
+    /**
+     * Number of cache textures allocated, whether held by a window or not.
+     */
+    int blurCacheTextures() const {
+        return m_blurCaches.count() + m_unusedBlurCaches.count();
+    }
+
 public Q_SLOTS:
     void slotWindowAdded(KWin::EffectWindow *w);
     void slotWindowDeleted(KWin::EffectWindow *w);
@@ -76,6 +116,28 @@ public Q_SLOTS:
     void slotScreenGeometryChanged();
 
 private:
+    /**
+     * The upsampled blur texture of a window from the last time it got painted.
+     *
+     * The cache has the size and layout of m_renderTextures[1]. @c validRegion is the
+     * part (in screen coordinates) whose background did not change since it got blurred,
+     * @c storedRegion the part which holds any blurred content at all.
+     *
+     * A window has one cache per screen it is blurred on. Caches of windows which are gone
+     * are kept for reuse. Once s_maxBlurCaches exist, the least recently blurred window gives
+     * up its cache, unless it was blurred in the current frame; then another one is allocated.
+     * Spare caches above the limit are released at the end of the frame.
+     */
+    struct BlurCache {
+        EffectWindow *window = nullptr;
+        quint64 lastUsedPass = 0;
+        GLTexture texture;
+        QScopedPointer<GLRenderTarget> renderTarget;
+        QRect screen;
+        QRegion validRegion;
+        QRegion storedRegion;
+    };
+
     QRect expand(const QRect &rect) const;
     QRegion expand(const QRegion &region) const;
     bool renderTargetsValid() const;
@@ -85,9 +147,15 @@ private:
     QRegion blurRegion(const EffectWindow *w) const;
     bool shouldBlur(const EffectWindow *w, int mask, const WindowPaintData &data) const;
     void updateBlurRegion(EffectWindow *w) const;
-    void doBlur(const QRegion &shape, const QRect &screen, const float opacity, const QMatrix4x4 &screenProjection, bool isDock, QRect windowRect);
-    void uploadRegion(QVector2D *&map, const QRegion &region, const int downSampleIterations);
-    void uploadGeometry(GLVertexBuffer *vbo, const QRegion &blurRegion, const QRegion &windowRegion);
+    void doBlur(const QRegion &shape, const QRect &screen, const float opacity, const QMatrix4x4 &screenProjection, bool isDock, QRect windowRect, BlurCache *cache = nullptr);
+    void uploadRegion(QVector2D *&map, const QRegion &region, const int firstIteration, const int lastIteration);
+    void uploadGeometry(GLVertexBuffer *vbo, const QRegion &blurRegion, const QRegion &windowRegion,
+                        const QRegion &restoreRegion = QRegion(), const QRegion &storeRegion = QRegion());
+    BlurCache *blurCache(EffectWindow *w, const QRect &screen);
+    bool isBlurCacheInUse(const BlurCache *cache) const;
+    void discardBlurCache(EffectWindow *w);
+    void discardBlurCaches();
+    void copySampleTexture(GLVertexBuffer *vbo, int vboStart, int rectCount, GLTexture &source, GLRenderTarget *target);
     void generateNoiseTexture();
 
     void upscaleRenderToScreen(GLVertexBuffer *vbo, int vboStart, int blurRectCount, QMatrix4x4 screenProjection, QPoint windowPosition);
@@ -108,6 +176,16 @@ private:
     QRegion m_damagedArea; // keeps track of the area which has been damaged (from bottom to top)
     QRegion m_paintedArea; // actually painted area which is greater than m_damagedArea
     QRegion m_currentBlur; // keeps track of the currently blured area of the windows(from bottom to top)
+    QRegion m_screenDamage; // the area of the screen repainted independently of any window
+
+    QMultiHash<EffectWindow*, BlurCache*> m_blurCaches;
+    QList<BlurCache*> m_blurCacheOrder; // least recently blurred first
+    QVector<BlurCache*> m_unusedBlurCaches;
+    quint64 m_paintPass = 0;
+    static const int s_maxBlurCaches = 4;
+    int m_fullBlurPasses = 0;
+    int m_partialBlurPasses = 0;
+    int m_skippedBlurPasses = 0;
 
     int m_downSampleIterations; // number of times the texture will be downsized to half size
     int m_offset;
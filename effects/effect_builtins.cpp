@@ -202,6 +202,13 @@ EFFECT_FALLBACK
         nullptr
 #endif
 EFFECT_FALLBACK
+        , {
+            QStringLiteral("Effect-DesktopGrid"),
+            {QStringLiteral("BorderActivate")},
+            {
+                {QStringLiteral("ShowDesktopGrid"), Qt::CTRL + Qt::Key_F8, SwipeDirection::Up, QStringLiteral("TouchBorderActivate")}
+            }
+        }
     }, {
         QStringLiteral("diminactive"),
         i18ndc("kwin_effects", "Name of a KWin Effect", "Dim Inactive"),
@@ -292,6 +299,14 @@ EFFECT_FALLBACK
         nullptr
 #endif
 EFFECT_FALLBACK
+        , {
+            QString(),
+            {},
+            {
+                {QStringLiteral("Invert"), Qt::CTRL + Qt::META + Qt::Key_I, SwipeDirection::Invalid, QString()},
+                {QStringLiteral("InvertWindow"), Qt::CTRL + Qt::META + Qt::Key_U, SwipeDirection::Invalid, QString()}
+            }
+        }
     }, {
         QStringLiteral("kscreen"),
         i18ndc("kwin_effects", "Name of a KWin Effect", "Kscreen"),
@@ -20,8 +20,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef KWIN_EFFECT_BUILTINS_H
 #define KWIN_EFFECT_BUILTINS_H
 #include <kwineffects_export.h>
+#include <kwinglobals.h>
+#include <QKeySequence>
 #include <QStringList>
 #include <QUrl>
+#include <QVector>
 #include <functional>
 
 namespace KWin
@@ -76,6 +79,46 @@ enum class BuiltInEffect
 namespace BuiltInEffects
 {
 
+/**
+ * A global shortcut of an effect, see EffectTriggers.
+ */
+struct EffectShortcut {
+    /**
+     * The object name of the QAction the effect registers for the shortcut.
+     */
+    QString action;
+    QKeySequence defaultShortcut;
+    /**
+     * The touchpad swipe gesture triggering the action, if any.
+     */
+    SwipeDirection swipe;
+    /**
+     * The config entry listing the touch screen edges triggering the action, if any.
+     */
+    QString touchBorderEntry;
+};
+
+/**
+ * The ways an effect which stays idle until the user activates it can be activated. If an
+ * effect declares them, it is created only when one of them fires, until then a lightweight
+ * stand-in listens to them.
+ */
+struct EffectTriggers {
+    /**
+     * The config group holding the screen edge settings of the effect.
+     */
+    QString configGroup;
+    /**
+     * The config entries listing the screen edges the effect reserves.
+     */
+    QStringList borderEntries;
+    QVector<EffectShortcut> shortcuts;
+
+    bool isEmpty() const {
+        return borderEntries.isEmpty() && shortcuts.isEmpty();
+    }
+};
+
 struct EffectData {
     QString name;
     QString displayName;
@@ -88,6 +131,7 @@ struct EffectData {
     std::function<Effect*()> createFunction;
     std::function<bool()> supportedFunction;
     std::function<bool()> enabledFunction;
+    EffectTriggers triggers;
 };
 
 KWINEFFECTS_EXPORT Effect *create(BuiltInEffect effect);
@@ -0,0 +1,421 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+Copyright (C) 2007 Rivo Laks <rivolaks@hot.ee>
+Copyright (C) 2008 Lucas Murray <lmurray@undefinedfire.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#include "naturallayout.h"
+
+#include <QHash>
+#include <QRegion>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+// windows closer than this to each other are considered overlapping
+static const int s_spacing = 5;
+
+static inline QRect padded(const QRect &rect)
+{
+    return rect.adjusted(-s_spacing, -s_spacing, s_spacing, s_spacing);
+}
+
+/**
+ * Uniform grid over the padded window geometries, the broadphase of the overlap tests.
+ */
+class LayoutGrid
+{
+public:
+    explicit LayoutGrid(const QVector<QRect> &rects);
+
+    /**
+     * Indices of all windows whose cells intersect the cells of @p rect, in ascending order.
+     */
+    QVector<int> candidates(const QRect &rect) const;
+    void move(int index, const QRect &from, const QRect &to);
+
+private:
+    struct Cells
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+        bool operator==(const Cells &other) const {
+            return left == other.left && top == other.top && right == other.right && bottom == other.bottom;
+        }
+    };
+    Cells cells(const QRect &rect) const;
+    static quint64 key(int x, int y) {
+        return (quint64(quint32(x)) << 32) | quint32(y);
+    }
+    int cell(int coordinate) const {
+        // round towards negative infinity, windows can be moved off the area
+        return coordinate >= 0 ? coordinate / m_cellSize : (coordinate + 1) / m_cellSize - 1;
+    }
+
+    int m_cellSize = 1;
+    QHash<quint64, QVector<int>> m_cells;
+};
+
+LayoutGrid::LayoutGrid(const QVector<QRect> &rects)
+{
+    // cells of about the average window size keep both the number of cells a window is
+    // inserted into and the number of windows per cell small
+    qint64 size = 0;
+    for (const QRect &rect : rects) {
+        size += qMax(rect.width(), rect.height());
+    }
+    if (!rects.isEmpty()) {
+        m_cellSize = int(qMax<qint64>(32, size / rects.count())) + 2 * s_spacing;
+    }
+
+    for (int i = 0; i < rects.count(); ++i) {
+        const Cells c = cells(rects[i]);
+        for (int y = c.top; y <= c.bottom; ++y) {
+            for (int x = c.left; x <= c.right; ++x) {
+                m_cells[key(x, y)].append(i);
+            }
+        }
+    }
+}
+
+LayoutGrid::Cells LayoutGrid::cells(const QRect &rect) const
+{
+    const QRect r = padded(rect);
+    return {cell(r.left()), cell(r.top()), cell(r.right()), cell(r.bottom())};
+}
+
+QVector<int> LayoutGrid::candidates(const QRect &rect) const
+{
+    QVector<int> ret;
+    const Cells c = cells(rect);
+    for (int y = c.top; y <= c.bottom; ++y) {
+        for (int x = c.left; x <= c.right; ++x) {
+            const auto it = m_cells.constFind(key(x, y));
+            if (it != m_cells.constEnd()) {
+                ret << *it;
+            }
+        }
+    }
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    return ret;
+}
+
+void LayoutGrid::move(int index, const QRect &from, const QRect &to)
+{
+    const Cells oldCells = cells(from);
+    const Cells newCells = cells(to);
+    if (oldCells == newCells) {
+        return;
+    }
+    for (int y = oldCells.top; y <= oldCells.bottom; ++y) {
+        for (int x = oldCells.left; x <= oldCells.right; ++x) {
+            auto it = m_cells.find(key(x, y));
+            it->removeOne(index);
+            if (it->isEmpty()) {
+                m_cells.erase(it);
+            }
+        }
+    }
+    for (int y = newCells.top; y <= newCells.bottom; ++y) {
+        for (int x = newCells.left; x <= newCells.right; ++x) {
+            m_cells[key(x, y)].append(index);
+        }
+    }
+}
+
+NaturalLayout::NaturalLayout(const QVector<QRect> &geometries, const QRect &area, int accuracy, bool fillGaps)
+    : m_geometries(geometries)
+    , m_area(area)
+    , m_accuracy(accuracy)
+    , m_fillGaps(fillGaps)
+{
+}
+
+QVector<QRect> NaturalLayout::estimate() const
+{
+    QRect bounds = m_area;
+    for (const QRect &geometry : m_geometries) {
+        bounds = bounds.united(geometry);
+    }
+    if (bounds == m_area) {
+        return m_geometries;
+    }
+    const double scale = qMin((m_area.width() - 20) / double(bounds.width()),
+                              (m_area.height() - 20) / double(bounds.height()));
+    QVector<QRect> targets;
+    targets.reserve(m_geometries.count());
+    for (const QRect &geometry : m_geometries) {
+        targets << QRect((geometry.x() - bounds.x()) * scale + m_area.x() + 10,
+                         (geometry.y() - bounds.y()) * scale + m_area.y() + 10,
+                         geometry.width() * scale,
+                         geometry.height() * scale);
+    }
+    return targets;
+}
+
+QVector<QRect> NaturalLayout::calculate() const
+{
+    const QRect &area = m_area;
+    QRect bounds = area;
+    QVector<QRect> targets = m_geometries;
+    for (const QRect &target : qAsConst(targets)) {
+        bounds = bounds.united(target);
+    }
+
+    // Iterate over all windows, if two overlap push them apart _slightly_ as we try to
+    // brute-force the most optimal positions over many iterations.
+    LayoutGrid grid(targets);
+    bool overlap;
+    do {
+        overlap = false;
+        for (int w = 0; w < targets.count(); ++w) {
+            QRect *target_w = &targets[w];
+            QVector<int> candidates = grid.candidates(*target_w);
+            for (int i = 0; i < candidates.count(); ++i) {
+                const int e = candidates.at(i);
+                if (w == e)
+                    continue;
+                QRect *target_e = &targets[e];
+                if (padded(*target_w).intersects(padded(*target_e))) {
+                    overlap = true;
+                    const QRect old_w = *target_w;
+                    const QRect old_e = *target_e;
+
+                    // Determine pushing direction
+                    QPoint diff(target_e->center() - target_w->center());
+                    // Prevent dividing by zero and non-movement
+                    if (diff.x() == 0 && diff.y() == 0)
+                        diff.setX(1);
+                    // Approximate a vector of between 10px and 20px in magnitude in the same direction
+                    diff *= m_accuracy / double(diff.manhattanLength());
+                    // Move both windows apart
+                    target_w->translate(-diff);
+                    target_e->translate(diff);
+
+                    // Try to keep the bounding rect the same aspect as the screen so that more
+                    // screen real estate is utilised. We do this by splitting the screen into nine
+                    // equal sections, if the window center is in any of the corner sections pull the
+                    // window towards the outer corner. If it is in any of the other edge sections
+                    // alternate between each corner on that edge. We don't want to determine it
+                    // randomly as it will not produce consistant locations when using the filter.
+                    // Only move one window so we don't cause large amounts of unnecessary zooming
+                    // in some situations. We need to do this even when expanding later just in case
+                    // all windows are the same size.
+                    // (We are using an old bounding rect for this, hopefully it doesn't matter)
+                    // The preferred direction of a window alternates with its position in the list.
+                    const int direction = w % 4;
+                    int xSection = (target_w->x() - bounds.x()) / (bounds.width() / 3);
+                    int ySection = (target_w->y() - bounds.y()) / (bounds.height() / 3);
+                    diff = QPoint(0, 0);
+                    if (xSection != 1 || ySection != 1) { // Remove this if you want the center to pull as well
+                        if (xSection == 1)
+                            xSection = (direction / 2 ? 2 : 0);
+                        if (ySection == 1)
+                            ySection = (direction % 2 ? 2 : 0);
+                    }
+                    if (xSection == 0 && ySection == 0)
+                        diff = QPoint(bounds.topLeft() - target_w->center());
+                    if (xSection == 2 && ySection == 0)
+                        diff = QPoint(bounds.topRight() - target_w->center());
+                    if (xSection == 2 && ySection == 2)
+                        diff = QPoint(bounds.bottomRight() - target_w->center());
+                    if (xSection == 0 && ySection == 2)
+                        diff = QPoint(bounds.bottomLeft() - target_w->center());
+                    if (diff.x() != 0 || diff.y() != 0) {
+                        diff *= m_accuracy / double(diff.manhattanLength());
+                        target_w->translate(diff);
+                    }
+
+                    // Update bounding rect
+                    bounds = bounds.united(*target_w);
+                    bounds = bounds.united(*target_e);
+
+                    grid.move(w, old_w, *target_w);
+                    grid.move(e, old_e, *target_e);
+
+                    // The window moved, go on with the windows after e close to where it is now
+                    candidates = grid.candidates(*target_w);
+                    i = std::upper_bound(candidates.constBegin(), candidates.constEnd(), e) - candidates.constBegin() - 1;
+                }
+            }
+        }
+    } while (overlap);
+
+    // Work out scaling by getting the most top-left and most bottom-right window coords.
+    // The 20's and 10's are so that the windows don't touch the edge of the screen.
+    double scale;
+    if (bounds == area)
+        scale = 1.0; // Don't add borders to the screen
+    else if (area.width() / double(bounds.width()) < area.height() / double(bounds.height()))
+        scale = (area.width() - 20) / double(bounds.width());
+    else
+        scale = (area.height() - 20) / double(bounds.height());
+    // Make bounding rect fill the screen size for later steps
+    bounds = QRect(
+                 bounds.x() - (area.width() - 20 - bounds.width() * scale) / 2 - 10 / scale,
+                 bounds.y() - (area.height() - 20 - bounds.height() * scale) / 2 - 10 / scale,
+                 area.width() / scale,
+                 area.height() / scale
+             );
+
+    // Move all windows back onto the screen and set their scale
+    for (QRect &target : targets) {
+        target.setRect((target.x() - bounds.x()) * scale + area.x(),
+                       (target.y() - bounds.y()) * scale + area.y(),
+                       target.width() * scale,
+                       target.height() * scale
+                       );
+    }
+
+    // Try to fill the gaps by enlarging windows if they have the space
+    if (m_fillGaps) {
+        // Don't expand onto or over the border
+        QRegion borderRegion(area.adjusted(-200, -200, 200, 200));
+        borderRegion ^= area.adjusted(10 / scale, 10 / scale, -10 / scale, -10 / scale);
+
+        LayoutGrid gapGrid(targets);
+        auto isOverlappingAny = [&targets, &gapGrid, &borderRegion](int w) {
+            const QRect &target_w = targets.at(w);
+            if (borderRegion.intersects(target_w))
+                return true;
+            const QVector<int> candidates = gapGrid.candidates(target_w);
+            for (int e : candidates) {
+                if (e == w)
+                    continue;
+                if (padded(target_w).intersects(padded(targets.at(e))))
+                    return true;
+            }
+            return false;
+        };
+
+        bool moved;
+        do {
+            moved = false;
+            for (int w = 0; w < targets.count(); ++w) {
+                QRect oldRect;
+                QRect *target = &targets[w];
+                const QRect initialRect = *target;
+                // This may cause some slight distortion if the windows are enlarged a large amount
+                int widthDiff = m_accuracy;
+                int heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                int xDiff = widthDiff / 2;  // Also move a bit in the direction of the enlarge, allows the
+                int yDiff = heightDiff / 2; // center windows to be enlarged if there is gaps on the side.
+
+                // heightDiff (and yDiff) will be re-computed after each successful enlargement attempt
+                // so that the error introduced in the window's aspect ratio is minimized
+
+                // Attempt enlarging to the top-right
+                oldRect = *target;
+                target->setRect(target->x() + xDiff,
+                                target->y() - yDiff - heightDiff,
+                                target->width() + widthDiff,
+                                target->height() + heightDiff
+                                );
+                if (isOverlappingAny(w))
+                    *target = oldRect;
+                else {
+                    moved = true;
+                    heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                    yDiff = heightDiff / 2;
+                }
+
+                // Attempt enlarging to the bottom-right
+                oldRect = *target;
+                target->setRect(
+                                 target->x() + xDiff,
+                                 target->y() + yDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w))
+                    *target = oldRect;
+                else {
+                    moved = true;
+                    heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                    yDiff = heightDiff / 2;
+                }
+
+                // Attempt enlarging to the bottom-left
+                oldRect = *target;
+                target->setRect(
+                                 target->x() - xDiff - widthDiff,
+                                 target->y() + yDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w))
+                    *target = oldRect;
+                else {
+                    moved = true;
+                    heightDiff = heightForWidth(w, target->width() + widthDiff) - target->height();
+                    yDiff = heightDiff / 2;
+                }
+
+                // Attempt enlarging to the top-left
+                oldRect = *target;
+                target->setRect(
+                                 target->x() - xDiff - widthDiff,
+                                 target->y() - yDiff - heightDiff,
+                                 target->width() + widthDiff,
+                                 target->height() + heightDiff
+                             );
+                if (isOverlappingAny(w))
+                    *target = oldRect;
+                else
+                    moved = true;
+
+                gapGrid.move(w, initialRect, *target);
+            }
+        } while (moved);
+
+        // The expanding code above can actually enlarge windows over 1.0/2.0 scale, we don't like this
+        // We can't add this to the loop above as it would cause a never-ending loop so we have to make
+        // do with the less-than-optimal space usage with using this method.
+        for (int w = 0; w < targets.count(); ++w) {
+            QRect *target = &targets[w];
+            const QRect &geometry = m_geometries.at(w);
+            double scale = target->width() / double(geometry.width());
+            if (scale > 2.0 || (scale > 1.0 && (geometry.width() > 300 || geometry.height() > 300))) {
+                scale = (geometry.width() > 300 || geometry.height() > 300) ? 1.0 : 2.0;
+                target->setRect(
+                                 target->center().x() - int(geometry.width() * scale) / 2,
+                                 target->center().y() - int(geometry.height() * scale) / 2,
+                                 geometry.width() * scale,
+                                 geometry.height() * scale);
+            }
+        }
+    }
+
+    return targets;
+}
+
+QFuture<QVector<QRect>> NaturalLayout::calculateAsync() const
+{
+    const NaturalLayout layout = *this;
+    return QtConcurrent::run([layout] {
+        return layout.calculate();
+    });
+}
+
+} // namespace
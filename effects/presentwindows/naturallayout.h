@@ -0,0 +1,77 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_PRESENTWINDOWS_NATURALLAYOUT_H
+#define KWIN_PRESENTWINDOWS_NATURALLAYOUT_H
+
+#include <QFuture>
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short The natural layout mode of the Present Windows effect.
+ *
+ * Works on plain window geometries only, so that it can be calculated in a worker thread.
+ * Overlapping windows are found with a uniform grid, which is updated whenever a window is
+ * moved, so that each window is only compared with the windows close to it. The windows are
+ * visited in the same order as when comparing all of them with each other, so the layout is
+ * the same as without the grid.
+ */
+class NaturalLayout
+{
+public:
+    /**
+     * @param geometries The geometries of the windows, in a stable order
+     * @param area The area to lay the windows out in
+     * @param accuracy The distance windows are moved in each step
+     * @param fillGaps Whether windows are enlarged to fill gaps in the layout
+     */
+    NaturalLayout(const QVector<QRect> &geometries, const QRect &area, int accuracy, bool fillGaps);
+
+    /**
+     * Calculates the target geometries, in the order of the geometries passed in.
+     */
+    QVector<QRect> calculate() const;
+    /**
+     * Calculates the same target geometries as calculate() in a worker thread.
+     */
+    QFuture<QVector<QRect>> calculateAsync() const;
+
+    /**
+     * Cheap approximation of the layout, the windows scaled down in place so that all of
+     * them fit into the area.
+     */
+    QVector<QRect> estimate() const;
+
+private:
+    int heightForWidth(int index, int width) const {
+        return int((width / double(m_geometries[index].width())) * m_geometries[index].height());
+    }
+
+    QVector<QRect> m_geometries;
+    QRect m_area;
+    int m_accuracy;
+    bool m_fillGaps;
+};
+
+} // namespace
+
+#endif
@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <kwineffectquickview.h>
 
 #include <QElapsedTimer>
+#include <QFutureWatcher>
 
 class QMouseEvent;
 class QQuickView;
@@ -219,6 +220,7 @@ protected:
     // Window rearranging
     void rearrangeWindows();
     void reCreateGrids();
+    void updateTextFrames();
     void calculateWindowTransformations(EffectWindowList windowlist, int screen,
                                         WindowMotionManager& motionManager, bool external = false);
     void calculateWindowTransformationsClosest(EffectWindowList windowlist, int screen,
@@ -238,7 +240,8 @@ protected:
     inline int heightForWidth(EffectWindow *w, int width) {
         return int((width / double(w->width())) * w->height());
     }
-    bool isOverlappingAny(EffectWindow *w, const QHash<EffectWindow*, QRect> &targets, const QRegion &border);
+    void applyNaturalLayout(int screen);
+    void cancelNaturalLayouts();
 
     // Filter box
     void updateFilterFrame();
@@ -293,6 +296,13 @@ private:
     // Grid layout info
     QList<GridSize> m_gridSizes;
 
+    // Natural layouts being calculated in a worker thread, by screen
+    struct PendingLayout {
+        EffectWindowList windows;
+        QFutureWatcher<QVector<QRect>> *watcher = nullptr;
+    };
+    QHash<int, PendingLayout> m_pendingLayouts;
+
     // Filter box
     EffectFrame* m_filterFrame;
     QString m_windowFilter;
@@ -261,35 +261,92 @@ void ZoomEffect::prePaintScreen(ScreenPrePaintData& data, int time)
             zoom = qMax(zoom - ((zoomDist * time) / animationTime(150*zoomFactor)), target_zoom);
     }
 
+    m_offscreen = false;
     if (zoom == 1.0) {
         showCursor();
+        m_offscreenTarget.reset();
+        m_offscreenTexture.reset();
     } else {
         hideCursor();
-        data.mask |= PAINT_SCREEN_TRANSFORMED;
+        if (updateOffscreenTarget(data)) {
+            // only the damaged parts of the screen are painted into the target, which is then
+            // presented zoomed, instead of painting all windows transformed
+            m_offscreen = true;
+            data.mask |= PAINT_SCREEN_OFFSCREEN;
+            GLRenderTarget::pushRenderTarget(m_offscreenTarget.data());
+            GLRenderTarget::setScreenTarget(m_offscreenTarget.data());
+        } else {
+            data.mask |= PAINT_SCREEN_TRANSFORMED;
+        }
     }
 
     effects->prePaintScreen(data, time);
 }
 
+bool ZoomEffect::updateOffscreenTarget(ScreenPrePaintData &data)
+{
+    // with per output rendering the target couldn't stand in for the whole virtual screen
+    if (!effects->isOpenGLCompositing() || !GLRenderTarget::supported()
+            || (effects->waylandDisplay() && effects->numScreens() > 1)) {
+        m_offscreenTarget.reset();
+        m_offscreenTexture.reset();
+        return false;
+    }
+
+    const QRect geometry = GLRenderTarget::virtualScreenGeometry();
+    const QSize size = geometry.size() * GLRenderTarget::virtualScreenScale();
+    if (m_offscreenTexture && m_offscreenTexture->size() == size) {
+        return true;
+    }
+
+    m_offscreenTarget.reset();
+    m_offscreenTexture.reset(new GLTexture(GL_RGBA8, size));
+    m_offscreenTexture->setFilter(GL_LINEAR);
+    m_offscreenTexture->setWrapMode(GL_CLAMP_TO_EDGE);
+    m_offscreenTexture->setYInverted(false);
+    m_offscreenTarget.reset(new GLRenderTarget(*m_offscreenTexture));
+    if (!m_offscreenTarget->valid()) {
+        m_offscreenTarget.reset();
+        m_offscreenTexture.reset();
+        return false;
+    }
+    // nothing has been painted into the new target yet
+    data.paint |= geometry;
+    return true;
+}
+
+void ZoomEffect::repaintViewport()
+{
+    if (!m_offscreenTarget) {
+        effects->addRepaintFull();
+        return;
+    }
+    // The offscreen target is still up to date, it only has to be presented with the new
+    // viewport. Any damage gets a new frame, so only the area around the cursor is damaged.
+    const QPoint pos = effects->cursorPos() - cursorHotSpot;
+    effects->addRepaint(QRect(pos, QSize(qMax(1, imageWidth), qMax(1, imageHeight))));
+}
+
 void ZoomEffect::paintScreen(int mask, const QRegion &region, ScreenPaintData& data)
 {
+    int xTranslation = 0;
+    int yTranslation = 0;
     if (zoom != 1.0) {
-        data *= QVector2D(zoom, zoom);
         const QSize screenSize = effects->virtualScreenSize();
 
         // mouse-tracking allows navigation of the zoom-area using the mouse.
         switch(mouseTracking) {
         case MouseTrackingProportional:
-            data.setXTranslation(- int(cursorPoint.x() * (zoom - 1.0)));
-            data.setYTranslation(- int(cursorPoint.y() * (zoom - 1.0)));
+            xTranslation = - int(cursorPoint.x() * (zoom - 1.0));
+            yTranslation = - int(cursorPoint.y() * (zoom - 1.0));
             prevPoint = cursorPoint;
             break;
         case MouseTrackingCentred:
             prevPoint = cursorPoint;
             // fall through
         case MouseTrackingDisabled:
-            data.setXTranslation(qMin(0, qMax(int(screenSize.width() - screenSize.width() * zoom), int(screenSize.width() / 2 - prevPoint.x() * zoom))));
-            data.setYTranslation(qMin(0, qMax(int(screenSize.height() - screenSize.height() * zoom), int(screenSize.height() / 2 - prevPoint.y() * zoom))));
+            xTranslation = qMin(0, qMax(int(screenSize.width() - screenSize.width() * zoom), int(screenSize.width() / 2 - prevPoint.x() * zoom)));
+            yTranslation = qMin(0, qMax(int(screenSize.height() - screenSize.height() * zoom), int(screenSize.height() / 2 - prevPoint.y() * zoom)));
             break;
         case MouseTrackingPush: {
                 // touching an edge of the screen moves the zoom-area in that direction.
@@ -309,8 +366,8 @@ void ZoomEffect::paintScreen(int mask, const QRegion &region, ScreenPaintData& d
                     prevPoint.setX(qMax(0, qMin(screenSize.width(), prevPoint.x() + xMove)));
                 if (yMove)
                     prevPoint.setY(qMax(0, qMin(screenSize.height(), prevPoint.y() + yMove)));
-                data.setXTranslation(- int(prevPoint.x() * (zoom - 1.0)));
-                data.setYTranslation(- int(prevPoint.y() * (zoom - 1.0)));
+                xTranslation = - int(prevPoint.x() * (zoom - 1.0));
+                yTranslation = - int(prevPoint.y() * (zoom - 1.0));
                 break;
             }
         }
@@ -325,14 +382,40 @@ void ZoomEffect::paintScreen(int mask, const QRegion &region, ScreenPaintData& d
                 acceptFocus = msecs > focusDelay;
             }
             if (acceptFocus) {
-                data.setXTranslation(- int(focusPoint.x() * (zoom - 1.0)));
-                data.setYTranslation(- int(focusPoint.y() * (zoom - 1.0)));
+                xTranslation = - int(focusPoint.x() * (zoom - 1.0));
+                yTranslation = - int(focusPoint.y() * (zoom - 1.0));
                 prevPoint = focusPoint;
             }
         }
     }
 
-    effects->paintScreen(mask, region, data);
+    if (m_offscreen) {
+        effects->paintScreen(mask, region, data);
+        GLRenderTarget::setScreenTarget(nullptr);
+        GLRenderTarget::popRenderTarget();
+
+        // present the target zoomed, it covers the whole screen
+        const QRect geometry = GLRenderTarget::virtualScreenGeometry();
+        const QRect rect(geometry.x() * zoom + xTranslation, geometry.y() * zoom + yTranslation,
+                         geometry.width() * zoom, geometry.height() * zoom);
+        glClearColor(0.0, 0.0, 0.0, 1.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        m_offscreenTexture->bind();
+        auto s = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
+        QMatrix4x4 mvp = data.projectionMatrix();
+        mvp.translate(rect.x(), rect.y());
+        s->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+        m_offscreenTexture->render(infiniteRegion(), rect);
+        ShaderManager::instance()->popShader();
+        m_offscreenTexture->unbind();
+    } else {
+        if (zoom != 1.0) {
+            data *= QVector2D(zoom, zoom);
+            data.setXTranslation(xTranslation);
+            data.setYTranslation(yTranslation);
+        }
+        effects->paintScreen(mask, region, data);
+    }
 
     if (zoom != 1.0 && mousePointer != MousePointerHide) {
         // Draw the mouse-texture at the position matching to zoomed-in image of the desktop. Hiding the
@@ -345,7 +428,7 @@ void ZoomEffect::paintScreen(int mask, const QRegion &region, ScreenPaintData& d
             h *= zoom;
         }
         const QPoint p = effects->cursorPos() - cursorHotSpot;
-        QRect rect(p.x() * zoom + data.xTranslation(), p.y() * zoom + data.yTranslation(), w, h);
+        QRect rect(p.x() * zoom + xTranslation, p.y() * zoom + yTranslation, w, h);
 
         if (texture) {
             texture->bind();
@@ -390,7 +473,7 @@ void ZoomEffect::paintScreen(int mask, const QRegion &region, ScreenPaintData& d
 void ZoomEffect::postPaintScreen()
 {
     if (zoom != target_zoom)
-        effects->addRepaintFull();
+        repaintViewport();
     effects->postPaintScreen();
 }
 
@@ -444,7 +527,7 @@ void ZoomEffect::timelineFrameChanged(int /* frame */)
     prevPoint.setX(qMax(0, qMin(screenSize.width(), prevPoint.x() + xMove)));
     prevPoint.setY(qMax(0, qMin(screenSize.height(), prevPoint.y() + yMove)));
     cursorPoint = prevPoint;
-    effects->addRepaintFull();
+    repaintViewport();
 }
 
 void ZoomEffect::moveZoom(int x, int y)
@@ -509,7 +592,7 @@ void ZoomEffect::slotMouseChanged(const QPoint& pos, const QPoint& old, Qt::Mous
     cursorPoint = pos;
     if (pos != old) {
         lastMouseEvent = QTime::currentTime();
-        effects->addRepaintFull();
+        repaintViewport();
     }
 }
 
@@ -521,7 +604,7 @@ void ZoomEffect::focusChanged(int px, int py, int rx, int ry, int rwidth, int rh
     focusPoint = (px >= 0 && py >= 0) ? QPoint(px, py) : QPoint(rx + qMax(0, (qMin(screenSize.width(), rwidth) / 2) - 60), ry + qMax(0, (qMin(screenSize.height(), rheight) / 2) - 60));
     if (enableFocusTracking) {
         lastFocusEvent = QTime::currentTime();
-        effects->addRepaintFull();
+        repaintViewport();
     }
 }
 
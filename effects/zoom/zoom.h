@@ -29,6 +29,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
+class GLRenderTarget;
 class GLTexture;
 class XRenderPicture;
 
@@ -98,6 +99,8 @@ private:
     void showCursor();
     void hideCursor();
     void moveZoom(int x, int y);
+    bool updateOffscreenTarget(ScreenPrePaintData &data);
+    void repaintViewport();
 private:
     double zoom;
     double target_zoom;
@@ -118,6 +121,10 @@ private:
     QTime lastMouseEvent;
     QTime lastFocusEvent;
     QScopedPointer<GLTexture> texture;
+    // the unzoomed screen, painted with the usual damage tracking
+    QScopedPointer<GLTexture> m_offscreenTexture;
+    QScopedPointer<GLRenderTarget> m_offscreenTarget;
+    bool m_offscreen = false;
 #ifdef KWIN_HAVE_XRENDER_COMPOSITING
     QScopedPointer<XRenderPicture> xrenderPicture;
 #endif
@@ -0,0 +1,465 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "frametimings.h"
+#include "utils.h"
+
+#include <kwinglplatform.h>
+#include <kwinglutils.h>
+
+namespace KWin
+{
+
+// frames are written to the trace file with a delay, so that their GPU and flip times are known
+static const quint64 s_traceDelay = 8;
+static const int s_traceFlushSize = 64 * 1024;
+
+FrameTimings *FrameTimings::s_self = nullptr;
+
+FrameTimings *FrameTimings::self()
+{
+    return s_self;
+}
+
+FrameTimings::FrameTimings()
+{
+    m_clock.start();
+    s_self = this;
+
+    m_enabled = qEnvironmentVariableIntValue("KWIN_FRAME_TIMINGS") != 0;
+
+    const QString traceFile = qEnvironmentVariable("KWIN_FRAME_TIMINGS_TRACE");
+    if (!traceFile.isEmpty()) {
+        startTrace(traceFile);
+    }
+}
+
+FrameTimings::~FrameTimings()
+{
+    stopTrace();
+    s_self = nullptr;
+}
+
+void FrameTimings::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+void FrameTimings::beginFrame()
+{
+    if (m_recording || !isEnabled()) {
+        return;
+    }
+    m_current = Frame();
+    m_current.sequence = ++m_sequence;
+    m_current.timestamp = m_clock.nsecsElapsed();
+    m_scopes.clear();
+    m_frameEffectTimes.clear();
+    m_gpuOwner = nullptr;
+    m_gpuOwnerStart = -1;
+    m_rendered = false;
+    m_recording = true;
+}
+
+void FrameTimings::discardFrame()
+{
+    if (!m_recording) {
+        return;
+    }
+    m_recording = false;
+    m_sequence--;
+}
+
+void FrameTimings::endFrame()
+{
+    if (!m_recording) {
+        return;
+    }
+    while (!m_scopes.isEmpty()) {
+        leave();
+    }
+    m_current.duration = m_clock.nsecsElapsed() - m_current.timestamp;
+    for (auto it = m_frameEffectTimes.constBegin(); it != m_frameEffectTimes.constEnd(); ++it) {
+        EffectCost &cost = m_effectCosts[it.key()];
+        cost.cpuTime += it.value();
+        cost.frames++;
+    }
+    m_recording = false;
+
+    Slot *slot = slotForSequence(m_current.sequence);
+    const quint64 version = slot->version.load(std::memory_order_relaxed);
+    slot->version.store(version + 1, std::memory_order_relaxed);
+    // keeps the writes to the frame from becoming visible before the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->frame = m_current;
+    slot->version.store(version + 2, std::memory_order_release);
+    m_head.store(m_current.sequence, std::memory_order_release);
+
+    if (isTracing()) {
+        while (m_tracedSequence + s_traceDelay < m_current.sequence) {
+            traceFrame(++m_tracedSequence);
+        }
+        if (m_traceBuffer.size() > s_traceFlushSize) {
+            flushTrace();
+        }
+    }
+}
+
+void FrameTimings::enter(Phase phase, const Effect *effect)
+{
+    if (!m_recording) {
+        return;
+    }
+    m_scopes.append({phase, effect, m_clock.nsecsElapsed(), 0});
+    if (m_effectGpuTiming && m_gpuTimerQueries) {
+        updateGpuOwner();
+    }
+}
+
+void FrameTimings::leave()
+{
+    if (!m_recording) {
+        return;
+    }
+    const Scope scope = m_scopes.last();
+    m_scopes.removeLast();
+    const qint64 duration = m_clock.nsecsElapsed() - scope.start;
+    const qint64 exclusive = duration - scope.children;
+    m_current.phases[scope.phase] += exclusive;
+    if (scope.effect) {
+        m_frameEffectTimes[scope.effect] += exclusive;
+    }
+    if (!m_scopes.isEmpty()) {
+        m_scopes.last().children += duration;
+    }
+    if (m_effectGpuTiming && m_gpuTimerQueries) {
+        updateGpuOwner();
+    }
+}
+
+void FrameTimings::updateGpuOwner()
+{
+    const Effect *owner = nullptr;
+    if (!m_scopes.isEmpty() && m_scopes.last().phase == Effects) {
+        owner = m_scopes.last().effect;
+    }
+    if (owner == m_gpuOwner) {
+        return;
+    }
+    if (m_gpuOwner) {
+        m_gpuTimerQueries->addSpan(m_gpuOwnerStart, m_gpuTimerQueries->timestamp(), m_current.sequence, m_gpuOwner);
+        m_gpuOwnerStart = -1;
+    }
+    m_gpuOwner = owner;
+    if (m_gpuOwner) {
+        m_gpuOwnerStart = m_gpuTimerQueries->timestamp();
+    }
+}
+
+void FrameTimings::markRendered()
+{
+    m_rendered = true;
+}
+
+void FrameTimings::swapStarted()
+{
+    if (m_recording && m_rendered) {
+        m_swapSequence = m_sequence;
+    } else if (m_recording) {
+        // presenting the previous frame before rendering the current one
+        m_swapSequence = m_sequence - 1;
+    } else {
+        m_swapSequence = m_sequence;
+    }
+    m_swapStart = m_clock.nsecsElapsed();
+}
+
+void FrameTimings::swapCompleted()
+{
+    if (m_swapStart < 0) {
+        return;
+    }
+    const qint64 flip = m_clock.nsecsElapsed() - m_swapStart;
+    m_swapStart = -1;
+    if (m_recording && m_swapSequence == m_current.sequence) {
+        m_current.phases[Flip] += flip;
+    } else {
+        updateSlot(m_swapSequence, Flip, flip);
+    }
+}
+
+void FrameTimings::addGpuTime(quint64 sequence, const Effect *effect, qint64 nsecs)
+{
+    if (effect) {
+        auto it = m_effectCosts.find(effect);
+        if (it != m_effectCosts.end()) {
+            it->gpuTime += nsecs;
+        }
+        return;
+    }
+    if (m_recording && sequence == m_current.sequence) {
+        m_current.phases[Gpu] += nsecs;
+    } else {
+        updateSlot(sequence, Gpu, nsecs);
+    }
+}
+
+void FrameTimings::setGpuTimerQueries(GpuTimerQueries *queries)
+{
+    m_gpuTimerQueries = queries;
+    m_gpuOwner = nullptr;
+    m_gpuOwnerStart = -1;
+}
+
+void FrameTimings::setEffectGpuTimingEnabled(bool enabled)
+{
+    m_effectGpuTiming = enabled;
+}
+
+void FrameTimings::forgetEffect(const Effect *effect)
+{
+    m_effectCosts.remove(effect);
+    m_frameEffectTimes.remove(effect);
+}
+
+FrameTimings::Slot *FrameTimings::slotForSequence(quint64 sequence)
+{
+    return &m_ring[sequence % s_capacity];
+}
+
+void FrameTimings::updateSlot(quint64 sequence, Phase phase, qint64 nsecs)
+{
+    Slot *slot = slotForSequence(sequence);
+    if (slot->frame.sequence != sequence) {
+        // already overwritten
+        return;
+    }
+    const quint64 version = slot->version.load(std::memory_order_relaxed);
+    slot->version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->frame.phases[phase] += nsecs;
+    slot->version.store(version + 2, std::memory_order_release);
+}
+
+QVector<FrameTimings::Frame> FrameTimings::frames(int count) const
+{
+    QVector<Frame> frames;
+    const quint64 head = m_head.load(std::memory_order_acquire);
+    const int capacity = s_capacity;
+    count = qMin<quint64>(qBound(0, count, capacity), head);
+    frames.reserve(count);
+    for (quint64 sequence = head - count + 1; sequence <= head; ++sequence) {
+        const Slot &slot = m_ring[sequence % s_capacity];
+        const quint64 version = slot.version.load(std::memory_order_acquire);
+        if (version & 1) {
+            continue;
+        }
+        const Frame frame = slot.frame;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != version || frame.sequence != sequence) {
+            // the writer overtook us
+            continue;
+        }
+        frames << frame;
+    }
+    return frames;
+}
+
+QString FrameTimings::phaseName(Phase phase)
+{
+    switch (phase) {
+    case DamageFetch:
+        return QStringLiteral("damageFetch");
+    case Stacking:
+        return QStringLiteral("stacking");
+    case PrePaint:
+        return QStringLiteral("prePaint");
+    case Culling:
+        return QStringLiteral("culling");
+    case Painting:
+        return QStringLiteral("painting");
+    case Effects:
+        return QStringLiteral("effects");
+    case Swap:
+        return QStringLiteral("swap");
+    case Gpu:
+        return QStringLiteral("gpu");
+    case Flip:
+        return QStringLiteral("flip");
+    default:
+        Q_UNREACHABLE();
+    }
+    return QString();
+}
+
+bool FrameTimings::startTrace(const QString &fileName)
+{
+    stopTrace();
+    m_traceFile.setFileName(fileName);
+    // never overwrite an existing file, the name may come from another process over D-Bus
+    if (!m_traceFile.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        qCWarning(KWIN_CORE) << "Failed to open frame timing trace file" << fileName;
+        return false;
+    }
+    m_tracedSequence = m_sequence;
+    m_traceBuffer = QByteArrayLiteral("[\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"Compositor\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,\"args\":{\"name\":\"Flip\"}}");
+    return true;
+}
+
+void FrameTimings::stopTrace()
+{
+    if (!isTracing()) {
+        return;
+    }
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+    while (m_tracedSequence < head) {
+        traceFrame(++m_tracedSequence);
+    }
+    m_traceBuffer += QByteArrayLiteral("\n]\n");
+    flushTrace();
+    m_traceFile.close();
+}
+
+static QByteArray traceEvent(const QByteArray &name, int tid, qint64 start, qint64 duration, quint64 sequence)
+{
+    return QByteArrayLiteral(",\n{\"name\":\"") + name
+        + QByteArrayLiteral("\",\"ph\":\"X\",\"pid\":1,\"tid\":") + QByteArray::number(tid)
+        + QByteArrayLiteral(",\"ts\":") + QByteArray::number(start / 1000.0, 'f', 3)
+        + QByteArrayLiteral(",\"dur\":") + QByteArray::number(duration / 1000.0, 'f', 3)
+        + QByteArrayLiteral(",\"args\":{\"sequence\":") + QByteArray::number(sequence)
+        + QByteArrayLiteral("}}");
+}
+
+void FrameTimings::traceFrame(quint64 sequence)
+{
+    const Frame &frame = slotForSequence(sequence)->frame;
+    if (frame.sequence != sequence) {
+        return;
+    }
+    m_traceBuffer += traceEvent(QByteArrayLiteral("frame"), 1, frame.timestamp, frame.duration, sequence);
+
+    // the phases are interleaved, lay out their exclusive times back to back inside the frame
+    qint64 start = frame.timestamp;
+    for (int phase = DamageFetch; phase <= Swap; ++phase) {
+        if (frame.phases[phase] <= 0) {
+            continue;
+        }
+        m_traceBuffer += traceEvent(phaseName(Phase(phase)).toLatin1(), 1, start, frame.phases[phase], sequence);
+        start += frame.phases[phase];
+    }
+    if (frame.phases[Gpu] > 0) {
+        m_traceBuffer += traceEvent(QByteArrayLiteral("gpu"), 2, frame.timestamp, frame.phases[Gpu], sequence);
+    }
+    if (frame.phases[Flip] > 0) {
+        m_traceBuffer += traceEvent(QByteArrayLiteral("flip"), 3, frame.timestamp + frame.duration, frame.phases[Flip], sequence);
+    }
+}
+
+void FrameTimings::flushTrace()
+{
+    m_traceFile.write(m_traceBuffer);
+    m_traceFile.flush();
+    m_traceBuffer.clear();
+}
+
+// don't let a lagging GPU make the pool grow without bounds, with per effect timings
+// a frame can easily need a few hundred queries
+static const int s_maxQueries = 4096;
+static const int s_queryAllocationSize = 32;
+
+GpuTimerQueries::GpuTimerQueries()
+{
+}
+
+GpuTimerQueries::~GpuTimerQueries()
+{
+    if (!m_queries.isEmpty()) {
+        glDeleteQueries(m_queries.count(), m_queries.data());
+    }
+}
+
+bool GpuTimerQueries::isSupported()
+{
+    if (GLPlatform::instance()->isGLES()) {
+        return false;
+    }
+    return hasGLVersion(3, 3) || hasGLExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+}
+
+int GpuTimerQueries::timestamp()
+{
+    if (m_freeQueries.isEmpty()) {
+        if (m_queries.count() >= s_maxQueries) {
+            return -1;
+        }
+        const int first = m_queries.count();
+        m_queries.resize(first + s_queryAllocationSize);
+        glGenQueries(s_queryAllocationSize, m_queries.data() + first);
+        for (int i = m_queries.count() - 1; i >= first; --i) {
+            m_freeQueries << i;
+        }
+    }
+    const int query = m_freeQueries.takeLast();
+    glQueryCounter(m_queries[query], GL_TIMESTAMP);
+    return query;
+}
+
+void GpuTimerQueries::release(int query)
+{
+    if (query >= 0) {
+        m_freeQueries << query;
+    }
+}
+
+void GpuTimerQueries::addSpan(int begin, int end, quint64 sequence, const Effect *effect)
+{
+    if (begin < 0 || end < 0) {
+        release(begin);
+        release(end);
+        return;
+    }
+    m_pendingSpans.append({begin, end, sequence, effect});
+}
+
+void GpuTimerQueries::resolve(FrameTimings *timings)
+{
+    int resolved = 0;
+    for (const Span &span : qAsConst(m_pendingSpans)) {
+        // queries complete in submission order, stop at the first one still in flight
+        GLint available = 0;
+        glGetQueryObjectiv(m_queries[span.end], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(m_queries[span.begin], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(m_queries[span.end], GL_QUERY_RESULT, &end);
+        if (end > begin) {
+            timings->addGpuTime(span.sequence, span.effect, end - begin);
+        }
+        release(span.begin);
+        release(span.end);
+        resolved++;
+    }
+    m_pendingSpans.remove(0, resolved);
+}
+
+}
@@ -0,0 +1,341 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_FRAMETIMINGS_H
+#define KWIN_FRAMETIMINGS_H
+
+#include <kwinglobals.h>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QVarLengthArray>
+#include <QVector>
+
+#include <atomic>
+
+namespace KWin
+{
+class Effect;
+class GpuTimerQueries;
+
+/**
+ * @short Records the time spent in the phases of each composited frame.
+ *
+ * The Compositor owns one instance for its whole lifetime. Code taking part in compositing
+ * wraps its work in a FrameTimingScope, scopes nest and each phase is accounted its exclusive
+ * time, that is the time not spent in a nested scope. Scopes for effects additionally account
+ * the exclusive time to the effect itself.
+ *
+ * If enabled, the GPU time of the effects' paint hooks is measured as well. A pair of
+ * timestamp queries is placed around every stretch of GL commands issued while an effect of
+ * the Effects phase is the innermost scope, so the GPU time of nested effects and of the scene
+ * is not accounted to the enclosing effect.
+ *
+ * Finished frames are stored in a fixed size ring buffer. The ring buffer is written only by
+ * the compositing thread and can be read without locking from any thread, a reader retries
+ * or skips slots which are overwritten while they are copied.
+ *
+ * Recording is disabled unless enabled with setEnabled, the KWIN_FRAME_TIMINGS environment
+ * variable or while tracing, so the scopes only cost a check of the recording state.
+ *
+ * Optionally the frames are written to a trace file in the Chrome trace event format, which
+ * can be loaded in chrome://tracing or the Perfetto UI. Tracing is started with the
+ * KWIN_FRAME_TIMINGS_TRACE environment variable or over D-Bus.
+ */
+class KWIN_EXPORT FrameTimings
+{
+public:
+    enum Phase {
+        /**
+         * Fetching the damage of the windows.
+         */
+        DamageFetch,
+        /**
+         * Building the list of windows to paint in stacking order.
+         */
+        Stacking,
+        /**
+         * Screen and window pre-paint passes, including the effects' pre-paint hooks.
+         */
+        PrePaint,
+        /**
+         * Occlusion culling of the windows to paint.
+         */
+        Culling,
+        /**
+         * Painting of the scene, not including the time spent in effects.
+         */
+        Painting,
+        /**
+         * Time spent in the paint hooks of effects.
+         */
+        Effects,
+        /**
+         * Preparing and submitting the frame in the platform backend.
+         */
+        Swap,
+        /**
+         * GPU time of the frame, resolved asynchronously from timer queries.
+         */
+        Gpu,
+        /**
+         * Time from handing the frame to the platform until the swap completed.
+         */
+        Flip,
+        PhaseCount
+    };
+
+    struct Frame
+    {
+        quint64 sequence = 0;
+        /**
+         * Start of the frame in nanoseconds of the monotonic clock of the recorder.
+         */
+        qint64 timestamp = 0;
+        /**
+         * CPU time from the start to the end of the frame in nanoseconds.
+         */
+        qint64 duration = 0;
+        qint64 phases[PhaseCount] = {};
+    };
+
+    struct EffectCost
+    {
+        qint64 cpuTime = 0;
+        qint64 gpuTime = 0;
+        quint64 frames = 0;
+    };
+
+    FrameTimings();
+    ~FrameTimings();
+
+    /**
+     * The recorder of the Compositor, @c nullptr if there is none.
+     */
+    static FrameTimings *self();
+
+    /**
+     * Whether frames get recorded. Tracing records frames regardless.
+     */
+    bool isEnabled() const {
+        return m_enabled || isTracing();
+    }
+    void setEnabled(bool enabled);
+
+    void beginFrame();
+    void endFrame();
+    /**
+     * Drops the current frame, e.g. if there turned out to be nothing to paint.
+     */
+    void discardFrame();
+    bool isRecording() const {
+        return m_recording;
+    }
+    /**
+     * Sequence number of the frame currently being recorded or of the last finished frame.
+     */
+    quint64 sequence() const {
+        return m_sequence;
+    }
+
+    void enter(Phase phase, const Effect *effect = nullptr);
+    void leave();
+
+    /**
+     * Marks that the contents of the current frame are completely rendered. A swap started
+     * afterwards belongs to the current frame, otherwise to the previous one.
+     */
+    void markRendered();
+    void swapStarted();
+    void swapCompleted();
+
+    /**
+     * Adds asynchronously resolved GPU time to the frame with @p sequence, and to @p effect
+     * if it is not @c nullptr.
+     */
+    void addGpuTime(quint64 sequence, const Effect *effect, qint64 nsecs);
+
+    /**
+     * The GPU timer queries of the current scene, @c nullptr if the scene doesn't provide any.
+     */
+    GpuTimerQueries *gpuTimerQueries() const {
+        return m_gpuTimerQueries;
+    }
+    void setGpuTimerQueries(GpuTimerQueries *queries);
+
+    /**
+     * Whether the GPU time of the individual effects is measured. Disabled by default, as it
+     * places timer queries around every effect paint hook.
+     */
+    bool isEffectGpuTimingEnabled() const {
+        return m_effectGpuTiming;
+    }
+    void setEffectGpuTimingEnabled(bool enabled);
+
+    /**
+     * Returns up to @p count of the most recent finished frames, oldest first. Can be called
+     * from any thread.
+     */
+    QVector<Frame> frames(int count) const;
+
+    /**
+     * Accumulated paint costs of the effects since they were loaded.
+     */
+    const QHash<const Effect *, EffectCost> &effectCosts() const {
+        return m_effectCosts;
+    }
+    void forgetEffect(const Effect *effect);
+
+    /**
+     * Starts writing the frames to @p fileName, which must not exist yet.
+     */
+    bool startTrace(const QString &fileName);
+    void stopTrace();
+    bool isTracing() const {
+        return m_traceFile.isOpen();
+    }
+
+    static QString phaseName(Phase phase);
+
+private:
+    struct Scope
+    {
+        Phase phase;
+        const Effect *effect;
+        qint64 start;
+        qint64 children;
+    };
+    struct Slot
+    {
+        /**
+         * Odd while the frame is being written.
+         */
+        std::atomic<quint64> version{0};
+        Frame frame;
+    };
+    static const int s_capacity = 256;
+
+    Slot *slotForSequence(quint64 sequence);
+    void updateGpuOwner();
+    void updateSlot(quint64 sequence, Phase phase, qint64 nsecs);
+    void traceFrame(quint64 sequence);
+    void flushTrace();
+
+    QElapsedTimer m_clock;
+    Frame m_current;
+    bool m_enabled = false;
+    bool m_recording = false;
+    bool m_rendered = false;
+    quint64 m_sequence = 0;
+    QVarLengthArray<Scope, 16> m_scopes;
+    QHash<const Effect *, qint64> m_frameEffectTimes;
+    QHash<const Effect *, EffectCost> m_effectCosts;
+
+    quint64 m_swapSequence = 0;
+    qint64 m_swapStart = -1;
+
+    Slot m_ring[s_capacity];
+    std::atomic<quint64> m_head{0};
+
+    GpuTimerQueries *m_gpuTimerQueries = nullptr;
+    bool m_effectGpuTiming = false;
+    const Effect *m_gpuOwner = nullptr;
+    int m_gpuOwnerStart = -1;
+
+    QFile m_traceFile;
+    QByteArray m_traceBuffer;
+    quint64 m_tracedSequence = 0;
+
+    static FrameTimings *s_self;
+};
+
+/**
+ * @short Accounts the time until it goes out of scope to a phase of the current frame.
+ */
+class FrameTimingScope
+{
+public:
+    explicit FrameTimingScope(FrameTimings::Phase phase, const Effect *effect = nullptr)
+        : m_timings(FrameTimings::self())
+    {
+        if (m_timings && m_timings->isRecording()) {
+            m_timings->enter(phase, effect);
+        } else {
+            m_timings = nullptr;
+        }
+    }
+    ~FrameTimingScope() {
+        if (m_timings) {
+            m_timings->leave();
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(FrameTimingScope)
+    FrameTimings *m_timings;
+};
+
+/**
+ * @short Pool of GL_TIMESTAMP queries measuring GPU time without stalling the pipeline.
+ *
+ * A span is recorded by placing a timestamp query before and after the GL commands to
+ * measure. The results are read back once the GPU has made them available, usually a few
+ * frames later, and handed to the FrameTimings. Requires a current OpenGL context for all
+ * operations, including destruction.
+ */
+class KWIN_EXPORT GpuTimerQueries
+{
+public:
+    GpuTimerQueries();
+    ~GpuTimerQueries();
+
+    static bool isSupported();
+
+    /**
+     * Records a timestamp into the command stream and returns the query index, or @c -1 if
+     * too many queries are pending.
+     */
+    int timestamp();
+    /**
+     * Adds the span between the timestamps @p begin and @p end to the frame @p sequence and
+     * the @p effect.
+     */
+    void addSpan(int begin, int end, quint64 sequence, const Effect *effect = nullptr);
+    /**
+     * Hands the results of all completed spans to @p timings, without waiting for the GPU.
+     */
+    void resolve(FrameTimings *timings);
+
+private:
+    struct Span
+    {
+        int begin;
+        int end;
+        quint64 sequence;
+        const Effect *effect;
+    };
+    void release(int query);
+
+    QVector<uint> m_queries;
+    QVector<int> m_freeQueries;
+    QVector<Span> m_pendingSpans;
+};
+
+}
+
+#endif
@@ -139,9 +139,8 @@ GlobalShortcutsManager::GlobalShortcutsManager(QObject *parent)
 template <typename T>
 void clearShortcuts(T &shortcuts)
 {
-    for (auto it = shortcuts.begin(); it != shortcuts.end(); ++it) {
-        qDeleteAll((*it));
-    }
+    qDeleteAll(shortcuts);
+    shortcuts.clear();
 }
 
 GlobalShortcutsManager::~GlobalShortcutsManager()
@@ -169,19 +168,16 @@ void GlobalShortcutsManager::init()
 template <typename T>
 void handleDestroyedAction(QObject *object, T &shortcuts)
 {
-    for (auto it = shortcuts.begin(); it != shortcuts.end(); ++it) {
-        auto &list = it.value();
-        auto it2 = list.begin();
-        while (it2 != list.end()) {
-            if (InternalGlobalShortcut *shortcut = dynamic_cast<InternalGlobalShortcut*>(it2.value())) {
-                if (shortcut->action() == object) {
-                    it2 = list.erase(it2);
-                    delete shortcut;
-                    continue;
-                }
+    auto it = shortcuts.begin();
+    while (it != shortcuts.end()) {
+        if (InternalGlobalShortcut *shortcut = dynamic_cast<InternalGlobalShortcut*>(it.value())) {
+            if (shortcut->action() == object) {
+                it = shortcuts.erase(it);
+                delete shortcut;
+                continue;
             }
-            ++it2;
         }
+        ++it;
     }
 }
 
@@ -196,15 +192,8 @@ template <typename T, typename R>
 GlobalShortcut *addShortcut(T &shortcuts, QAction *action, Qt::KeyboardModifiers modifiers, R value)
 {
     GlobalShortcut *cut = new InternalGlobalShortcut(modifiers, value, action);
-    auto it = shortcuts.find(modifiers);
-    if (it != shortcuts.end()) {
-        // TODO: check if shortcut already exists
-        (*it).insert(value, cut);
-    } else {
-        QHash<R, GlobalShortcut*> s;
-        s.insert(value, cut);
-        shortcuts.insert(modifiers, s);
-    }
+    // TODO: check if shortcut already exists
+    shortcuts.insert(qMakePair(modifiers, value), cut);
     return cut;
 }
 
@@ -230,52 +219,92 @@ void GlobalShortcutsManager::registerTouchpadSwipe(QAction *action, SwipeDirecti
 template <typename T, typename U>
 bool processShortcut(Qt::KeyboardModifiers mods, T key, U &shortcuts)
 {
-    auto it = shortcuts.find(mods);
-    if (it == shortcuts.end()) {
-        return false;
-    }
-    auto it2 = (*it).find(key);
-    if (it2 == (*it).end()) {
+    auto it = shortcuts.constFind(qMakePair(mods, key));
+    if (it == shortcuts.constEnd()) {
         return false;
     }
-    it2.value()->invoke();
+    it.value()->invoke();
     return true;
 }
 
-bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, int keyQt)
+void GlobalShortcutsManager::setKGlobalAccelInterface(KGlobalAccelInterface *interface)
 {
-    if (m_kglobalAccelInterface) {
-        if (!keyQt && !mods) {
-            return false;
+    m_kglobalAccelInterface = interface;
+    m_checkKeyPressed = QMetaMethod();
+    if (interface) {
+        const QMetaObject *metaObject = interface->metaObject();
+        const int index = metaObject->indexOfMethod("checkKeyPressed(int)");
+        if (index != -1) {
+            m_checkKeyPressed = metaObject->method(index);
         }
-        auto check = [this] (Qt::KeyboardModifiers mods, int keyQt) {
-            bool retVal = false;
-            QMetaObject::invokeMethod(m_kglobalAccelInterface,
-                                        "checkKeyPressed",
-                                        Qt::DirectConnection,
-                                        Q_RETURN_ARG(bool, retVal),
-                                        Q_ARG(int, int(mods) | keyQt));
-            return retVal;
-        };
-        if (check(mods, keyQt)) {
-            return true;
-        } else if (keyQt == Qt::Key_Backtab) {
-            // KGlobalAccel on X11 has some workaround for Backtab
-            // see kglobalaccel/src/runtime/plugins/xcb/kglobalccel_x11.cpp method x11KeyPress
-            // Apparently KKeySequenceWidget captures Shift+Tab instead of Backtab
-            // thus if the key is backtab we should adjust to add shift again and use tab
-            // in addition KWin registers the shortcut incorrectly as Alt+Shift+Backtab
-            // this should be changed to either Alt+Backtab or Alt+Shift+Tab to match KKeySequenceWidget
-            // trying the variants
-            if (check(mods | Qt::ShiftModifier, keyQt)) {
-                return true;
-            }
-            if (check(mods | Qt::ShiftModifier, Qt::Key_Tab)) {
-                return true;
-            }
+    }
+}
+
+void GlobalShortcutsManager::grabKey(int keyQt, bool grab)
+{
+    if (grab) {
+        m_grabbedKeys[keyQt]++;
+    } else {
+        auto it = m_grabbedKeys.find(keyQt);
+        if (it == m_grabbedKeys.end()) {
+            return;
+        }
+        if (--(*it) > 0) {
+            return;
         }
+        m_grabbedKeys.erase(it);
+    }
+    updateKeyShortcuts();
+}
+
+void GlobalShortcutsManager::updateKeyShortcuts()
+{
+    // KGlobalAccel on X11 has some workaround for Backtab
+    // see kglobalaccel/src/runtime/plugins/xcb/kglobalccel_x11.cpp method x11KeyPress
+    // Apparently KKeySequenceWidget captures Shift+Tab instead of Backtab
+    // thus if the key is backtab we should adjust to add shift again and use tab
+    // in addition KWin registers the shortcut incorrectly as Alt+Shift+Backtab
+    // this should be changed to either Alt+Backtab or Alt+Shift+Tab to match KKeySequenceWidget
+    // so a Backtab press also triggers the Shift+Backtab and Shift+Tab variants. The variants are
+    // inserted from the lowest to the highest priority, an exact match wins over Shift+Backtab,
+    // which wins over Shift+Tab.
+    m_keyShortcuts.clear();
+    const int shift = int(Qt::ShiftModifier);
+    const QList<int> keys = m_grabbedKeys.keys();
+    for (int keyQt : keys) {
+        if ((keyQt & ~int(Qt::KeyboardModifierMask)) == Qt::Key_Tab && (keyQt & shift)) {
+            const int mods = keyQt & int(Qt::KeyboardModifierMask);
+            m_keyShortcuts.insert((mods & ~shift) | Qt::Key_Backtab, keyQt);
+            m_keyShortcuts.insert(mods | Qt::Key_Backtab, keyQt);
+        }
+    }
+    for (int keyQt : keys) {
+        if ((keyQt & ~int(Qt::KeyboardModifierMask)) == Qt::Key_Backtab && (keyQt & shift)) {
+            m_keyShortcuts.insert(keyQt & ~shift, keyQt);
+        }
+    }
+    for (int keyQt : keys) {
+        m_keyShortcuts.insert(keyQt, keyQt);
+    }
+}
+
+bool GlobalShortcutsManager::processKey(Qt::KeyboardModifiers mods, int keyQt)
+{
+    if (!m_kglobalAccelInterface || !m_checkKeyPressed.isValid()) {
+        return false;
+    }
+    if (!keyQt && !mods) {
+        return false;
+    }
+    // keys which are not part of any shortcut are rejected without calling into KGlobalAccel
+    const auto it = m_keyShortcuts.constFind(int(mods) | keyQt);
+    if (it == m_keyShortcuts.constEnd()) {
+        return false;
     }
-    return false;
+    bool retVal = false;
+    m_checkKeyPressed.invoke(m_kglobalAccelInterface, Qt::DirectConnection,
+                             Q_RETURN_ARG(bool, retVal), Q_ARG(int, it.value()));
+    return retVal;
 }
 
 bool GlobalShortcutsManager::processPointerPressed(Qt::KeyboardModifiers mods, Qt::MouseButtons pointerButtons)
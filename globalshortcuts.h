@@ -22,7 +22,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // KWin
 #include <kwinglobals.h>
 // Qt
+#include <QHash>
 #include <QKeySequence>
+#include <QMetaMethod>
 
 class QAction;
 class KGlobalAccelD;
@@ -102,17 +104,37 @@ public:
     void processSwipeCancel();
     void processSwipeEnd();
 
-    void setKGlobalAccelInterface(KGlobalAccelInterface *interface) {
-        m_kglobalAccelInterface = interface;
-    }
+    void setKGlobalAccelInterface(KGlobalAccelInterface *interface);
+
+    /**
+     * @brief Tracks the keys KGlobalAccelD grabs for its registered shortcuts.
+     *
+     * Only key presses which resolve to a grabbed key get passed to KGlobalAccelD, all others
+     * are rejected with one hash lookup.
+     *
+     * @param keyQt The key combination, the Qt::Key or'ed with the modifiers
+     * @param grab Whether the key gets grabbed or released
+     */
+    void grabKey(int keyQt, bool grab);
 
 private:
     void objectDeleted(QObject *object);
-    QHash<Qt::KeyboardModifiers, QHash<Qt::MouseButtons, GlobalShortcut*> > m_pointerShortcuts;
-    QHash<Qt::KeyboardModifiers, QHash<PointerAxisDirection, GlobalShortcut*> > m_axisShortcuts;
-    QHash<Qt::KeyboardModifiers, QHash<SwipeDirection, GlobalShortcut*> > m_swipeShortcuts;
+    void updateKeyShortcuts();
+    QHash<QPair<Qt::KeyboardModifiers, Qt::MouseButtons>, GlobalShortcut*> m_pointerShortcuts;
+    QHash<QPair<Qt::KeyboardModifiers, PointerAxisDirection>, GlobalShortcut*> m_axisShortcuts;
+    QHash<QPair<Qt::KeyboardModifiers, SwipeDirection>, GlobalShortcut*> m_swipeShortcuts;
+    /**
+     * The number of grabs of each key combination by KGlobalAccelD.
+     */
+    QHash<int, int> m_grabbedKeys;
+    /**
+     * Maps the key combinations of key presses to the grabbed key combination they trigger,
+     * including the Backtab variants.
+     */
+    QHash<int, int> m_keyShortcuts;
     KGlobalAccelD *m_kglobalAccel = nullptr;
     KGlobalAccelInterface *m_kglobalAccelInterface = nullptr;
+    QMetaMethod m_checkKeyPressed;
     GestureRecognizer *m_gestureRecognizer;
 };
 
@@ -37,6 +37,11 @@ namespace KWin {
 
 QElapsedTimer AnimationEffect::s_clock;
 
+/**
+ * The animations are kept in a table with one row per animated window, the per window paint
+ * calls look their row up in a hash. All animations are evaluated once per frame into flat
+ * arrays, the paint calls only read the values of their window from them.
+ */
 class AnimationEffectPrivate {
 public:
     AnimationEffectPrivate()
@@ -44,7 +49,37 @@ public:
         m_animated = m_damageDirty = m_animationsTouched = m_isInitialized = false;
         m_justEndedAnimation = 0;
     }
-    AnimationEffect::AniMap m_animations;
+    bool isEmpty() const {
+        return m_windows.isEmpty();
+    }
+    int row(EffectWindow *w) const {
+        return m_rows.value(w, -1);
+    }
+    int addRow(EffectWindow *w);
+    void removeRow(int row);
+    void evaluate(qint64 now);
+    void ensureEvaluated() {
+        if (!m_evaluated) {
+            evaluate(AnimationEffect::clock());
+        }
+    }
+
+    QVector<EffectWindow *> m_windows;
+    QVector<QList<AniData> > m_animations;
+    QVector<QRect> m_layerRects;
+    QHash<EffectWindow *, int> m_rows;
+
+    // the values of the animations of row r start at index m_offsets[r]
+    QVector<int> m_offsets;
+    QVector<quint8> m_started;
+    QVector<float> m_progress;
+    QVector<float> m_factor;
+    QVector<float> m_from[2];
+    QVector<float> m_to[2];
+    QVector<float> m_values[2];
+    bool m_evaluated = false;
+    bool m_hasEmptyRows = false;
+
     static quint64 m_animCounter;
     quint64 m_justEndedAnimation; // protect against cancel
     QWeakPointer<FullScreenEffectLock> m_fullScreenEffectLock;
@@ -56,6 +91,81 @@ using namespace KWin;
 
 quint64 AnimationEffectPrivate::m_animCounter = 0;
 
+int AnimationEffectPrivate::addRow(EffectWindow *w)
+{
+    const int row = m_windows.count();
+    m_windows.append(w);
+    m_animations.append(QList<AniData>());
+    m_layerRects.append(QRect());
+    m_rows.insert(w, row);
+    m_evaluated = false;
+    return row;
+}
+
+void AnimationEffectPrivate::removeRow(int row)
+{
+    // the last row takes the place of the removed one, so only one row changes its index
+    const int last = m_windows.count() - 1;
+    m_rows.remove(m_windows.at(row));
+    if (row != last) {
+        m_windows[row] = m_windows.at(last);
+        m_animations[row].swap(m_animations[last]);
+        m_layerRects[row] = m_layerRects.at(last);
+        m_rows[m_windows.at(row)] = row;
+    }
+    m_windows.removeLast();
+    m_animations.removeLast();
+    m_layerRects.removeLast();
+    m_evaluated = false;
+}
+
+void AnimationEffectPrivate::evaluate(qint64 now)
+{
+    int count = 0;
+    m_offsets.resize(m_animations.count());
+    for (int row = 0; row < m_animations.count(); ++row) {
+        m_offsets[row] = count;
+        count += m_animations.at(row).count();
+    }
+    m_started.resize(count);
+    m_progress.resize(count);
+    m_factor.resize(count);
+    for (int i = 0; i < 2; ++i) {
+        m_from[i].resize(count);
+        m_to[i].resize(count);
+        m_values[i].resize(count);
+    }
+
+    // the timelines and easing curves can't be evaluated in a batch, gather their values first
+    int index = 0;
+    for (const QList<AniData> &animations : qAsConst(m_animations)) {
+        for (const AniData &anim : animations) {
+            const bool started = anim.startTime <= now;
+            const float value = started ? anim.timeLine.value() : 0.0;
+            m_started[index] = started;
+            m_progress[index] = value;
+            // we're done and "waiting" at the target value
+            m_factor[index] = (started && anim.timeLine.done()) ? 1.0 : value;
+            m_from[0][index] = anim.from[0];
+            m_from[1][index] = anim.from[1];
+            m_to[0][index] = anim.to[0];
+            m_to[1][index] = anim.to[1];
+            ++index;
+        }
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        const float *from = m_from[i].constData();
+        const float *to = m_to[i].constData();
+        const float *factor = m_factor.constData();
+        float *values = m_values[i].data();
+        for (int j = 0; j < count; ++j) {
+            values[j] = from[j] + factor[j] * (to[j] - from[j]);
+        }
+    }
+    m_evaluated = true;
+}
+
 AnimationEffect::AnimationEffect() : d_ptr(new AnimationEffectPrivate())
 {
     Q_D(AnimationEffect);
@@ -89,7 +199,7 @@ void AnimationEffect::init()
 bool AnimationEffect::isActive() const
 {
     Q_D(const AnimationEffect);
-    return !d->m_animations.isEmpty();
+    return !d->isEmpty();
 }
 
 
@@ -225,7 +335,7 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
     Q_D(AnimationEffect);
     if (!d->m_isInitialized)
         init(); // needs to ensure the window gets removed if deleted in the same event cycle
-    if (d->m_animations.isEmpty()) {
+    if (d->isEmpty()) {
         connect(effects, &EffectsHandler::windowGeometryShapeChanged,
             this, &AnimationEffect::_expandedGeometryChanged);
         connect(effects, &EffectsHandler::windowStepUserMovedResized,
@@ -233,10 +343,6 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
         connect(effects, &EffectsHandler::windowPaddingChanged,
             this, &AnimationEffect::_expandedGeometryChanged);
     }
-    AniMap::iterator it = d->m_animations.find(w);
-    if (it == d->m_animations.end())
-        it = d->m_animations.insert(w, QPair<QList<AniData>, QRect>(QList<AniData>(), QRect()));
-
     FullScreenEffectLockPtr fullscreen;
     if (fullScreenEffect) {
         if (d->m_fullScreenEffectLock.isNull()) {
@@ -252,7 +358,12 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
         previousPixmap = PreviousWindowPixmapLockPtr::create(w);
     }
 
-    it->first.append(AniData(
+    int row = d->row(w);
+    if (row == -1)
+        row = d->addRow(w);
+    QList<AniData> &animations = d->m_animations[row];
+
+    animations.append(AniData(
         a,              // Attribute
         meta,           // Metadata
         to,             // Target
@@ -265,7 +376,7 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
     ));
 
     const quint64 ret_id = ++d->m_animCounter;
-    AniData &animation = it->first.last();
+    AniData &animation = animations.last();
     animation.id = ret_id;
 
     animation.timeLine.setDirection(TimeLine::Forward);
@@ -279,9 +390,10 @@ quint64 AnimationEffect::p_animate( EffectWindow *w, Attribute a, uint meta, int
         animation.terminationFlags |= TerminateAtTarget;
     }
 
-    it->second = QRect();
+    d->m_layerRects[row] = QRect();
 
     d->m_animationsTouched = true;
+    d->m_evaluated = false;
 
     if (delay > 0) {
         QTimer::singleShot(delay, this, &AnimationEffect::triggerRepaint);
@@ -300,18 +412,19 @@ bool AnimationEffect::retarget(quint64 animationId, FPx2 newTarget, int newRemai
     Q_D(AnimationEffect);
     if (animationId == d->m_justEndedAnimation)
         return false; // this is just ending, do not try to retarget it
-    for (AniMap::iterator entry = d->m_animations.begin(),
-                         mapEnd = d->m_animations.end(); entry != mapEnd; ++entry) {
-        for (QList<AniData>::iterator anim = entry->first.begin(),
-                                   animEnd = entry->first.end(); anim != animEnd; ++anim) {
+    for (int row = 0; row < d->m_animations.count(); ++row) {
+        QList<AniData> &animations = d->m_animations[row];
+        for (QList<AniData>::iterator anim = animations.begin(),
+                                   animEnd = animations.end(); anim != animEnd; ++anim) {
             if (anim->id == animationId) {
                 anim->from.set(interpolated(*anim, 0), interpolated(*anim, 1));
-                validate(anim->attribute, anim->meta, nullptr, &newTarget, entry.key());
+                validate(anim->attribute, anim->meta, nullptr, &newTarget, d->m_windows.at(row));
                 anim->to.set(newTarget[0], newTarget[1]);
 
                 anim->timeLine.setDirection(TimeLine::Forward);
                 anim->timeLine.setDuration(std::chrono::milliseconds(newRemainingTime));
                 anim->timeLine.reset();
+                d->m_evaluated = false;
 
                 return true;
             }
@@ -328,13 +441,13 @@ bool AnimationEffect::redirect(quint64 animationId, Direction direction, Termina
         return false;
     }
 
-    for (auto entryIt = d->m_animations.begin(); entryIt != d->m_animations.end(); ++entryIt) {
-        auto animIt = std::find_if(entryIt->first.begin(), entryIt->first.end(),
+    for (QList<AniData> &animations : d->m_animations) {
+        auto animIt = std::find_if(animations.begin(), animations.end(),
             [animationId] (AniData &anim) {
                 return anim.id == animationId;
             }
         );
-        if (animIt == entryIt->first.end()) {
+        if (animIt == animations.end()) {
             continue;
         }
 
@@ -349,6 +462,7 @@ bool AnimationEffect::redirect(quint64 animationId, Direction direction, Termina
         }
 
         animIt->terminationFlags = terminationFlags & ~TerminateAtTarget;
+        d->m_evaluated = false;
 
         return true;
     }
@@ -364,17 +478,18 @@ bool AnimationEffect::complete(quint64 animationId)
         return false;
     }
 
-    for (auto entryIt = d->m_animations.begin(); entryIt != d->m_animations.end(); ++entryIt) {
-        auto animIt = std::find_if(entryIt->first.begin(), entryIt->first.end(),
+    for (QList<AniData> &animations : d->m_animations) {
+        auto animIt = std::find_if(animations.begin(), animations.end(),
             [animationId] (AniData &anim) {
                 return anim.id == animationId;
             }
         );
-        if (animIt == entryIt->first.end()) {
+        if (animIt == animations.end()) {
             continue;
         }
 
         animIt->timeLine.setElapsed(animIt->timeLine.duration());
+        d->m_evaluated = false;
 
         return true;
     }
@@ -387,14 +502,22 @@ bool AnimationEffect::cancel(quint64 animationId)
     Q_D(AnimationEffect);
     if (animationId == d->m_justEndedAnimation)
         return true; // this is just ending, do not try to cancel it but fake success
-    for (AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end(); entry != mapEnd; ++entry) {
-        for (QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end(); anim != animEnd; ++anim) {
+    for (int row = 0; row < d->m_animations.count(); ++row) {
+        QList<AniData> &animations = d->m_animations[row];
+        for (QList<AniData>::iterator anim = animations.begin(), animEnd = animations.end(); anim != animEnd; ++anim) {
             if (anim->id == animationId) {
-                entry->first.erase(anim); // remove the animation
-                if (entry->first.isEmpty()) { // no other animations on the window, release it.
-                    d->m_animations.erase(entry);
+                animations.erase(anim); // remove the animation
+                d->m_evaluated = false;
+                // no other animations on the window, release it. If we are called from
+                // animationEnded, prePaintScreen is walking the rows and releases it itself
+                if (animations.isEmpty()) {
+                    if (d->m_justEndedAnimation) {
+                        d->m_hasEmptyRows = true;
+                    } else {
+                        d->removeRow(row);
+                    }
                 }
-                if (d->m_animations.isEmpty())
+                if (d->isEmpty())
                     disconnectGeometryChanges();
                 d->m_animationsTouched = true; // could be called from animationEnded
                 return true;
@@ -407,77 +530,85 @@ bool AnimationEffect::cancel(quint64 animationId)
 void AnimationEffect::prePaintScreen( ScreenPrePaintData& data, int time )
 {
     Q_D(AnimationEffect);
-    if (d->m_animations.isEmpty()) {
+    if (d->isEmpty()) {
         effects->prePaintScreen(data, time);
         return;
     }
 
     d->m_animationsTouched = false;
-    AniMap::iterator entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
     d->m_animated = false;
+    const qint64 now = clock();
+    int row = 0;
 //     short int transformed = 0;
-    while (entry != mapEnd) {
+    while (row < d->m_animations.count()) {
         bool invalidateLayerRect = false;
-        QList<AniData>::iterator anim = entry->first.begin(), animEnd = entry->first.end();
         int animCounter = 0;
-        while (anim != animEnd) {
-            if (anim->startTime > clock()) {
-                if (!anim->waitAtSource) {
-                    ++anim;
+        while (animCounter < d->m_animations.at(row).count()) {
+            AniData &anim = d->m_animations[row][animCounter];
+            if (anim.startTime > now) {
+                if (!anim.waitAtSource) {
                     ++animCounter;
                     continue;
                 }
             } else {
-                anim->timeLine.update(std::chrono::milliseconds(time));
+                anim.timeLine.update(std::chrono::milliseconds(time));
             }
 
-            if (anim->isActive()) {
-//                 if (anim->attribute != Brightness && anim->attribute != Saturation && anim->attribute != Opacity)
+            if (anim.isActive()) {
+//                 if (anim.attribute != Brightness && anim.attribute != Saturation && anim.attribute != Opacity)
 //                     transformed = true;
                 d->m_animated = true;
-                ++anim;
                 ++animCounter;
             } else {
-                EffectWindow *oldW = entry.key();
-                d->m_justEndedAnimation = anim->id;
-                animationEnded(oldW, anim->attribute, anim->meta);
+                EffectWindow *oldW = d->m_windows.at(row);
+                d->m_justEndedAnimation = anim.id;
+                animationEnded(oldW, anim.attribute, anim.meta);
                 d->m_justEndedAnimation = 0;
                 // NOTICE animationEnded is an external call and might have called "::animate"
-                // as a result our iterators could now point random junk on the heap
-                // so we've to restore the former states, ie. find our window list and animation
+                // or "::cancel", so we've to find our window row again
                 if (d->m_animationsTouched) {
                     d->m_animationsTouched = false;
-                    entry = d->m_animations.begin(), mapEnd = d->m_animations.end();
-                    while (entry.key() != oldW && entry != mapEnd)
-                        ++entry;
-                    Q_ASSERT(entry != mapEnd); // usercode should not delete animations from animationEnded (not even possible atm.)
-                    anim = entry->first.begin(), animEnd = entry->first.end();
-                    Q_ASSERT(animCounter < entry->first.count());
-                    for (int i = 0; i < animCounter; ++i)
-                        ++anim;
+                    row = d->row(oldW);
+                    Q_ASSERT(row != -1); // usercode should not delete animations from animationEnded (not even possible atm.)
+                    Q_ASSERT(animCounter < d->m_animations.at(row).count());
                 }
-                anim = entry->first.erase(anim);
+                d->m_animations[row].removeAt(animCounter);
                 invalidateLayerRect = d->m_damageDirty = true;
-                animEnd = entry->first.end();
             }
         }
-        if (entry->first.isEmpty()) {
-            data.paint |= entry->second;
+        if (d->m_animations.at(row).isEmpty()) {
+            data.paint |= d->m_layerRects.at(row);
 //             d->m_damageDirty = true; // TODO likely no longer required
-            entry = d->m_animations.erase(entry);
-            mapEnd = d->m_animations.end();
+            d->removeRow(row);
         } else {
             if (invalidateLayerRect)
-                *const_cast<QRect*>(&(entry->second)) = QRect(); // invalidate
-            ++entry;
+                d->m_layerRects[row] = QRect(); // invalidate
+            ++row;
+        }
+    }
+
+    // rows that animationEnded emptied behind the current one
+    if (d->m_hasEmptyRows) {
+        d->m_hasEmptyRows = false;
+        row = 0;
+        while (row < d->m_animations.count()) {
+            if (d->m_animations.at(row).isEmpty()) {
+                data.paint |= d->m_layerRects.at(row);
+                d->removeRow(row);
+            } else {
+                ++row;
+            }
         }
     }
 
     // janitorial...
-    if (d->m_animations.isEmpty()) {
+    if (d->isEmpty()) {
         disconnectGeometryChanges();
     }
 
+    // evaluate all animations at once, the windows only look their values up while painting
+    d->evaluate(now);
+
     effects->prePaintScreen(data, time);
 }
 
@@ -578,12 +709,15 @@ void AnimationEffect::prePaintWindow( EffectWindow* w, WindowPrePaintData& data,
 {
     Q_D(AnimationEffect);
     if ( d->m_animated ) {
-        AniMap::const_iterator entry = d->m_animations.constFind( w );
-        if ( entry != d->m_animations.constEnd() ) {
+        const int row = d->row( w );
+        if ( row != -1 ) {
+            d->ensureEvaluated();
             bool isUsed = false;
             bool paintDeleted = false;
-            for (QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim) {
-                if (anim->startTime > clock() && !anim->waitAtSource)
+            const QList<AniData> &animations = d->m_animations.at(row);
+            int index = d->m_offsets.at(row);
+            for (QList<AniData>::const_iterator anim = animations.constBegin(); anim != animations.constEnd(); ++anim, ++index) {
+                if (!d->m_started.at(index) && !anim->waitAtSource)
                     continue;
 
                 isUsed = true;
@@ -625,32 +759,39 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
 {
     Q_D(AnimationEffect);
     if ( d->m_animated ) {
-        AniMap::const_iterator entry = d->m_animations.constFind( w );
-        if ( entry != d->m_animations.constEnd() ) {
-            for ( QList<AniData>::const_iterator anim = entry->first.constBegin(); anim != entry->first.constEnd(); ++anim ) {
-
-                if (anim->startTime > clock() && !anim->waitAtSource)
+        const int row = d->row( w );
+        if ( row != -1 ) {
+            d->ensureEvaluated();
+            // genericAnimation might start new animations, don't refer to the table
+            const QList<AniData> animations = d->m_animations.at(row);
+            int index = d->m_offsets.at(row);
+            for ( QList<AniData>::const_iterator anim = animations.constBegin(); anim != animations.constEnd(); ++anim, ++index ) {
+
+                if (!d->m_started.at(index) && !anim->waitAtSource)
                     continue;
 
+                const float value[2] = { d->m_values[0].at(index), d->m_values[1].at(index) };
+                const float animProgress = d->m_progress.at(index);
+
                 switch (anim->attribute) {
                 case Opacity:
-                    data.multiplyOpacity(interpolated(*anim)); break;
+                    data.multiplyOpacity(value[0]); break;
                 case Brightness:
-                    data.multiplyBrightness(interpolated(*anim)); break;
+                    data.multiplyBrightness(value[0]); break;
                 case Saturation:
-                    data.multiplySaturation(interpolated(*anim)); break;
+                    data.multiplySaturation(value[0]); break;
                 case Scale: {
                     const QSize sz = w->geometry().size();
                     float f1(1.0), f2(0.0);
                     if (anim->from[0] >= 0.0 && anim->to[0] >= 0.0) { // scale x
-                        f1 = interpolated(*anim, 0);
+                        f1 = value[0];
                         f2 = geometryCompensation( anim->meta & AnimationEffect::Horizontal, f1 );
                         data.translate(f2 * sz.width());
                         data.setXScale(data.xScale() * f1);
                     }
                     if (anim->from[1] >= 0.0 && anim->to[1] >= 0.0) { // scale y
                         if (!anim->isOneDimensional()) {
-                            f1 = interpolated(*anim, 1);
+                            f1 = value[1];
                             f2 = geometryCompensation( anim->meta & AnimationEffect::Vertical, f1 );
                         }
                         else if ( ((anim->meta & AnimationEffect::Vertical)>>1) != (anim->meta & AnimationEffect::Horizontal) )
@@ -664,10 +805,10 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
                     region = clipRect(w->expandedGeometry(), *anim);
                     break;
                 case Translation:
-                    data += QPointF(interpolated(*anim, 0), interpolated(*anim, 1));
+                    data += QPointF(value[0], value[1]);
                     break;
                 case Size: {
-                    FPx2 dest = anim->from + progress(*anim) * (anim->to - anim->from);
+                    FPx2 dest = anim->from + animProgress * (anim->to - anim->from);
                     const QSize sz = w->geometry().size();
                     float f;
                     if (anim->from[0] >= 0.0 && anim->to[0] >= 0.0) { // resize x
@@ -684,15 +825,15 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
                 }
                 case Position: {
                     const QRect geo = w->geometry();
-                    const float prgrs = progress(*anim);
+                    const float prgrs = animProgress;
                     if ( anim->from[0] >= 0.0 && anim->to[0] >= 0.0 ) {
-                        float dest = interpolated(*anim, 0);
+                        float dest = value[0];
                         const int x[2] = {  xCoord(geo, metaData(SourceAnchor, anim->meta)),
                                             xCoord(geo, metaData(TargetAnchor, anim->meta)) };
                         data.translate(dest - (x[0] + prgrs*(x[1] - x[0])));
                     }
                     if ( anim->from[1] >= 0.0 && anim->to[1] >= 0.0 ) {
-                        float dest = interpolated(*anim, 1);
+                        float dest = value[1];
                         const int y[2] = {  yCoord(geo, metaData(SourceAnchor, anim->meta)),
                                             yCoord(geo, metaData(TargetAnchor, anim->meta)) };
                         data.translate(0.0, dest - (y[0] + prgrs*(y[1] - y[0])));
@@ -701,7 +842,7 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
                 }
                 case Rotation: {
                     data.setRotationAxis((Qt::Axis)metaData(Axis, anim->meta));
-                    const float prgrs = progress(*anim);
+                    const float prgrs = animProgress;
                     data.setRotationAngle(anim->from[0] + prgrs*(anim->to[0] - anim->from[0]));
 
                     const QRect geo = w->rect();
@@ -717,10 +858,10 @@ void AnimationEffect::paintWindow( EffectWindow* w, int mask, QRegion region, Wi
                     break;
                 }
                 case Generic:
-                    genericAnimation(w, data, progress(*anim), anim->meta);
+                    genericAnimation(w, data, animProgress, anim->meta);
                     break;
                 case CrossFadePrevious:
-                    data.setCrossFadeProgress(progress(*anim));
+                    data.setCrossFadeProgress(animProgress);
                     break;
                 default:
                     break;
@@ -740,12 +881,14 @@ void AnimationEffect::postPaintScreen()
         if (d->m_needSceneRepaint) {
             effects->addRepaintFull();
         } else {
-            AniMap::const_iterator it = d->m_animations.constBegin(), end = d->m_animations.constEnd();
-            for (; it != end; ++it) {
+            d->ensureEvaluated();
+            for (int row = 0; row < d->m_animations.count(); ++row) {
                 bool addRepaint = false;
-                QList<AniData>::const_iterator anim = it->first.constBegin();
-                for (; anim != it->first.constEnd(); ++anim) {
-                    if (anim->startTime > clock())
+                const QList<AniData> &animations = d->m_animations.at(row);
+                int index = d->m_offsets.at(row);
+                QList<AniData>::const_iterator anim = animations.constBegin();
+                for (; anim != animations.constEnd(); ++anim, ++index) {
+                    if (!d->m_started.at(index))
                         continue;
                     if (!anim->timeLine.done()) {
                         addRepaint = true;
@@ -753,7 +896,7 @@ void AnimationEffect::postPaintScreen()
                     }
                 }
                 if (addRepaint) {
-                    it.key()->addLayerRepaint(it->second);
+                    d->m_windows.at(row)->addLayerRepaint(d->m_layerRects.at(row));
                 }
             }
         }
@@ -839,15 +982,13 @@ void AnimationEffect::setMetaData( MetaType type, uint value, uint &meta )
 void AnimationEffect::triggerRepaint()
 {
     Q_D(AnimationEffect);
-    for (AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd(); entry != mapEnd; ++entry)
-        *const_cast<QRect*>(&(entry->second)) = QRect();
+    d->m_layerRects.fill(QRect());
     updateLayerRepaints();
     if (d->m_needSceneRepaint) {
         effects->addRepaintFull();
     } else {
-        AniMap::const_iterator it = d->m_animations.constBegin(), end = d->m_animations.constEnd();
-        for (; it != end; ++it) {
-            it.key()->addLayerRepaint(it->second);
+        for (int row = 0; row < d->m_windows.count(); ++row) {
+            d->m_windows.at(row)->addLayerRepaint(d->m_layerRects.at(row));
         }
     }
 }
@@ -874,16 +1015,19 @@ void AnimationEffect::updateLayerRepaints()
 {
     Q_D(AnimationEffect);
     d->m_needSceneRepaint = false;
-    for (AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd(); entry != mapEnd; ++entry) {
-        if (!entry->second.isNull())
+    const qint64 now = clock();
+    for (int row = 0; row < d->m_windows.count(); ++row) {
+        if (!d->m_layerRects.at(row).isNull())
             continue;
+        EffectWindow *w = d->m_windows.at(row);
+        const QList<AniData> &animations = d->m_animations.at(row);
         float f[2] = {1.0, 1.0};
         float t[2] = {0.0, 0.0};
         bool createRegion = false;
         QList<QRect> rects;
-        QRect *layerRect = const_cast<QRect*>(&(entry->second));
-        for (QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd(); anim != animEnd; ++anim) {
-            if (anim->startTime > clock())
+        QRect *layerRect = &d->m_layerRects[row];
+        for (QList<AniData>::const_iterator anim = animations.constBegin(), animEnd = animations.constEnd(); anim != animEnd; ++anim) {
+            if (anim->startTime > now)
                 continue;
             switch (anim->attribute) {
                 case Opacity:
@@ -902,7 +1046,7 @@ void AnimationEffect::updateLayerRepaints()
                 case Translation:
                 case Position: {
                     createRegion = true;
-                    QRect r(entry.key()->geometry());
+                    QRect r(w->geometry());
                     int x[2] = {0,0};
                     int y[2] = {0,0};
                     if (anim->attribute == Translation) {
@@ -920,7 +1064,7 @@ void AnimationEffect::updateLayerRepaints()
                             y[1] = anim->to[1] - yCoord(r, metaData(TargetAnchor, anim->meta));
                         }
                     }
-                    r = entry.key()->expandedGeometry();
+                    r = w->expandedGeometry();
                     rects << r.translated(x[0], y[0]) << r.translated(x[1], y[1]);
                     break;
                 }
@@ -930,7 +1074,7 @@ void AnimationEffect::updateLayerRepaints()
                 case Size:
                 case Scale: {
                     createRegion = true;
-                    const QSize sz = entry.key()->geometry().size();
+                    const QSize sz = w->geometry().size();
                     float fx = qMax(fixOvershoot(anim->from[0], *anim, 1), fixOvershoot(anim->to[0], *anim, 2));
 //                     float fx = qMax(interpolated(*anim,0), anim->to[0]);
                     if (fx >= 0.0) {
@@ -958,7 +1102,7 @@ void AnimationEffect::updateLayerRepaints()
         }
 region_creation:
         if (createRegion) {
-            const QRect geo = entry.key()->expandedGeometry();
+            const QRect geo = w->expandedGeometry();
             if (rects.isEmpty())
                 rects << geo;
             QList<QRect>::const_iterator r, rEnd = rects.constEnd();
@@ -984,12 +1128,12 @@ void AnimationEffect::_expandedGeometryChanged(KWin::EffectWindow *w, const QRec
 {
     Q_UNUSED(old)
     Q_D(AnimationEffect);
-    AniMap::const_iterator entry = d->m_animations.constFind(w);
-    if (entry != d->m_animations.constEnd()) {
-        *const_cast<QRect*>(&(entry->second)) = QRect();
+    const int row = d->row(w);
+    if (row != -1) {
+        d->m_layerRects[row] = QRect();
         updateLayerRepaints();
-        if (!entry->second.isNull()) // actually got updated, ie. is in use - ensure it get's a repaint
-            w->addLayerRepaint(entry->second);
+        if (!d->m_layerRects.at(row).isNull()) // actually got updated, ie. is in use - ensure it get's a repaint
+            w->addLayerRepaint(d->m_layerRects.at(row));
     }
 }
 
@@ -997,14 +1141,14 @@ void AnimationEffect::_windowClosed( EffectWindow* w )
 {
     Q_D(AnimationEffect);
 
-    auto it = d->m_animations.find(w);
-    if (it == d->m_animations.end()) {
+    const int row = d->row(w);
+    if (row == -1) {
         return;
     }
 
     KeepAliveLockPtr keepAliveLock;
 
-    QList<AniData> &animations = (*it).first;
+    QList<AniData> &animations = d->m_animations[row];
     for (auto animationIt = animations.begin();
             animationIt != animations.end();
             ++animationIt) {
@@ -1023,7 +1167,10 @@ void AnimationEffect::_windowClosed( EffectWindow* w )
 void AnimationEffect::_windowDeleted( EffectWindow* w )
 {
     Q_D(AnimationEffect);
-    d->m_animations.remove( w );
+    const int row = d->row( w );
+    if (row != -1) {
+        d->removeRow( row );
+    }
 }
 
 
@@ -1031,16 +1178,16 @@ QString AnimationEffect::debug(const QString &/*parameter*/) const
 {
     Q_D(const AnimationEffect);
     QString dbg;
-    if (d->m_animations.isEmpty())
+    if (d->isEmpty())
         dbg = QStringLiteral("No window is animated");
     else {
-        AniMap::const_iterator entry = d->m_animations.constBegin(), mapEnd = d->m_animations.constEnd();
-        for (; entry != mapEnd; ++entry) {
-            QString caption = entry.key()->isDeleted() ? QStringLiteral("[Deleted]") : entry.key()->caption();
+        for (int row = 0; row < d->m_windows.count(); ++row) {
+            const EffectWindow *w = d->m_windows.at(row);
+            QString caption = w->isDeleted() ? QStringLiteral("[Deleted]") : w->caption();
             if (caption.isEmpty())
                 caption = QStringLiteral("[Untitled]");
             dbg += QLatin1String("Animating window: ") + caption + QLatin1Char('\n');
-            QList<AniData>::const_iterator anim = entry->first.constBegin(), animEnd = entry->first.constEnd();
+            QList<AniData>::const_iterator anim = d->m_animations.at(row).constBegin(), animEnd = d->m_animations.at(row).constEnd();
             for (; anim != animEnd; ++anim)
                 dbg += anim->debugInfo();
         }
@@ -1051,7 +1198,11 @@ QString AnimationEffect::debug(const QString &/*parameter*/) const
 AnimationEffect::AniMap AnimationEffect::state() const
 {
     Q_D(const AnimationEffect);
-    return d->m_animations;
+    AniMap state;
+    for (int row = 0; row < d->m_windows.count(); ++row) {
+        state.insert(d->m_windows.at(row), qMakePair(d->m_animations.at(row), d->m_layerRects.at(row)));
+    }
+    return state;
 }
 
 #include "moc_kwinanimationeffect.cpp"
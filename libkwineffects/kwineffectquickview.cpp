@@ -187,6 +187,9 @@ void EffectQuickView::update()
 
     if (d->m_useBlit) {
         d->m_image = d->m_renderControl->grab();
+    } else {
+        // read back lazily, see bufferAsImage
+        d->m_image = QImage();
     }
 
     if (usingGl) {
@@ -316,9 +319,20 @@ GLTexture *EffectQuickView::bufferAsTexture()
 
 QImage EffectQuickView::bufferAsImage() const
 {
+    if (!d->m_useBlit && d->m_image.isNull() && d->m_fbo) {
+        if (d->m_glcontext->makeCurrent(d->m_offscreenSurface.data())) {
+            d->m_image = d->m_fbo->toImage();
+            d->m_glcontext->doneCurrent();
+        }
+    }
     return d->m_image;
 }
 
+EffectQuickView::ExportMode EffectQuickView::exportMode() const
+{
+    return d->m_useBlit ? ExportMode::Image : ExportMode::Texture;
+}
+
 QSize EffectQuickView::size() const
 {
     return d->m_view->geometry().size();
@@ -63,7 +63,10 @@ public:
     static void setShareContext(std::unique_ptr<QOpenGLContext> context);
 
     enum class ExportMode {
-        /** The contents will be available as a texture in the shared contexts. Image will be blank*/
+        /**
+         * The contents will be available as a texture in the shared contexts.
+         * The image is only read back from the texture when it is requested.
+         */
         Texture,
         /** The contents will be blit during the update into a QImage buffer. */
         Image
@@ -87,6 +90,12 @@ public:
 
     QSize size() const;
 
+    /**
+     * The mode the contents are exported with. This is ExportMode::Image if it was requested,
+     * but also if the scene graph does not render with a context shared with the compositor.
+     */
+    ExportMode exportMode() const;
+
     /**
      * The geometry of the current view
      * This may be out of sync with the current buffer size if an update is pending
@@ -126,6 +135,9 @@ public:
 
     /**
      * Returns the current output of the scene graph
+     *
+     * In ExportMode::Texture the contents are read back from the texture the first time
+     * they are requested after an update. Note this may change the current GL context
      */
     QImage bufferAsImage() const;
 
@@ -224,7 +224,8 @@ enum DataRole {
     WindowBlurBehindRole, ///< For single windows to blur behind
     WindowForceBackgroundContrastRole, ///< For fullscreen effects to enforce the background contrast,
     WindowBackgroundContrastRole, ///< For single windows to enable Background contrast
-    LanczosCacheRole
+    LanczosCacheRole,
+    WindowForceFrameCallbacksRole ///< For effects which need the contents of a window to be kept up to date while it is not painted
 };
 
 /**
@@ -354,8 +355,15 @@ public:
         /**
          * Window will be painted with a lanczos filter.
          */
-        PAINT_WINDOW_LANCZOS = 1 << 8
+        PAINT_WINDOW_LANCZOS = 1 << 8,
         // PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_WITHOUT_FULL_REPAINTS = 1 << 9 has been removed
+        /**
+         * The screen is painted into an offscreen target which keeps its contents between
+         * frames, the effect setting it presents the target on the whole screen. Only the
+         * damaged region is painted into the target, regardless of the age of the back buffer.
+         * @since 5.18
+         */
+        PAINT_SCREEN_OFFSCREEN = 1 << 10
     };
 
     enum Feature {
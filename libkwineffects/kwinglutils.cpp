@@ -999,6 +999,7 @@ GLShader *ShaderManager::pushShader(ShaderTraits traits)
 
 void ShaderManager::pushShader(GLShader *shader)
 {
+    flushDeferredDraws();
     // only bind shader if it is not already bound
     if (shader != getBoundShader()) {
         shader->bind();
@@ -1006,6 +1007,22 @@ void ShaderManager::pushShader(GLShader *shader)
     m_boundShaders.push(shader);
 }
 
+void ShaderManager::setDeferredDrawsFlush(std::function<void()> flush)
+{
+    m_deferredDrawsFlush = std::move(flush);
+}
+
+void ShaderManager::flushDeferredDraws()
+{
+    if (!m_deferredDrawsFlush) {
+        return;
+    }
+    // reset first, the flush pushes shaders itself
+    const std::function<void()> flush = std::move(m_deferredDrawsFlush);
+    m_deferredDrawsFlush = nullptr;
+    flush();
+}
+
 void ShaderManager::popShader()
 {
     if (m_boundShaders.isEmpty()) {
@@ -1050,6 +1067,7 @@ QSize GLRenderTarget::s_virtualScreenSize;
 QRect GLRenderTarget::s_virtualScreenGeometry;
 qreal GLRenderTarget::s_virtualScreenScale = 1.0;
 GLint GLRenderTarget::s_virtualScreenViewport[4];
+GLRenderTarget *GLRenderTarget::s_screenTarget = nullptr;
 
 void GLRenderTarget::initStatic()
 {
@@ -1086,6 +1104,7 @@ bool GLRenderTarget::blitSupported()
 
 void GLRenderTarget::pushRenderTarget(GLRenderTarget* target)
 {
+    ShaderManager::instance()->flushDeferredDraws();
     if (s_renderTargets.isEmpty()) {
         glGetIntegerv(GL_VIEWPORT, s_virtualScreenViewport);
     }
@@ -1095,6 +1114,7 @@ void GLRenderTarget::pushRenderTarget(GLRenderTarget* target)
 
 void GLRenderTarget::pushRenderTargets(QStack <GLRenderTarget*> targets)
 {
+    ShaderManager::instance()->flushDeferredDraws();
     if (s_renderTargets.isEmpty()) {
         glGetIntegerv(GL_VIEWPORT, s_virtualScreenViewport);
     }
@@ -1278,9 +1298,10 @@ void GLRenderTarget::blitFromFramebuffer(const QRect &source, const QRect &desti
         initFBO();
     }
 
+    // reads the screen, so pending draws have to land first
     GLRenderTarget::pushRenderTarget(this);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mFramebuffer);
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, s_screenTarget ? s_screenTarget->mFramebuffer : 0);
     const QRect s = source.isNull() ? s_virtualScreenGeometry : source;
     const QRect d = destination.isNull() ? QRect(0, 0, mTexture.width(), mTexture.height()) : destination;
 
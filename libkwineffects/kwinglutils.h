@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QSize>
 #include <QStack>
 
+#include <functional>
+
 /** @addtogroup kwineffects */
 /** @{ */
 
@@ -307,6 +309,23 @@ public:
      */
     bool selfTest();
 
+    /**
+     * Installs a function which submits draw calls the compositor recorded but did not
+     * issue yet. It is invoked once before the next shader or render target is pushed,
+     * or when @link flushDeferredDraws @endlink is called. Pass an empty function to
+     * discard a previously installed one.
+     * @internal
+     * @since 5.18
+     */
+    void setDeferredDrawsFlush(std::function<void()> flush);
+
+    /**
+     * Submits the draw calls deferred by the compositor. Effects which read the
+     * framebuffer without pushing a shader or a render target have to call this first.
+     * @since 5.18
+     */
+    void flushDeferredDraws();
+
     /**
      * @return a pointer to the ShaderManager instance
      */
@@ -332,6 +351,7 @@ private:
     QHash<ShaderTraits, GLShader *> m_shaderHash;
     bool m_debug;
     QString m_resourcePath;
+    std::function<void()> m_deferredDrawsFlush;
     static ShaderManager *s_shaderManager;
 };
 
@@ -544,6 +564,17 @@ public:
         return s_virtualScreenScale;
     }
 
+    /**
+     * Makes @p target stand in for the screen while the screen is painted into it, so that
+     * blitFromFramebuffer() reads the screen contents from @p target instead of the default
+     * framebuffer. The target has to cover the virtual screen geometry. Pass @c nullptr once
+     * the screen is painted directly again.
+     * @since 5.18
+     */
+    static void setScreenTarget(GLRenderTarget *target) {
+        s_screenTarget = target;
+    }
+
 
 protected:
     void initFBO();
@@ -559,6 +590,7 @@ private:
     static QRect s_virtualScreenGeometry;
     static qreal s_virtualScreenScale;
     static GLint s_virtualScreenViewport[4];
+    static GLRenderTarget *s_screenTarget;
 
     GLTexture mTexture;
     bool mValid;
@@ -225,10 +225,14 @@ protected:
     /**
      * Inheriting classes should use this method to set the xcb connection
      * before accessing any X11 specific code pathes.
+     * If @p announce is @c false the caller has to emit x11ConnectionChanged once the
+     * connection is ready to be used.
      */
-    void setX11Connection(xcb_connection_t *c) {
+    void setX11Connection(xcb_connection_t *c, bool announce = true) {
         m_connection = c;
-        emit x11ConnectionChanged();
+        if (announce) {
+            emit x11ConnectionChanged();
+        }
     }
     void destroyAtoms();
     void destroyPlatform();
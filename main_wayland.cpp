@@ -209,8 +209,14 @@ void ApplicationWayland::continueStartupWithScene()
         std::cerr << "Xwayland had a critical error. Going to exit now." << std::endl;
         exit(code);
     });
+    // Xwayland is started once the first X11 client connects, the workspace picks up
+    // the X11 connection when it gets established
     connect(m_xwayland, &Xwl::Xwayland::initialized, this, &ApplicationWayland::finalizeStartup);
-    m_xwayland->init();
+    m_xwayland->listen();
+    if (m_xwayland->isListening()) {
+        finalizeStartup();
+    }
+    // otherwise Xwayland got started right away and the session needs its DISPLAY
 }
 
 void ApplicationWayland::startSession()
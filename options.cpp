@@ -109,11 +109,15 @@ Options::Options(QObject *parent)
     , m_compositingMode(Options::defaultCompositingMode())
     , m_useCompositing(Options::defaultUseCompositing())
     , m_hiddenPreviews(Options::defaultHiddenPreviews())
+    , m_hiddenPreviewsBudget(Options::defaultHiddenPreviewsBudget())
+    , m_preciseDamageRegions(Options::defaultPreciseDamageRegions())
     , m_glSmoothScale(Options::defaultGlSmoothScale())
     , m_xrenderSmoothScale(Options::defaultXrenderSmoothScale())
     , m_maxFpsInterval(Options::defaultMaxFpsInterval())
     , m_refreshRate(Options::defaultRefreshRate())
     , m_vBlankTime(Options::defaultVBlankTime())
+    , m_occludedFrameRate(Options::defaultOccludedFrameRate())
+    , m_textureMemoryBudget(Options::defaultTextureMemoryBudget())
     , m_glStrictBinding(Options::defaultGlStrictBinding())
     , m_glStrictBindingFollowsDriver(Options::defaultGlStrictBindingFollowsDriver())
     , m_glCoreProfile(Options::defaultGLCoreProfile())
@@ -589,6 +593,24 @@ void Options::setHiddenPreviews(int hiddenPreviews)
     emit hiddenPreviewsChanged();
 }
 
+void Options::setHiddenPreviewsBudget(uint hiddenPreviewsBudget)
+{
+    if (m_hiddenPreviewsBudget == hiddenPreviewsBudget) {
+        return;
+    }
+    m_hiddenPreviewsBudget = hiddenPreviewsBudget;
+    emit hiddenPreviewsBudgetChanged();
+}
+
+void Options::setPreciseDamageRegions(bool preciseDamageRegions)
+{
+    if (m_preciseDamageRegions == preciseDamageRegions) {
+        return;
+    }
+    m_preciseDamageRegions = preciseDamageRegions;
+    emit preciseDamageRegionsChanged();
+}
+
 void Options::setGlSmoothScale(int glSmoothScale)
 {
     if (m_glSmoothScale == glSmoothScale) {
@@ -634,6 +656,24 @@ void Options::setVBlankTime(qint64 vBlankTime)
     emit vBlankTimeChanged();
 }
 
+void Options::setOccludedFrameRate(uint occludedFrameRate)
+{
+    if (m_occludedFrameRate == occludedFrameRate) {
+        return;
+    }
+    m_occludedFrameRate = occludedFrameRate;
+    emit occludedFrameRateChanged();
+}
+
+void Options::setTextureMemoryBudget(uint textureMemoryBudget)
+{
+    if (m_textureMemoryBudget == textureMemoryBudget) {
+        return;
+    }
+    m_textureMemoryBudget = textureMemoryBudget;
+    emit textureMemoryBudgetChanged();
+}
+
 void Options::setGlStrictBinding(bool glStrictBinding)
 {
     if (m_glStrictBinding == glStrictBinding) {
@@ -786,6 +826,8 @@ void Options::loadConfig()
     setMaxFpsInterval(1 * 1000 * 1000 * 1000 / config.readEntry("MaxFPS", Options::defaultMaxFps()));
     setRefreshRate(config.readEntry("RefreshRate", Options::defaultRefreshRate()));
     setVBlankTime(config.readEntry("VBlankTime", Options::defaultVBlankTime()) * 1000); // config in micro, value in nano resolution
+    setOccludedFrameRate(config.readEntry("OccludedFrameRate", Options::defaultOccludedFrameRate()));
+    setTextureMemoryBudget(config.readEntry("TextureMemoryBudget", Options::defaultTextureMemoryBudget()));
 
     // Modifier Only Shortcuts
     config = KConfigGroup(m_settings->config(), "ModifierOnlyShortcuts");
@@ -938,6 +980,8 @@ void Options::reloadCompositingSettings(bool force)
     else if (hps == 6)
         previews = HiddenPreviewsAlways;
     setHiddenPreviews(previews);
+    setHiddenPreviewsBudget(config.readEntry("HiddenPreviewsBudget", Options::defaultHiddenPreviewsBudget()));
+    setPreciseDamageRegions(config.readEntry("PreciseDamageRegions", Options::defaultPreciseDamageRegions()));
 
     auto interfaceToKey = [](OpenGLPlatformInterface interface) {
         switch (interface) {
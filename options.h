@@ -163,6 +163,17 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(int compositingMode READ compositingMode WRITE setCompositingMode NOTIFY compositingModeChanged)
     Q_PROPERTY(bool useCompositing READ isUseCompositing WRITE setUseCompositing NOTIFY useCompositingChanged)
     Q_PROPERTY(int hiddenPreviews READ hiddenPreviews WRITE setHiddenPreviews NOTIFY hiddenPreviewsChanged)
+    /**
+     * The amount of memory in MiB the window pixmaps of X11 windows on other desktops, which are
+     * kept mapped for hidden previews, may occupy, @c 0 for no limit. Windows on the desktops
+     * the user is likely to switch to next are kept first.
+     */
+    Q_PROPERTY(uint hiddenPreviewsBudget READ hiddenPreviewsBudget WRITE setHiddenPreviewsBudget NOTIFY hiddenPreviewsBudgetChanged)
+    /**
+     * Whether the damage of X11 windows is repainted rectangle by rectangle. Otherwise damage
+     * regions with 16 or more rectangles are repainted as their bounding rectangle.
+     */
+    Q_PROPERTY(bool preciseDamageRegions READ isPreciseDamageRegions WRITE setPreciseDamageRegions NOTIFY preciseDamageRegionsChanged)
     /**
      * 0 = no, 1 = yes when transformed,
      * 2 = try trilinear when transformed; else 1,
@@ -173,6 +184,16 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(qint64 maxFpsInterval READ maxFpsInterval WRITE setMaxFpsInterval NOTIFY maxFpsIntervalChanged)
     Q_PROPERTY(uint refreshRate READ refreshRate WRITE setRefreshRate NOTIFY refreshRateChanged)
     Q_PROPERTY(qint64 vBlankTime READ vBlankTime WRITE setVBlankTime NOTIFY vBlankTimeChanged)
+    /**
+     * The rate in Hz at which Wayland clients whose contents are not visible get frame callbacks,
+     * @c 0 to withhold them until the client becomes visible again.
+     */
+    Q_PROPERTY(uint occludedFrameRate READ occludedFrameRate WRITE setOccludedFrameRate NOTIFY occludedFrameRateChanged)
+    /**
+     * The amount of memory in MiB the window textures of the OpenGL compositor may occupy,
+     * @c 0 for no limit. Over budget, the textures of windows on other desktops get released.
+     */
+    Q_PROPERTY(uint textureMemoryBudget READ textureMemoryBudget WRITE setTextureMemoryBudget NOTIFY textureMemoryBudgetChanged)
     Q_PROPERTY(bool glStrictBinding READ isGlStrictBinding WRITE setGlStrictBinding NOTIFY glStrictBindingChanged)
     /**
      * Whether strict binding follows the driver or has been overwritten by a user defined config value.
@@ -535,6 +556,12 @@ public:
     HiddenPreviews hiddenPreviews() const {
         return m_hiddenPreviews;
     }
+    uint hiddenPreviewsBudget() const {
+        return m_hiddenPreviewsBudget;
+    }
+    bool isPreciseDamageRegions() const {
+        return m_preciseDamageRegions;
+    }
     // OpenGL
     // 0 = no, 1 = yes when transformed,
     // 2 = try trilinear when transformed; else 1,
@@ -557,6 +584,12 @@ public:
     qint64 vBlankTime() const {
         return m_vBlankTime;
     }
+    uint occludedFrameRate() const {
+        return m_occludedFrameRate;
+    }
+    uint textureMemoryBudget() const {
+        return m_textureMemoryBudget;
+    }
     bool isGlStrictBinding() const {
         return m_glStrictBinding;
     }
@@ -628,11 +661,15 @@ public:
     void setCompositingMode(int compositingMode);
     void setUseCompositing(bool useCompositing);
     void setHiddenPreviews(int hiddenPreviews);
+    void setHiddenPreviewsBudget(uint hiddenPreviewsBudget);
+    void setPreciseDamageRegions(bool preciseDamageRegions);
     void setGlSmoothScale(int glSmoothScale);
     void setXrenderSmoothScale(bool xrenderSmoothScale);
     void setMaxFpsInterval(qint64 maxFpsInterval);
     void setRefreshRate(uint refreshRate);
     void setVBlankTime(qint64 vBlankTime);
+    void setOccludedFrameRate(uint occludedFrameRate);
+    void setTextureMemoryBudget(uint textureMemoryBudget);
     void setGlStrictBinding(bool glStrictBinding);
     void setGlStrictBindingFollowsDriver(bool glStrictBindingFollowsDriver);
     void setGLCoreProfile(bool glCoreProfile);
@@ -710,6 +747,12 @@ public:
     static HiddenPreviews defaultHiddenPreviews() {
         return HiddenPreviewsShown;
     }
+    static uint defaultHiddenPreviewsBudget() {
+        return 0;
+    }
+    static bool defaultPreciseDamageRegions() {
+        return false;
+    }
     static int defaultGlSmoothScale() {
         return 2;
     }
@@ -728,6 +771,12 @@ public:
     static uint defaultVBlankTime() {
         return 6000; // 6ms
     }
+    static uint defaultOccludedFrameRate() {
+        return 1;
+    }
+    static uint defaultTextureMemoryBudget() {
+        return 0;
+    }
     static bool defaultGlStrictBinding() {
         return true;
     }
@@ -804,11 +853,15 @@ Q_SIGNALS:
     void compositingModeChanged();
     void useCompositingChanged();
     void hiddenPreviewsChanged();
+    void hiddenPreviewsBudgetChanged();
+    void preciseDamageRegionsChanged();
     void glSmoothScaleChanged();
     void xrenderSmoothScaleChanged();
     void maxFpsIntervalChanged();
     void refreshRateChanged();
     void vBlankTimeChanged();
+    void occludedFrameRateChanged();
+    void textureMemoryBudgetChanged();
     void glStrictBindingChanged();
     void glStrictBindingFollowsDriverChanged();
     void glCoreProfileChanged();
@@ -847,12 +900,16 @@ private:
     CompositingType m_compositingMode;
     bool m_useCompositing;
     HiddenPreviews m_hiddenPreviews;
+    uint m_hiddenPreviewsBudget;
+    bool m_preciseDamageRegions;
     int m_glSmoothScale;
     bool m_xrenderSmoothScale;
     qint64 m_maxFpsInterval;
     // Settings that should be auto-detected
     uint m_refreshRate;
     qint64 m_vBlankTime;
+    uint m_occludedFrameRate;
+    uint m_textureMemoryBudget;
     bool m_glStrictBinding;
     bool m_glStrictBindingFollowsDriver;
     bool m_glCoreProfile;
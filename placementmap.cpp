@@ -0,0 +1,267 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "placementmap.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+static int edgeIndex(const QVector<int> &edges, int value)
+{
+    return std::lower_bound(edges.constBegin(), edges.constEnd(), value) - edges.constBegin();
+}
+
+PlacementMap::PlacementMap(const QVector<Window> &windows)
+    : m_windows(windows)
+{
+    for (const Window &window : windows) {
+        if (window.weight == 0 || window.geometry.isEmpty()) {
+            continue;
+        }
+        m_xEdges << window.geometry.x() << window.geometry.x() + window.geometry.width();
+        m_yEdges << window.geometry.y() << window.geometry.y() + window.geometry.height();
+    }
+    std::sort(m_xEdges.begin(), m_xEdges.end());
+    m_xEdges.erase(std::unique(m_xEdges.begin(), m_xEdges.end()), m_xEdges.end());
+    std::sort(m_yEdges.begin(), m_yEdges.end());
+    m_yEdges.erase(std::unique(m_yEdges.begin(), m_yEdges.end()), m_yEdges.end());
+
+    const int columns = m_xEdges.count();
+    const int rows = m_yEdges.count();
+    if (columns == 0) {
+        return;
+    }
+
+    // the weight of each grid cell, rasterized with a difference array
+    QVector<qint64> weights(columns * rows, 0);
+    for (const Window &window : windows) {
+        if (window.weight == 0 || window.geometry.isEmpty()) {
+            continue;
+        }
+        const int left = edgeIndex(m_xEdges, window.geometry.x());
+        const int right = edgeIndex(m_xEdges, window.geometry.x() + window.geometry.width());
+        const int top = edgeIndex(m_yEdges, window.geometry.y());
+        const int bottom = edgeIndex(m_yEdges, window.geometry.y() + window.geometry.height());
+        weights[top * columns + left] += window.weight;
+        weights[top * columns + right] -= window.weight;
+        weights[bottom * columns + left] -= window.weight;
+        weights[bottom * columns + right] += window.weight;
+    }
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            qint64 &weight = weights[row * columns + column];
+            if (column > 0) {
+                weight += weights[row * columns + column - 1];
+            }
+            if (row > 0) {
+                weight += weights[(row - 1) * columns + column];
+            }
+            if (row > 0 && column > 0) {
+                weight -= weights[(row - 1) * columns + column - 1];
+            }
+        }
+    }
+
+    m_table.fill(0, columns * rows);
+    for (int row = 1; row < rows; ++row) {
+        const qint64 height = m_yEdges[row] - m_yEdges[row - 1];
+        for (int column = 1; column < columns; ++column) {
+            const qint64 width = m_xEdges[column] - m_xEdges[column - 1];
+            m_table[row * columns + column] = table(column - 1, row) + table(column, row - 1)
+                - table(column - 1, row - 1)
+                + weights[(row - 1) * columns + column - 1] * width * height;
+        }
+    }
+}
+
+qint64 PlacementMap::integral(int x, int y) const
+{
+    if (m_xEdges.isEmpty() || x <= m_xEdges.first() || y <= m_yEdges.first()) {
+        return 0;
+    }
+    x = qMin(x, m_xEdges.last());
+    y = qMin(y, m_yEdges.last());
+
+    // the grid point at or left of and above the position
+    const int column = std::upper_bound(m_xEdges.constBegin(), m_xEdges.constEnd(), x) - m_xEdges.constBegin() - 1;
+    const int row = std::upper_bound(m_yEdges.constBegin(), m_yEdges.constEnd(), y) - m_yEdges.constBegin() - 1;
+    const qint64 dx = x - m_xEdges[column];
+    const qint64 dy = y - m_yEdges[row];
+    qint64 result = table(column, row);
+    if (dx == 0 && dy == 0) {
+        return result;
+    }
+
+    // inside a cell the weight is constant, so the integral is bilinear between the grid points
+    const qint64 width = dx ? m_xEdges[column + 1] - m_xEdges[column] : 1;
+    const qint64 height = dy ? m_yEdges[row + 1] - m_yEdges[row] : 1;
+    if (dx) {
+        result += dx * (table(column + 1, row) - table(column, row)) / width;
+    }
+    if (dy) {
+        result += dy * (table(column, row + 1) - table(column, row)) / height;
+    }
+    if (dx && dy) {
+        const qint64 cell = table(column + 1, row + 1) - table(column + 1, row)
+            - table(column, row + 1) + table(column, row);
+        result += dx * dy * (cell / (width * height));
+    }
+    return result;
+}
+
+qint64 PlacementMap::overlap(const QRect &rect, Method method) const
+{
+    const int left = rect.x();
+    const int top = rect.y();
+    const int right = rect.x() + rect.width();
+    const int bottom = rect.y() + rect.height();
+
+    if (method == SummedAreaTable) {
+        return integral(right, bottom) - integral(left, bottom) - integral(right, top) + integral(left, top);
+    }
+
+    qint64 overlap = 0;
+    for (const Window &window : m_windows) {
+        int xl = window.geometry.x();
+        int yt = window.geometry.y();
+        int xr = xl + window.geometry.width();
+        int yb = yt + window.geometry.height();
+        if ((left < xr) && (right > xl) && (top < yb) && (bottom > yt)) {
+            xl = qMax(left, xl); xr = qMin(right, xr);
+            yt = qMax(top, yt); yb = qMin(bottom, yb);
+            overlap += qint64(window.weight) * (xr - xl) * (yb - yt);
+        }
+    }
+    return overlap;
+}
+
+QPoint PlacementMap::smartPosition(const QSize &size, const QRect &area, Method method) const
+{
+    /*
+     * SmartPlacement by Cristian Tibirna (tibirna@kde.org)
+     * adapted for kwm (16-19jan98) and for kwin (16Nov1999) using (with
+     * permission) ideas from fvwm, authored by
+     * Anthony Martin (amartin@engr.csulb.edu).
+     * Xinerama supported added by Balaji Ramani (balaji@yablibli.com)
+     * with ideas from xfce.
+     */
+
+    const qint64 none = 0, h_wrong = -1, w_wrong = -2; // overlap types
+    qint64 overlap, min_overlap = 0;
+    int x_optimal, y_optimal;
+    int possible;
+
+    int xl, xr, yt, yb;     //temp coords
+    int basket;                 //temp holder
+
+    // get the maximum allowed windows space
+    int x = area.left();
+    int y = area.top();
+    x_optimal = x; y_optimal = y;
+
+    //client gabarit
+    const int ch = size.height() - 1;
+    const int cw = size.width()  - 1;
+
+    bool first_pass = true; //CT lame flag. Don't like it. What else would do?
+
+    //loop over possible positions
+    do {
+        //test if enough room in x and y directions
+        if (y + ch > area.bottom() && ch < area.height()) {
+            overlap = h_wrong; // this throws the algorithm to an exit
+        } else if (x + cw > area.right()) {
+            overlap = w_wrong;
+        } else {
+            overlap = this->overlap(QRect(x, y, cw, ch), method);
+        }
+
+        //CT first time we get no overlap we stop.
+        if (overlap == none) {
+            x_optimal = x;
+            y_optimal = y;
+            break;
+        }
+
+        if (first_pass) {
+            first_pass = false;
+            min_overlap = overlap;
+        }
+        //CT save the best position and the minimum overlap up to now
+        else if (overlap >= none && overlap < min_overlap) {
+            min_overlap = overlap;
+            x_optimal = x;
+            y_optimal = y;
+        }
+
+        // really need to loop? test if there's any overlap
+        if (overlap > none) {
+
+            possible = area.right();
+            if (possible - cw > x) possible -= cw;
+
+            // compare to the position of each client on the same desk
+            for (const Window &window : m_windows) {
+                xl = window.geometry.x();          yt = window.geometry.y();
+                xr = xl + window.geometry.width(); yb = yt + window.geometry.height();
+
+                // if not enough room above or under the current tested client
+                // determine the first non-overlapped x position
+                if ((y < yb) && (yt < ch + y)) {
+
+                    if ((xr > x) && (possible > xr)) possible = xr;
+
+                    basket = xl - cw;
+                    if ((basket > x) && (possible > basket)) possible = basket;
+                }
+            }
+            x = possible;
+        }
+
+        // ... else ==> not enough x dimension (overlap was wrong on horizontal)
+        else if (overlap == w_wrong) {
+            x = area.left();
+            possible = area.bottom();
+
+            if (possible - ch > y) possible -= ch;
+
+            //test the position of each window on the desk
+            for (const Window &window : m_windows) {
+                yt = window.geometry.y();
+                yb = yt + window.geometry.height();
+
+                // if not enough room to the left or right of the current tested client
+                // determine the first non-overlapped y position
+                if ((yb > y) && (possible > yb)) possible = yb;
+
+                basket = yt - ch;
+                if ((basket > y) && (possible > basket)) possible = basket;
+            }
+            y = possible;
+        }
+    } while ((overlap != none) && (overlap != h_wrong) && (y < area.bottom()));
+
+    if (ch >= area.height()) {
+        y_optimal = area.top();
+    }
+
+    return QPoint(x_optimal, y_optimal);
+}
+
+}
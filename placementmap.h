@@ -0,0 +1,91 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_PLACEMENTMAP_H
+#define KWIN_PLACEMENTMAP_H
+
+#include <kwinglobals.h>
+
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * @short Weighted occupancy of the windows considered by the smart placement.
+ *
+ * The geometries of the windows are rasterized once into a summed-area table over the grid
+ * spanned by their edges, the weighted overlap of any rectangle with the windows can then be
+ * looked up in logarithmic time instead of iterating all windows. As the table is built from
+ * the exact window edges, the overlap is the same as the one summed up window by window.
+ */
+class KWIN_EXPORT PlacementMap
+{
+public:
+    struct Window
+    {
+        QRect geometry;
+        /**
+         * Factor the overlapping area with the window is weighted with, @c 0 if the window
+         * may be covered freely.
+         */
+        int weight;
+    };
+
+    enum Method {
+        SummedAreaTable,
+        /**
+         * Sums the overlap up window by window, as smart placement always did.
+         */
+        BruteForce
+    };
+
+    explicit PlacementMap(const QVector<Window> &windows);
+
+    /**
+     * Weighted area in which @p rect overlaps the windows.
+     */
+    qint64 overlap(const QRect &rect, Method method = SummedAreaTable) const;
+
+    /**
+     * Finds the position with the least overlap for a window of @p size inside @p area with
+     * the smart placement algorithm by Cristian Tibirna. The first position without any
+     * overlap is taken, otherwise the first one with the minimal overlap.
+     */
+    QPoint smartPosition(const QSize &size, const QRect &area, Method method = SummedAreaTable) const;
+
+private:
+    qint64 integral(int x, int y) const;
+    qint64 table(int column, int row) const {
+        return m_table[row * m_xEdges.count() + column];
+    }
+
+    QVector<Window> m_windows;
+    QVector<int> m_xEdges;
+    QVector<int> m_yEdges;
+    /**
+     * Weighted area of the windows left of and above each grid point.
+     */
+    QVector<qint64> m_table;
+};
+
+}
+
+#endif
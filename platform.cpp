@@ -214,8 +214,8 @@ void Platform::triggerCursorRepaint()
     if (!Compositor::self()) {
         return;
     }
-    Compositor::self()->addRepaint(m_cursor.lastRenderedGeometry);
-    Compositor::self()->addRepaint(QRect(Cursor::pos() - softwareCursorHotspot(), softwareCursor().size()));
+    Compositor::self()->addCursorRepaint(m_cursor.lastRenderedGeometry);
+    Compositor::self()->addCursorRepaint(QRect(Cursor::pos() - softwareCursorHotspot(), softwareCursor().size()));
 }
 
 void Platform::markCursorAsRendered()
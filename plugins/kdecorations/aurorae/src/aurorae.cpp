@@ -324,12 +324,20 @@ void Decoration::init()
         m_item->setParentItem(visualParent.value<QQuickItem*>());
         visualParent.value<QQuickItem*>()->setProperty("drawBackground", false);
     } else {
-        m_view = new KWin::EffectQuickView(this, KWin::EffectQuickView::ExportMode::Image);
+        // the view falls back to an image itself if it cannot share its texture with the compositor
+        m_view = new KWin::EffectQuickView(this, KWin::EffectQuickView::ExportMode::Texture);
         m_item->setParentItem(m_view->contentItem());
         auto updateSize = [this]() { m_item->setSize(m_view->contentItem()->size()); };
         updateSize();
         connect(m_view->contentItem(), &QQuickItem::widthChanged, m_item, updateSize);
         connect(m_view->contentItem(), &QQuickItem::heightChanged, m_item, updateSize);
+        m_shadowAnimationTimer = new QTimer(this);
+        m_shadowAnimationTimer->setSingleShot(true);
+        connect(m_shadowAnimationTimer, &QTimer::timeout, this, [this] {
+            // the buffer after the last step of the animation
+            m_shadowGeneration++;
+            updateShadow();
+        });
         connect(m_view, &KWin::EffectQuickView::repaintNeeded, this, &Decoration::updateBuffer);
     }
     setupBorders(m_item);
@@ -371,6 +379,24 @@ void Decoration::init()
         connect(client().data(), &KDecoration2::DecoratedClient::maximizedChanged, this, resizeWindow);
         connect(client().data(), &KDecoration2::DecoratedClient::shadedChanged, this, resizeWindow);
         resizeWindow();
+        auto markShadowChanged = [this] {
+            m_shadowGeneration++;
+        };
+        auto markShadowAnimated = [this] {
+            m_shadowGeneration++;
+            // the theme cross-fades e.g. the active and inactive frames, the shadow is taken
+            // again from the buffer after the animation
+            m_shadowAnimationTimer->start(animationDuration());
+        };
+        connect(client().data(), &KDecoration2::DecoratedClient::activeChanged, this, markShadowAnimated);
+        connect(this, &Decoration::configChanged, this, markShadowAnimated);
+        connect(client().data(), &KDecoration2::DecoratedClient::maximizedChanged, this, markShadowChanged);
+        if (m_padding) {
+            connect(m_padding, &KWin::Borders::leftChanged, this, markShadowChanged);
+            connect(m_padding, &KWin::Borders::rightChanged, this, markShadowChanged);
+            connect(m_padding, &KWin::Borders::topChanged, this, markShadowChanged);
+            connect(m_padding, &KWin::Borders::bottomChanged, this, markShadowChanged);
+        }
         updateBuffer();
     } else {
         // create a dummy shadow for the configuration interface
@@ -426,19 +452,16 @@ void Decoration::updateShadow()
     if (!m_view) {
         return;
     }
-    bool updateShadow = false;
+    // nothing which affects the shadow changed since it got extracted, reading the buffer
+    // back and comparing it would only find the same shadow
+    if (m_shadowGeneration == m_extractedShadowGeneration) {
+        return;
+    }
+    m_extractedShadowGeneration = m_shadowGeneration;
     const auto oldShadow = shadow();
     if (m_padding &&
             (m_padding->left() > 0 || m_padding->top() > 0 || m_padding->right() > 0 || m_padding->bottom() > 0) &&
             !client().data()->isMaximized()) {
-        if (oldShadow.isNull()) {
-            updateShadow = true;
-        } else {
-            // compare padding
-            if (oldShadow->padding() != *m_padding) {
-                updateShadow = true;
-            }
-        }
         const QImage m_buffer = m_view->bufferAsImage();
 
         QImage img(m_buffer.size(), QImage::Format_ARGB32_Premultiplied);
@@ -456,19 +479,14 @@ void Decoration::updateShadow()
         p.drawImage(m_buffer.width() - m_padding->right(), m_padding->top(), m_buffer,
                     m_buffer.width() - m_padding->right(), m_padding->top(),
                     m_padding->right(), m_buffer.height() - m_padding->top() - m_padding->bottom());
-        if (!updateShadow) {
-            updateShadow = (oldShadow->shadow() != img);
-        }
-        if (updateShadow) {
-            auto s = QSharedPointer<KDecoration2::DecorationShadow>::create();
-            s->setShadow(img);
-            s->setPadding(*m_padding);
-            s->setInnerShadowRect(QRect(m_padding->left(),
-                                        m_padding->top(),
-                                        m_buffer.width() - m_padding->left() - m_padding->right(),
-                                        m_buffer.height() - m_padding->top() - m_padding->bottom()));
-            setShadow(s);
-        }
+        auto s = QSharedPointer<KDecoration2::DecorationShadow>::create();
+        s->setShadow(img);
+        s->setPadding(*m_padding);
+        s->setInnerShadowRect(QRect(m_padding->left(),
+                                    m_padding->top(),
+                                    m_buffer.width() - m_padding->left() - m_padding->right(),
+                                    m_buffer.height() - m_padding->top() - m_padding->bottom()));
+        setShadow(s);
     } else {
         if (!oldShadow.isNull()) {
             setShadow(QSharedPointer<KDecoration2::DecorationShadow>());
@@ -476,6 +494,15 @@ void Decoration::updateShadow()
     }
 }
 
+int Decoration::animationDuration() const
+{
+    if (auto theme = qobject_cast<AuroraeTheme *>(m_qmlContext->contextProperty(QStringLiteral("auroraeTheme")).value<QObject *>())) {
+        return theme->animationTime();
+    }
+    // QML themes like Plastik provide the duration of their animations on the root item
+    return m_item ? m_item->property("animationDuration").toInt() : 0;
+}
+
 void Decoration::hoverEnterEvent(QHoverEvent *event)
 {
     if (m_view) {
@@ -582,12 +609,21 @@ void Decoration::updateExtendedBorders()
 
 void Decoration::updateBuffer()
 {
-    m_contentRect = QRect(QPoint(0, 0), m_view->bufferAsImage().size());
+    // the buffer was just rendered, so it has the size of the view; reading the size of
+    // the image would read back the texture
+    const QSize bufferSize = m_view->exportMode() == KWin::EffectQuickView::ExportMode::Texture
+        ? m_view->size() : m_view->bufferAsImage().size();
+    QRect contentRect(QPoint(0, 0), bufferSize);
     if (m_padding &&
             (m_padding->left() > 0 || m_padding->top() > 0 || m_padding->right() > 0 || m_padding->bottom() > 0) &&
             !client().data()->isMaximized()) {
-        m_contentRect = m_contentRect.adjusted(m_padding->left(), m_padding->top(), -m_padding->right(), -m_padding->bottom());
+        contentRect = contentRect.adjusted(m_padding->left(), m_padding->top(), -m_padding->right(), -m_padding->bottom());
+    }
+    if (m_contentRect != contentRect) {
+        m_contentRect = contentRect;
+        m_shadowGeneration++;
     }
+    // the shadow is only extracted after changes which can affect it, e.g. not on hover
     updateShadow();
     update();
 }
@@ -597,6 +633,14 @@ KDecoration2::DecoratedClient *Decoration::clientPointer() const
     return client().data();
 }
 
+QObject *Decoration::bufferView() const
+{
+    if (m_view && m_view->exportMode() == KWin::EffectQuickView::ExportMode::Texture) {
+        return m_view;
+    }
+    return nullptr;
+}
+
 ThemeFinder::ThemeFinder(QObject *parent, const QVariantList &args)
     : QObject(parent)
 {
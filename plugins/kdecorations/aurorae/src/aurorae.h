@@ -27,6 +27,7 @@ class QQmlComponent;
 class QQmlContext;
 class QQmlEngine;
 class QQuickItem;
+class QTimer;
 
 class KConfigLoader;
 
@@ -43,6 +44,15 @@ class Decoration : public KDecoration2::Decoration
 {
     Q_OBJECT
     Q_PROPERTY(KDecoration2::DecoratedClient* client READ clientPointer CONSTANT)
+    /**
+     * The view rendering the decoration, if its contents are available as a texture shared
+     * with the compositor. The compositor can use the texture instead of painting the decoration.
+     */
+    Q_PROPERTY(QObject *bufferView READ bufferView)
+    /**
+     * The geometry of the decoration in the buffer of the bufferView.
+     */
+    Q_PROPERTY(QRect bufferContentRect READ bufferContentRect)
 public:
     explicit Decoration(QObject *parent = nullptr, const QVariantList &args = QVariantList());
     ~Decoration() override;
@@ -52,6 +62,10 @@ public:
     Q_INVOKABLE QVariant readConfig(const QString &key, const QVariant &defaultValue = QVariant());
 
     KDecoration2::DecoratedClient *clientPointer() const;
+    QObject *bufferView() const;
+    QRect bufferContentRect() const {
+        return m_contentRect;
+    }
 
 public Q_SLOTS:
     void init() override;
@@ -75,6 +89,7 @@ private:
     void updateBorders();
     void updateBuffer();
     void updateExtendedBorders();
+    int animationDuration() const;
 
     QRect m_contentRect; //the geometry of the part of the buffer that is not a shadow when buffer was created.
     QQuickItem *m_item = nullptr;
@@ -86,6 +101,12 @@ private:
     QString m_themeName;
 
     KWin::EffectQuickView *m_view;
+    // bumped by every change which can affect the shadow, it's only extracted from the next
+    // buffer if the generation differs from the one it got extracted at
+    quint64 m_shadowGeneration = 1;
+    quint64 m_extractedShadowGeneration = 0;
+    // runs while the theme animates a change which can affect the shadow
+    QTimer *m_shadowAnimationTimer = nullptr;
     QElapsedTimer m_doubleClickTimer;
 };
 
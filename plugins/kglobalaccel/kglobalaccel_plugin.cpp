@@ -18,6 +18,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "kglobalaccel_plugin.h"
+#include "../../globalshortcuts.h"
 #include "../../input.h"
 
 #include <QDebug>
@@ -31,8 +32,13 @@ KGlobalAccelImpl::~KGlobalAccelImpl() = default;
 
 bool KGlobalAccelImpl::grabKey(int key, bool grab)
 {
-    Q_UNUSED(key)
-    Q_UNUSED(grab)
+    // KWin sees all key events, grabbing only tells it which keys to pass to KGlobalAccel
+    if (m_shuttingDown) {
+        return true;
+    }
+    if (KWin::InputRedirection *input = KWin::InputRedirection::self()) {
+        input->shortcuts()->grabKey(key, grab);
+    }
     return true;
 }
 
@@ -38,6 +38,9 @@ DrmObject::DrmObject(uint32_t object_id, int fd)
 DrmObject::~DrmObject()
 {
     for (auto *p : m_props) {
+        if (p && p->blobId()) {
+            drmModeDestroyPropertyBlob(m_fd, p->blobId());
+        }
         delete p;
     }
 }
@@ -91,6 +94,16 @@ bool DrmObject::doAtomicPopulate(drmModeAtomicReq *req, int firstProperty) const
     return true;
 }
 
+bool DrmObject::atomicPopulateProperty(drmModeAtomicReq *req, int prop) const
+{
+    Q_ASSERT(prop < m_props.size());
+    auto property = m_props.at(prop);
+    if (!property) {
+        return false;
+    }
+    return atomicAddProperty(req, property);
+}
+
 void DrmObject::setValue(int prop, uint64_t new_value)
 {
     Q_ASSERT(prop < m_props.size());
@@ -100,6 +113,34 @@ void DrmObject::setValue(int prop, uint64_t new_value)
     }
 }
 
+bool DrmObject::setBlob(int prop, const QByteArray &data)
+{
+    Q_ASSERT(prop < m_props.size());
+    auto property = m_props.at(prop);
+    if (!property) {
+        return false;
+    }
+    if (property->value() == property->blobId() && property->blobData() == data
+            && (property->blobId() || data.isEmpty())) {
+        // unchanged, e.g. the same gamma ramp set again
+        return true;
+    }
+
+    uint32_t blobId = 0;
+    if (!data.isEmpty()
+            && drmModeCreatePropertyBlob(m_fd, data.constData(), data.size(), &blobId) != 0) {
+        qCWarning(KWIN_DRM) << "Failed to create property blob for" << property->name();
+        return false;
+    }
+    // the kernel holds its own reference to a blob in use
+    if (property->blobId()) {
+        drmModeDestroyPropertyBlob(m_fd, property->blobId());
+    }
+    property->setBlob(blobId, data);
+    property->setValue(blobId);
+    return true;
+}
+
 bool DrmObject::propHasEnum(int prop, uint64_t value) const
 {
     auto property = m_props.at(prop);
@@ -70,8 +70,22 @@ public:
      * @return true when the request was successfully populated
      */
     virtual bool atomicPopulate(drmModeAtomicReq *req) const;
+    /**
+     * Populate an atomic request with a single property of this object.
+     * @param req the atomic request
+     * @param prop the index of the property
+     * @return true when the request was successfully populated
+     */
+    bool atomicPopulateProperty(drmModeAtomicReq *req, int prop) const;
 
     void setValue(int prop, uint64_t new_value);
+    /**
+     * Sets the blob property @p prop to a property blob holding @p data, an empty @p data
+     * unsets the blob. A new blob is only created if @p data differs from the one of the
+     * blob currently set, the previous blob is released.
+     * @return true when the blob could be created
+     */
+    bool setBlob(int prop, const QByteArray &data);
     bool propHasEnum(int prop, uint64_t value) const;
 
 protected:
@@ -134,6 +148,17 @@ protected:
             return m_propName;
         }
 
+        uint32_t blobId() const {
+            return m_blobId;
+        }
+        const QByteArray &blobData() const {
+            return m_blobData;
+        }
+        void setBlob(uint32_t blobId, const QByteArray &data) {
+            m_blobId = blobId;
+            m_blobData = data;
+        }
+
     private:
         uint32_t m_propId = 0;
         QByteArray m_propName;
@@ -141,6 +166,10 @@ protected:
         uint64_t m_value = 0;
         QVector<uint64_t> m_enumMap;
         QVector<QByteArray> m_enumNames;
+
+        // the property blob created by us, if any
+        uint32_t m_blobId = 0;
+        QByteArray m_blobData;
     };
 
 private:
@@ -24,6 +24,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "drm_pointer.h"
 #include "logging.h"
 
+#include <libdrm/drm_mode.h>
+
 namespace KWin
 {
 
@@ -57,6 +59,7 @@ bool DrmCrtc::initProps()
     setPropertyNames({
         QByteArrayLiteral("MODE_ID"),
         QByteArrayLiteral("ACTIVE"),
+        QByteArrayLiteral("GAMMA_LUT"),
     });
 
     DrmScopedPointer<drmModeObjectProperties> properties(
@@ -71,6 +74,17 @@ bool DrmCrtc::initProps()
         initProp(j, properties.data());
     }
 
+    // GAMMA_LUT_SIZE is immutable, so it is only read and never part of a commit
+    if (m_props.at(int(PropertyIndex::GammaLut))) {
+        for (uint32_t i = 0; i < properties->count_props; ++i) {
+            DrmScopedPointer<drmModePropertyRes> prop(drmModeGetProperty(fd(), properties->props[i]));
+            if (prop && qstrcmp(prop->name, "GAMMA_LUT_SIZE") == 0) {
+                m_gammaLutSize = properties->prop_values[i];
+                break;
+            }
+        }
+    }
+
     return true;
 }
 
@@ -115,6 +129,21 @@ bool DrmCrtc::blank()
 
 bool DrmCrtc::setGammaRamp(const GammaRamp &gamma)
 {
+    if (m_gammaLutSize) {
+        if (gamma.size() != m_gammaLutSize) {
+            return false;
+        }
+        QByteArray lut(gamma.size() * sizeof(drm_color_lut), Qt::Uninitialized);
+        drm_color_lut *entries = reinterpret_cast<drm_color_lut *>(lut.data());
+        for (uint32_t i = 0; i < gamma.size(); ++i) {
+            entries[i].red = gamma.red()[i];
+            entries[i].green = gamma.green()[i];
+            entries[i].blue = gamma.blue()[i];
+            entries[i].reserved = 0;
+        }
+        return setBlob(int(PropertyIndex::GammaLut), lut);
+    }
+
     uint16_t *red = const_cast<uint16_t *>(gamma.red());
     uint16_t *green = const_cast<uint16_t *>(gamma.green());
     uint16_t *blue = const_cast<uint16_t *>(gamma.blue());
@@ -42,6 +42,7 @@ public:
     enum class PropertyIndex {
         ModeId = 0,
         Active,
+        GammaLut,
         Count
     };
 
@@ -65,13 +66,24 @@ public:
     bool blank();
 
     int gammaRampSize() const {
-        return m_gammaRampSize;
+        return m_gammaLutSize ? m_gammaLutSize : m_gammaRampSize;
     }
+    /**
+     * With atomic mode setting the gamma ramp is only stored in the GAMMA_LUT property,
+     * it gets applied with the next atomic commit of the output.
+     */
     bool setGammaRamp(const GammaRamp &gamma);
+    /**
+     * @return true when the gamma ramp is set through the GAMMA_LUT property
+     */
+    bool hasGammaLut() const {
+        return m_gammaLutSize != 0;
+    }
 
 private:
     int m_resIndex;
     uint32_t m_gammaRampSize = 0;
+    uint32_t m_gammaLutSize = 0;
 
     DrmBuffer *m_currentBuffer = nullptr;
     DrmBuffer *m_nextBuffer = nullptr;
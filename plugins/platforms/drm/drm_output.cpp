@@ -50,6 +50,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
+// enough for the shapes and animation frames of the cursor which are in use
+static const int s_cursorBufferCount = 8;
+
 DrmOutput::DrmOutput(DrmBackend *backend)
     : AbstractWaylandOutput(backend)
     , m_backend(backend)
@@ -84,8 +87,12 @@ void DrmOutput::teardown()
     m_crtc->setOutput(nullptr);
     m_conn->setOutput(nullptr);
 
-    delete m_cursor[0];
-    delete m_cursor[1];
+    for (const CursorBuffer &cursor : qAsConst(m_cursorBuffers)) {
+        delete cursor.buffer;
+    }
+    m_cursorBuffers.clear();
+    m_cursor = nullptr;
+    m_shownCursor = nullptr;
     if (!m_pageFlipPending) {
         deleteLater();
     } //else will be deleted in the page flip handler
@@ -115,16 +122,14 @@ bool DrmOutput::showCursor(DrmDumbBuffer *c)
 
 bool DrmOutput::showCursor()
 {
-    const bool ret = showCursor(m_cursor[m_cursorIndex]);
+    if (!m_cursor) {
+        return false;
+    }
+    const bool ret = showCursor(m_cursor);
     if (!ret) {
         return ret;
     }
-
-    if (m_hasNewCursor) {
-        m_cursorIndex = (m_cursorIndex + 1) % 2;
-        m_hasNewCursor = false;
-    }
-
+    m_shownCursor = m_cursor;
     return ret;
 }
 
@@ -170,8 +175,39 @@ void DrmOutput::updateCursor()
     if (cursorImage.isNull()) {
         return;
     }
-    m_hasNewCursor = true;
-    QImage *c = m_cursor[m_cursorIndex]->image();
+    const qint64 cacheKey = cursorImage.cacheKey();
+    for (int i = 0; i < m_cursorBuffers.count(); ++i) {
+        const CursorBuffer &cursor = m_cursorBuffers.at(i);
+        if (cursor.cacheKey == cacheKey && cursor.transform == transform() && cursor.scale == scale()) {
+            m_cursor = cursor.buffer;
+            m_cursorBuffers.move(i, 0);
+            return;
+        }
+    }
+
+    CursorBuffer cursor;
+    if (m_cursorBuffers.count() < s_cursorBufferCount) {
+        cursor.buffer = createCursorBuffer();
+    }
+    if (!cursor.buffer) {
+        // reuse the least recently used buffer, but not the one on the screen
+        for (int i = m_cursorBuffers.count() - 1; i >= 0; --i) {
+            if (m_cursorBuffers.at(i).buffer != m_shownCursor) {
+                cursor.buffer = m_cursorBuffers.takeAt(i).buffer;
+                break;
+            }
+        }
+    }
+    if (!cursor.buffer) {
+        return;
+    }
+    cursor.cacheKey = cacheKey;
+    cursor.transform = transform();
+    cursor.scale = scale();
+    m_cursorBuffers.prepend(cursor);
+    m_cursor = cursor.buffer;
+
+    QImage *c = m_cursor->image();
     c->fill(Qt::transparent);
 
     QPainter p;
@@ -459,19 +495,31 @@ bool DrmOutput::initCursorPlane()       // TODO: Add call in init (but needs lay
 
 bool DrmOutput::initCursor(const QSize &cursorSize)
 {
-    auto createCursor = [this, cursorSize] (int index) {
-        m_cursor[index] = m_backend->createBuffer(cursorSize);
-        if (!m_cursor[index]->map(QImage::Format_ARGB32_Premultiplied)) {
+    m_cursorSize = cursorSize;
+    // a new cursor image is rendered while the current one is on the screen,
+    // so at least two buffers are needed
+    for (int i = 0; i < 2; ++i) {
+        CursorBuffer cursor;
+        cursor.buffer = createCursorBuffer();
+        if (!cursor.buffer) {
             return false;
         }
-        return true;
-    };
-    if (!createCursor(0) || !createCursor(1)) {
-        return false;
+        m_cursorBuffers << cursor;
     }
+    m_cursor = m_cursorBuffers.first().buffer;
     return true;
 }
 
+DrmDumbBuffer *DrmOutput::createCursorBuffer()
+{
+    DrmDumbBuffer *buffer = m_backend->createBuffer(m_cursorSize);
+    if (!buffer->map(QImage::Format_ARGB32_Premultiplied)) {
+        delete buffer;
+        return nullptr;
+    }
+    return buffer;
+}
+
 void DrmOutput::initDpms(drmModeConnector *connector)
 {
     for (int i = 0; i < connector->count_props; ++i) {
@@ -976,6 +1024,10 @@ bool DrmOutput::doAtomicCommit(AtomicCommitMode mode)
     }
 
     bool ret = true;
+    // a modeset populates all properties of the CRTC already
+    if (m_crtc->hasGammaLut() && !(flags & DRM_MODE_ATOMIC_ALLOW_MODESET)) {
+        ret &= m_crtc->atomicPopulateProperty(req, int(DrmCrtc::PropertyIndex::GammaLut));
+    }
     // TODO: Make sure when we use more than one plane at a time, that we go through this list in the right order.
     for (int i = m_nextPlanesFlipList.size() - 1; 0 <= i; i-- ) {
         DrmPlane *p = m_nextPlanesFlipList[i];
@@ -1100,7 +1152,16 @@ int DrmOutput::gammaRampSize() const
 
 bool DrmOutput::setGammaRamp(const GammaRamp &gamma)
 {
-    return m_crtc->setGammaRamp(gamma);
+    if (!m_crtc->setGammaRamp(gamma)) {
+        return false;
+    }
+    if (m_crtc->hasGammaLut()) {
+        // the gamma ramp is committed together with the next page flip
+        if (Compositor *compositor = Compositor::self()) {
+            compositor->addRepaint(geometry());
+        }
+    }
+    return true;
 }
 
 }
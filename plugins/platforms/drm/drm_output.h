@@ -107,6 +107,7 @@ private:
     void initUuid();
     bool initPrimaryPlane();
     bool initCursorPlane();
+    DrmDumbBuffer *createCursorBuffer();
 
     void atomicEnable();
     void atomicDisable();
@@ -156,9 +157,21 @@ private:
         QPoint globalPos;
         bool valid = false;
     } m_lastWorkingState;
-    DrmDumbBuffer *m_cursor[2] = {nullptr, nullptr};
-    int m_cursorIndex = 0;
-    bool m_hasNewCursor = false;
+    struct CursorBuffer {
+        DrmDumbBuffer *buffer = nullptr;
+        qint64 cacheKey = 0;
+        Transform transform = Transform::Normal;
+        qreal scale = 1;
+    };
+    /**
+     * The cursor buffers, the most recently used first. Each holds a rendered cursor image,
+     * so that a cursor shape or animation frame which was shown before doesn't need to be
+     * rendered again.
+     */
+    QVector<CursorBuffer> m_cursorBuffers;
+    DrmDumbBuffer *m_cursor = nullptr;
+    DrmDumbBuffer *m_shownCursor = nullptr;
+    QSize m_cursorSize;
     bool m_deleted = false;
 };
 
@@ -50,8 +50,10 @@ EglGbmBackend::~EglGbmBackend()
     while (GLRenderTarget::isRenderTargetBound()) {
         GLRenderTarget::popRenderTarget();
     }
-    delete m_fbo;
-    delete m_backBuffer;
+    for (const Buffer &buffer : qAsConst(m_buffers)) {
+        delete buffer.renderTarget;
+        delete buffer.texture;
+    }
     cleanup();
 }
 
@@ -90,14 +92,12 @@ void EglGbmBackend::init()
 
     initKWinGL();
 
-    m_backBuffer = new GLTexture(GL_RGB8, screens()->size().width(), screens()->size().height());
-    m_fbo = new GLRenderTarget(*m_backBuffer);
-    if (!m_fbo->valid()) {
+    if (!initBuffers()) {
         setFailed("Could not create framebuffer object");
         return;
     }
-    GLRenderTarget::pushRenderTarget(m_fbo);
-    if (!m_fbo->isRenderTargetBound()) {
+    GLRenderTarget::pushRenderTarget(m_buffers.first().renderTarget);
+    if (!GLRenderTarget::isRenderTargetBound()) {
         setFailed("Failed to bind framebuffer object");
         return;
     }
@@ -106,10 +106,36 @@ void EglGbmBackend::init()
         return;
     }
 
-    setSupportsBufferAge(false);
+    // without a swap chain there is a single buffer which is fully repainted every frame
+    setSupportsBufferAge(m_backend->swapChainDepth() > 0);
     initWayland();
 }
 
+bool EglGbmBackend::initBuffers()
+{
+    const QSize size = screens()->size();
+    const int count = qMax(1, m_backend->swapChainDepth());
+    for (int i = 0; i < count; ++i) {
+        Buffer buffer;
+        buffer.texture = new GLTexture(GL_RGB8, size.width(), size.height());
+        buffer.renderTarget = new GLRenderTarget(*buffer.texture);
+        m_buffers << buffer;
+        if (!buffer.renderTarget->valid()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int EglGbmBackend::currentBufferAge() const
+{
+    const Buffer &buffer = m_buffers.at(m_currentBuffer);
+    if (buffer.lastFrame == 0) {
+        return 0;
+    }
+    return m_frameSequence - buffer.lastFrame + 1;
+}
+
 bool EglGbmBackend::initRenderingContext()
 {
     initBufferConfigs();
@@ -160,6 +186,7 @@ void EglGbmBackend::present()
 
     eglSwapBuffers(eglDisplay(), surface());
     setLastDamage(QRegion());
+    m_currentBuffer = (m_currentBuffer + 1) % m_buffers.count();
 
     Compositor::self()->bufferSwapComplete();
 }
@@ -168,6 +195,10 @@ void EglGbmBackend::screenGeometryChanged(const QSize &size)
 {
     Q_UNUSED(size)
     // TODO, create new buffer?
+    // the buffers no longer match the screen layout, treat their contents as undefined
+    for (Buffer &buffer : m_buffers) {
+        buffer.lastFrame = 0;
+    }
 }
 
 SceneOpenGLTexturePrivate *EglGbmBackend::createBackendTexture(SceneOpenGLTexture *texture)
@@ -181,12 +212,43 @@ QRegion EglGbmBackend::prepareRenderingFrame()
         present();
     }
     startRenderTimer();
-    if (!GLRenderTarget::isRenderTargetBound()) {
-        GLRenderTarget::pushRenderTarget(m_fbo);
+    if (GLRenderTarget::isRenderTargetBound()) {
+        GLRenderTarget::popRenderTarget();
+    }
+    GLRenderTarget::pushRenderTarget(m_buffers.at(m_currentBuffer).renderTarget);
+    return repaintRegion();
+}
+
+QRegion EglGbmBackend::repaintRegion() const
+{
+    if (supportsBufferAge()) {
+        return accumulatedDamageHistory(currentBufferAge());
     }
     return QRegion(0, 0, screens()->size().width(), screens()->size().height());
 }
 
+bool EglGbmBackend::perScreenRendering() const
+{
+    // all outputs share one buffer, it only maps onto the screen of a single output at the origin
+    return m_backend->perScreenRendering() && screens()->count() == 1 &&
+            screens()->geometry(0).topLeft() == QPoint(0, 0);
+}
+
+QRegion EglGbmBackend::prepareRenderingForScreen(int screenId)
+{
+    // prepareRenderingFrame() already bound the buffer of the frame
+    // the buffer stands in for the screen when the scene reads it back
+    GLRenderTarget::setScreenTarget(m_buffers.at(m_currentBuffer).renderTarget);
+    return repaintRegion().intersected(screens()->geometry(screenId));
+}
+
+void EglGbmBackend::endRenderingFrameForScreen(int screenId, const QRegion &renderedRegion, const QRegion &damagedRegion)
+{
+    Q_UNUSED(screenId)
+    GLRenderTarget::setScreenTarget(nullptr);
+    endRenderingFrame(renderedRegion, damagedRegion);
+}
+
 static void convertFromGLImage(QImage &img, int w, int h)
 {
     // from QtOpenGL/qgl.cpp
@@ -220,15 +282,21 @@ static void convertFromGLImage(QImage &img, int w, int h)
 
 void EglGbmBackend::endRenderingFrame(const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
-    Q_UNUSED(damagedRegion)
     glFlush();
+    Buffer &buffer = m_buffers[m_currentBuffer];
     if (m_backend->saveFrames()) {
-        QImage img = QImage(QSize(m_backBuffer->width(), m_backBuffer->height()), QImage::Format_ARGB32);
-        glReadnPixels(0, 0, m_backBuffer->width(), m_backBuffer->height(), GL_RGBA, GL_UNSIGNED_BYTE, img.sizeInBytes(), (GLvoid*)img.bits());
-        convertFromGLImage(img, m_backBuffer->width(), m_backBuffer->height());
+        const GLTexture *texture = buffer.texture;
+        QImage img = QImage(QSize(texture->width(), texture->height()), QImage::Format_ARGB32);
+        glReadnPixels(0, 0, texture->width(), texture->height(), GL_RGBA, GL_UNSIGNED_BYTE, img.sizeInBytes(), (GLvoid*)img.bits());
+        convertFromGLImage(img, texture->width(), texture->height());
         img.save(QStringLiteral("%1/%2.png").arg(m_backend->saveFrames()).arg(QString::number(m_frameCounter++)));
     }
     GLRenderTarget::popRenderTarget();
+    buffer.lastFrame = ++m_frameSequence;
+    if (supportsBufferAge()) {
+        addToDamageHistory(damagedRegion);
+    }
+    m_backend->addFrameStatistics(renderedRegion, damagedRegion);
     setLastDamage(renderedRegion);
 }
 
@@ -21,6 +21,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define KWIN_EGL_GBM_BACKEND_H
 #include "abstract_egl_backend.h"
 
+#include <QVector>
+
 namespace KWin
 {
 class VirtualBackend;
@@ -39,6 +41,9 @@ public:
     SceneOpenGLTexturePrivate *createBackendTexture(SceneOpenGLTexture *texture) override;
     QRegion prepareRenderingFrame() override;
     void endRenderingFrame(const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    QRegion prepareRenderingForScreen(int screenId) override;
+    void endRenderingFrameForScreen(int screenId, const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    bool perScreenRendering() const override;
     bool usesOverlayWindow() const override;
     void init() override;
 
@@ -49,9 +54,23 @@ private:
     bool initializeEgl();
     bool initBufferConfigs();
     bool initRenderingContext();
+    bool initBuffers();
+    int currentBufferAge() const;
+    QRegion repaintRegion() const;
+
+    struct Buffer {
+        GLTexture *texture = nullptr;
+        GLRenderTarget *renderTarget = nullptr;
+        /**
+         * Sequence number of the last frame rendered into this buffer, @c 0 if the
+         * contents of the buffer are undefined.
+         */
+        quint64 lastFrame = 0;
+    };
     VirtualBackend *m_backend;
-    GLTexture *m_backBuffer = nullptr;
-    GLRenderTarget *m_fbo = nullptr;
+    QVector<Buffer> m_buffers;
+    int m_currentBuffer = 0;
+    quint64 m_frameSequence = 0;
     int m_frameCounter = 0;
     friend class EglGbmTexture;
 };
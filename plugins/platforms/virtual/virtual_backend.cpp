@@ -70,6 +70,16 @@ void VirtualBackend::init()
         m_enabledOutputs << dummyOutput ;
     }
 
+    if (qEnvironmentVariableIsSet("KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH")) {
+        bool ok = false;
+        const int depth = qEnvironmentVariableIntValue("KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH", &ok);
+        if (ok) {
+            // the damage history of the OpenGL backend only covers the last ten frames
+            m_swapChainDepth = qBound(0, depth, 10);
+        }
+    }
+    m_perScreenRendering = qEnvironmentVariableIsSet("KWIN_WAYLAND_VIRTUAL_PER_SCREEN_RENDERING");
+
     setSoftWareCursor(true);
     setReady(true);
     waylandServer()->seat()->setHasPointer(true);
@@ -87,6 +97,29 @@ QString VirtualBackend::screenshotDirPath() const
     return m_screenshotDir->path();
 }
 
+static quint64 regionArea(const QRegion &region)
+{
+    quint64 area = 0;
+    for (const QRect &rect : region) {
+        area += quint64(rect.width()) * rect.height();
+    }
+    return area;
+}
+
+void VirtualBackend::addFrameStatistics(const QRegion &repainted, const QRegion &damaged)
+{
+    m_renderedFrames++;
+    m_repaintedPixels += regionArea(repainted);
+    m_damagedPixels += regionArea(damaged);
+}
+
+void VirtualBackend::resetFrameStatistics()
+{
+    m_renderedFrames = 0;
+    m_repaintedPixels = 0;
+    m_damagedPixels = 0;
+}
+
 Screens *VirtualBackend::createScreens(QObject *parent)
 {
     return new VirtualScreens(this, parent);
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QRect>
+#include <QRegion>
 
 class QTemporaryDir;
 
@@ -37,6 +38,10 @@ class KWIN_EXPORT VirtualBackend : public Platform
     Q_OBJECT
     Q_INTERFACES(KWin::Platform)
     Q_PLUGIN_METADATA(IID "org.kde.kwin.Platform" FILE "virtual.json")
+    Q_PROPERTY(int swapChainDepth READ swapChainDepth CONSTANT)
+    Q_PROPERTY(quint64 renderedFrames READ renderedFrames)
+    Q_PROPERTY(quint64 repaintedPixels READ repaintedPixels)
+    Q_PROPERTY(quint64 damagedPixels READ damagedPixels)
 
 public:
     VirtualBackend(QObject *parent = nullptr);
@@ -48,6 +53,40 @@ public:
     }
     QString screenshotDirPath() const;
 
+    /**
+     * The number of buffers the OpenGL backend cycles through, configured with the
+     * KWIN_WAYLAND_VIRTUAL_SWAPCHAIN_DEPTH environment variable. A depth of @c 0 means
+     * that a single buffer without buffer age support is used and every frame is a
+     * full repaint.
+     */
+    int swapChainDepth() const {
+        return m_swapChainDepth;
+    }
+
+    /**
+     * Whether the OpenGL backend renders the outputs one after another like the hardware
+     * backends do, configured with the KWIN_WAYLAND_VIRTUAL_PER_SCREEN_RENDERING environment
+     * variable. Only the per screen rendering of the OpenGL scene draws the software cursor.
+     */
+    bool perScreenRendering() const {
+        return m_perScreenRendering;
+    }
+
+    /**
+     * Damage accounting of the rendered frames, used to benchmark partial repaints.
+     */
+    quint64 renderedFrames() const {
+        return m_renderedFrames;
+    }
+    quint64 repaintedPixels() const {
+        return m_repaintedPixels;
+    }
+    quint64 damagedPixels() const {
+        return m_damagedPixels;
+    }
+    void addFrameStatistics(const QRegion &repainted, const QRegion &damaged);
+    Q_INVOKABLE void resetFrameStatistics();
+
     Screens *createScreens(QObject *parent = nullptr) override;
     QPainterBackend* createQPainterBackend() override;
     OpenGLBackend *createOpenGLBackend() override;
@@ -72,6 +111,11 @@ private:
     QVector<VirtualOutput*> m_enabledOutputs;
 
     QScopedPointer<QTemporaryDir> m_screenshotDir;
+    int m_swapChainDepth = 0;
+    bool m_perScreenRendering = false;
+    quint64 m_renderedFrames = 0;
+    quint64 m_repaintedPixels = 0;
+    quint64 m_damagedPixels = 0;
 };
 
 }
@@ -40,16 +40,16 @@ bool ScreenEdgesFilter::event(xcb_generic_event_t *event)
         const auto mouseEvent = reinterpret_cast<xcb_motion_notify_event_t*>(event);
         const QPoint rootPos(mouseEvent->root_x, mouseEvent->root_y);
         if (QWidget::mouseGrabber()) {
-            ScreenEdges::self()->check(rootPos, QDateTime::fromMSecsSinceEpoch(xTime()), true);
+            ScreenEdges::self()->check(rootPos, xTime(), true);
         } else {
-            ScreenEdges::self()->check(rootPos, QDateTime::fromMSecsSinceEpoch(mouseEvent->time));
+            ScreenEdges::self()->check(rootPos, mouseEvent->time);
         }
         // not filtered out
         break;
     }
     case XCB_ENTER_NOTIFY: {
         const auto enter = reinterpret_cast<xcb_enter_notify_event_t*>(event);
-        return ScreenEdges::self()->handleEnterNotifiy(enter->event, QPoint(enter->root_x, enter->root_y), QDateTime::fromMSecsSinceEpoch(enter->time));
+        return ScreenEdges::self()->handleEnterNotifiy(enter->event, QPoint(enter->root_x, enter->root_y), enter->time);
     }
     case XCB_CLIENT_MESSAGE: {
         const auto ce = reinterpret_cast<xcb_client_message_event_t*>(event);
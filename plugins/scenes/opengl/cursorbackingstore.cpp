@@ -0,0 +1,88 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "cursorbackingstore.h"
+
+#include <kwinglutils.h>
+
+namespace KWin
+{
+
+CursorBackingStore::CursorBackingStore(const QRect &geometry, qreal scale)
+    : m_geometry(geometry)
+    , m_scale(scale)
+{
+    if (!GLRenderTarget::blitSupported()) {
+        return;
+    }
+    m_texture.reset(new GLTexture(GL_RGBA8, geometry.size() * scale));
+    m_texture->setFilter(GL_NEAREST);
+    m_texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    m_texture->setYInverted(false);
+    m_renderTarget.reset(new GLRenderTarget(*m_texture));
+    if (!m_renderTarget->valid()) {
+        m_renderTarget.reset();
+        m_texture.reset();
+    }
+}
+
+CursorBackingStore::~CursorBackingStore() = default;
+
+bool CursorBackingStore::isValid() const
+{
+    return !m_renderTarget.isNull();
+}
+
+void CursorBackingStore::save(const QRegion &region)
+{
+    if (!isValid()) {
+        return;
+    }
+    const QRegion saved = region & m_geometry;
+    for (const QRect &rect : saved) {
+        const QRect destination(QPoint(qRound((rect.x() - m_geometry.x()) * m_scale),
+                                       qRound((rect.y() - m_geometry.y()) * m_scale)),
+                                rect.size() * m_scale);
+        m_renderTarget->blitFromFramebuffer(rect, destination, GL_NEAREST);
+    }
+    if (saved == m_geometry) {
+        m_complete = true;
+    }
+}
+
+void CursorBackingStore::restore(const QRegion &region, const QMatrix4x4 &projection)
+{
+    if (!isValid() || !m_complete) {
+        return;
+    }
+    const QRegion restored = region & m_geometry;
+    if (restored.isEmpty()) {
+        return;
+    }
+    QMatrix4x4 mvp = projection;
+    mvp.translate(m_geometry.x(), m_geometry.y());
+
+    glEnable(GL_SCISSOR_TEST);
+    m_texture->bind();
+    ShaderBinder binder(ShaderTrait::MapTexture);
+    binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+    m_texture->render(restored, m_geometry, true);
+    m_texture->unbind();
+    glDisable(GL_SCISSOR_TEST);
+}
+
+} // namespace KWin
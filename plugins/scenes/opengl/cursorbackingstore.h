@@ -0,0 +1,82 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_SCENE_OPENGL_CURSORBACKINGSTORE_H
+#define KWIN_SCENE_OPENGL_CURSORBACKINGSTORE_H
+
+#include <QMatrix4x4>
+#include <QRect>
+#include <QRegion>
+#include <QScopedPointer>
+
+namespace KWin
+{
+
+class GLRenderTarget;
+class GLTexture;
+
+/**
+ * @short Keeps the content of a screen as painted without the software cursor.
+ *
+ * After the windows of a screen got painted, the damaged part of the back buffer is saved
+ * before the cursor is drawn on top. A frame in which only the cursor moved can then be
+ * presented by restoring the stale parts of the back buffer, including the previous cursor
+ * position, and drawing the cursor at its new position, without painting the windows and
+ * effects again.
+ */
+class CursorBackingStore
+{
+public:
+    CursorBackingStore(const QRect &geometry, qreal scale);
+    ~CursorBackingStore();
+
+    bool isValid() const;
+    /**
+     * Whether the whole screen has been saved since the backing store was created.
+     */
+    bool isComplete() const {
+        return m_complete;
+    }
+    QRect geometry() const {
+        return m_geometry;
+    }
+    qreal scale() const {
+        return m_scale;
+    }
+
+    /**
+     * Copies @p region from the back buffer, the virtual screen has to be set to the screen.
+     * The backing store is complete once the whole screen got saved.
+     */
+    void save(const QRegion &region);
+    /**
+     * Paints @p region of the saved screen into the back buffer.
+     */
+    void restore(const QRegion &region, const QMatrix4x4 &projection);
+
+private:
+    QRect m_geometry;
+    qreal m_scale;
+    QScopedPointer<GLTexture> m_texture;
+    QScopedPointer<GLRenderTarget> m_renderTarget;
+    bool m_complete = false;
+};
+
+} // namespace KWin
+
+#endif
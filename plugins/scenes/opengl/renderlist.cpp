@@ -0,0 +1,150 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "renderlist.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace KWin
+{
+
+// indexed quads are drawn with 16 bit indices, don't let a merged draw exceed that
+static const int s_maxMergedVertexCount = 65532;
+
+RenderList::RenderList()
+{
+}
+
+GLVertex2D *RenderList::allocate(int count, int *firstVertex)
+{
+    *firstVertex = m_vertices.count();
+    m_vertices.resize(m_vertices.count() + count);
+    return m_vertices.data() + *firstVertex;
+}
+
+static bool canMerge(const RenderList::Item &previous, const RenderList::Item &item)
+{
+    return previous.texture == item.texture &&
+        previous.traits == item.traits &&
+        previous.modulation == item.modulation &&
+        previous.saturation == item.saturation &&
+        previous.filter == item.filter &&
+        previous.blend == item.blend &&
+        previous.firstVertex + previous.vertexCount == item.firstVertex &&
+        previous.vertexCount + item.vertexCount <= s_maxMergedVertexCount;
+}
+
+void RenderList::append(const Item &item)
+{
+    m_statistics.items++;
+    if (!m_items.isEmpty() && canMerge(m_items.last(), item)) {
+        m_items.last().vertexCount += item.vertexCount;
+        return;
+    }
+    m_items.append(item);
+}
+
+void RenderList::submit(const QMatrix4x4 &projection, GLenum primitiveType)
+{
+    if (m_items.isEmpty()) {
+        m_vertices.clear();
+        return;
+    }
+
+    const GLVertexAttrib attribs[] = {
+        { VA_Position, 2, GL_FLOAT, offsetof(GLVertex2D, position) },
+        { VA_TexCoord, 2, GL_FLOAT, offsetof(GLVertex2D, texcoord) },
+    };
+
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setAttribLayout(attribs, 2, sizeof(GLVertex2D));
+
+    const size_t size = m_vertices.count() * sizeof(GLVertex2D);
+    GLVertex2D *map = static_cast<GLVertex2D *>(vbo->map(size));
+    memcpy(map, m_vertices.constData(), size);
+    vbo->unmap();
+    vbo->bindArrays();
+
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLShader *shader = nullptr;
+    ShaderTraits traits;
+    QVector4D modulation;
+    float saturation = -1.0;
+    GLTexture *texture = nullptr;
+    GLenum filter = GL_NONE;
+    bool blending = false;
+
+    for (const Item &item : qAsConst(m_items)) {
+        if (!shader || item.traits != traits) {
+            if (shader) {
+                ShaderManager::instance()->popShader();
+            }
+            shader = ShaderManager::instance()->pushShader(item.traits);
+            shader->setUniform(GLShader::ModelViewProjectionMatrix, projection);
+            traits = item.traits;
+            // uniforms are per program, the previous values are unknown
+            modulation = QVector4D();
+            saturation = -1.0;
+            m_statistics.shaderChanges++;
+            m_statistics.uniformChanges++;
+        }
+        if ((traits & ShaderTrait::Modulate) && modulation != item.modulation) {
+            shader->setUniform(GLShader::ModulationConstant, item.modulation);
+            modulation = item.modulation;
+            m_statistics.uniformChanges++;
+        }
+        if ((traits & ShaderTrait::AdjustSaturation) && saturation != item.saturation) {
+            shader->setUniform(GLShader::Saturation, item.saturation);
+            saturation = item.saturation;
+            m_statistics.uniformChanges++;
+        }
+        if (blending != item.blend) {
+            if (item.blend) {
+                glEnable(GL_BLEND);
+            } else {
+                glDisable(GL_BLEND);
+            }
+            blending = item.blend;
+            m_statistics.blendChanges++;
+        }
+        if (texture != item.texture || filter != item.filter) {
+            item.texture->setFilter(item.filter);
+            item.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+            item.texture->bind();
+            texture = item.texture;
+            filter = item.filter;
+            m_statistics.textureChanges++;
+        }
+
+        vbo->draw(primitiveType, item.firstVertex, item.vertexCount);
+        m_statistics.drawCalls++;
+    }
+
+    if (blending) {
+        glDisable(GL_BLEND);
+    }
+    ShaderManager::instance()->popShader();
+    vbo->unbindArrays();
+
+    m_items.clear();
+    m_vertices.clear();
+}
+
+} // namespace
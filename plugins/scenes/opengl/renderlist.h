@@ -0,0 +1,118 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_SCENE_OPENGL_RENDERLIST_H
+#define KWIN_SCENE_OPENGL_RENDERLIST_H
+
+#include <kwineffects.h>
+#include <kwinglutils.h>
+
+#include <QMatrix4x4>
+#include <QVector>
+#include <QVector4D>
+
+namespace KWin
+{
+
+/**
+ * @short Collects the textured draws of a frame and submits them with minimal state changes.
+ *
+ * The SceneOpenGL2Window leaves (shadow, decoration, contents and sub-surfaces) of all
+ * windows which are painted without transformations are recorded into one list. The
+ * window position is baked into the vertices, so all items share the screen projection
+ * matrix. On submit all vertices are uploaded in one go and the items are drawn in
+ * painting order. Shader, uniforms, texture and blend state are only touched when they
+ * differ from the previous item, and adjacent items with identical state are merged into
+ * a single draw call.
+ *
+ * Items are never reordered, as that would break blending of overlapping translucent
+ * windows.
+ */
+class RenderList
+{
+public:
+    struct Item
+    {
+        GLTexture *texture = nullptr;
+        ShaderTraits traits = ShaderTrait::MapTexture;
+        QVector4D modulation = QVector4D(1.0, 1.0, 1.0, 1.0);
+        float saturation = 1.0;
+        GLenum filter = GL_NEAREST;
+        bool blend = false;
+        int firstVertex = 0;
+        int vertexCount = 0;
+    };
+
+    /**
+     * Counters describing the work needed to submit the window draws of one frame.
+     * Windows which could not be batched are accounted for as well.
+     */
+    struct Statistics
+    {
+        int items = 0;
+        int drawCalls = 0;
+        int shaderChanges = 0;
+        int uniformChanges = 0;
+        int textureChanges = 0;
+        int blendChanges = 0;
+
+        int stateChanges() const {
+            return shaderChanges + uniformChanges + textureChanges + blendChanges;
+        }
+    };
+
+    RenderList();
+
+    /**
+     * Reserves @p count vertices at the end of the list and returns a pointer to them.
+     * The pointer is only valid until the next call to allocate().
+     */
+    GLVertex2D *allocate(int count, int *firstVertex);
+    /**
+     * Appends @p item, merging it into the last item if it shares the same state and
+     * its vertices directly follow the vertices of the last item.
+     */
+    void append(const Item &item);
+    /**
+     * Draws all recorded items with @p projection and clears the list.
+     */
+    void submit(const QMatrix4x4 &projection, GLenum primitiveType);
+
+    bool isEmpty() const {
+        return m_items.isEmpty();
+    }
+
+    Statistics &statistics() {
+        return m_statistics;
+    }
+    const Statistics &statistics() const {
+        return m_statistics;
+    }
+    void resetStatistics() {
+        m_statistics = Statistics();
+    }
+
+private:
+    QVector<Item> m_items;
+    QVector<GLVertex2D> m_vertices;
+    Statistics m_statistics;
+};
+
+} // namespace
+
+#endif
@@ -27,6 +27,7 @@ You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "scene_opengl.h"
+#include "cursorbackingstore.h"
 
 #include "platform.h"
 #include "wayland_server.h"
@@ -40,7 +41,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "composite.h"
 #include "deleted.h"
 #include "effects.h"
+#include "frametimings.h"
 #include "lanczosfilter.h"
+#include "textureresidency.h"
 #include "main.h"
 #include "overlaywindow.h"
 #include "screens.h"
@@ -48,6 +51,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "decorations/decoratedclient.h"
 #include <logging.h>
 
+#include <KDecoration2/Decoration>
+
 #include <KWayland/Server/buffer_interface.h>
 #include <KWayland/Server/subcompositor_interface.h>
 #include <KWayland/Server/surface_interface.h>
@@ -55,8 +60,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <array>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <unistd.h>
 
+#include <QCryptographicHash>
 #include <QDBusConnection>
 #include <QDBusConnectionInterface>
 #include <QDBusInterface>
@@ -87,6 +94,9 @@ namespace KWin
 
 extern int currentRefreshRate();
 
+// the textures of the cursor shapes and animation frames which are in use
+static const int s_cursorTextureCacheSize = 16;
+
 
 /**
  * SyncObject represents a fence used to synchronize operations in
@@ -316,6 +326,7 @@ SceneOpenGL::SceneOpenGL(OpenGLBackend *backend, QObject *parent)
     , m_backend(backend)
     , m_syncManager(nullptr)
     , m_currentFence(nullptr)
+    , m_textureResidency(new TextureResidency(this))
 {
     if (m_backend->isFailed()) {
         init_ok = false;
@@ -360,6 +371,13 @@ SceneOpenGL::SceneOpenGL(OpenGLBackend *backend, QObject *parent)
             qCDebug(KWIN_OPENGL) << "Explicit synchronization with the X command stream disabled by environment variable";
         }
     }
+
+    if (FrameTimings *timings = FrameTimings::self()) {
+        if (GpuTimerQueries::isSupported()) {
+            m_gpuTimerQueries = new GpuTimerQueries;
+            timings->setGpuTimerQueries(m_gpuTimerQueries);
+        }
+    }
 }
 
 static SceneOpenGL *gs_debuggedScene = nullptr;
@@ -372,9 +390,17 @@ SceneOpenGL::~SceneOpenGL()
         makeOpenGLContextCurrent();
     }
     SceneOpenGL::EffectFrame::cleanup();
+    discardCursorBackingStores();
 
     delete m_syncManager;
 
+    if (m_gpuTimerQueries) {
+        if (FrameTimings *timings = FrameTimings::self()) {
+            timings->setGpuTimerQueries(nullptr);
+        }
+        delete m_gpuTimerQueries;
+    }
+
     // backend might be still needed for a different scene
     delete m_backend;
 }
@@ -599,27 +625,17 @@ void SceneOpenGL2::paintCursor()
         return;
     }
 
-    // lazy init texture cursor only in case we need software rendering
-    if (!m_cursorTexture) {
-        auto updateCursorTexture = [this] {
-            // don't paint if no image for cursor is set
-            const QImage img = kwinApp()->platform()->softwareCursor();
-            if (img.isNull()) {
-                return;
-            }
-            m_cursorTexture.reset(new GLTexture(img));
-        };
-
-        // init now
-        updateCursorTexture();
-
-        // handle shape update on case cursor image changed
-        connect(kwinApp()->platform(), &Platform::cursorChanged, this, updateCursorTexture);
+    // switching between cursor shapes or animation frames reuses their textures
+    const QImage img = kwinApp()->platform()->softwareCursor();
+    GLTexture *cursorTexture = m_cursorTextures.object(img.cacheKey());
+    if (!cursorTexture) {
+        cursorTexture = new GLTexture(img);
+        m_cursorTextures.insert(img.cacheKey(), cursorTexture);
     }
 
     // get cursor position in projection coordinates
     const QPoint cursorPos = Cursor::pos() - kwinApp()->platform()->softwareCursorHotspot();
-    const QRect cursorRect(0, 0, m_cursorTexture->width(), m_cursorTexture->height());
+    const QRect cursorRect(0, 0, cursorTexture->width(), cursorTexture->height());
     QMatrix4x4 mvp = m_projectionMatrix;
     mvp.translate(cursorPos.x(), cursorPos.y());
 
@@ -628,11 +644,11 @@ void SceneOpenGL2::paintCursor()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // paint texture in cursor offset
-    m_cursorTexture->bind();
+    cursorTexture->bind();
     ShaderBinder binder(ShaderTrait::MapTexture);
     binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
-    m_cursorTexture->render(QRegion(cursorRect), cursorRect);
-    m_cursorTexture->unbind();
+    cursorTexture->render(QRegion(cursorRect), cursorRect);
+    cursorTexture->unbind();
 
     kwinApp()->platform()->markCursorAsRendered();
 
@@ -652,17 +668,20 @@ qint64 SceneOpenGL::paint(QRegion damage, QList<Toplevel *> toplevels)
     QRegion updateRegion, validRegion;
     if (m_backend->perScreenRendering()) {
         // trigger start render timer
-        m_backend->prepareRenderingFrame();
+        {
+            FrameTimingScope scope(FrameTimings::Swap);
+            m_backend->prepareRenderingFrame();
+        }
         for (int i = 0; i < screens()->count(); ++i) {
             const QRect &geo = screens()->geometry(i);
             QRegion update;
             QRegion valid;
             // prepare rendering makes context current on the output
-            QRegion repaint = m_backend->prepareRenderingForScreen(i);
-            GLVertexBuffer::setVirtualScreenGeometry(geo);
-            GLRenderTarget::setVirtualScreenGeometry(geo);
-            GLVertexBuffer::setVirtualScreenScale(screens()->scale(i));
-            GLRenderTarget::setVirtualScreenScale(screens()->scale(i));
+            QRegion repaint;
+            {
+                FrameTimingScope scope(FrameTimings::Swap);
+                repaint = m_backend->prepareRenderingForScreen(i);
+            }
 
             const GLenum status = glGetGraphicsResetStatus();
             if (status != GL_NO_ERROR) {
@@ -670,26 +689,44 @@ qint64 SceneOpenGL::paint(QRegion damage, QList<Toplevel *> toplevels)
                 return 0;
             }
 
+            // started after the reset check, so that no query is left open
+            const int gpuTimer = startGpuTimer();
+            GLVertexBuffer::setVirtualScreenGeometry(geo);
+            GLRenderTarget::setVirtualScreenGeometry(geo);
+            GLVertexBuffer::setVirtualScreenScale(screens()->scale(i));
+            GLRenderTarget::setVirtualScreenScale(screens()->scale(i));
+
             int mask = 0;
             updateProjectionMatrix();
             paintScreen(&mask, damage.intersected(geo), repaint, &update, &valid, projectionMatrix(), geo);   // call generic implementation
+            saveCursorBackingStore(i, update, valid);
             paintCursor();
 
             GLVertexBuffer::streamingBuffer()->endOfFrame();
 
-            m_backend->endRenderingFrameForScreen(i, valid, update);
+            frameRendered(gpuTimer);
+            {
+                FrameTimingScope scope(FrameTimings::Swap);
+                m_backend->endRenderingFrameForScreen(i, valid, update);
+            }
 
             GLVertexBuffer::streamingBuffer()->framePosted();
         }
     } else {
         m_backend->makeCurrent();
-        QRegion repaint = m_backend->prepareRenderingFrame();
+        QRegion repaint;
+        {
+            FrameTimingScope scope(FrameTimings::Swap);
+            repaint = m_backend->prepareRenderingFrame();
+        }
 
         const GLenum status = glGetGraphicsResetStatus();
         if (status != GL_NO_ERROR) {
             handleGraphicsReset(status);
             return 0;
         }
+        const int gpuTimer = startGpuTimer();
+
         GLVertexBuffer::setVirtualScreenGeometry(screens()->geometry());
         GLRenderTarget::setVirtualScreenGeometry(screens()->geometry());
         GLVertexBuffer::setVirtualScreenScale(1);
@@ -716,7 +753,11 @@ qint64 SceneOpenGL::paint(QRegion damage, QList<Toplevel *> toplevels)
 
         GLVertexBuffer::streamingBuffer()->endOfFrame();
 
-        m_backend->endRenderingFrame(validRegion, updateRegion);
+        frameRendered(gpuTimer);
+        {
+            FrameTimingScope scope(FrameTimings::Swap);
+            m_backend->endRenderingFrame(validRegion, updateRegion);
+        }
 
         GLVertexBuffer::streamingBuffer()->framePosted();
     }
@@ -731,11 +772,139 @@ qint64 SceneOpenGL::paint(QRegion damage, QList<Toplevel *> toplevels)
         m_currentFence = nullptr;
     }
 
+    m_textureResidency->endFrame();
+
     // do cleanup
     clearStackingOrder();
     return m_backend->renderTime();
 }
 
+bool SceneOpenGL::canPaintCursorOnly() const
+{
+    if (!m_backend->perScreenRendering() || !kwinApp()->platform()->usesSoftwareCursor()) {
+        return false;
+    }
+    if (m_cursorBackingStores.count() != screens()->count()) {
+        return false;
+    }
+    for (int i = 0; i < m_cursorBackingStores.count(); ++i) {
+        const CursorBackingStore *store = m_cursorBackingStores.at(i);
+        if (!store || !store->isValid() || !store->isComplete() ||
+                store->geometry() != screens()->geometry(i) || store->scale() != screens()->scale(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+qint64 SceneOpenGL::paintCursorOnly(const QRegion &damage)
+{
+    {
+        FrameTimingScope scope(FrameTimings::Swap);
+        m_backend->prepareRenderingFrame();
+    }
+    for (int i = 0; i < screens()->count(); ++i) {
+        const QRect &geo = screens()->geometry(i);
+        QRegion repaint;
+        {
+            FrameTimingScope scope(FrameTimings::Swap);
+            repaint = m_backend->prepareRenderingForScreen(i);
+        }
+
+        const GLenum status = glGetGraphicsResetStatus();
+        if (status != GL_NO_ERROR) {
+            handleGraphicsReset(status);
+            return 0;
+        }
+
+        const int gpuTimer = startGpuTimer();
+        GLVertexBuffer::setVirtualScreenGeometry(geo);
+        GLRenderTarget::setVirtualScreenGeometry(geo);
+        GLVertexBuffer::setVirtualScreenScale(screens()->scale(i));
+        GLRenderTarget::setVirtualScreenScale(screens()->scale(i));
+
+        updateProjectionMatrix();
+        // the back buffer lacks the damage of the previous frames besides the cursor
+        const QRegion update = damage & geo;
+        const QRegion valid = (update | repaint) & geo;
+        {
+            FrameTimingScope scope(FrameTimings::Painting);
+            m_cursorBackingStores.at(i)->restore(valid, projectionMatrix());
+            paintCursor();
+        }
+
+        GLVertexBuffer::streamingBuffer()->endOfFrame();
+
+        frameRendered(gpuTimer);
+        {
+            FrameTimingScope scope(FrameTimings::Swap);
+            m_backend->endRenderingFrameForScreen(i, valid, update);
+        }
+
+        GLVertexBuffer::streamingBuffer()->framePosted();
+    }
+    m_cursorOnlyFrames++;
+    return m_backend->renderTime();
+}
+
+void SceneOpenGL::saveCursorBackingStore(int screen, const QRegion &update, const QRegion &valid)
+{
+    if (!kwinApp()->platform()->usesSoftwareCursor()) {
+        discardCursorBackingStores();
+        return;
+    }
+    if (m_cursorBackingStores.count() != screens()->count()) {
+        discardCursorBackingStores();
+        m_cursorBackingStores.fill(nullptr, screens()->count());
+    }
+    CursorBackingStore *&store = m_cursorBackingStores[screen];
+    const QRect &geo = screens()->geometry(screen);
+    const qreal scale = screens()->scale(screen);
+    if (!store || store->geometry() != geo || store->scale() != scale) {
+        delete store;
+        store = new CursorBackingStore(geo, scale);
+    }
+    if (store->isComplete()) {
+        // the rest of the screen didn't change since it got saved
+        store->save(update);
+    } else if ((QRegion(geo) - valid).isEmpty()) {
+        store->save(geo);
+    } else {
+        // the rest of the back buffer might still show the cursor
+        Compositor::self()->addRepaint(geo);
+    }
+}
+
+void SceneOpenGL::discardCursorBackingStores()
+{
+    qDeleteAll(m_cursorBackingStores);
+    m_cursorBackingStores.clear();
+}
+
+int SceneOpenGL::startGpuTimer()
+{
+    FrameTimings *timings = FrameTimings::self();
+    if (!m_gpuTimerQueries || !timings || !timings->isRecording()) {
+        return -1;
+    }
+    // pick up the results of previous frames, they are usually available a few frames later
+    m_gpuTimerQueries->resolve(timings);
+    return m_gpuTimerQueries->timestamp();
+}
+
+void SceneOpenGL::frameRendered(int gpuTimer)
+{
+    FrameTimings *timings = FrameTimings::self();
+    if (!timings) {
+        return;
+    }
+    if (gpuTimer >= 0) {
+        m_gpuTimerQueries->addSpan(gpuTimer, m_gpuTimerQueries->timestamp(), timings->sequence());
+    }
+    // a buffer swap from now on presents this frame
+    timings->markRendered();
+}
+
 QMatrix4x4 SceneOpenGL::transformation(int mask, const ScreenPaintData &data) const
 {
     QMatrix4x4 matrix;
@@ -910,6 +1079,53 @@ QVector<QByteArray> SceneOpenGL::openGLPlatformInterfaceExtensions() const
     return m_backend->extensions().toVector();
 }
 
+static const SceneOpenGLDecorationRenderer *decorationRenderer(const Toplevel *toplevel)
+{
+    if (const AbstractClient *client = qobject_cast<const AbstractClient *>(toplevel)) {
+        if (client->isDecorated()) {
+            return static_cast<const SceneOpenGLDecorationRenderer *>(client->decoratedClient()->renderer());
+        }
+    } else if (toplevel->isDeleted()) {
+        const Deleted *deleted = static_cast<const Deleted *>(toplevel);
+        if (deleted->wasClient() && !deleted->noBorder()) {
+            return static_cast<const SceneOpenGLDecorationRenderer *>(deleted->decorationRenderer());
+        }
+    }
+    return nullptr;
+}
+
+QVariantMap SceneOpenGL::textureMemory() const
+{
+    QVariantMap map = m_textureResidency->statistics();
+
+    // only the window textures are managed, the other textures are counted for the statistics
+    qint64 decorations = 0;
+    qint64 shadows = 0;
+    qint64 lanczos = 0;
+    QSet<const GLTexture *> sharedShadows;
+    const auto toplevels = m_textureResidency->toplevels();
+    for (Toplevel *toplevel : toplevels) {
+        if (const SceneOpenGLDecorationRenderer *renderer = decorationRenderer(toplevel)) {
+            decorations += TextureResidency::textureSize(renderer->texture());
+        }
+        if (SceneOpenGLShadow *shadow = static_cast<SceneOpenGLShadow *>(toplevel->shadow())) {
+            // shadows with the same contents share their texture
+            const GLTexture *texture = shadow->shadowTexture();
+            if (texture && !sharedShadows.contains(texture)) {
+                sharedShadows.insert(texture);
+                shadows += TextureResidency::textureSize(texture);
+            }
+        }
+        if (const EffectWindowImpl *window = toplevel->effectWindow()) {
+            lanczos += TextureResidency::textureSize(static_cast<GLTexture *>(window->data(LanczosCacheRole).value<void *>()));
+        }
+    }
+    map.insert(QStringLiteral("decorationTextures"), decorations);
+    map.insert(QStringLiteral("shadowTextures"), shadows);
+    map.insert(QStringLiteral("lanczosTextures"), lanczos);
+    return map;
+}
+
 //****************************************
 // SceneOpenGL2
 //****************************************
@@ -938,6 +1154,7 @@ bool SceneOpenGL2::supported(OpenGLBackend *backend)
 SceneOpenGL2::SceneOpenGL2(OpenGLBackend *backend, QObject *parent)
     : SceneOpenGL(backend, parent)
     , m_lanczosFilter(nullptr)
+    , m_cursorTextures(s_cursorTextureCacheSize)
 {
     if (!init_ok) {
         // base ctor already failed
@@ -1025,11 +1242,35 @@ void SceneOpenGL2::updateProjectionMatrix()
     m_projectionMatrix = createProjectionMatrix();
 }
 
+qint64 SceneOpenGL2::paint(QRegion damage, QList<Toplevel *> windows)
+{
+    m_renderList.resetStatistics();
+    return SceneOpenGL::paint(damage, windows);
+}
+
+void SceneOpenGL2::flushRenderList()
+{
+    if (m_renderList.isEmpty()) {
+        return;
+    }
+    ShaderManager::instance()->setDeferredDrawsFlush(nullptr);
+    const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
+    m_renderList.submit(m_screenProjectionMatrix, indexedQuads ? GL_QUADS : GL_TRIANGLES);
+}
+
 void SceneOpenGL2::paintSimpleScreen(int mask, QRegion region)
 {
     m_screenProjectionMatrix = m_projectionMatrix;
 
+    // Effects may sample the back buffer behind a window or issue their own GL draws
+    // around it in the paint chain, e.g. blur or the resize outline. The recorded draws
+    // are flushed as soon as such an effect pushes a shader or a render target.
+    m_batchWindows = true;
+
     Scene::paintSimpleScreen(mask, region);
+
+    flushRenderList();
+    m_batchWindows = false;
 }
 
 void SceneOpenGL2::paintGenericScreen(int mask, ScreenPaintData data)
@@ -1082,6 +1323,7 @@ void SceneOpenGL2::performPaintWindow(EffectWindowImpl* w, int mask, QRegion reg
                 m_lanczosFilter = nullptr;
             });
         }
+        flushRenderList();
         m_lanczosFilter->performPaint(w, mask, region, data);
     } else
         w->sceneWindow()->performPaint(mask, region, data);
@@ -1361,6 +1603,12 @@ void SceneOpenGL2Window::renderSubSurface(GLShader *shader, const QMatrix4x4 &mv
         texture->bind();
         texture->render(region, QRect(0, 0, texture->width() / scale, texture->height() / scale), hardwareClipping);
         texture->unbind();
+
+        RenderList::Statistics &statistics = static_cast<SceneOpenGL2 *>(m_scene)->frameStatistics();
+        statistics.items++;
+        statistics.uniformChanges++;
+        statistics.textureChanges++;
+        statistics.drawCalls++;
     }
 
     const auto &children = pixmap->children();
@@ -1372,11 +1620,168 @@ void SceneOpenGL2Window::renderSubSurface(GLShader *shader, const QMatrix4x4 &mv
     }
 }
 
+GLenum SceneOpenGL2Window::textureFilter(int mask) const
+{
+    if (waylandServer()) {
+        return GL_LINEAR;
+    }
+    const bool isTransformed = mask & (Effect::PAINT_WINDOW_TRANSFORMED |
+                                       Effect::PAINT_SCREEN_TRANSFORMED);
+    if (isTransformed && options->glSmoothScale() != 0) {
+        return GL_LINEAR;
+    }
+    return GL_NEAREST;
+}
+
+bool SceneOpenGL2Window::canBatch(int mask, const WindowPaintData &data) const
+{
+    // Only windows which are painted at their position with the default shader and
+    // projection can share the state of a render list
+    if (mask & (Effect::PAINT_WINDOW_TRANSFORMED | Effect::PAINT_SCREEN_TRANSFORMED)) {
+        return false;
+    }
+    return !data.shader && data.crossFadeProgress() == 1.0 &&
+        data.projectionMatrix().isIdentity() && data.modelViewMatrix().isIdentity();
+}
+
+void SceneOpenGL2Window::recordSubSurface(RenderList *list, const RenderList::Item &state, const QPointF &offset, OpenGLWindowPixmap *pixmap)
+{
+    const QPointF position = offset + pixmap->subSurface()->position();
+
+    qreal scale = 1.0;
+    if (pixmap->surface()) {
+        scale = pixmap->surface()->scale();
+    }
+
+    GLTexture *texture = pixmap->texture();
+    if (!texture->isNull()) {
+        const qreal width = texture->width() / scale;
+        const qreal height = texture->height() / scale;
+
+        WindowQuad quad(WindowQuadContents);
+        quad[0] = WindowVertex(0, 0, 0, 0);
+        quad[1] = WindowVertex(width, 0, texture->width(), 0);
+        quad[2] = WindowVertex(width, height, texture->width(), texture->height());
+        quad[3] = WindowVertex(0, height, 0, texture->height());
+        WindowQuadList quads;
+        quads.append(quad);
+
+        const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
+        const int vertexCount = indexedQuads ? 4 : 6;
+
+        RenderList::Item item = state;
+        GLVertex2D *vertices = list->allocate(vertexCount, &item.firstVertex);
+        quads.makeInterleavedArrays(indexedQuads ? GL_QUADS : GL_TRIANGLES, vertices,
+                                    texture->matrix(UnnormalizedCoordinates));
+        for (int i = 0; i < vertexCount; ++i) {
+            vertices[i].position += QVector2D(position);
+        }
+        item.texture = texture;
+        item.vertexCount = vertexCount;
+        item.blend = (pixmap->buffer() && pixmap->buffer()->hasAlphaChannel()) || state.modulation.w() < 1.0;
+        list->append(item);
+    }
+
+    const auto &children = pixmap->children();
+    for (auto child : children) {
+        if (child->subSurface().isNull() || child->subSurface()->surface().isNull() || !child->subSurface()->surface()->isMapped()) {
+            continue;
+        }
+        recordSubSurface(list, state, position, static_cast<OpenGLWindowPixmap*>(child));
+    }
+}
+
+void SceneOpenGL2Window::recordPaint(RenderList *list, const WindowPaintData &data)
+{
+    RenderList::Item state;
+    state.traits = ShaderTrait::MapTexture;
+    if (data.opacity() != 1.0 || data.brightness() != 1.0)
+        state.traits |= ShaderTrait::Modulate;
+    if (data.saturation() != 1.0)
+        state.traits |= ShaderTrait::AdjustSaturation;
+    state.saturation = data.saturation();
+    state.filter = textureFilter(0);
+
+    WindowQuadList quads[LeafCount];
+    for (const WindowQuad &quad : qAsConst(data.quads)) {
+        switch (quad.type()) {
+        case WindowQuadDecoration:
+            quads[DecorationLeaf].append(quad);
+            continue;
+        case WindowQuadContents:
+            quads[ContentLeaf].append(quad);
+            continue;
+        case WindowQuadShadow:
+            quads[ShadowLeaf].append(quad);
+            continue;
+        default:
+            continue;
+        }
+    }
+
+    LeafNode nodes[LeafCount];
+    setupLeafNodes(nodes, quads, data);
+
+    const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
+    const GLenum primitiveType = indexedQuads ? GL_QUADS : GL_TRIANGLES;
+    const int verticesPerQuad = indexedQuads ? 4 : 6;
+    // the window translation is baked into the vertices
+    const QVector2D offset(x(), y());
+
+    for (int i = 0; i < LeafCount; i++) {
+        if (quads[i].isEmpty() || !nodes[i].texture)
+            continue;
+
+        RenderList::Item item = state;
+        item.texture = nodes[i].texture;
+        item.modulation = modulate(nodes[i].opacity, data.brightness());
+        item.blend = nodes[i].hasAlpha || nodes[i].opacity < 1.0;
+        item.vertexCount = quads[i].count() * verticesPerQuad;
+
+        GLVertex2D *vertices = list->allocate(item.vertexCount, &item.firstVertex);
+        quads[i].makeInterleavedArrays(primitiveType, vertices, nodes[i].texture->matrix(nodes[i].coordinateType));
+        for (int v = 0; v < item.vertexCount; ++v) {
+            vertices[v].position += offset;
+        }
+        list->append(item);
+    }
+
+    auto wp = windowPixmap<OpenGLWindowPixmap>();
+    const auto &children = wp ? wp->children() : QVector<WindowPixmap*>();
+    if (children.isEmpty()) {
+        return;
+    }
+    state.modulation = modulate(nodes[ContentLeaf].opacity, data.brightness());
+    const QPointF mainSurfaceOffset = QPointF(pos() + bufferOffset());
+    for (auto pixmap : children) {
+        if (pixmap->subSurface().isNull() || pixmap->subSurface()->surface().isNull() || !pixmap->subSurface()->surface()->isMapped()) {
+            continue;
+        }
+        recordSubSurface(list, state, mainSurfaceOffset, static_cast<OpenGLWindowPixmap*>(pixmap));
+    }
+}
+
 void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData data)
 {
+    SceneOpenGL2 *scene = static_cast<SceneOpenGL2 *>(m_scene);
+    RenderList *list = scene->renderList();
+    if (list && canBatch(mask, data)) {
+        if (!beginRenderWindow(mask, region, data))
+            return;
+        recordPaint(list, data);
+        endRenderWindow();
+        ShaderManager::instance()->setDeferredDrawsFlush([scene] { scene->flushRenderList(); });
+        return;
+    }
+
+    // everything recorded so far is below this window
+    scene->flushRenderList();
+
     if (!beginRenderWindow(mask, region, data))
         return;
 
+    RenderList::Statistics &statistics = scene->frameStatistics();
+
     QMatrix4x4 windowMatrix = transformation(mask, data);
     const QMatrix4x4 modelViewProjection = modelViewProjectionMatrix(mask, data);
     const QMatrix4x4 mvpMatrix = modelViewProjection * windowMatrix;
@@ -1392,23 +1797,14 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
             traits |= ShaderTrait::AdjustSaturation;
 
         shader = ShaderManager::instance()->pushShader(traits);
+        statistics.shaderChanges++;
     }
     shader->setUniform(GLShader::ModelViewProjectionMatrix, mvpMatrix);
 
     shader->setUniform(GLShader::Saturation, data.saturation());
+    statistics.uniformChanges += 2;
 
-    GLenum filter;
-    if (waylandServer()) {
-        filter = GL_LINEAR;
-    } else {
-        const bool isTransformed = mask & (Effect::PAINT_WINDOW_TRANSFORMED |
-                                           Effect::PAINT_SCREEN_TRANSFORMED);
-        if (isTransformed && options->glSmoothScale() != 0) {
-            filter = GL_LINEAR;
-        } else {
-            filter = GL_NEAREST;
-        }
-    }
+    const GLenum filter = textureFilter(mask);
 
     WindowQuadList quads[LeafCount];
 
@@ -1463,16 +1859,18 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
     const size_t size = verticesPerQuad *
         (quads[0].count() + quads[1].count() + quads[2].count() + quads[3].count()) * sizeof(GLVertex2D);
 
-    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
-    GLVertex2D *map = (GLVertex2D *) vbo->map(size);
-
+    // the decoration texture may be rendered with GL, so it's set up before the buffer is mapped
     LeafNode nodes[LeafCount];
     setupLeafNodes(nodes, quads, data);
 
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    GLVertex2D *map = (GLVertex2D *) vbo->map(size);
+
     for (int i = 0, v = 0; i < LeafCount; i++) {
         if (quads[i].isEmpty() || !nodes[i].texture)
             continue;
 
+        statistics.items++;
         nodes[i].firstVertex = v;
         nodes[i].vertexCount = quads[i].count() * verticesPerQuad;
 
@@ -1494,19 +1892,26 @@ void SceneOpenGL2Window::performPaint(int mask, QRegion region, WindowPaintData
         if (nodes[i].vertexCount == 0)
             continue;
 
-        setBlendEnabled(nodes[i].hasAlpha || nodes[i].opacity < 1.0);
+        const bool blend = nodes[i].hasAlpha || nodes[i].opacity < 1.0;
+        if (blend != m_blendingEnabled) {
+            statistics.blendChanges++;
+        }
+        setBlendEnabled(blend);
 
         if (opacity != nodes[i].opacity) {
             shader->setUniform(GLShader::ModulationConstant,
                                modulate(nodes[i].opacity, data.brightness()));
             opacity = nodes[i].opacity;
+            statistics.uniformChanges++;
         }
 
         nodes[i].texture->setFilter(filter);
         nodes[i].texture->setWrapMode(GL_CLAMP_TO_EDGE);
         nodes[i].texture->bind();
+        statistics.textureChanges++;
 
         vbo->draw(region, primitiveType, nodes[i].firstVertex, nodes[i].vertexCount, m_hardwareClipping);
+        statistics.drawCalls++;
     }
 
     vbo->unbindArrays();
@@ -1552,6 +1957,9 @@ OpenGLWindowPixmap::OpenGLWindowPixmap(const QPointer<KWayland::Server::SubSurfa
 
 OpenGLWindowPixmap::~OpenGLWindowPixmap()
 {
+    if (subSurface().isNull()) {
+        m_scene->textureResidency()->remove(this);
+    }
 }
 
 static bool needsPixmapUpdate(const OpenGLWindowPixmap *pixmap)
@@ -1594,6 +2002,9 @@ bool OpenGLWindowPixmap::bind()
         for (auto it = children().constBegin(); it != children().constEnd(); ++it) {
             static_cast<OpenGLWindowPixmap*>(*it)->bind();
         }
+        if (subSurface().isNull()) {
+            m_scene->textureResidency()->touch(this);
+        }
         return true;
     }
     // also bind all children, needs to be done before checking isValid
@@ -1613,6 +2024,7 @@ bool OpenGLWindowPixmap::bind()
     if (success) {
         if (subSurface().isNull()) {
             toplevel()->resetDamage();
+            m_scene->textureResidency()->touch(this);
         }
     } else
         qCDebug(KWIN_OPENGL) << "Failed to bind window";
@@ -1632,6 +2044,23 @@ bool OpenGLWindowPixmap::isValid() const
     return WindowPixmap::isValid();
 }
 
+qint64 OpenGLWindowPixmap::textureSize() const
+{
+    qint64 size = TextureResidency::textureSize(m_texture.data());
+    for (auto it = children().constBegin(); it != children().constEnd(); ++it) {
+        size += static_cast<OpenGLWindowPixmap*>(*it)->textureSize();
+    }
+    return size;
+}
+
+void OpenGLWindowPixmap::discardTexture()
+{
+    m_texture->discard();
+    for (auto it = children().constBegin(); it != children().constEnd(); ++it) {
+        static_cast<OpenGLWindowPixmap*>(*it)->discardTexture();
+    }
+}
+
 //****************************************
 // SceneOpenGL::EffectFrame
 //****************************************
@@ -2064,37 +2493,51 @@ void SceneOpenGL::EffectFrame::cleanup()
 //****************************************
 // SceneOpenGL::Shadow
 //****************************************
-class DecorationShadowTextureCache
+/**
+ * Shares the textures of shadows, windows of the same style usually have the same shadow.
+ * Decoration shadows are shared by their KDecoration2::DecorationShadow and X11 shadows by
+ * the pixmaps in the property, so that the image is only composed and converted for the
+ * first window. Wayland shadows are shared by their contents.
+ */
+class ShadowTextureCache
 {
 public:
-    ~DecorationShadowTextureCache();
-    DecorationShadowTextureCache(const DecorationShadowTextureCache&) = delete;
-    static DecorationShadowTextureCache &instance();
+    ~ShadowTextureCache();
+    ShadowTextureCache(const ShadowTextureCache&) = delete;
+    static ShadowTextureCache &instance();
 
     void unregister(SceneOpenGLShadow *shadow);
-    QSharedPointer<GLTexture> getTexture(SceneOpenGLShadow *shadow);
+    /**
+     * The texture for @p key, @p image is only called to create it if there is none yet.
+     */
+    QSharedPointer<GLTexture> getTexture(SceneOpenGLShadow *shadow, const QByteArray &key,
+                                         const std::function<QImage()> &image);
+    static QByteArray imageKey(const QImage &image);
 
 private:
-    DecorationShadowTextureCache() = default;
+    ShadowTextureCache() = default;
+    static QSharedPointer<GLTexture> createTexture(QImage image);
     struct Data {
         QSharedPointer<GLTexture> texture;
         QVector<SceneOpenGLShadow*> shadows;
     };
-    QHash<KDecoration2::DecorationShadow*, Data> m_cache;
+    // keyed by the source of the shadow, or a cryptographic hash of the contents, so that the
+    // images don't need to be retained to tell apart collisions
+    QHash<QByteArray, Data> m_cache;
 };
 
-DecorationShadowTextureCache &DecorationShadowTextureCache::instance()
+ShadowTextureCache &ShadowTextureCache::instance()
 {
-    static DecorationShadowTextureCache s_instance;
+    static ShadowTextureCache s_instance;
     return s_instance;
 }
 
-DecorationShadowTextureCache::~DecorationShadowTextureCache()
+ShadowTextureCache::~ShadowTextureCache()
 {
     Q_ASSERT(m_cache.isEmpty());
 }
 
-void DecorationShadowTextureCache::unregister(SceneOpenGLShadow *shadow)
+void ShadowTextureCache::unregister(SceneOpenGLShadow *shadow)
 {
     auto it = m_cache.begin();
     while (it != m_cache.end()) {
@@ -2117,25 +2560,70 @@ void DecorationShadowTextureCache::unregister(SceneOpenGLShadow *shadow)
     }
 }
 
-QSharedPointer<GLTexture> DecorationShadowTextureCache::getTexture(SceneOpenGLShadow *shadow)
+QSharedPointer<GLTexture> ShadowTextureCache::getTexture(SceneOpenGLShadow *shadow, const QByteArray &key,
+                                                         const std::function<QImage()> &image)
 {
-    Q_ASSERT(shadow->hasDecorationShadow());
     unregister(shadow);
-    const auto &decoShadow = shadow->decorationShadow();
-    Q_ASSERT(!decoShadow.isNull());
-    auto it = m_cache.find(decoShadow.data());
+    auto it = m_cache.find(key);
     if (it != m_cache.end()) {
         Q_ASSERT(!it.value().shadows.contains(shadow));
         it.value().shadows << shadow;
         return it.value().texture;
     }
+    const QImage contents = image();
+    if (contents.isNull()) {
+        return QSharedPointer<GLTexture>();
+    }
     Data d;
     d.shadows << shadow;
-    d.texture = QSharedPointer<GLTexture>::create(shadow->decorationShadowImage());
-    m_cache.insert(decoShadow.data(), d);
+    d.texture = createTexture(contents);
+    m_cache.insert(key, d);
     return d.texture;
 }
 
+QByteArray ShadowTextureCache::imageKey(const QImage &image)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const int header[] = { image.width(), image.height(), image.bytesPerLine(), int(image.format()) };
+    hash.addData(reinterpret_cast<const char *>(header), sizeof(header));
+    hash.addData(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+    return QByteArrayLiteral("image:") + hash.result();
+}
+
+QSharedPointer<GLTexture> ShadowTextureCache::createTexture(QImage image)
+{
+    // Check if the image is alpha-only in practice, and if so convert it to an 8-bpp format
+    if (!GLPlatform::instance()->isGLES() && GLTexture::supportsSwizzle() && GLTexture::supportsFormatRG()) {
+        QImage alphaImage(image.size(), QImage::Format_Indexed8); // Change to Format_Alpha8 w/ Qt 5.5
+        const QImage argbImage = image.convertToFormat(QImage::Format_ARGB32);
+        bool alphaOnly = true;
+
+        for (ptrdiff_t y = 0; alphaOnly && y < argbImage.height(); y++) {
+            const uint32_t * const src = reinterpret_cast<const uint32_t *>(argbImage.scanLine(y));
+            uint8_t * const dst = reinterpret_cast<uint8_t *>(alphaImage.scanLine(y));
+
+            for (ptrdiff_t x = 0; x < argbImage.width(); x++) {
+                if (src[x] & 0x00ffffff)
+                    alphaOnly = false;
+
+                dst[x] = qAlpha(src[x]);
+            }
+        }
+
+        if (alphaOnly) {
+            image = alphaImage;
+        }
+    }
+
+    auto texture = QSharedPointer<GLTexture>::create(image);
+    if (texture->internalFormat() == GL_R8) {
+        // Swizzle red to alpha and all other channels to zero
+        texture->bind();
+        texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+    }
+    return texture;
+}
+
 SceneOpenGLShadow::SceneOpenGLShadow(Toplevel *toplevel)
     : Shadow(toplevel)
 {
@@ -2146,7 +2634,7 @@ SceneOpenGLShadow::~SceneOpenGLShadow()
     Scene *scene = Compositor::self()->scene();
     if (scene) {
         scene->makeOpenGLContextCurrent();
-        DecorationShadowTextureCache::instance().unregister(this);
+        ShadowTextureCache::instance().unregister(this);
         m_texture.reset();
     }
 }
@@ -2402,14 +2890,40 @@ void SceneOpenGLShadow::buildQuads()
 
 bool SceneOpenGLShadow::prepareBackend()
 {
+    Scene *scene = Compositor::self()->scene();
     if (hasDecorationShadow()) {
         // simplifies a lot by going directly to
-        Scene *scene = Compositor::self()->scene();
+        const QImage image = decorationShadowImage();
+        // the image is part of the key as the decoration might change the shadow in place
+        const QByteArray key = QByteArrayLiteral("decoration:")
+            + QByteArray::number(quintptr(decorationShadow().toStrongRef().data()), 16)
+            + ':' + QByteArray::number(image.cacheKey());
         scene->makeOpenGLContextCurrent();
-        m_texture = DecorationShadowTextureCache::instance().getTexture(this);
+        m_texture = ShadowTextureCache::instance().getTexture(this, key, [&image] { return image; });
 
-        return true;
+        return !m_texture.isNull();
+    }
+    if (const quint64 serial = x11ShadowSerial()) {
+        scene->makeOpenGLContextCurrent();
+        m_texture = ShadowTextureCache::instance().getTexture(this, QByteArrayLiteral("x11:") + QByteArray::number(serial),
+                                                              [this] { return composeImage(); });
+        return !m_texture.isNull();
+    }
+
+    const QImage image = composeImage();
+    if (image.isNull()) {
+        ShadowTextureCache::instance().unregister(this);
+        m_texture.reset();
+        return false;
     }
+    scene->makeOpenGLContextCurrent();
+    m_texture = ShadowTextureCache::instance().getTexture(this, ShadowTextureCache::imageKey(image),
+                                                          [&image] { return image; });
+    return true;
+}
+
+QImage SceneOpenGLShadow::composeImage() const
+{
     const QSize top(shadowPixmap(ShadowElementTop).size());
     const QSize topRight(shadowPixmap(ShadowElementTopRight).size());
     const QSize right(shadowPixmap(ShadowElementRight).size());
@@ -2427,7 +2941,7 @@ bool SceneOpenGLShadow::prepareBackend()
                        std::max({bottomLeft.height(), bottom.height(), bottomRight.height()});
 
     if (width == 0 || height == 0) {
-        return false;
+        return QImage();
     }
 
     QImage image(width, height, QImage::Format_ARGB32);
@@ -2452,39 +2966,7 @@ bool SceneOpenGLShadow::prepareBackend()
 
     p.end();
 
-    // Check if the image is alpha-only in practice, and if so convert it to an 8-bpp format
-    if (!GLPlatform::instance()->isGLES() && GLTexture::supportsSwizzle() && GLTexture::supportsFormatRG()) {
-        QImage alphaImage(image.size(), QImage::Format_Indexed8); // Change to Format_Alpha8 w/ Qt 5.5
-        bool alphaOnly = true;
-
-        for (ptrdiff_t y = 0; alphaOnly && y < image.height(); y++) {
-            const uint32_t * const src = reinterpret_cast<const uint32_t *>(image.scanLine(y));
-            uint8_t * const dst = reinterpret_cast<uint8_t *>(alphaImage.scanLine(y));
-
-            for (ptrdiff_t x = 0; x < image.width(); x++) {
-                if (src[x] & 0x00ffffff)
-                    alphaOnly = false;
-
-                dst[x] = qAlpha(src[x]);
-            }
-        }
-
-        if (alphaOnly) {
-            image = alphaImage;
-        }
-    }
-
-    Scene *scene = Compositor::self()->scene();
-    scene->makeOpenGLContextCurrent();
-    m_texture = QSharedPointer<GLTexture>::create(image);
-
-    if (m_texture->internalFormat() == GL_R8) {
-        // Swizzle red to alpha and all other channels to zero
-        m_texture->bind();
-        m_texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
-    }
-
-    return true;
+    return image;
 }
 
 SceneOpenGLDecorationRenderer::SceneOpenGLDecorationRenderer(Decoration::DecoratedClientImpl *client)
@@ -2543,6 +3025,10 @@ void SceneOpenGLDecorationRenderer::render()
         return;
     }
 
+    if (renderFromView()) {
+        return;
+    }
+
     QRect left, top, right, bottom;
     client()->client()->layoutDecorationRects(left, top, right, bottom);
 
@@ -2565,6 +3051,103 @@ void SceneOpenGLDecorationRenderer::render()
     renderPart(bottom.intersected(geometry), bottom, QPoint(0, top.height() + 1));
 }
 
+// Copies the decoration parts from the texture of the view the decoration is rendered
+// with, if the decoration exposes one, instead of painting the decoration into images
+// which would have to be read back from the view and uploaded again.
+bool SceneOpenGLDecorationRenderer::renderFromView()
+{
+    KDecoration2::Decoration *decoration = client()->decoration();
+    EffectQuickView *view = qobject_cast<EffectQuickView *>(decoration->property("bufferView").value<QObject *>());
+    if (!view) {
+        return false;
+    }
+    GLTexture *source = view->bufferAsTexture();
+    const QRect contentRect = decoration->property("bufferContentRect").toRect();
+    if (!source || contentRect.isEmpty()) {
+        // the view hasn't rendered yet, it schedules a repaint once it has
+        return true;
+    }
+
+    if (!m_renderTarget) {
+        m_renderTarget.reset(new GLRenderTarget(*m_texture));
+    }
+    if (!m_renderTarget->valid()) {
+        // painting the decoration instead reads the texture back with the context of the view,
+        // so that's done up front and the context of the compositor made current again
+        view->bufferAsImage();
+        if (Scene *scene = Compositor::self()->scene()) {
+            scene->makeOpenGLContextCurrent();
+        }
+        return false;
+    }
+
+    QRect left, top, right, bottom;
+    client()->client()->layoutDecorationRects(left, top, right, bottom);
+
+    // the content rect of the buffer is stretched over the decoration, like painting does
+    const QSize size = client()->client()->size();
+    const qreal scaleX = qreal(size.width()) / contentRect.width();
+    const qreal scaleY = qreal(size.height()) / contentRect.height();
+    const qreal scale = client()->client()->screenScale();
+
+    // maps the rows of the atlas from top to bottom like the uploaded images do
+    QMatrix4x4 projection;
+    projection.ortho(0, m_texture->width(), 0, m_texture->height(), 0, 65535);
+
+    GLint scissorBox[4];
+    glGetIntegerv(GL_SCISSOR_BOX, scissorBox);
+    const bool scissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+    const bool blendEnabled = glIsEnabled(GL_BLEND);
+    glEnable(GL_SCISSOR_TEST);
+    glDisable(GL_BLEND);
+
+    GLRenderTarget::pushRenderTarget(m_renderTarget.data());
+    ShaderBinder binder(ShaderTrait::MapTexture);
+    source->setFilter(GL_LINEAR);
+    source->setWrapMode(GL_CLAMP_TO_EDGE);
+    source->bind();
+
+    auto renderPart = [&](const QRect &partRect, const QPoint &offset, bool rotated = false) {
+        if (!partRect.isValid()) {
+            return;
+        }
+        const QRect targetRect(offset * scale, (rotated ? partRect.size().transposed() : partRect.size()) * scale);
+        QMatrix4x4 mvp = projection;
+        mvp.translate(targetRect.x(), targetRect.y());
+        if (rotated) {
+            // swaps the axes, the same as rotate() does
+            mvp *= QMatrix4x4(0, 1, 0, 0,
+                              1, 0, 0, 0,
+                              0, 0, 1, 0,
+                              0, 0, 0, 1);
+        }
+        mvp.scale(scale);
+        mvp.translate(-partRect.x(), -partRect.y());
+        mvp.scale(scaleX, scaleY);
+        mvp.translate(-contentRect.x(), -contentRect.y());
+        binder.shader()->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+
+        glScissor(targetRect.x(), targetRect.y(), targetRect.width(), targetRect.height());
+        source->render(QRegion(), QRect(QPoint(0, 0), source->size()));
+    };
+    renderPart(left, QPoint(0, top.height() + bottom.height() + 2), true);
+    renderPart(top, QPoint(0, 0));
+    renderPart(right, QPoint(0, top.height() + bottom.height() + left.width() + 3), true);
+    renderPart(bottom, QPoint(0, top.height() + 1));
+
+    source->unbind();
+    GLRenderTarget::popRenderTarget();
+
+    if (blendEnabled) {
+        glEnable(GL_BLEND);
+    }
+    if (!scissorEnabled) {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+    return true;
+}
+
 static int align(int value, int align)
 {
     return (value + align - 1) & ~(align - 1);
@@ -2587,6 +3170,7 @@ void SceneOpenGLDecorationRenderer::resizeTexture()
     if (m_texture && m_texture->size() == size)
         return;
 
+    m_renderTarget.reset();
     if (!size.isEmpty()) {
         m_texture.reset(new GLTexture(GL_RGBA8, size.width(), size.height()));
         m_texture->setYInverted(true);
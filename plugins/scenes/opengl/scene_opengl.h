@@ -24,23 +24,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "scene.h"
 #include "shadow.h"
+#include "renderlist.h"
 
 #include "kwinglutils.h"
 
 #include "decorations/decorationrenderer.h"
 #include "platformsupport/scenes/opengl/backend.h"
 
+#include <QCache>
+
 namespace KWin
 {
+class GpuTimerQueries;
 class LanczosFilter;
+class CursorBackingStore;
 class OpenGLBackend;
 class SyncManager;
 class SyncObject;
+class TextureResidency;
 
 class KWIN_EXPORT SceneOpenGL
     : public Scene
 {
     Q_OBJECT
+    /**
+     * The number of frames presented with paintCursorOnly.
+     */
+    Q_PROPERTY(quint64 cursorOnlyFrames READ cursorOnlyFrames)
 public:
     class EffectFrame;
     class Window;
@@ -48,6 +58,8 @@ public:
     bool initFailed() const override;
     bool hasPendingFlush() const override;
     qint64 paint(QRegion damage, QList<Toplevel *> windows) override;
+    bool canPaintCursorOnly() const override;
+    qint64 paintCursorOnly(const QRegion &damage) override;
     Scene::EffectFrame *createEffectFrame(EffectFrameImpl *frame) override;
     Shadow *createShadow(Toplevel *toplevel) override;
     void screenGeometryChanged(const QSize &size) override;
@@ -80,6 +92,15 @@ public:
     }
 
     QVector<QByteArray> openGLPlatformInterfaceExtensions() const override;
+    QVariantMap textureMemory() const override;
+
+    TextureResidency *textureResidency() const {
+        return m_textureResidency;
+    }
+
+    quint64 cursorOnlyFrames() const {
+        return m_cursorOnlyFrames;
+    }
 
     static SceneOpenGL *createScene(QObject *parent);
 
@@ -100,16 +121,36 @@ protected:
     bool init_ok;
 private:
     bool viewportLimitsMatched(const QSize &size) const;
+    int startGpuTimer();
+    void frameRendered(int gpuTimer);
+    void saveCursorBackingStore(int screen, const QRegion &update, const QRegion &valid);
+    void discardCursorBackingStores();
 private:
     bool m_debug;
     OpenGLBackend *m_backend;
     SyncManager *m_syncManager;
     SyncObject *m_currentFence;
+    GpuTimerQueries *m_gpuTimerQueries = nullptr;
+    TextureResidency *m_textureResidency;
+    /**
+     * The screens without the software cursor, one per screen, if the software
+     * cursor is used.
+     */
+    QVector<CursorBackingStore *> m_cursorBackingStores;
+    quint64 m_cursorOnlyFrames = 0;
 };
 
 class SceneOpenGL2 : public SceneOpenGL
 {
     Q_OBJECT
+    /**
+     * Counters of the window draws submitted in the last frame.
+     */
+    Q_PROPERTY(int renderItems READ renderItems)
+    Q_PROPERTY(int drawCalls READ drawCalls)
+    Q_PROPERTY(int stateChanges READ stateChanges)
+    Q_PROPERTY(int shaderChanges READ shaderChanges)
+    Q_PROPERTY(int textureChanges READ textureChanges)
 public:
     explicit SceneOpenGL2(OpenGLBackend *backend, QObject *parent = nullptr);
     ~SceneOpenGL2() override;
@@ -122,6 +163,39 @@ public:
     QMatrix4x4 projectionMatrix() const override { return m_projectionMatrix; }
     QMatrix4x4 screenProjectionMatrix() const override { return m_screenProjectionMatrix; }
 
+    qint64 paint(QRegion damage, QList<Toplevel *> windows) override;
+
+    /**
+     * The render list window draws get recorded into while painting a simple screen,
+     * or @c null if windows have to be drawn immediately.
+     */
+    RenderList *renderList() {
+        return m_batchWindows ? &m_renderList : nullptr;
+    }
+    /**
+     * Draws all pending items of the render list.
+     */
+    void flushRenderList();
+    RenderList::Statistics &frameStatistics() {
+        return m_renderList.statistics();
+    }
+
+    int renderItems() const {
+        return m_renderList.statistics().items;
+    }
+    int drawCalls() const {
+        return m_renderList.statistics().drawCalls;
+    }
+    int stateChanges() const {
+        return m_renderList.statistics().stateChanges();
+    }
+    int shaderChanges() const {
+        return m_renderList.statistics().shaderChanges;
+    }
+    int textureChanges() const {
+        return m_renderList.statistics().textureChanges;
+    }
+
 protected:
     void paintSimpleScreen(int mask, QRegion region) override;
     void paintGenericScreen(int mask, ScreenPaintData data) override;
@@ -137,10 +211,15 @@ private:
 
 private:
     LanczosFilter *m_lanczosFilter;
-    QScopedPointer<GLTexture> m_cursorTexture;
+    /**
+     * The textures of the recently shown cursor images, keyed by QImage::cacheKey.
+     */
+    QCache<qint64, GLTexture> m_cursorTextures;
     QMatrix4x4 m_projectionMatrix;
     QMatrix4x4 m_screenProjectionMatrix;
     GLuint vao;
+    RenderList m_renderList;
+    bool m_batchWindows = false;
 };
 
 class SceneOpenGL::Window
@@ -206,6 +285,10 @@ protected:
     void performPaint(int mask, QRegion region, WindowPaintData data) override;
 
 private:
+    GLenum textureFilter(int mask) const;
+    bool canBatch(int mask, const WindowPaintData &data) const;
+    void recordPaint(RenderList *list, const WindowPaintData &data);
+    void recordSubSurface(RenderList *list, const RenderList::Item &state, const QPointF &offset, OpenGLWindowPixmap *pixmap);
     void renderSubSurface(GLShader *shader, const QMatrix4x4 &mvp, const QMatrix4x4 &windowMatrix, OpenGLWindowPixmap *pixmap, const QRegion &region, bool hardwareClipping);
     /**
      * Whether prepareStates enabled blending and restore states should disable again.
@@ -221,6 +304,14 @@ public:
     SceneOpenGLTexture *texture() const;
     bool bind();
     bool isValid() const override;
+    /**
+     * The approximate amount of memory the textures of this pixmap and its children occupy.
+     */
+    qint64 textureSize() const;
+    /**
+     * Releases the textures of this pixmap and its children, they get loaded again on the next bind.
+     */
+    void discardTexture();
 protected:
     WindowPixmap *createChild(const QPointer<KWayland::Server::SubSurfaceInterface> &subSurface) override;
 private:
@@ -287,6 +378,7 @@ protected:
     void buildQuads() override;
     bool prepareBackend() override;
 private:
+    QImage composeImage() const;
     QSharedPointer<GLTexture> m_texture;
 };
 
@@ -316,7 +408,9 @@ public:
 
 private:
     void resizeTexture();
+    bool renderFromView();
     QScopedPointer<GLTexture> m_texture;
+    QScopedPointer<GLRenderTarget> m_renderTarget;
 };
 
 inline bool SceneOpenGL::hasPendingFlush() const
@@ -0,0 +1,244 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "textureresidency.h"
+#include "scene_opengl.h"
+
+#include "options.h"
+#include "toplevel.h"
+#include "virtualdesktops.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+/**
+ * The number of released textures loaded again per frame, so that re-warming doesn't
+ * cause a frame drop on its own.
+ */
+static const int s_rewarmsPerFrame = 2;
+
+/**
+ * The part of the budget window textures are released down to and loaded again up to, so that
+ * a re-warmed texture isn't released right again in the next frame.
+ */
+static qint64 headroom(qint64 budget)
+{
+    return budget * 3 / 4;
+}
+
+TextureResidency::TextureResidency(QObject *parent)
+    : QObject(parent)
+{
+    connect(VirtualDesktopManager::self(), &VirtualDesktopManager::currentChanged, this,
+        [this](uint previousDesktop) {
+            m_previousDesktop = previousDesktop;
+        }
+    );
+}
+
+TextureResidency::~TextureResidency()
+{
+}
+
+qint64 TextureResidency::textureSize(const GLTexture *texture)
+{
+    if (!texture || texture->isNull()) {
+        return 0;
+    }
+    return qint64(texture->width()) * texture->height() * 4;
+}
+
+void TextureResidency::touch(OpenGLWindowPixmap *pixmap)
+{
+    Entry &entry = m_entries[pixmap];
+    const qint64 size = pixmap->textureSize();
+    m_residentSize += size - (entry.resident ? entry.size : 0);
+    entry.size = size;
+    entry.lastPainted = m_frame;
+    entry.resident = true;
+}
+
+void TextureResidency::remove(OpenGLWindowPixmap *pixmap)
+{
+    auto it = m_entries.find(pixmap);
+    if (it == m_entries.end()) {
+        return;
+    }
+    if (it->resident) {
+        m_residentSize -= it->size;
+    }
+    m_entries.erase(it);
+}
+
+void TextureResidency::endFrame()
+{
+    const qint64 budget = qint64(options->textureMemoryBudget()) * 1024 * 1024;
+    if (budget > 0 && m_residentSize > budget) {
+        evict(budget);
+    }
+    rewarm(budget);
+    m_frame++;
+}
+
+void TextureResidency::evict(qint64 budget)
+{
+    struct Candidate
+    {
+        OpenGLWindowPixmap *pixmap;
+        quint64 lastPainted;
+        bool predicted;
+    };
+    QVector<Candidate> candidates;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        OpenGLWindowPixmap *pixmap = it.key();
+        if (!it->resident || it->lastPainted == m_frame) {
+            continue;
+        }
+        // the pixmaps of closed windows can't be loaded again, neither can a texture shared
+        // with the framebuffer object of an internal window be released
+        const Toplevel *toplevel = pixmap->toplevel();
+        if (toplevel->isDeleted() || toplevel->isOnCurrentDesktop() || !pixmap->fbo().isNull()) {
+            continue;
+        }
+        candidates << Candidate{pixmap, it->lastPainted, isPredicted(toplevel)};
+    }
+    // the windows the user is likely to switch to go last
+    std::sort(candidates.begin(), candidates.end(),
+        [](const Candidate &a, const Candidate &b) {
+            if (a.predicted != b.predicted) {
+                return b.predicted;
+            }
+            return a.lastPainted < b.lastPainted;
+        }
+    );
+
+    // Release down to the headroom and make room for the released textures of predicted
+    // windows on top, otherwise those can't be loaded again. Predicted windows only give up
+    // their texture as far as it takes to get within the budget.
+    qint64 target = headroom(budget);
+    const QVector<OpenGLWindowPixmap *> pending = rewarmCandidates();
+    for (int i = 0; i < pending.count() && i < s_rewarmsPerFrame; ++i) {
+        target -= m_entries[pending[i]].size;
+    }
+
+    for (const Candidate &candidate : qAsConst(candidates)) {
+        if (m_residentSize <= (candidate.predicted ? budget : target)) {
+            break;
+        }
+        OpenGLWindowPixmap *pixmap = candidate.pixmap;
+        Entry &entry = m_entries[pixmap];
+        pixmap->discardTexture();
+        entry.resident = false;
+        m_residentSize -= entry.size;
+        m_evictions++;
+    }
+}
+
+QVector<OpenGLWindowPixmap *> TextureResidency::rewarmCandidates() const
+{
+    QVector<OpenGLWindowPixmap *> candidates;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (!it->resident && !it.key()->toplevel()->isDeleted() && isPredicted(it.key()->toplevel())) {
+            candidates << it.key();
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+        [this](OpenGLWindowPixmap *a, OpenGLWindowPixmap *b) {
+            return m_entries[a].lastPainted > m_entries[b].lastPainted;
+        }
+    );
+    return candidates;
+}
+
+void TextureResidency::rewarm(qint64 budget)
+{
+    const QVector<OpenGLWindowPixmap *> candidates = rewarmCandidates();
+    if (candidates.isEmpty()) {
+        return;
+    }
+
+    const qint64 limit = headroom(budget);
+    int rewarmed = 0;
+    for (OpenGLWindowPixmap *pixmap : qAsConst(candidates)) {
+        if (rewarmed == s_rewarmsPerFrame) {
+            break;
+        }
+        if (budget > 0 && m_residentSize + m_entries[pixmap].size > limit) {
+            continue;
+        }
+        // binding loads the texture and touches the entry
+        if (pixmap->bind()) {
+            m_rewarms++;
+        }
+        rewarmed++;
+    }
+}
+
+bool TextureResidency::isPredicted(const Toplevel *toplevel) const
+{
+    if (m_previousDesktop && toplevel->isOnDesktop(m_previousDesktop)) {
+        return true;
+    }
+    VirtualDesktopManager *manager = VirtualDesktopManager::self();
+    const bool wrap = manager->isNavigationWrappingAround();
+    const uint neighbours[] = {
+        manager->toLeft(0, wrap),
+        manager->toRight(0, wrap),
+        manager->above(0, wrap),
+        manager->below(0, wrap)
+    };
+    for (uint desktop : neighbours) {
+        if (toplevel->isOnDesktop(desktop)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QVector<Toplevel *> TextureResidency::toplevels() const
+{
+    QVector<Toplevel *> toplevels;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        Toplevel *toplevel = it.key()->toplevel();
+        if (!toplevels.contains(toplevel)) {
+            toplevels << toplevel;
+        }
+    }
+    return toplevels;
+}
+
+QVariantMap TextureResidency::statistics() const
+{
+    int resident = 0;
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        if (it->resident) {
+            resident++;
+        }
+    }
+    QVariantMap map;
+    map.insert(QStringLiteral("budget"), qint64(options->textureMemoryBudget()) * 1024 * 1024);
+    map.insert(QStringLiteral("windowTextures"), m_residentSize);
+    map.insert(QStringLiteral("residentWindows"), resident);
+    map.insert(QStringLiteral("evictedWindows"), m_entries.count() - resident);
+    map.insert(QStringLiteral("evictions"), m_evictions);
+    map.insert(QStringLiteral("rewarms"), m_rewarms);
+    return map;
+}
+
+}
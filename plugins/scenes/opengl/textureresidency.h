@@ -0,0 +1,103 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+
+#ifndef KWIN_SCENE_OPENGL_TEXTURERESIDENCY_H
+#define KWIN_SCENE_OPENGL_TEXTURERESIDENCY_H
+
+#include <QHash>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+namespace KWin
+{
+
+class GLTexture;
+class OpenGLWindowPixmap;
+class Toplevel;
+
+/**
+ * @short Keeps the memory occupied by window textures within the configured budget.
+ *
+ * Every window pixmap reports to the residency when its texture got bound for painting. At the
+ * end of a frame the textures of the windows which are neither on the current desktop nor
+ * painted in that frame are released once the window textures exceed
+ * Options::textureMemoryBudget, least recently painted first and those of predicted windows last,
+ * until they fit into three quarters of the budget. A released texture is loaded again from the
+ * window pixmap the next time the window gets painted.
+ *
+ * To avoid a stall on switching desktops, released textures of windows on the desktops the user
+ * is likely to switch to next, the previous desktop and the neighbours of the current desktop,
+ * are loaded again a few per frame while there is enough room left in the budget.
+ */
+class TextureResidency : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TextureResidency(QObject *parent = nullptr);
+    ~TextureResidency() override;
+
+    /**
+     * Marks the texture of @p pixmap as used in the current frame.
+     */
+    void touch(OpenGLWindowPixmap *pixmap);
+    void remove(OpenGLWindowPixmap *pixmap);
+    /**
+     * Enforces the budget and loads the textures of predicted windows again. Must be called
+     * with the OpenGL context current.
+     */
+    void endFrame();
+
+    /**
+     * The windows which have a texture or had one before it got released.
+     */
+    QVector<Toplevel *> toplevels() const;
+    /**
+     * Counters and sizes in bytes of the window textures, see
+     * CompositorDBusInterface::textureMemory.
+     */
+    QVariantMap statistics() const;
+
+    /**
+     * The approximate amount of memory @p texture occupies, assuming four bytes per pixel.
+     */
+    static qint64 textureSize(const GLTexture *texture);
+
+private:
+    struct Entry
+    {
+        qint64 size = 0;
+        quint64 lastPainted = 0;
+        bool resident = false;
+    };
+    void evict(qint64 budget);
+    void rewarm(qint64 budget);
+    QVector<OpenGLWindowPixmap *> rewarmCandidates() const;
+    bool isPredicted(const Toplevel *toplevel) const;
+
+    QHash<OpenGLWindowPixmap *, Entry> m_entries;
+    qint64 m_residentSize = 0;
+    quint64 m_frame = 1;
+    quint64 m_evictions = 0;
+    quint64 m_rewarms = 0;
+    uint m_previousDesktop = 0;
+};
+
+}
+
+#endif
@@ -59,6 +59,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 namespace KWin
 {
 
+// enough for the frames of an animated cursor
+static const int s_recentServerCursors = 16;
+
 static const QHash<uint32_t, Qt::MouseButton> s_buttonToQtMouseButton = {
     { BTN_LEFT , Qt::LeftButton },
     { BTN_MIDDLE , Qt::MiddleButton },
@@ -1140,13 +1143,32 @@ void CursorImage::updateServerCursor()
         return;
     }
     m_serverCursor.hotSpot = c->hotspot();
-    m_serverCursor.image = buffer->data().copy();
-    m_serverCursor.image.setDevicePixelRatio(cursorSurface->scale());
+    m_serverCursor.image = serverCursorImage(buffer->data(), cursorSurface->scale());
     if (needsEmit) {
         emit changed();
     }
 }
 
+QImage CursorImage::serverCursorImage(const QImage &buffer, qreal scale)
+{
+    // the cursor renderers cache their textures and buffers by the QImage::cacheKey,
+    // so an image which was shown recently has to be handed out again
+    for (int i = 0; i < m_serverCursor.recentImages.count(); ++i) {
+        const QImage &image = m_serverCursor.recentImages.at(i);
+        if (image.devicePixelRatio() == scale && image == buffer) {
+            m_serverCursor.recentImages.move(i, 0);
+            return m_serverCursor.recentImages.first();
+        }
+    }
+    QImage image = buffer.copy();
+    image.setDevicePixelRatio(scale);
+    m_serverCursor.recentImages.prepend(image);
+    if (m_serverCursor.recentImages.count() > s_recentServerCursors) {
+        m_serverCursor.recentImages.removeLast();
+    }
+    return image;
+}
+
 void CursorImage::loadTheme()
 {
     if (m_cursorTheme) {
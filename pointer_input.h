@@ -205,6 +205,7 @@ private:
     void reevaluteSource();
     void update();
     void updateServerCursor();
+    QImage serverCursorImage(const QImage &buffer, qreal scale);
     void updateDecoration();
     void updateDecorationCursor();
     void updateMoveResize();
@@ -239,6 +240,11 @@ private:
         QMetaObject::Connection connection;
         QImage image;
         QPoint hotSpot;
+        /**
+         * The most recently used images, so that an animated cursor, which attaches a new
+         * buffer for every frame, keeps getting the same QImage for the same frame.
+         */
+        QVector<QImage> recentImages;
     } m_serverCursor;
 
     Image m_effectsCursor;
@@ -74,6 +74,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "x11client.h"
 #include "deleted.h"
 #include "effects.h"
+#include "frametimings.h"
 #include "overlaywindow.h"
 #include "screens.h"
 #include "shadow.h"
@@ -121,7 +122,10 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     pdata.mask = *mask;
     pdata.paint = region;
 
-    effects->prePaintScreen(pdata, time_diff);
+    {
+        FrameTimingScope scope(FrameTimings::PrePaint);
+        effects->prePaintScreen(pdata, time_diff);
+    }
     *mask = pdata.mask;
     region = pdata.paint;
 
@@ -139,24 +143,34 @@ void Scene::paintScreen(int* mask, const QRegion &damage, const QRegion &repaint
     }
 
     painted_region = region;
-    repaint_region = repaint;
+    // the offscreen target is up to date apart from the damage, unlike a reused back buffer
+    repaint_region = (*mask & PAINT_SCREEN_OFFSCREEN) ? QRegion() : repaint;
 
     if (*mask & PAINT_SCREEN_BACKGROUND_FIRST) {
         paintBackground(region);
     }
 
-    ScreenPaintData data(projection, outputGeometry);
-    effects->paintScreen(*mask, region, data);
+    {
+        FrameTimingScope scope(FrameTimings::Painting);
+        ScreenPaintData data(projection, outputGeometry);
+        effects->paintScreen(*mask, region, data);
 
-    foreach (Window *w, stacking_order) {
-        effects->postPaintWindow(effectWindow(w));
-    }
+        foreach (Window *w, stacking_order) {
+            effects->postPaintWindow(effectWindow(w));
+        }
 
-    effects->postPaintScreen();
+        effects->postPaintScreen();
+    }
 
-    // make sure not to go outside of the screen area
-    *updateRegion = damaged_region;
-    *validRegion = (region | painted_region) & displayRegion;
+    if (*mask & PAINT_SCREEN_OFFSCREEN) {
+        // the whole back buffer has been painted from the offscreen target
+        *updateRegion = displayRegion;
+        *validRegion = displayRegion;
+    } else {
+        // make sure not to go outside of the screen area
+        *updateRegion = damaged_region;
+        *validRegion = (region | painted_region) & displayRegion;
+    }
 
     repaint_region = QRegion();
     damaged_region = QRegion();
@@ -190,6 +204,17 @@ void Scene::idle()
     last_time.invalidate();
 }
 
+bool Scene::canPaintCursorOnly() const
+{
+    return false;
+}
+
+qint64 Scene::paintCursorOnly(const QRegion &damage)
+{
+    Q_UNUSED(damage)
+    return 0;
+}
+
 // the function that'll be eventually called by paintScreen() above
 void Scene::finalPaintScreen(int mask, QRegion region, ScreenPaintData& data)
 {
@@ -208,6 +233,11 @@ void Scene::paintGenericScreen(int orig_mask, ScreenPaintData)
     }
     QVector<Phase2Data> phase2;
     phase2.reserve(stacking_order.size());
+    FrameTimings *timings = FrameTimings::self();
+    const bool recording = timings && timings->isRecording();
+    if (recording) {
+        timings->enter(FrameTimings::PrePaint);
+    }
     foreach (Window * w, stacking_order) { // bottom to top
         Toplevel* topw = w->window();
 
@@ -232,8 +262,13 @@ void Scene::paintGenericScreen(int orig_mask, ScreenPaintData)
         if (!w->isPaintingEnabled()) {
             continue;
         }
+        // without clipping there is no way to tell whether the window is covered
+        w->setOccluded(false);
         phase2.append({w, infiniteRegion(), data.clip, data.mask, data.quads});
     }
+    if (recording) {
+        timings->leave();
+    }
 
     foreach (const Phase2Data & d, phase2) {
         paintWindow(d.window, d.mask, d.region, d.quads);
@@ -256,6 +291,12 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
     QRegion dirtyArea = region;
     bool opaqueFullscreen = false;
 
+    FrameTimings *timings = FrameTimings::self();
+    const bool recording = timings && timings->isRecording();
+    if (recording) {
+        timings->enter(FrameTimings::PrePaint);
+    }
+
     // Traverse the scene windows from bottom to top.
     for (int i = 0; i < stacking_order.count(); ++i) {
         Window *window = stacking_order[i];
@@ -305,6 +346,11 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         phase2data.append({ window, data.paint, data.clip, data.mask, data.quads });
     }
 
+    if (recording) {
+        timings->leave();
+        timings->enter(FrameTimings::Culling);
+    }
+
     // Save the part of the repaint region that's exclusively rendered to
     // bring a reused back buffer up to date. Then union the dirty region
     // with the repaint region.
@@ -336,6 +382,15 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         // a higher opaque window
         data->region -= allclips;
 
+        // frame callbacks of Wayland clients whose contents are completely covered by
+        // opaque windows or off screen get throttled
+        if (data->window->window()->surface()) {
+            const QRegion contents = data->window->clientShape().translated(data->window->pos() + data->window->bufferOffset());
+            data->window->setOccluded(((contents & displayRegion) - allclips).isEmpty());
+        } else {
+            data->window->setOccluded(false);
+        }
+
         // Here we rely on WindowPrePaintData::setTranslucent() to remove
         // the clip if needed.
         if (!data->clip.isEmpty() && !(data->mask & PAINT_WINDOW_TRANSLUCENT)) {
@@ -350,6 +405,10 @@ void Scene::paintSimpleScreen(int orig_mask, QRegion region)
         }
     }
 
+    if (recording) {
+        timings->leave();
+    }
+
     QRegion paintedArea;
     // Fill any areas of the root window not covered by opaque windows
     if (!(orig_mask & PAINT_SCREEN_BACKGROUND_FIRST)) {
@@ -443,10 +502,14 @@ void Scene::windowGeometryShapeChanged(Toplevel *c)
 
 void Scene::createStackingOrder(QList<Toplevel *> toplevels)
 {
+    FrameTimingScope scope(FrameTimings::Stacking);
     // TODO: cache the stacking_order in case it has not changed
     foreach (Toplevel *c, toplevels) {
         Q_ASSERT(m_windows.contains(c));
-        stacking_order.append(m_windows[ c ]);
+        Window *window = m_windows[ c ];
+        // until painting the frame proves otherwise
+        window->setOccluded(true);
+        stacking_order.append(window);
     }
 }
 
@@ -475,7 +538,10 @@ void Scene::paintWindow(Window* w, int mask, QRegion region, WindowQuadList quad
 
     WindowPaintData data(w->window()->effectWindow(), screenProjectionMatrix());
     data.quads = quads;
+    Window *previousPaintedWindow = m_paintedWindow;
+    m_paintedWindow = w;
     effects->paintWindow(effectWindow(w), mask, region, data);
+    m_paintedWindow = previousPaintedWindow;
     // paint thumbnails on top of window
     paintWindowThumbnails(w, region, data.opacity(), data.brightness(), data.saturation());
     // and desktop thumbnails
@@ -672,6 +738,11 @@ QVector<QByteArray> Scene::openGLPlatformInterfaceExtensions() const
     return QVector<QByteArray>{};
 }
 
+QVariantMap Scene::textureMemory() const
+{
+    return QVariantMap();
+}
+
 //****************************************
 // Scene::Window
 //****************************************
@@ -711,6 +782,14 @@ void Scene::Window::unreferencePreviousPixmap()
     }
 }
 
+void Scene::Window::releasePixmap()
+{
+    m_currentPixmap.reset();
+    if (m_referencePixmapCounter == 0) {
+        m_previousPixmap.reset();
+    }
+}
+
 void Scene::Window::pixmapDiscarded()
 {
     if (!m_currentPixmap.isNull()) {
@@ -77,6 +77,20 @@ public:
     // returns the time since the last vblank signal - if there's one
     // ie. "what of this frame is lost to painting"
     virtual qint64 paint(QRegion damage, QList<Toplevel *> windows) = 0;
+    /**
+     * Whether the next frame can be presented with paintCursorOnly, because the previous
+     * frames have been kept without the software cursor. The default implementation
+     * returns @c false.
+     */
+    virtual bool canPaintCursorOnly() const;
+    /**
+     * Presents a frame in which only the software cursor changed, without painting the
+     * windows and effects again. The @p damage holds the previous and the new geometry
+     * of the cursor.
+     *
+     * Only called if canPaintCursorOnly returns @c true. Returns the same as paint.
+     */
+    virtual qint64 paintCursorOnly(const QRegion &damage);
 
     /**
      * Adds the Toplevel to the Scene.
@@ -138,8 +152,10 @@ public:
         PAINT_SCREEN_BACKGROUND_FIRST = 1 << 6,
         // PAINT_DECORATION_ONLY = 1 << 7 has been removed
         // Window will be painted with a lanczos filter.
-        PAINT_WINDOW_LANCZOS = 1 << 8
+        PAINT_WINDOW_LANCZOS = 1 << 8,
         // PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS_WITHOUT_FULL_REPAINTS = 1 << 9 has been removed
+        // Screen is painted into an offscreen target which is presented on the whole screen.
+        PAINT_SCREEN_OFFSCREEN = 1 << 10
     };
     // types of filtering available
     enum ImageFilterType { ImageFilterFast, ImageFilterGood };
@@ -197,6 +213,14 @@ public:
      */
     virtual QVector<QByteArray> openGLPlatformInterfaceExtensions() const;
 
+    /**
+     * The sizes in bytes of the textures held by the Scene, see
+     * CompositorDBusInterface::textureMemory.
+     *
+     * Default implementation returns an empty map
+     */
+    virtual QVariantMap textureMemory() const;
+
 Q_SIGNALS:
     void frameRendered();
     void resetCompositing();
@@ -267,6 +291,8 @@ private:
     QHash< Toplevel*, Window* > m_windows;
     // windows in their stacking order
     QVector< Window* > stacking_order;
+    // the window going through the effects' paintWindow() chain from paintWindow()
+    Window *m_paintedWindow = nullptr;
 };
 
 /**
@@ -328,6 +354,13 @@ public:
     void disablePainting(int reason);
     // is the window visible at all
     bool isVisible() const;
+    // was no part of the window's contents visible in the last painted frame
+    bool isOccluded() const {
+        return m_occluded;
+    }
+    void setOccluded(bool occluded) {
+        m_occluded = occluded;
+    }
     // is the window fully opaque
     bool isOpaque() const;
     // shape of the window
@@ -344,6 +377,8 @@ public:
     Shadow* shadow();
     void referencePreviousPixmap();
     void unreferencePreviousPixmap();
+    // drops the window pixmaps, the previous one only if no effect references it
+    void releasePixmap();
     void invalidateQuadsCache();
 protected:
     WindowQuadList makeDecorationQuads(const QRect *rects, const QRegion &region, qreal textureScale = 1.0) const;
@@ -380,6 +415,7 @@ private:
     QScopedPointer<WindowPixmap> m_previousPixmap;
     int m_referencePixmapCounter;
     int disable_painting;
+    bool m_occluded = false;
     mutable QRegion m_bufferShape;
     mutable bool m_bufferShapeIsValid = false;
     mutable QScopedPointer<WindowQuadList> cached_quad_list;
@@ -243,13 +243,19 @@ bool Edge::triggersFor(const QPoint &cursorPos) const
     return true;
 }
 
-bool Edge::check(const QPoint &cursorPos, const QDateTime &triggerTime, bool forceNoPushBack)
+// the milliseconds passed from @p from to @p to, unsigned arithmetic handles the wrap around
+static inline qint64 elapsed(quint32 from, quint32 to)
+{
+    return quint32(to - from);
+}
+
+bool Edge::check(const QPoint &cursorPos, quint32 triggerTime, bool forceNoPushBack)
 {
     if (!triggersFor(cursorPos)) {
         return false;
     }
-    if (m_lastTrigger.isValid() && // still in cooldown
-        m_lastTrigger.msecsTo(triggerTime) < edges()->reActivationThreshold() - edges()->timeThreshold()) {
+    if (m_lastTriggerValid && // still in cooldown
+        elapsed(m_lastTrigger, triggerTime) < edges()->reActivationThreshold() - edges()->timeThreshold()) {
         return false;
     }
     // no pushback so we have to activate at once
@@ -265,27 +271,29 @@ bool Edge::check(const QPoint &cursorPos, const QDateTime &triggerTime, bool for
     return false;
 }
 
-void Edge::markAsTriggered(const QPoint &cursorPos, const QDateTime &triggerTime)
+void Edge::markAsTriggered(const QPoint &cursorPos, quint32 triggerTime)
 {
     m_lastTrigger = triggerTime;
-    m_lastReset = QDateTime(); // invalidate
+    m_lastTriggerValid = true;
+    m_lastResetValid = false; // invalidate
     m_triggeredPoint = cursorPos;
 }
 
-bool Edge::canActivate(const QPoint &cursorPos, const QDateTime &triggerTime)
+bool Edge::canActivate(const QPoint &cursorPos, quint32 triggerTime)
 {
     // we check whether either the timer has explicitly been invalidated (successful trigger) or is
     // bigger than the reactivation threshold (activation "aborted", usually due to moving away the cursor
     // from the corner after successful activation)
     // either condition means that "this is the first event in a new attempt"
-    if (!m_lastReset.isValid() || m_lastReset.msecsTo(triggerTime) > edges()->reActivationThreshold()) {
+    if (!m_lastResetValid || elapsed(m_lastReset, triggerTime) > edges()->reActivationThreshold()) {
         m_lastReset = triggerTime;
+        m_lastResetValid = true;
         return false;
     }
-    if (m_lastTrigger.isValid() && m_lastTrigger.msecsTo(triggerTime) < edges()->reActivationThreshold() - edges()->timeThreshold()) {
+    if (m_lastTriggerValid && elapsed(m_lastTrigger, triggerTime) < edges()->reActivationThreshold() - edges()->timeThreshold()) {
         return false;
     }
-    if (m_lastReset.msecsTo(triggerTime) < edges()->timeThreshold()) {
+    if (elapsed(m_lastReset, triggerTime) < edges()->timeThreshold()) {
         return false;
     }
     // does the check on position make any sense at all?
@@ -1055,6 +1063,7 @@ void ScreenEdges::recreateEdges()
         }
     }
     qDeleteAll(oldEdges);
+    updateHotRegion();
 }
 
 void ScreenEdges::createVerticalEdge(ElectricBorder border, const QRect &screen, const QRect &fullArea)
@@ -1236,6 +1245,7 @@ void ScreenEdges::reserve(AbstractClient *client, ElectricBorder border)
         if (hadBorder) // show again
             client->showOnScreenEdge();
     }
+    updateHotRegion();
 }
 
 void ScreenEdges::reserveTouch(ElectricBorder border, QAction *action)
@@ -1340,10 +1350,25 @@ void ScreenEdges::deleteEdgeForClient(AbstractClient* c)
             it++;
         }
     }
+    updateHotRegion();
 }
 
-void ScreenEdges::check(const QPoint &pos, const QDateTime &now, bool forceNoPushBack)
+void ScreenEdges::updateHotRegion()
 {
+    m_hotRegion = QRegion();
+    for (const Edge *edge : qAsConst(m_edges)) {
+        m_hotRegion += edge->geometry();
+        m_hotRegion += edge->approachGeometry();
+    }
+    // make sure approaching gets updated with the next motion
+    m_pointerInHotRegion = true;
+}
+
+void ScreenEdges::check(const QPoint &pos, quint32 now, bool forceNoPushBack)
+{
+    if (!m_hotRegion.contains(pos)) {
+        return;
+    }
     bool activatedForClient = false;
     for (auto it = m_edges.begin(); it != m_edges.end(); ++it) {
         if (!(*it)->isReserved()) {
@@ -1372,6 +1397,13 @@ bool ScreenEdges::isEntered(QMouseEvent *event)
     if (event->type() != QEvent::MouseMove) {
         return false;
     }
+    // approaching edges are stopped by the first motion leaving the hot region
+    const bool inHotRegion = m_hotRegion.contains(event->globalPos());
+    if (!inHotRegion && !m_pointerInHotRegion) {
+        return false;
+    }
+    m_pointerInHotRegion = inHotRegion;
+    const quint32 timestamp = event->timestamp();
     bool activated = false;
     bool activatedForClient = false;
     for (auto it = m_edges.begin(); it != m_edges.end(); ++it) {
@@ -1394,7 +1426,7 @@ bool ScreenEdges::isEntered(QMouseEvent *event)
             }
         }
         if (edge->geometry().contains(event->globalPos())) {
-            if (edge->check(event->globalPos(), QDateTime::fromMSecsSinceEpoch(event->timestamp()))) {
+            if (edge->check(event->globalPos(), timestamp)) {
                 if (edge->client()) {
                     activatedForClient = true;
                 }
@@ -1404,14 +1436,14 @@ bool ScreenEdges::isEntered(QMouseEvent *event)
     if (activatedForClient) {
         for (auto it = m_edges.constBegin(); it != m_edges.constEnd(); ++it) {
             if ((*it)->client()) {
-                (*it)->markAsTriggered(event->globalPos(), QDateTime::fromMSecsSinceEpoch(event->timestamp()));
+                (*it)->markAsTriggered(event->globalPos(), timestamp);
             }
         }
     }
     return activated;
 }
 
-bool ScreenEdges::handleEnterNotifiy(xcb_window_t window, const QPoint &point, const QDateTime &timestamp)
+bool ScreenEdges::handleEnterNotifiy(xcb_window_t window, const QPoint &point, quint32 timestamp)
 {
     bool activated = false;
     bool activatedForClient = false;
@@ -1460,7 +1492,7 @@ bool ScreenEdges::handleDndNotify(xcb_window_t window, const QPoint &point)
         }
         if (edge->isReserved() && edge->window() == window) {
             updateXTime();
-            edge->check(point, QDateTime::fromMSecsSinceEpoch(xTime()), true);
+            edge->check(point, xTime(), true);
             return true;
         }
     }
@@ -36,8 +36,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QObject>
 #include <QVector>
-#include <QDateTime>
 #include <QRect>
+#include <QRegion>
 
 class QAction;
 class QMouseEvent;
@@ -62,8 +62,13 @@ public:
     bool isCorner() const;
     bool isScreenEdge() const;
     bool triggersFor(const QPoint &cursorPos) const;
-    bool check(const QPoint &cursorPos, const QDateTime &triggerTime, bool forceNoPushBack = false);
-    void markAsTriggered(const QPoint &cursorPos, const QDateTime &triggerTime);
+    /**
+     * @param triggerTime The time of the event in milliseconds, e.g. the X server time or the
+     * timestamp of the input event. Only the differences between times are used, so any
+     * monotonic clock works, and a wrap around of the 32 bit time is fine.
+     */
+    bool check(const QPoint &cursorPos, quint32 triggerTime, bool forceNoPushBack = false);
+    void markAsTriggered(const QPoint &cursorPos, quint32 triggerTime);
     bool isReserved() const;
     const QRect &approachGeometry() const;
 
@@ -124,7 +129,7 @@ protected:
 private:
     void activate();
     void deactivate();
-    bool canActivate(const QPoint &cursorPos, const QDateTime &triggerTime);
+    bool canActivate(const QPoint &cursorPos, quint32 triggerTime);
     void handle(const QPoint &cursorPos);
     bool handleAction(ElectricBorderAction action);
     bool handlePointerAction() {
@@ -144,8 +149,10 @@ private:
     int m_reserved;
     QRect m_geometry;
     QRect m_approachGeometry;
-    QDateTime m_lastTrigger;
-    QDateTime m_lastReset;
+    quint32 m_lastTrigger = 0;
+    quint32 m_lastReset = 0;
+    bool m_lastTriggerValid = false;
+    bool m_lastResetValid = false;
     QPoint m_triggeredPoint;
     QHash<QObject *, QByteArray> m_callBacks;
     bool m_approaching;
@@ -230,10 +237,10 @@ public:
      * Check, if a screen edge is entered and trigger the appropriate action
      * if one is enabled for the current region and the timeout is satisfied
      * @param pos the position of the mouse pointer
-     * @param now the time when the function is called
+     * @param now the time of the event in milliseconds, see Edge::check
      * @param forceNoPushBack needs to be called to workaround some DnD clients, don't use unless you want to chek on a DnD event
      */
-    void check(const QPoint& pos, const QDateTime &now, bool forceNoPushBack = false);
+    void check(const QPoint& pos, quint32 now, bool forceNoPushBack = false);
     /**
      * The (dpi dependent) length, reserved for the active corners of each edge - 1/3"
      */
@@ -346,7 +353,7 @@ public:
     }
 
     bool handleDndNotify(xcb_window_t window, const QPoint &point);
-    bool handleEnterNotifiy(xcb_window_t window, const QPoint &point, const QDateTime &timestamp);
+    bool handleEnterNotifiy(xcb_window_t window, const QPoint &point, quint32 timestamp);
 
 public Q_SLOTS:
     void reconfigure();
@@ -385,6 +392,7 @@ private:
     ElectricBorderAction actionForTouchEdge(Edge *edge) const;
     void createEdgeForClient(AbstractClient *client, ElectricBorder border);
     void deleteEdgeForClient(AbstractClient *client);
+    void updateHotRegion();
     bool m_desktopSwitching;
     bool m_desktopSwitchingMovingClients;
     QSize m_cursorPushBackDistance;
@@ -392,6 +400,14 @@ private:
     int m_reactivateThreshold;
     Qt::Orientations m_virtualDesktopLayout;
     QList<Edge*> m_edges;
+    /**
+     * The geometries and approach geometries of all edges. Pointer motion outside of it can't
+     * trigger or approach any edge, which spares the iteration over the edges for the common
+     * case of the pointer moving somewhere in the middle of the screen.
+     */
+    QRegion m_hotRegion;
+    // whether the pointer was in the hot region on the last motion, so approaching got stopped
+    bool m_pointerInHotRegion = true;
     KSharedConfig::Ptr m_config;
     ElectricBorderAction m_actionTopLeft;
     ElectricBorderAction m_actionTop;
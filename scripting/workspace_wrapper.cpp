@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 
 #include "workspace_wrapper.h"
+#include "../composite.h"
 #include "../x11client.h"
 #include "../outline.h"
 #include "../screens.h"
@@ -33,11 +34,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QDesktopWidget>
 #include <QApplication>
+#include <QMetaMethod>
+#include <QTimer>
 
 namespace KWin {
 
-WorkspaceWrapper::WorkspaceWrapper(QObject* parent) : QObject(parent)
+WorkspaceWrapper::WorkspaceWrapper(QObject* parent)
+    : QObject(parent)
+    , m_pendingChangesTimer(new QTimer(this))
 {
+    m_pendingChangesTimer->setSingleShot(true);
+    connect(m_pendingChangesTimer, &QTimer::timeout, this,
+        static_cast<void (WorkspaceWrapper::*)()>(&WorkspaceWrapper::deliverPendingChanges));
     KWin::Workspace *ws = KWin::Workspace::self();
     KWin::VirtualDesktopManager *vds = KWin::VirtualDesktopManager::self();
     connect(ws, &Workspace::desktopPresenceChanged, this, &WorkspaceWrapper::desktopPresenceChanged);
@@ -272,6 +280,86 @@ void WorkspaceWrapper::setupAbstractClientConnections(AbstractClient *client)
     connect(client, &AbstractClient::clientUnminimized, this, &WorkspaceWrapper::clientUnminimized);
     connect(client, qOverload<AbstractClient *, bool, bool>(&AbstractClient::clientMaximizedStateChanged),
             this, &WorkspaceWrapper::clientMaximizeSet);
+
+    connect(client, &AbstractClient::geometryChanged, this,
+        [this, client] {
+            addPendingChange(client, GeometryChange);
+        }
+    );
+    connect(client, &AbstractClient::clientStepUserMovedResized, this,
+        [this] (AbstractClient *client, const QRect &geometry) {
+            addPendingChange(client, MoveResizeStep, geometry);
+        }
+    );
+    connect(client, &AbstractClient::captionChanged, this,
+        [this, client] {
+            addPendingChange(client, CaptionChange);
+        }
+    );
+    connect(client, &AbstractClient::clientFinishUserMovedResized, this,
+        static_cast<void (WorkspaceWrapper::*)(AbstractClient *)>(&WorkspaceWrapper::deliverPendingChanges));
+    connect(client, &AbstractClient::windowClosed, this,
+        [this, client] {
+            m_pendingChanges.remove(client);
+        }
+    );
+}
+
+void WorkspaceWrapper::addPendingChange(AbstractClient *client, ClientChange change, const QRect &geometry)
+{
+    QMetaMethod signal;
+    switch (change) {
+    case GeometryChange:
+        signal = QMetaMethod::fromSignal(&WorkspaceWrapper::clientGeometryChanged);
+        break;
+    case MoveResizeStep:
+        signal = QMetaMethod::fromSignal(&WorkspaceWrapper::clientStepUserMovedResized);
+        break;
+    case CaptionChange:
+        signal = QMetaMethod::fromSignal(&WorkspaceWrapper::clientCaptionChanged);
+        break;
+    }
+    if (!isSignalConnected(signal)) {
+        return;
+    }
+
+    PendingChanges &pending = m_pendingChanges[client];
+    pending.changes |= change;
+    if (change == MoveResizeStep) {
+        pending.moveResizeGeometry = geometry;
+    }
+    if (m_pendingChangesTimer->isActive()) {
+        return;
+    }
+    // deliver with the next frame, or once the event loop is idle if not compositing
+    int interval = 0;
+    if (Compositor::compositing() && Compositor::self()->refreshRate() > 0) {
+        interval = 1000 / Compositor::self()->refreshRate();
+    }
+    m_pendingChangesTimer->start(interval);
+}
+
+void WorkspaceWrapper::deliverPendingChanges()
+{
+    const QList<AbstractClient *> clients = m_pendingChanges.keys();
+    for (AbstractClient *client : clients) {
+        deliverPendingChanges(client);
+    }
+}
+
+void WorkspaceWrapper::deliverPendingChanges(AbstractClient *client)
+{
+    // a script might close the window or change it again, the changes are taken first
+    const PendingChanges pending = m_pendingChanges.take(client);
+    if (pending.changes & MoveResizeStep) {
+        emit clientStepUserMovedResized(client, pending.moveResizeGeometry);
+    }
+    if (pending.changes & GeometryChange) {
+        emit clientGeometryChanged(client);
+    }
+    if (pending.changes & CaptionChange) {
+        emit clientCaptionChanged(client);
+    }
 }
 
 void WorkspaceWrapper::setupClientConnections(X11Client *client)
@@ -22,6 +22,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef KWIN_SCRIPTING_WORKSPACE_WRAPPER_H
 #define KWIN_SCRIPTING_WORKSPACE_WRAPPER_H
 
+#include <QHash>
 #include <QObject>
 #include <QSize>
 #include <QStringList>
@@ -29,6 +30,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QQmlListProperty>
 #include <kwinglobals.h>
 
+class QTimer;
+
 namespace KWin
 {
 // forward declarations
@@ -163,6 +166,32 @@ Q_SIGNALS:
      * @since 5.0
      */
     void virtualScreenGeometryChanged();
+    /**
+     * Emitted at most once per frame for each Client whose geometry changed since the previous
+     * emission. Unlike the geometryChanged signal of the Client, which is emitted for every
+     * input event of an interactive move or resize, the number of emissions is bounded by the
+     * frame rate. Query the Client for its latest geometry.
+     * @param client The Client whose geometry changed
+     * @since 5.18
+     */
+    void clientGeometryChanged(KWin::AbstractClient *client);
+    /**
+     * Coalesced variant of the clientStepUserMovedResized signal of the Client, emitted at most
+     * once per frame for each Client which is interactively moved or resized, with the latest
+     * geometry. A pending emission is delivered before the clientFinishUserMovedResized signal
+     * of the Client.
+     * @param client The Client which is moved or resized
+     * @param geometry The latest geometry of the move or resize
+     * @since 5.18
+     */
+    void clientStepUserMovedResized(KWin::AbstractClient *client, const QRect &geometry);
+    /**
+     * Emitted at most once per frame for each Client whose caption changed since the previous
+     * emission.
+     * @param client The Client whose caption changed
+     * @since 5.18
+     */
+    void clientCaptionChanged(KWin::AbstractClient *client);
 
 public:
 //------------------------------------------------------------------
@@ -348,6 +377,23 @@ public Q_SLOTS:
 private Q_SLOTS:
     void setupAbstractClientConnections(AbstractClient *client);
     void setupClientConnections(X11Client *client);
+
+private:
+    enum ClientChange {
+        GeometryChange = 1 << 0,
+        MoveResizeStep = 1 << 1,
+        CaptionChange = 1 << 2
+    };
+    struct PendingChanges {
+        int changes = 0;
+        QRect moveResizeGeometry;
+    };
+    void addPendingChange(AbstractClient *client, ClientChange change, const QRect &geometry = QRect());
+    void deliverPendingChanges();
+    void deliverPendingChanges(AbstractClient *client);
+
+    QHash<AbstractClient *, PendingChanges> m_pendingChanges;
+    QTimer *m_pendingChangesTimer;
 };
 
 class QtScriptWorkspaceWrapper : public WorkspaceWrapper
@@ -33,6 +33,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KWayland/Server/shadow_interface.h>
 #include <KWayland/Server/surface_interface.h>
 
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
 namespace KWin
 {
 
@@ -46,6 +50,7 @@ Shadow::Shadow(Toplevel *toplevel)
 
 Shadow::~Shadow()
 {
+    cancelX11Fetch();
 }
 
 Shadow *Shadow::createShadow(Toplevel *toplevel)
@@ -137,39 +142,110 @@ QVector< uint32_t > Shadow::readX11ShadowProperty(xcb_window_t id)
     return ret;
 }
 
-bool Shadow::init(const QVector< uint32_t > &data)
+/**
+ * The contents of the pixmaps of an X11 shadow, fetched or still being fetched. Windows of
+ * the same application usually share the pixmaps of their shadow, so they are only fetched
+ * and converted once.
+ */
+struct X11ShadowImages
 {
-    QVector<Xcb::WindowGeometry> pixmapGeometries(ShadowElementsCount);
-    QVector<xcb_get_image_cookie_t> getImageCookies(ShadowElementsCount);
-    auto *c = connection();
-    for (int i = 0; i < ShadowElementsCount; ++i) {
-        pixmapGeometries[i] = Xcb::WindowGeometry(data[i]);
+    QFuture<QVector<QImage>> future;
+    // converted from the fetched images by the first shadow which uses them
+    QVector<QPixmap> pixmaps;
+    quint64 serial = 0;
+};
+
+// keyed by the pixmaps in the property without the offsets, the entries go away with the last
+// shadow using them
+static QHash<QVector<uint32_t>, QWeakPointer<X11ShadowImages>> s_x11ShadowImages;
+
+static QVector<uint32_t> x11ShadowPixmaps(const QVector<uint32_t> &data)
+{
+    return data.mid(0, 8);
+}
+
+static QThreadPool *x11FetchThreadPool()
+{
+    static QThreadPool *pool = nullptr;
+    if (!pool) {
+        pool = new QThreadPool(kwinApp());
+        pool->setMaxThreadCount(1);
+        // the fetches use the X11 connection
+        auto waitForFetches = [] {
+            pool->waitForDone();
+        };
+        QObject::connect(kwinApp(), &Application::x11ConnectionAboutToBeDestroyed, pool, waitForFetches);
+        QObject::connect(kwinApp(), &QCoreApplication::aboutToQuit, pool, waitForFetches);
     }
-    auto discardReplies = [&getImageCookies](int start) {
-        for (int i = start; i < getImageCookies.size(); ++i) {
-            xcb_discard_reply(connection(), getImageCookies.at(i).sequence);
-        }
-    };
-    for (int i = 0; i < ShadowElementsCount; ++i) {
-        auto &geo = pixmapGeometries[i];
-        if (geo.isNull()) {
-            discardReplies(0);
-            return false;
+    return pool;
+}
+
+// Waits for the geometries of the pixmaps and fetches their contents. This runs in a
+// thread, an xcb connection can be used from any thread.
+static QVector<QImage> fetchX11ShadowImages(xcb_connection_t *c, const QVector<xcb_pixmap_t> &pixmaps,
+                                            const QVector<xcb_get_geometry_cookie_t> &geometryCookies)
+{
+    QVector<QSize> sizes;
+    QVector<xcb_get_image_cookie_t> getImageCookies;
+    for (int i = 0; i < pixmaps.count(); ++i) {
+        xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(c, geometryCookies.at(i), nullptr);
+        if (!geometry) {
+            for (int j = i + 1; j < geometryCookies.count(); ++j) {
+                xcb_discard_reply(c, geometryCookies.at(j).sequence);
+            }
+            for (const xcb_get_image_cookie_t &cookie : qAsConst(getImageCookies)) {
+                xcb_discard_reply(c, cookie.sequence);
+            }
+            return QVector<QImage>();
         }
-        getImageCookies[i] = xcb_get_image_unchecked(c, XCB_IMAGE_FORMAT_Z_PIXMAP, data[i],
-                                                     0, 0, geo->width, geo->height, ~0);
+        sizes << QSize(geometry->width, geometry->height);
+        getImageCookies << xcb_get_image_unchecked(c, XCB_IMAGE_FORMAT_Z_PIXMAP, pixmaps.at(i),
+                                                   0, 0, geometry->width, geometry->height, ~0);
+        free(geometry);
     }
-    for (int i = 0; i < ShadowElementsCount; ++i) {
+    xcb_flush(c);
+
+    QVector<QImage> images;
+    for (int i = 0; i < getImageCookies.count(); ++i) {
         auto *reply = xcb_get_image_reply(c, getImageCookies.at(i), nullptr);
         if (!reply) {
-            discardReplies(i+1);
-            return false;
+            for (int j = i + 1; j < getImageCookies.count(); ++j) {
+                xcb_discard_reply(c, getImageCookies.at(j).sequence);
+            }
+            return QVector<QImage>();
         }
-        auto &geo = pixmapGeometries[i];
-        QImage image(xcb_get_image_data(reply), geo->width, geo->height, QImage::Format_ARGB32);
-        m_shadowElements[i] = QPixmap::fromImage(image);
+        const QSize &size = sizes.at(i);
+        images << QImage(xcb_get_image_data(reply), size.width(), size.height(), QImage::Format_ARGB32).copy();
         free(reply);
     }
+    return images;
+}
+
+bool Shadow::init(const QVector< uint32_t > &data)
+{
+    if (!m_x11Fetch || m_x11FetchData != data) {
+        // the previous shadow is shown until the pixmaps have been fetched
+        fetchX11Pixmaps(data);
+    }
+    // another window might have fetched the same pixmaps already
+    if (!m_x11Images->future.isFinished()) {
+        return true;
+    }
+    const QSharedPointer<X11ShadowImages> images = m_x11Images;
+    cancelX11Fetch();
+    if (images->pixmaps.isEmpty()) {
+        QVector<QImage> result = images->future.result();
+        if (result.count() != ShadowElementsCount) {
+            return false;
+        }
+        for (QImage &image : result) {
+            images->pixmaps << QPixmap::fromImage(std::move(image));
+        }
+    }
+    for (int i = 0; i < ShadowElementsCount; ++i) {
+        m_shadowElements[i] = images->pixmaps.at(i);
+    }
+    m_x11ShadowSerial = images->serial;
     m_topOffset = data[ShadowElementsCount];
     m_rightOffset = data[ShadowElementsCount+1];
     m_bottomOffset = data[ShadowElementsCount+2];
@@ -182,6 +258,60 @@ bool Shadow::init(const QVector< uint32_t > &data)
     return true;
 }
 
+void Shadow::fetchX11Pixmaps(const QVector<uint32_t> &data)
+{
+    cancelX11Fetch();
+    const QVector<uint32_t> key = x11ShadowPixmaps(data);
+    QSharedPointer<X11ShadowImages> images = s_x11ShadowImages.value(key).toStrongRef();
+    if (!images) {
+        static quint64 s_serial = 0;
+        xcb_connection_t *c = connection();
+        QVector<xcb_pixmap_t> pixmaps(ShadowElementsCount);
+        QVector<xcb_get_geometry_cookie_t> geometryCookies(ShadowElementsCount);
+        for (int i = 0; i < ShadowElementsCount; ++i) {
+            pixmaps[i] = data[i];
+            geometryCookies[i] = xcb_get_geometry_unchecked(c, data[i]);
+        }
+        xcb_flush(c);
+
+        images = QSharedPointer<X11ShadowImages>::create();
+        images->future = QtConcurrent::run(x11FetchThreadPool(), fetchX11ShadowImages, c, pixmaps, geometryCookies);
+        images->serial = ++s_serial;
+        for (auto it = s_x11ShadowImages.begin(); it != s_x11ShadowImages.end();) {
+            if (it.value().isNull()) {
+                it = s_x11ShadowImages.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        s_x11ShadowImages.insert(key, images);
+    }
+
+    m_x11FetchData = data;
+    m_x11Images = images;
+    m_x11Fetch = new QFutureWatcher<QVector<QImage>>(this);
+    Toplevel *toplevel = m_topLevel;
+    QPointer<Shadow> shadow(this);
+    // queued, as updating the shadow may delete it together with the watcher
+    connect(m_x11Fetch, &QFutureWatcher<QVector<QImage>>::finished, toplevel,
+        [toplevel, shadow] {
+            if (shadow && toplevel->shadow() == shadow) {
+                // reads the property again, which picks up the fetched pixmaps
+                toplevel->updateShadow();
+            }
+        }, Qt::QueuedConnection
+    );
+    m_x11Fetch->setFuture(images->future);
+}
+
+void Shadow::cancelX11Fetch()
+{
+    // a running fetch finishes on its own, only its result is dropped
+    delete m_x11Fetch;
+    m_x11Fetch = nullptr;
+    m_x11FetchData.clear();
+}
+
 bool Shadow::init(KDecoration2::Decoration *decoration)
 {
     if (m_decorationShadow) {
@@ -194,6 +324,8 @@ bool Shadow::init(KDecoration2::Decoration *decoration)
     if (!m_decorationShadow) {
         return false;
     }
+    m_x11Images.reset();
+    m_x11ShadowSerial = 0;
     // setup connections - all just mapped to recreate
     connect(m_decorationShadow.data(), &KDecoration2::DecorationShadow::innerShadowRectChanged, m_topLevel, &Toplevel::updateShadow);
     connect(m_decorationShadow.data(), &KDecoration2::DecorationShadow::shadowChanged,        m_topLevel, &Toplevel::updateShadow);
@@ -227,6 +359,9 @@ bool Shadow::init(const QPointer< KWayland::Server::ShadowInterface > &shadow)
     m_shadowElements[ShadowElementLeft] = shadow->left() ? QPixmap::fromImage(shadow->left()->data().copy()) : QPixmap();
     m_shadowElements[ShadowElementTopLeft] = shadow->topLeft() ? QPixmap::fromImage(shadow->topLeft()->data().copy()) : QPixmap();
 
+    m_x11Images.reset();
+    m_x11ShadowSerial = 0;
+
     const QMarginsF &p = shadow->offset();
     m_topOffset    = p.top();
     m_rightOffset  = p.right();
@@ -360,6 +495,11 @@ bool Shadow::updateShadow()
     if (data.isEmpty()) {
         return false;
     }
+    if (!m_x11Fetch || m_x11FetchData != data) {
+        // unless this is our fetch finishing, the property got set again and the pixmaps
+        // might have been painted anew
+        s_x11ShadowImages.remove(x11ShadowPixmaps(data));
+    }
 
     init(data);
 
@@ -368,6 +508,7 @@ bool Shadow::updateShadow()
 
 void Shadow::setToplevel(Toplevel *topLevel)
 {
+    cancelX11Fetch();
     m_topLevel = topLevel;
     connect(m_topLevel, SIGNAL(geometryChanged()), SLOT(geometryChanged()));
 }
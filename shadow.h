@@ -24,6 +24,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QPixmap>
 #include <kwineffects.h>
 
+template <typename T>
+class QFutureWatcher;
+
 namespace KDecoration2
 {
 class Decoration;
@@ -41,6 +44,7 @@ class ShadowInterface;
 namespace KWin {
 
 class Toplevel;
+struct X11ShadowImages;
 
 /**
  * @short Class representing a Window's Shadow to be rendered by the Compositor.
@@ -161,6 +165,13 @@ protected:
         m_shadowRegion = region;
     };
     virtual bool prepareBackend() = 0;
+    /**
+     * Identifies the X11 pixmaps the shadow elements got fetched from. Shadows with the same
+     * serial have the same elements, the serial is @c 0 if the shadow doesn't come from X11.
+     */
+    quint64 x11ShadowSerial() const {
+        return m_x11ShadowSerial;
+    }
     WindowQuadList m_shadowQuads;
     void setShadowElement(const QPixmap &shadow, ShadowElements element);
 
@@ -172,14 +183,22 @@ private:
     bool init(const QVector<uint32_t> &data);
     bool init(KDecoration2::Decoration *decoration);
     bool init(const QPointer<KWayland::Server::ShadowInterface> &shadow);
+    void fetchX11Pixmaps(const QVector<uint32_t> &data);
+    void cancelX11Fetch();
     Toplevel *m_topLevel;
     // shadow pixmaps
     QPixmap m_shadowElements[ShadowElementsCount];
     // shadow offsets
-    int m_topOffset;
-    int m_rightOffset;
-    int m_bottomOffset;
-    int m_leftOffset;
+    int m_topOffset = 0;
+    int m_rightOffset = 0;
+    int m_bottomOffset = 0;
+    int m_leftOffset = 0;
+    // the X11 pixmaps are fetched in a thread, the property they belong to is kept to
+    // recognize the result when the property is read again
+    QVector<uint32_t> m_x11FetchData;
+    QSharedPointer<X11ShadowImages> m_x11Images;
+    QFutureWatcher<QVector<QImage>> *m_x11Fetch = nullptr;
+    quint64 m_x11ShadowSerial = 0;
     // caches
     QRegion m_shadowRegion;
     QSize m_cachedSize;
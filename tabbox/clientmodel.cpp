@@ -173,8 +173,7 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         }
     }
 
-    beginResetModel();
-    m_clientList.clear();
+    TabBoxClientList clientList;
     QList< QWeakPointer< TabBoxClient > > stickyClients;
 
     switch(tabBox->config().clientSwitchingMode()) {
@@ -190,7 +189,7 @@ void ClientModel::createClientList(int desktop, bool partialReset)
         do {
             QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
             if (!add.isNull()) {
-                m_clientList += add;
+                clientList += add;
                 if (add.data()->isFirstInTabBox()) {
                     stickyClients << add;
                 }
@@ -209,10 +208,10 @@ void ClientModel::createClientList(int desktop, bool partialReset)
             QWeakPointer<TabBoxClient> add = tabBox->clientToAddToList(c, desktop);
             if (!add.isNull()) {
                 if (start == add.data()) {
-                    m_clientList.removeAll(add);
-                    m_clientList.prepend(add);
+                    clientList.removeAll(add);
+                    clientList.prepend(add);
                 } else
-                    m_clientList += add;
+                    clientList += add;
                 if (add.data()->isFirstInTabBox()) {
                     stickyClients << add;
                 }
@@ -230,16 +229,53 @@ void ClientModel::createClientList(int desktop, bool partialReset)
     }
     }
     foreach (const QWeakPointer< TabBoxClient > &c, stickyClients) {
-        m_clientList.removeAll(c);
-        m_clientList.prepend(c);
+        clientList.removeAll(c);
+        clientList.prepend(c);
     }
     if (tabBox->config().clientApplicationsMode() != TabBoxConfig::AllWindowsCurrentApplication
-            && (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || m_clientList.isEmpty())) {
+            && (tabBox->config().showDesktopMode() == TabBoxConfig::ShowDesktopClient || clientList.isEmpty())) {
         QWeakPointer<TabBoxClient> desktopClient = tabBox->desktopClient();
         if (!desktopClient.isNull())
-            m_clientList.append(desktopClient);
+            clientList.append(desktopClient);
+    }
+    updateClientList(clientList);
+}
+
+void ClientModel::updateClientList(const TabBoxClientList &clientList)
+{
+    // move the rows instead of resetting the model, so that the view keeps its delegates
+    for (int row = m_clientList.count() - 1; row >= 0; --row) {
+        if (!clientList.contains(m_clientList.at(row))) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_clientList.removeAt(row);
+            endRemoveRows();
+        }
+    }
+    for (int row = 0; row < clientList.count(); ++row) {
+        const QWeakPointer<TabBoxClient> &client = clientList.at(row);
+        if (row < m_clientList.count() && m_clientList.at(row) == client) {
+            continue;
+        }
+        const int oldRow = m_clientList.indexOf(client, row + 1);
+        if (oldRow != -1) {
+            beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), row);
+            m_clientList.move(oldRow, row);
+            endMoveRows();
+        } else {
+            beginInsertRows(QModelIndex(), row, row);
+            m_clientList.insert(row, client);
+            endInsertRows();
+        }
+    }
+    if (m_clientList.count() > clientList.count()) {
+        beginRemoveRows(QModelIndex(), clientList.count(), m_clientList.count() - 1);
+        m_clientList.erase(m_clientList.begin() + clientList.count(), m_clientList.end());
+        endRemoveRows();
+    }
+    if (!m_clientList.isEmpty()) {
+        // captions, icons and desktops might have changed while the view was hidden
+        emit dataChanged(index(0, 0), index(m_clientList.count() - 1, 0));
     }
-    endResetModel();
 }
 
 void ClientModel::close(int i)
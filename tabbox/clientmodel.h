@@ -105,6 +105,7 @@ public Q_SLOTS:
     void activate(int index);
 
 private:
+    void updateClientList(const TabBoxClientList &clientList);
     TabBoxClientList m_clientList;
 };
 
@@ -70,6 +70,10 @@ public:
     void endHighlightWindows(bool abort = false);
 
     void show();
+    /**
+     * Creates the switcher item of @p layoutName, unless it already exists, and sets its model.
+     */
+    QObject *prepareSwitcherItem(bool desktopMode, const QString &layoutName);
     QQuickWindow *window() const;
     SwitcherItem *switcherItem() const;
 
@@ -95,7 +99,7 @@ public:
     int wheelAngleDelta = 0;
 
 private:
-    QObject *createSwitcherItem(bool desktopMode);
+    QObject *createSwitcherItem(bool desktopMode, const QString &layoutName);
 };
 
 TabBoxHandlerPrivate::TabBoxHandlerPrivate(TabBoxHandler *q)
@@ -227,20 +231,20 @@ void TabBoxHandlerPrivate::endHighlightWindows(bool abort)
 }
 
 #ifndef KWIN_UNIT_TEST
-QObject *TabBoxHandlerPrivate::createSwitcherItem(bool desktopMode)
+QObject *TabBoxHandlerPrivate::createSwitcherItem(bool desktopMode, const QString &layoutName)
 {
     // first try look'n'feel package
     QString file = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
                                           QStringLiteral("plasma/look-and-feel/%1/contents/%2")
-                                              .arg(config.layoutName())
+                                              .arg(layoutName)
                                               .arg(desktopMode ? QStringLiteral("desktopswitcher/DesktopSwitcher.qml") : QStringLiteral("windowswitcher/WindowSwitcher.qml")));
     if (file.isNull()) {
         const QString folderName = QLatin1String(KWIN_NAME) + (desktopMode ? QLatin1String("/desktoptabbox/") : QLatin1String("/tabbox/"));
-        auto findSwitcher = [this, desktopMode, folderName] {
+        auto findSwitcher = [desktopMode, folderName, layoutName] {
             const QString type = desktopMode ? QStringLiteral("KWin/DesktopSwitcher") : QStringLiteral("KWin/WindowSwitcher");
             auto offers = KPackage::PackageLoader::self()->findPackages(type,  folderName,
-                [this] (const KPluginMetaData &data) {
-                    return data.pluginId().compare(config.layoutName(), Qt::CaseInsensitive) == 0;
+                [layoutName] (const KPluginMetaData &data) {
+                    return data.pluginId().compare(layoutName, Qt::CaseInsensitive) == 0;
                 }
             );
             if (offers.isEmpty()) {
@@ -286,19 +290,17 @@ QObject *TabBoxHandlerPrivate::createSwitcherItem(bool desktopMode)
     } else {
         QObject *object = m_qmlComponent->create(m_qmlContext.data());
         if (desktopMode) {
-            m_desktopTabBoxes.insert(config.layoutName(), object);
+            m_desktopTabBoxes.insert(layoutName, object);
         } else {
-            m_clientTabBoxes.insert(config.layoutName(), object);
+            m_clientTabBoxes.insert(layoutName, object);
         }
         return object;
     }
     return nullptr;
 }
-#endif
 
-void TabBoxHandlerPrivate::show()
+QObject *TabBoxHandlerPrivate::prepareSwitcherItem(bool desktopMode, const QString &layoutName)
 {
-#ifndef KWIN_UNIT_TEST
     if (m_qmlContext.isNull()) {
         qmlRegisterType<SwitcherItem>("org.kde.kwin", 2, 0, "Switcher");
         m_qmlContext.reset(new QQmlContext(Scripting::self()->qmlEngine()));
@@ -306,35 +308,47 @@ void TabBoxHandlerPrivate::show()
     if (m_qmlComponent.isNull()) {
         m_qmlComponent.reset(new QQmlComponent(Scripting::self()->qmlEngine()));
     }
-    const bool desktopMode = (config.tabBoxMode() == TabBoxConfig::DesktopTabBox);
-    auto findMainItem = [this](const QMap<QString, QObject *> &tabBoxes) -> QObject* {
-        auto it = tabBoxes.constFind(config.layoutName());
-        if (it != tabBoxes.constEnd()) {
-            return it.value();
+    const QMap<QString, QObject *> &tabBoxes = desktopMode ? m_desktopTabBoxes : m_clientTabBoxes;
+    QObject *object = tabBoxes.value(layoutName);
+    if (!object) {
+        object = createSwitcherItem(desktopMode, layoutName);
+        if (!object) {
+            return nullptr;
         }
-        return nullptr;
-    };
-    m_mainItem = nullptr;
-    m_mainItem = desktopMode ? findMainItem(m_desktopTabBoxes) : findMainItem(m_clientTabBoxes);
-    if (!m_mainItem) {
-        m_mainItem = createSwitcherItem(desktopMode);
-        if (!m_mainItem) {
-            return;
+    }
+    SwitcherItem *item = qobject_cast<SwitcherItem*>(object);
+    if (!item) {
+        if (QQuickWindow *w = qobject_cast<QQuickWindow*>(object)) {
+            item = w->contentItem()->findChild<SwitcherItem*>();
+        } else {
+            item = object->findChild<SwitcherItem*>();
         }
     }
-    if (SwitcherItem *item = switcherItem()) {
-        // In case the model isn't yet set (see below), index will be reset and therefore we
-        // need to save the current index row (https://bugs.kde.org/show_bug.cgi?id=333511).
-        int indexRow = index.row();
-        if (!item->model()) {
-            QAbstractItemModel *model = nullptr;
-            if (desktopMode) {
-                model = desktopModel();
-            } else {
-                model = clientModel();
-            }
-            item->setModel(model);
+    if (item && !item->model()) {
+        QAbstractItemModel *model = nullptr;
+        if (desktopMode) {
+            model = desktopModel();
+        } else {
+            model = clientModel();
         }
+        item->setModel(model);
+    }
+    return object;
+}
+#endif
+
+void TabBoxHandlerPrivate::show()
+{
+#ifndef KWIN_UNIT_TEST
+    const bool desktopMode = (config.tabBoxMode() == TabBoxConfig::DesktopTabBox);
+    // In case the model isn't yet set, index will be reset and therefore we
+    // need to save the current index row (https://bugs.kde.org/show_bug.cgi?id=333511).
+    const int indexRow = index.row();
+    m_mainItem = prepareSwitcherItem(desktopMode, config.layoutName());
+    if (!m_mainItem) {
+        return;
+    }
+    if (SwitcherItem *item = switcherItem()) {
         item->setAllDesktops(config.clientDesktopMode() == TabBoxConfig::AllDesktopsClients);
         item->setCurrentIndex(indexRow);
         item->setNoModifierGrab(q->noModifierGrab());
@@ -377,6 +391,18 @@ void TabBoxHandler::setConfig(const TabBoxConfig& config)
     emit configChanged();
 }
 
+void TabBoxHandler::preloadSwitcher(const TabBoxConfig &config)
+{
+#ifndef KWIN_UNIT_TEST
+    if (!config.isShowTabBox() || !Scripting::self()) {
+        return;
+    }
+    d->prepareSwitcherItem(config.tabBoxMode() == TabBoxConfig::DesktopTabBox, config.layoutName());
+#else
+    Q_UNUSED(config)
+#endif
+}
+
 void TabBoxHandler::show()
 {
     d->isShown = true;
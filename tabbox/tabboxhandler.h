@@ -227,6 +227,13 @@ public:
      */
     void setConfig(const TabBoxConfig& config);
 
+    /**
+     * Creates the TabBoxView of @p config without showing it, so that
+     * showing it later on doesn't have to load and lay it out first.
+     * Does nothing if the view has already been created.
+     * @see TabBoxConfig::layoutName
+     */
+    void preloadSwitcher(const TabBoxConfig &config);
     /**
      * Call this method to show the TabBoxView. Depending on current
      * configuration this method might not do anything.
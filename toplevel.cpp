@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "client_machine.h"
 #include "composite.h"
 #include "effects.h"
+#include "options.h"
 #include "screens.h"
 #include "shadow.h"
 #include "workspace.h"
@@ -65,6 +66,7 @@ Toplevel::Toplevel()
 Toplevel::~Toplevel()
 {
     Q_ASSERT(damage_handle == XCB_NONE);
+    discardDamageRegionReplies();
     delete info;
 }
 
@@ -288,6 +290,7 @@ void Toplevel::finishCompositing(ReleaseReason releaseReason)
         xcb_damage_destroy(connection(), damage_handle);
     }
 
+    discardDamageRegionReplies();
     damage_handle = XCB_NONE;
     damage_region = QRegion();
     repaints_region = QRegion();
@@ -301,10 +304,23 @@ void Toplevel::discardWindowPixmap()
         effectWindow()->sceneWindow()->pixmapDiscarded();
 }
 
+void Toplevel::releaseWindowPixmap()
+{
+    addDamageFull();
+    if (effectWindow() != nullptr && effectWindow()->sceneWindow() != nullptr)
+        effectWindow()->sceneWindow()->releasePixmap();
+}
+
 void Toplevel::damageNotifyEvent()
 {
     m_isDamaged = true;
 
+    // Request the damage region right away, the reply is collected from the event loop
+    // and doesn't have to be waited for when the next frame is painted
+    if (damage_handle != XCB_NONE && compositing()) {
+        fetchDamageRegion();
+    }
+
     // Note: The rect is supposed to specify the damage extents,
     //       but we don't know it at this point. No one who connects
     //       to this signal uses the rect however.
@@ -339,14 +355,22 @@ void X11Client::damageNotifyEvent()
 
 bool Toplevel::resetAndFetchDamage()
 {
+    if (m_isDamaged && damage_handle != XCB_NONE) {
+        fetchDamageRegion();
+    }
+
+    if (m_damageReplyPending)
+        return true;
+
     if (!m_isDamaged)
         return false;
 
-    if (damage_handle == XCB_NONE) {
-        m_isDamaged = false;
-        return true;
-    }
+    m_isDamaged = false;
+    return true;
+}
 
+void Toplevel::fetchDamageRegion()
+{
     xcb_connection_t *conn = connection();
 
     // Create a new region and copy the damage region to it,
@@ -356,13 +380,23 @@ bool Toplevel::resetAndFetchDamage()
     xcb_damage_subtract(conn, damage_handle, 0, region);
 
     // Send a fetch-region request and destroy the region
-    m_regionCookie = xcb_xfixes_fetch_region_unchecked(conn, region);
+    if (m_regionReplies.isEmpty()) {
+        Compositor::self()->addPendingDamageReply(this);
+    }
+    m_regionReplies.fetch(region);
     xcb_xfixes_destroy_region(conn, region);
 
     m_isDamaged = false;
     m_damageReplyPending = true;
+}
 
-    return m_damageReplyPending;
+/**
+ * Damage regions with many rectangles are collapsed to their extents unless precise
+ * damage regions are enabled.
+ */
+static int maxDamageRects()
+{
+    return options->isPreciseDamageRegions() ? INT_MAX : 15;
 }
 
 void Toplevel::getDamageRegionReply()
@@ -372,38 +406,46 @@ void Toplevel::getDamageRegionReply()
 
     m_damageReplyPending = false;
 
-    // Get the fetch-region reply
-    xcb_xfixes_fetch_region_reply_t *reply =
-            xcb_xfixes_fetch_region_reply(connection(), m_regionCookie, nullptr);
-
-    if (!reply)
+    if (m_regionReplies.isEmpty())
         return;
 
-    // Convert the reply to a QRegion
-    int count = xcb_xfixes_fetch_region_rectangles_length(reply);
+    // Get the fetch-region replies which haven't been collected yet
     QRegion region;
+    m_regionReplies.wait(&region, maxDamageRects());
+    addDamageRegion(region);
+    Compositor::self()->removePendingDamageReply(this);
+}
 
-    if (count > 1 && count < 16) {
-        xcb_rectangle_t *rects = xcb_xfixes_fetch_region_rectangles(reply);
-
-        QVector<QRect> qrects;
-        qrects.reserve(count);
-
-        for (int i = 0; i < count; i++)
-            qrects << QRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+bool Toplevel::pollDamageRegionReply()
+{
+    QRegion region;
+    const bool done = m_regionReplies.poll(&region, maxDamageRects());
+    addDamageRegion(region);
+    return done;
+}
 
-        region.setRects(qrects.constData(), count);
-    } else
-        region += QRect(reply->extents.x, reply->extents.y,
-                        reply->extents.width, reply->extents.height);
+void Toplevel::addDamageRegion(const QRegion &region)
+{
+    if (region.isEmpty())
+        return;
 
     const QRect bufferRect = bufferGeometry();
     const QRect frameRect = frameGeometry();
 
     damage_region += region;
     repaints_region += region.translated(bufferRect.topLeft() - frameRect.topLeft());
+}
 
-    free(reply);
+void Toplevel::discardDamageRegionReplies()
+{
+    if (m_regionReplies.isEmpty())
+        return;
+
+    m_regionReplies.discard();
+    m_damageReplyPending = false;
+    if (Compositor::self()) {
+        Compositor::self()->removePendingDamageReply(this);
+    }
 }
 
 void Toplevel::addDamageFull()
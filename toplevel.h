@@ -496,20 +496,29 @@ public:
     virtual Layer layer() const = 0;
 
     /**
-     * Resets the damage state and sends a request for the damage region.
+     * Resets the damage state and sends a request for the damage region, unless it has
+     * already been requested when the damage was reported.
      * A call to this function must be followed by a call to getDamageRegionReply(),
      * or the reply will be leaked.
      *
-     * Returns true if the window was damaged, and false otherwise.
+     * Returns true if the window was damaged since the previous call, and false otherwise.
      */
     bool resetAndFetchDamage();
 
     /**
-     * Gets the reply from a previous call to resetAndFetchDamage().
+     * Gets the replies of the damage region requests which have not been collected yet,
+     * waiting for them if necessary.
      * Calling this function is a no-op if there is no pending reply.
      * Call damage() to return the fetched region.
      */
     void getDamageRegionReply();
+    /**
+     * Collects the replies of the damage region requests which have already arrived,
+     * without waiting for the others.
+     *
+     * Returns true if no reply is outstanding anymore.
+     */
+    bool pollDamageRegionReply();
 
     bool skipsCloseAnimation() const;
     void setSkipCloseAnimation(bool set);
@@ -668,6 +677,11 @@ protected:
     virtual void damageNotifyEvent();
     virtual void clientMessageEvent(xcb_client_message_event_t *e);
     void discardWindowPixmap();
+    /**
+     * Unlike discardWindowPixmap, doesn't keep the last pixmap around for effects, unless an
+     * effect references it.
+     */
+    void releaseWindowPixmap();
     void addDamageFull();
     virtual void addDamage(const QRegion &damage);
     Xcb::Property fetchWmClientLeader() const;
@@ -724,9 +738,12 @@ private:
     QByteArray resource_class;
     ClientMachine *m_clientMachine;
     xcb_window_t m_wmClientLeader;
+    void fetchDamageRegion();
+    void addDamageRegion(const QRegion &region);
+    void discardDamageRegionReplies();
     bool m_damageReplyPending;
     QRegion opaque_region;
-    xcb_xfixes_fetch_region_cookie_t m_regionCookie;
+    Xcb::RegionReplies m_regionReplies;
     int m_screen;
     bool m_skipCloseAnimation;
     quint32 m_surfaceId = 0;
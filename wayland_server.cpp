@@ -178,6 +178,10 @@ void WaylandServer::createSurface(T *surface)
         client->installPalette(palette);
     }
     m_clients << client;
+    m_clientsBySurface.insert(client->surface(), client);
+    if (client->windowId() != 0) {
+        m_clientsById.insert(client->windowId(), client);
+    }
     if (client->readyForPainting()) {
         emit shellClientAdded(client);
     } else {
@@ -642,6 +646,21 @@ void WaylandServer::createInternalConnection()
 void WaylandServer::removeClient(XdgShellClient *c)
 {
     m_clients.removeAll(c);
+    if (c->surface() && m_clientsBySurface.value(c->surface()) == c) {
+        m_clientsBySurface.remove(c->surface());
+    } else {
+        // the surface is already destroyed, so the index has to be searched
+        for (auto it = m_clientsBySurface.begin(); it != m_clientsBySurface.end();) {
+            if (it.value() == c) {
+                it = m_clientsBySurface.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (m_clientsById.value(c->windowId()) == c) {
+        m_clientsById.remove(c->windowId());
+    }
     emit shellClientRemoved(c);
 }
 
@@ -656,41 +675,12 @@ void WaylandServer::dispatch()
     m_display->dispatchEvents(0);
 }
 
-static XdgShellClient *findClientInList(const QList<XdgShellClient *> &clients, quint32 id)
-{
-    auto it = std::find_if(clients.begin(), clients.end(),
-        [id] (XdgShellClient *c) {
-            return c->windowId() == id;
-        }
-    );
-    if (it == clients.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
-static XdgShellClient *findClientInList(const QList<XdgShellClient *> &clients, KWayland::Server::SurfaceInterface *surface)
-{
-    auto it = std::find_if(clients.begin(), clients.end(),
-        [surface] (XdgShellClient *c) {
-            return c->surface() == surface;
-        }
-    );
-    if (it == clients.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
 XdgShellClient *WaylandServer::findClient(quint32 id) const
 {
     if (id == 0) {
         return nullptr;
     }
-    if (XdgShellClient *c = findClientInList(m_clients, id)) {
-        return c;
-    }
-    return nullptr;
+    return m_clientsById.value(id);
 }
 
 XdgShellClient *WaylandServer::findClient(SurfaceInterface *surface) const
@@ -698,8 +688,10 @@ XdgShellClient *WaylandServer::findClient(SurfaceInterface *surface) const
     if (!surface) {
         return nullptr;
     }
-    if (XdgShellClient *c = findClientInList(m_clients, surface)) {
-        return c;
+    XdgShellClient *client = m_clientsBySurface.value(surface);
+    // a destroyed surface stays in the index until its client is removed
+    if (client && client->surface() == surface) {
+        return client;
     }
     return nullptr;
 }
@@ -282,6 +282,11 @@ private:
     KWayland::Server::XdgForeignInterface *m_XdgForeign = nullptr;
     KWayland::Server::KeyStateInterface *m_keyState = nullptr;
     QList<XdgShellClient *> m_clients;
+    /**
+     * Indices of m_clients, looked up with every focus change and transient update.
+     */
+    QHash<KWayland::Server::SurfaceInterface *, XdgShellClient *> m_clientsBySurface;
+    QHash<quint32, XdgShellClient *> m_clientsById;
     QHash<KWayland::Server::ClientConnection*, quint16> m_clientIds;
     InitalizationFlags m_initFlags;
     QVector<KWayland::Server::PlasmaShellSurfaceInterface*> m_plasmaShellSurfaces;
@@ -70,6 +70,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Qt
 #include <QtConcurrentRun>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -270,9 +272,13 @@ void Workspace::init()
 
     reconfigureTimer.setSingleShot(true);
     updateToolWindowsTimer.setSingleShot(true);
+    m_hiddenPreviewsTimer.setSingleShot(true);
 
     connect(&reconfigureTimer, SIGNAL(timeout()), this, SLOT(slotReconfigure()));
     connect(&updateToolWindowsTimer, SIGNAL(timeout()), this, SLOT(slotUpdateToolWindows()));
+    connect(&m_hiddenPreviewsTimer, &QTimer::timeout, this, &Workspace::slotUpdateHiddenPreviews);
+    connect(options, &Options::hiddenPreviewsChanged, this, &Workspace::scheduleHiddenPreviewsUpdate);
+    connect(options, &Options::hiddenPreviewsBudgetChanged, this, &Workspace::scheduleHiddenPreviewsUpdate);
 
     // TODO: do we really need to reconfigure everything when fonts change?
     // maybe just reconfigure the decorations? Move this into libkdecoration?
@@ -676,6 +682,18 @@ void Workspace::addClient(X11Client *c)
     if (c->isUtility() || c->isMenu() || c->isToolbar())
         updateToolWindows(true);
     updateTabbox();
+
+    // the budget of the hidden previews is shared with the windows already there
+    connect(c, &AbstractClient::desktopChanged, this, &Workspace::scheduleHiddenPreviewsUpdate);
+    connect(c, &Toplevel::activitiesChanged, this, &Workspace::scheduleHiddenPreviewsUpdate);
+    connect(c, &Toplevel::geometryShapeChanged, this,
+        [this, c] {
+            if (!c->isOnCurrentDesktop() || !c->isOnCurrentActivity()) {
+                scheduleHiddenPreviewsUpdate();
+            }
+        }
+    );
+    scheduleHiddenPreviewsUpdate();
 }
 
 void Workspace::addUnmanaged(Unmanaged* c)
@@ -709,6 +727,10 @@ void Workspace::removeClient(X11Client *c)
     desktops.removeAll(c);
     markXStackingOrderAsDirty();
     attention_chain.removeAll(c);
+    if (m_hiddenPreviews.remove(c)) {
+        // another window might fit now
+        scheduleHiddenPreviewsUpdate();
+    }
     Group* group = findGroup(c->window());
     if (group != nullptr)
         group->lostLeader();
@@ -924,6 +946,8 @@ void Workspace::slotCurrentDesktopChanged(uint oldDesktop, uint newDesktop)
     closeActivePopup();
     ++block_focus;
     StackingUpdatesBlocker blocker(this);
+    m_previousDesktop = oldDesktop;
+    updateHiddenPreviews();
     updateClientVisibilityOnDesktopChange(newDesktop);
     // Restore the focus on this desktop
     --block_focus;
@@ -966,6 +990,80 @@ void Workspace::updateClientVisibilityOnDesktopChange(uint newDesktop)
         setShowingDesktop(false);
 }
 
+void Workspace::updateHiddenPreviews()
+{
+    m_hiddenPreviewsTimer.stop();
+    m_hiddenPreviews.clear();
+    const qint64 budget = qint64(options->hiddenPreviewsBudget()) * 1024 * 1024;
+    if (budget == 0) {
+        return;
+    }
+
+    // the desktops the user is likely to switch to next are kept first, and on each of them
+    // the windows from top to bottom
+    VirtualDesktopManager *manager = VirtualDesktopManager::self();
+    const uint current = manager->current();
+    const bool wrap = manager->isNavigationWrappingAround();
+    const uint predicted[] = {
+        m_previousDesktop,
+        manager->toLeft(current, wrap),
+        manager->toRight(current, wrap),
+        manager->above(current, wrap),
+        manager->below(current, wrap)
+    };
+    QVector<X11Client *> candidates;
+    QVector<X11Client *> others;
+    for (int i = stacking_order.size() - 1; i >= 0; --i) {
+        X11Client *c = qobject_cast<X11Client *>(stacking_order.at(i));
+        if (!c || (c->isOnCurrentDesktop() && c->isOnCurrentActivity())) {
+            continue;
+        }
+        const bool isPredicted = c->isOnCurrentDesktop() || std::any_of(std::begin(predicted), std::end(predicted),
+            [c](uint desktop) {
+                return c->isOnDesktop(desktop);
+            }
+        );
+        if (isPredicted) {
+            candidates << c;
+        } else {
+            others << c;
+        }
+    }
+    candidates << others;
+
+    qint64 size = 0;
+    for (X11Client *c : qAsConst(candidates)) {
+        const QSize pixmapSize = c->bufferGeometry().size();
+        const qint64 pixmapBytes = qint64(pixmapSize.width()) * pixmapSize.height() * 4;
+        if (size + pixmapBytes > budget) {
+            continue;
+        }
+        size += pixmapBytes;
+        m_hiddenPreviews.insert(c);
+    }
+}
+
+void Workspace::scheduleHiddenPreviewsUpdate()
+{
+    m_hiddenPreviewsTimer.start();
+}
+
+void Workspace::slotUpdateHiddenPreviews()
+{
+    updateHiddenPreviews();
+    // map or unmap the hidden windows according to the new selection
+    for (X11Client *c : qAsConst(clients)) {
+        if (!c->isOnCurrentDesktop() || !c->isOnCurrentActivity()) {
+            c->updateVisibility();
+        }
+    }
+}
+
+bool Workspace::keepsHiddenPreview(const X11Client *c) const
+{
+    return options->hiddenPreviewsBudget() == 0 || m_hiddenPreviews.contains(c);
+}
+
 void Workspace::activateClientOnNewDesktop(uint desktop)
 {
     AbstractClient* c = nullptr;
@@ -1040,6 +1138,7 @@ void Workspace::updateCurrentActivity(const QString &new_activity)
     ++block_focus;
     // TODO: Q_ASSERT( block_stacking_updates == 0 ); // Make sure stacking_order is up to date
     StackingUpdatesBlocker blocker(this);
+    updateHiddenPreviews();
 
     // Optimized Desktop switching: unmapping done from back to front
     // mapping done from front to back => less exposure events
@@ -208,6 +208,12 @@ public:
 
     void clientHidden(AbstractClient*);
     void clientAttentionChanged(AbstractClient* c, bool set);
+    /**
+     * Whether @p c stays mapped for its hidden preview while it is not on the current desktop,
+     * which keeps its window pixmap valid. Only as many windows as fit into
+     * Options::hiddenPreviewsBudget are kept.
+     */
+    bool keepsHiddenPreview(const X11Client *c) const;
 
     /**
      * @return List of clients currently managed by Workspace
@@ -571,6 +577,9 @@ private:
     void updateClientArea(bool force);
     void resetClientAreas(uint desktopCount);
     void updateClientVisibilityOnDesktopChange(uint newDesktop);
+    void updateHiddenPreviews();
+    void scheduleHiddenPreviewsUpdate();
+    void slotUpdateHiddenPreviews();
     void activateClientOnNewDesktop(uint desktop);
     AbstractClient *findClientToActivateOnDesktop(uint desktop);
 
@@ -590,6 +599,10 @@ private:
     AbstractClient* last_active_client;
     AbstractClient* most_recently_raised; // Used ONLY by raiseOrLowerClient()
     AbstractClient* movingClient;
+    // The X11 clients on other desktops which fit into the hidden previews budget
+    QSet<const X11Client *> m_hiddenPreviews;
+    // The desktop left behind by the last desktop switch, its windows are kept first
+    uint m_previousDesktop = 0;
 
     // Delay(ed) window focus timer and client
     QTimer* delayFocusTimer;
@@ -642,6 +655,9 @@ private:
 
     QTimer updateToolWindowsTimer;
 
+    // Compresses the changes which affect the hidden previews
+    QTimer m_hiddenPreviewsTimer;
+
     static Workspace* _self;
 
     bool workspaceInit;
@@ -1598,17 +1598,11 @@ void X11Client::updateVisibility()
     }
     info->setState(NET::States(), NET::Hidden);
     if (!isOnCurrentDesktop()) {
-        if (compositing() && options->hiddenPreviews() != HiddenPreviewsNever)
-            internalKeep();
-        else
-            internalHide();
+        internalKeepOrHide();
         return;
     }
     if (!isOnCurrentActivity()) {
-        if (compositing() && options->hiddenPreviews() != HiddenPreviewsNever)
-            internalKeep();
-        else
-            internalHide();
+        internalKeepOrHide();
         return;
     }
     internalShow();
@@ -1665,6 +1659,28 @@ void X11Client::internalHide()
     emit windowHidden(this);
 }
 
+/**
+ * Hides the client which is not on the current desktop or activity. With compositing it stays
+ * mapped to keep its window pixmap valid, as long as it fits into the hidden previews budget.
+ */
+void X11Client::internalKeepOrHide()
+{
+    if (!compositing() || options->hiddenPreviews() == HiddenPreviewsNever) {
+        internalHide();
+        return;
+    }
+    if (workspace()->keepsHiddenPreview(this)) {
+        internalKeep();
+        return;
+    }
+    if (mapping_state == Unmapped) {
+        return;
+    }
+    internalHide();
+    // the named pixmap of an unmapped window still holds the memory
+    releaseWindowPixmap();
+}
+
 void X11Client::internalKeep()
 {
     Q_ASSERT(compositing());
@@ -450,6 +450,7 @@ private:
     void internalShow();
     void internalHide();
     void internalKeep();
+    void internalKeepOrHide();
     void map();
     void unmap();
     void updateHiddenPreview();
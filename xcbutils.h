@@ -33,6 +33,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <xcb/randr.h>
 
 #include <xcb/shm.h>
+#include <xcb/xcbext.h>
+#include <xcb/xfixes.h>
 
 class TestXcbSizeHints;
 
@@ -1835,6 +1837,119 @@ void selectInput(xcb_window_t window, uint32_t events)
     xcb_change_window_attributes(connection(), window, XCB_CW_EVENT_MASK, &events);
 }
 
+/**
+ * @brief The replies of XFixes fetch-region requests, in the order the requests were sent.
+ *
+ * The replies can be collected without blocking as they arrive with @ref poll, or waited for
+ * with @ref wait. Regions with more than @p maxRects rectangles are collapsed to their extents.
+ */
+class RegionReplies
+{
+public:
+    RegionReplies() = default;
+    ~RegionReplies();
+    /**
+     * Sends a fetch-region request for @p region. The region can be destroyed right away.
+     */
+    void fetch(xcb_xfixes_region_t region);
+    /**
+     * Adds the regions of the replies which have already arrived to @p region.
+     * @returns @c true if no reply is outstanding anymore
+     */
+    bool poll(QRegion *region, int maxRects);
+    /**
+     * Waits for the outstanding replies and adds their regions to @p region.
+     */
+    void wait(QRegion *region, int maxRects);
+    /**
+     * Drops the outstanding replies.
+     */
+    void discard();
+    bool isEmpty() const;
+
+    static QRegion toRegion(xcb_xfixes_fetch_region_reply_t *reply, int maxRects);
+
+private:
+    Q_DISABLE_COPY(RegionReplies)
+    QVector<xcb_xfixes_fetch_region_cookie_t> m_cookies;
+};
+
+inline
+RegionReplies::~RegionReplies()
+{
+    discard();
+}
+
+inline
+void RegionReplies::fetch(xcb_xfixes_region_t region)
+{
+    m_cookies << xcb_xfixes_fetch_region_unchecked(connection(), region);
+}
+
+inline
+bool RegionReplies::poll(QRegion *region, int maxRects)
+{
+    while (!m_cookies.isEmpty()) {
+        void *reply = nullptr;
+        xcb_generic_error_t *error = nullptr;
+        if (!xcb_poll_for_reply(connection(), m_cookies.first().sequence, &reply, &error)) {
+            return false;
+        }
+        m_cookies.removeFirst();
+        free(error);
+        if (reply) {
+            *region += toRegion(static_cast<xcb_xfixes_fetch_region_reply_t *>(reply), maxRects);
+            free(reply);
+        }
+    }
+    return true;
+}
+
+inline
+void RegionReplies::wait(QRegion *region, int maxRects)
+{
+    for (const xcb_xfixes_fetch_region_cookie_t &cookie : qAsConst(m_cookies)) {
+        ScopedCPointer<xcb_xfixes_fetch_region_reply_t> reply(xcb_xfixes_fetch_region_reply(connection(), cookie, nullptr));
+        if (!reply.isNull()) {
+            *region += toRegion(reply.data(), maxRects);
+        }
+    }
+    m_cookies.clear();
+}
+
+inline
+void RegionReplies::discard()
+{
+    for (const xcb_xfixes_fetch_region_cookie_t &cookie : qAsConst(m_cookies)) {
+        xcb_discard_reply(connection(), cookie.sequence);
+    }
+    m_cookies.clear();
+}
+
+inline
+bool RegionReplies::isEmpty() const
+{
+    return m_cookies.isEmpty();
+}
+
+inline
+QRegion RegionReplies::toRegion(xcb_xfixes_fetch_region_reply_t *reply, int maxRects)
+{
+    const int count = xcb_xfixes_fetch_region_rectangles_length(reply);
+    if (count <= 1 || count > maxRects) {
+        return QRect(reply->extents.x, reply->extents.y, reply->extents.width, reply->extents.height);
+    }
+    const xcb_rectangle_t *rects = xcb_xfixes_fetch_region_rectangles(reply);
+    QVector<QRect> qrects;
+    qrects.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        qrects << QRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
+    }
+    QRegion region;
+    region.setRects(qrects.constData(), count);
+    return region;
+}
+
 /**
  * @brief Small helper class to encapsulate SHM related functionality.
  */
@@ -20,6 +20,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "xwayland.h"
 #include "databridge.h"
+#include "xwaylandsocket.h"
 
 #include "main_wayland.h"
 #include "utils.h"
@@ -104,10 +105,52 @@ Xwayland::~Xwayland()
         }
         waylandServer()->destroyXWaylandConnection();
     }
+    qDeleteAll(m_socketNotifiers);
+    delete m_socket;
     s_self = nullptr;
 }
 
 void Xwayland::init()
+{
+    startProcess();
+}
+
+void Xwayland::listen()
+{
+    m_socket = new XwaylandSocket;
+    if (!m_socket->isValid()) {
+        delete m_socket;
+        m_socket = nullptr;
+        init();
+        return;
+    }
+
+    const QString display = m_socket->name();
+    setenv("DISPLAY", display.toUtf8().constData(), true);
+    auto env = m_app->processStartupEnvironment();
+    env.insert(QStringLiteral("DISPLAY"), display);
+    m_app->setProcessStartupEnvironment(env);
+
+    const QVector<int> fileDescriptors = m_socket->fileDescriptors();
+    for (int fd : fileDescriptors) {
+        QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this,
+            [this] {
+                // the pending connection is accepted by Xwayland once it's up, the notifiers
+                // can't be deleted right away as one of them is emitting this signal
+                for (QSocketNotifier *notifier : qAsConst(m_socketNotifiers)) {
+                    notifier->setEnabled(false);
+                    notifier->deleteLater();
+                }
+                m_socketNotifiers.clear();
+                startProcess();
+            }
+        );
+        m_socketNotifiers << notifier;
+    }
+}
+
+void Xwayland::startProcess()
 {
     int pipeFds[2];
     if (pipe(pipeFds) != 0) {
@@ -150,11 +193,28 @@ void Xwayland::init()
     env.insert("WAYLAND_SOCKET", QByteArray::number(wlfd));
     env.insert("EGL_PLATFORM", QByteArrayLiteral("DRM"));
     m_xwaylandProcess->setProcessEnvironment(env);
-    m_xwaylandProcess->setArguments({QStringLiteral("-displayfd"),
-                           QString::number(pipeFds[1]),
-                           QStringLiteral("-rootless"),
-                           QStringLiteral("-wm"),
-                           QString::number(fd)});
+    QStringList arguments{QStringLiteral("-displayfd"),
+                          QString::number(pipeFds[1]),
+                          QStringLiteral("-rootless"),
+                          QStringLiteral("-wm"),
+                          QString::number(fd)};
+    QVector<int> listenFds;
+    if (m_socket) {
+        arguments.prepend(m_socket->name());
+        // the sockets are close-on-exec, Xwayland gets copies which aren't
+        const QVector<int> fileDescriptors = m_socket->fileDescriptors();
+        for (int socketFd : fileDescriptors) {
+            const int listenFd = dup(socketFd);
+            if (listenFd < 0) {
+                std::cerr << "FATAL ERROR: failed to pass the X11 sockets to Xwayland" << std::endl;
+                Q_EMIT criticalError(20);
+                return;
+            }
+            arguments << QStringLiteral("-listen") << QString::number(listenFd);
+            listenFds << listenFd;
+        }
+    }
+    m_xwaylandProcess->setArguments(arguments);
     m_xwaylandFailConnection = connect(m_xwaylandProcess, static_cast<void (QProcess::*)(QProcess::ProcessError)>(&QProcess::error), this,
         [this] (QProcess::ProcessError error) {
             if (error == QProcess::FailedToStart) {
@@ -176,6 +236,9 @@ void Xwayland::init()
     );
     m_xwaylandProcess->start();
     close(pipeFds[1]);
+    for (int listenFd : qAsConst(listenFds)) {
+        close(listenFd);
+    }
 }
 
 void Xwayland::prepareDestroy()
@@ -203,7 +266,8 @@ void Xwayland::createX11Connection()
     m_xcbScreen = iter.data;
     Q_ASSERT(m_xcbScreen);
 
-    m_app->setX11Connection(c);
+    // the change is announced once the connection is completely set up
+    m_app->setX11Connection(c, false);
     // we don't support X11 multi-head in Wayland
     m_app->setX11ScreenNumber(screenNumber);
     m_app->setX11RootWindow(defaultScreen()->root);
@@ -264,6 +328,8 @@ void Xwayland::continueStartupWithX()
     env.insert(QStringLiteral("DISPLAY"), QString::fromUtf8(qgetenv("DISPLAY")));
     m_app->setProcessStartupEnvironment(env);
 
+    // the workspace might exist already and starts managing X11 windows
+    Q_EMIT m_app->x11ConnectionChanged();
     emit initialized();
 
     Xcb::sync(); // Trigger possible errors, there's still a chance to abort
@@ -22,9 +22,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "xwayland_interface.h"
 
+#include <QVector>
+
 #include <xcb/xproto.h>
 
 class QProcess;
+class QSocketNotifier;
 
 class xcb_screen_t;
 
@@ -35,6 +38,7 @@ class ApplicationWaylandAbstract;
 namespace Xwl
 {
 class DataBridge;
+class XwaylandSocket;
 
 class Xwayland : public XwaylandInterface
 {
@@ -46,7 +50,25 @@ public:
     Xwayland(ApplicationWaylandAbstract *app, QObject *parent = nullptr);
     ~Xwayland() override;
 
+    /**
+     * Starts Xwayland right away, it picks the display number itself.
+     */
     void init();
+    /**
+     * Listens on the sockets of a free X11 display and starts Xwayland when the first X11
+     * client connects to them. The DISPLAY environment variable is set right away, so that
+     * processes started in the meantime find the display.
+     *
+     * Falls back to init() if no display can be claimed.
+     */
+    void listen();
+    /**
+     * Whether listen() claimed a display, so that DISPLAY is set before Xwayland is up.
+     * Otherwise the display is only known once initialized() got emitted.
+     */
+    bool isListening() const {
+        return m_socket;
+    }
     void prepareDestroy();
 
     xcb_screen_t *xcbScreen() const {
@@ -61,6 +83,7 @@ Q_SIGNALS:
     void criticalError(int code);
 
 private:
+    void startProcess();
     void createX11Connection();
     void continueStartupWithX();
 
@@ -69,6 +92,8 @@ private:
     int m_xcbConnectionFd = -1;
     QProcess *m_xwaylandProcess = nullptr;
     QMetaObject::Connection m_xwaylandFailConnection;
+    XwaylandSocket *m_socket = nullptr;
+    QVector<QSocketNotifier *> m_socketNotifiers;
 
     xcb_screen_t *m_xcbScreen = nullptr;
     const xcb_query_extension_reply_t *m_xfixes = nullptr;
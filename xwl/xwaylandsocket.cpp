@@ -0,0 +1,167 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#include "xwaylandsocket.h"
+
+#include <xwayland_logging.h>
+
+#include <QFile>
+
+#include <cstring>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace KWin
+{
+namespace Xwl
+{
+
+static const int s_maxDisplay = 32;
+
+XwaylandSocket::XwaylandSocket()
+{
+    // the directory is usually created by the system, create it in case it isn't
+    mkdir("/tmp/.X11-unix", 01777);
+
+    for (int display = 0; display < s_maxDisplay; ++display) {
+        if (!lock(display)) {
+            continue;
+        }
+        const QByteArray path = QByteArrayLiteral("/tmp/.X11-unix/X") + QByteArray::number(display);
+        const int fd = listen(path, false);
+        if (fd == -1) {
+            QFile::remove(m_lockFileName);
+            continue;
+        }
+        m_fileDescriptors << fd;
+        m_socketFileName = QString::fromUtf8(path);
+#if defined(Q_OS_LINUX)
+        const int abstractFd = listen(path, true);
+        if (abstractFd == -1) {
+            // the display is used by an X server in another network namespace
+            close(fd);
+            m_fileDescriptors.clear();
+            QFile::remove(m_socketFileName);
+            QFile::remove(m_lockFileName);
+            continue;
+        }
+        m_fileDescriptors << abstractFd;
+#endif
+        m_display = display;
+        return;
+    }
+    qCWarning(KWIN_XWL) << "Failed to find a free X11 display";
+}
+
+XwaylandSocket::~XwaylandSocket()
+{
+    for (int fd : qAsConst(m_fileDescriptors)) {
+        close(fd);
+    }
+    if (isValid()) {
+        QFile::remove(m_socketFileName);
+        QFile::remove(m_lockFileName);
+    }
+}
+
+QString XwaylandSocket::name() const
+{
+    return QStringLiteral(":") + QString::number(m_display);
+}
+
+bool XwaylandSocket::lock(int display)
+{
+    const QString fileName = QStringLiteral("/tmp/.X%1-lock").arg(display);
+    const QByteArray encodedFileName = QFile::encodeName(fileName);
+
+    int fd = open(encodedFileName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0444);
+    if (fd == -1 && errno == EEXIST) {
+        // the lock file might be left over from an X server which is gone
+        QFile lockFile(fileName);
+        if (!lockFile.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        bool ok = false;
+        const pid_t pid = lockFile.readLine().trimmed().toInt(&ok);
+        if (!ok || pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH) {
+            return false;
+        }
+        if (!QFile::remove(fileName)) {
+            return false;
+        }
+        fd = open(encodedFileName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0444);
+    }
+    if (fd == -1) {
+        return false;
+    }
+
+    // the pid is written the way X servers do, so that they respect the lock
+    const QByteArray pid = QByteArray::number(getpid()).rightJustified(10) + '\n';
+    const bool written = write(fd, pid.constData(), pid.size()) == pid.size();
+    close(fd);
+    if (!written) {
+        QFile::remove(fileName);
+        return false;
+    }
+    m_lockFileName = fileName;
+    return true;
+}
+
+int XwaylandSocket::listen(const QByteArray &path, bool abstract)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    // an abstract socket has the path after a leading null byte
+    const int offset = abstract ? 1 : 0;
+    if (path.size() + offset >= int(sizeof(address.sun_path))) {
+        return -1;
+    }
+    memcpy(address.sun_path + offset, path.constData(), path.size());
+    socklen_t size = offsetof(sockaddr_un, sun_path) + offset + path.size();
+    if (!abstract) {
+        // the socket of a stale lock file
+        unlink(path.constData());
+        size++;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (bind(fd, reinterpret_cast<sockaddr *>(&address), size) == -1) {
+        close(fd);
+        return -1;
+    }
+    if (::listen(fd, 1) == -1) {
+        close(fd);
+        if (!abstract) {
+            unlink(path.constData());
+        }
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace Xwl
+} // namespace KWin
@@ -0,0 +1,68 @@
+/********************************************************************
+ KWin - the KDE window manager
+ This file is part of the KDE project.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*********************************************************************/
+#ifndef KWIN_XWL_XWAYLAND_SOCKET
+#define KWIN_XWL_XWAYLAND_SOCKET
+
+#include <QString>
+#include <QVector>
+
+namespace KWin
+{
+namespace Xwl
+{
+
+/**
+ * @short The listening sockets of an X11 display.
+ *
+ * Claims the first free display number with a lock file, the same way an X server does, and
+ * listens on its Unix socket and, on Linux, on its abstract socket. The sockets are handed
+ * to Xwayland, which accepts the connections of X11 clients on them.
+ */
+class XwaylandSocket
+{
+public:
+    XwaylandSocket();
+    ~XwaylandSocket();
+
+    bool isValid() const {
+        return m_display != -1;
+    }
+    /**
+     * The name of the display, e.g. ":1", for the DISPLAY environment variable.
+     */
+    QString name() const;
+    QVector<int> fileDescriptors() const {
+        return m_fileDescriptors;
+    }
+
+private:
+    bool lock(int display);
+    int listen(const QByteArray &path, bool abstract);
+
+    int m_display = -1;
+    QString m_lockFileName;
+    QString m_socketFileName;
+    QVector<int> m_fileDescriptors;
+
+    Q_DISABLE_COPY(XwaylandSocket)
+};
+
+} // namespace Xwl
+} // namespace KWin
+
+#endif